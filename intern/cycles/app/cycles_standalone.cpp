@@ -9,9 +9,11 @@
 #include "scene/integrator.h"
 #include "scene/scene.h"
 #include "session/buffers.h"
+#include "session/merge.h"
 #include "session/session.h"
 
 #include "util/args.h"
+#include "util/debug.h"
 #include "util/foreach.h"
 #include "util/function.h"
 #include "util/image.h"
@@ -19,6 +21,8 @@
 #include "util/path.h"
 #include "util/progress.h"
 #include "util/string.h"
+#include "util/system.h"
+#include "util/task.h"
 #include "util/time.h"
 #include "util/transform.h"
 #include "util/unique_ptr.h"
@@ -30,6 +34,13 @@
 
 #include "app/cycles_xml.h"
 #include "app/oiio_output_driver.h"
+#include "app/shared_output_driver.h"
+
+#ifndef _WIN32
+#  include <sys/mman.h>
+#  include <sys/wait.h>
+#  include <unistd.h>
+#endif
 
 #ifdef WITH_CYCLES_STANDALONE_GUI
 #  include "opengl/display_driver.h"
@@ -49,6 +60,8 @@ struct Options {
   bool show_help, interactive, pause;
   string output_filepath;
   string output_pass;
+  int workers;
+  SharedRenderResult *shared_result;
 } options;
 
 static void session_print(const string &str)
@@ -128,7 +141,6 @@ static void scene_init()
 
 static void session_init()
 {
-  options.output_pass = "combined";
   options.session = new Session(options.session_params, options.scene_params);
 
 #ifdef WITH_CYCLES_STANDALONE_GUI
@@ -138,7 +150,14 @@ static void session_init()
   }
 #endif
 
-  if (!options.output_filepath.empty()) {
+  if (options.shared_result) {
+    options.session->set_output_driver(
+        make_unique<SharedOutputDriver>(options.shared_result,
+                                        options.output_pass,
+                                        options.session_params.samples,
+                                        session_print));
+  }
+  else if (!options.output_filepath.empty()) {
     options.session->set_output_driver(make_unique<OIIOOutputDriver>(
         options.output_filepath, options.output_pass, session_print));
   }
@@ -154,6 +173,13 @@ static void session_init()
   /* load scene */
   scene_init();
 
+  if (options.shared_result && options.scene->integrator->get_use_denoise()) {
+    /* Denoising the partial results of the workers separately does not give the same result as
+     * denoising the merged result once, so let the main process report it instead of rendering. */
+    options.shared_result->use_denoise = true;
+    return;
+  }
+
   /* add pass for output. */
   Pass *pass = options.scene->create_node<Pass>();
   pass->set_name(ustring(options.output_pass.c_str()));
@@ -176,6 +202,198 @@ static void session_exit()
   }
 }
 
+#ifndef _WIN32
+/* Local Render Farm
+ *
+ * Render with multiple worker processes, each bound to a NUMA node and rendering a disjoint
+ * range of samples. Workers write their result into shared memory, where it is merged weighted
+ * by the number of samples once all workers finished. */
+
+class SharedRenderTile : public OutputDriver::Tile {
+ public:
+  SharedRenderTile(SharedRenderResult *result)
+      : OutputDriver::Tile(make_int2(0, 0),
+                           make_int2(result->width, result->height),
+                           make_int2(result->width, result->height),
+                           "",
+                           ""),
+        result_(result)
+  {
+  }
+
+  bool get_pass_pixels(const string_view /*pass_name*/,
+                       const int num_channels,
+                       float *pixels) const override
+  {
+    if (num_channels != 4) {
+      return false;
+    }
+
+    memcpy(pixels, result_->pixels(), sizeof(float) * 4 * size.x * size.y);
+    return true;
+  }
+
+  bool set_pass_pixels(const string_view /*pass_name*/,
+                       const int /*num_channels*/,
+                       const float * /*pixels*/) const override
+  {
+    return false;
+  }
+
+ protected:
+  SharedRenderResult *result_;
+};
+
+static int farm_worker_run(SharedRenderResult *result,
+                           const int numa_node,
+                           const int sample_offset,
+                           const int num_samples,
+                           const int num_threads)
+{
+  /* Bind before loading the scene, so its memory is allocated on the same node. */
+  if (!system_numa_node_bind(numa_node)) {
+    fprintf(stderr, "Failed to bind worker to NUMA node %d\n", numa_node);
+  }
+
+  options.shared_result = result;
+  options.quiet = true;
+  options.session_params.sample_offset = sample_offset;
+  options.session_params.samples = num_samples;
+  if (options.session_params.threads == 0) {
+    options.session_params.threads = num_threads;
+  }
+
+  session_init();
+  if (result->use_denoise) {
+    session_exit();
+    return EXIT_FAILURE;
+  }
+  options.session->wait();
+
+  const bool canceled = options.session->progress.get_cancel();
+  session_exit();
+
+  return (!canceled && result->samples > 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static bool farm_render()
+{
+  const int num_samples = options.session_params.samples;
+  const int num_workers = min(options.workers, num_samples);
+  const int num_nodes = system_numa_node_count();
+
+  /* Shared memory is mapped before forking, so all worker processes inherit it. */
+  const size_t result_size = align_up(
+      SharedRenderResult::size(options.width, options.height), 64);
+  const size_t shared_size = result_size * num_workers;
+  void *shared_memory = mmap(
+      NULL, shared_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (shared_memory == MAP_FAILED) {
+    fprintf(stderr, "Failed to allocate shared memory for %d workers\n", num_workers);
+    return false;
+  }
+
+  vector<SharedRenderResult *> results;
+  vector<pid_t> pids;
+  bool ok = true;
+
+  for (int i = 0; i < num_workers; i++) {
+    SharedRenderResult *result = reinterpret_cast<SharedRenderResult *>(
+        static_cast<char *>(shared_memory) + result_size * i);
+    result->width = options.width;
+    result->height = options.height;
+    result->samples = 0;
+    result->use_denoise = false;
+    results.push_back(result);
+
+    const int sample_begin = int(int64_t(num_samples) * i / num_workers);
+    const int sample_end = int(int64_t(num_samples) * (i + 1) / num_workers);
+    const int numa_node = i % num_nodes;
+
+    /* Share the processors of a node between the workers bound to it. Without NUMA information
+     * all processors are shared between all workers. */
+    const int node_workers = (num_workers - numa_node + num_nodes - 1) / num_nodes;
+    const int node_processors = system_numa_node_num_processors(numa_node);
+    const int num_threads = max((node_processors > 0) ?
+                                    node_processors / node_workers :
+                                    TaskScheduler::max_concurrency() / num_workers,
+                                1);
+
+    if (!options.quiet) {
+      printf("Worker %d: rendering samples %d-%d on NUMA node %d\n",
+             i,
+             sample_begin,
+             sample_end - 1,
+             numa_node);
+      fflush(stdout);
+    }
+
+    const pid_t pid = fork();
+    if (pid == 0) {
+      _exit(farm_worker_run(
+          result, numa_node, sample_begin, sample_end - sample_begin, num_threads));
+    }
+    else if (pid < 0) {
+      fprintf(stderr, "Failed to start worker %d\n", i);
+      ok = false;
+      break;
+    }
+
+    pids.push_back(pid);
+  }
+
+  for (const pid_t pid : pids) {
+    int status = 0;
+    if (waitpid(pid, &status, 0) != pid || !WIFEXITED(status) ||
+        WEXITSTATUS(status) != EXIT_SUCCESS)
+    {
+      ok = false;
+    }
+  }
+
+  bool use_denoise = false;
+  for (const SharedRenderResult *result : results) {
+    use_denoise |= result->use_denoise;
+  }
+
+  if (ok) {
+    BufferMerger merger;
+    for (SharedRenderResult *result : results) {
+      merger.input.push_back({result->pixels(), result->samples});
+    }
+    merger.size = size_t(options.width) * options.height * 4;
+    merger.output = results[0]->pixels();
+
+    if (merger.run()) {
+      results[0]->samples = num_samples;
+
+      OIIOOutputDriver output_driver(
+          options.output_filepath, options.output_pass, session_print);
+      output_driver.write_render_tile(SharedRenderTile(results[0]));
+    }
+    else {
+      fprintf(stderr, "%s\n", merger.error.c_str());
+      ok = false;
+    }
+  }
+  else if (use_denoise) {
+    fprintf(stderr, "Rendering with multiple workers does not support denoising\n");
+  }
+  else {
+    fprintf(stderr, "Rendering failed in one or more workers\n");
+  }
+
+  munmap(shared_memory, shared_size);
+
+  if (ok && !options.quiet) {
+    session_print("Finished Rendering.");
+    printf("\n");
+  }
+
+  return ok;
+}
+#endif
+
 #ifdef WITH_CYCLES_STANDALONE_GUI
 static void display_info(Progress &progress)
 {
@@ -364,6 +582,9 @@ static void options_parse(int argc, const char **argv)
   options.filepath = "";
   options.session = NULL;
   options.quiet = false;
+  options.output_pass = "combined";
+  options.workers = 0;
+  options.shared_result = NULL;
   options.session_params.use_auto_tile = false;
   options.session_params.tile_size = 0;
 
@@ -388,7 +609,9 @@ static void options_parse(int argc, const char **argv)
   /* parse options */
   ArgParse ap;
   bool help = false, profile = false, debug = false, version = false;
+  bool cpu_wavefront = false;
   int verbosity = 1;
+  int texture_cache_size = 0;
 
   ap.options("Usage: cycles [options] file.xml",
              "%*",
@@ -426,6 +649,17 @@ static void options_parse(int argc, const char **argv)
              "--tile-size %d",
              &options.session_params.tile_size,
              "Tile size in pixels",
+             "--texture-cache-size %d",
+             &texture_cache_size,
+             "Memory limit in MB for tiled image textures loaded on demand, CPU only",
+             "--cpu-wavefront",
+             &cpu_wavefront,
+             "Render many paths at once sorted by shader instead of one by one, CPU only",
+#ifndef _WIN32
+             "--workers %d",
+             &options.workers,
+             "Render in background with multiple processes bound to NUMA nodes, CPU only",
+#endif
              "--list-devices",
              &list,
              "List information about all available devices",
@@ -498,6 +732,14 @@ static void options_parse(int argc, const char **argv)
     options.session_params.use_auto_tile = true;
   }
 
+  if (texture_cache_size > 0) {
+    options.scene_params.texture_cache_size = size_t(texture_cache_size) * 1024 * 1024;
+  }
+
+  if (cpu_wavefront) {
+    DebugFlags().cpu.wavefront = true;
+  }
+
   /* find matching device */
   DeviceType device_type = Device::type_from_string(devicename.c_str());
   vector<DeviceInfo> devices = Device::available_devices(DEVICE_MASK(device_type));
@@ -533,6 +775,28 @@ static void options_parse(int argc, const char **argv)
     fprintf(stderr, "No file path specified\n");
     exit(EXIT_FAILURE);
   }
+  else if (options.workers > 1) {
+    if (options.session_params.device.type != DEVICE_CPU) {
+      fprintf(stderr, "Rendering with multiple workers only works with CPU device\n");
+      exit(EXIT_FAILURE);
+    }
+    else if (!options.session_params.background) {
+      fprintf(stderr, "Rendering with multiple workers requires background mode\n");
+      exit(EXIT_FAILURE);
+    }
+    else if (options.output_filepath.empty()) {
+      fprintf(stderr, "Rendering with multiple workers requires an output file path\n");
+      exit(EXIT_FAILURE);
+    }
+    else if (options.width <= 0 || options.height <= 0) {
+      fprintf(stderr, "Rendering with multiple workers requires a width and height\n");
+      exit(EXIT_FAILURE);
+    }
+    else if (options.session_params.samples == 0) {
+      fprintf(stderr, "Rendering with multiple workers requires a number of samples\n");
+      exit(EXIT_FAILURE);
+    }
+  }
 }
 
 CCL_NAMESPACE_END
@@ -545,6 +809,12 @@ int main(int argc, const char **argv)
   path_init();
   options_parse(argc, argv);
 
+#ifndef _WIN32
+  if (options.workers > 1) {
+    return farm_render() ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+#endif
+
 #ifdef WITH_CYCLES_STANDALONE_GUI
   if (options.session_params.background) {
 #endif
@@ -0,0 +1,39 @@
+/* SPDX-FileCopyrightText: 2011-2022 Blender Foundation
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include "app/shared_output_driver.h"
+
+CCL_NAMESPACE_BEGIN
+
+SharedOutputDriver::SharedOutputDriver(SharedRenderResult *result,
+                                       const string_view pass,
+                                       const int samples,
+                                       LogFunction log)
+    : result_(result), pass_(pass), samples_(samples), log_(log)
+{
+}
+
+SharedOutputDriver::~SharedOutputDriver() {}
+
+void SharedOutputDriver::write_render_tile(const Tile &tile)
+{
+  /* Only write the full buffer, no intermediate tiles. */
+  if (!(tile.size == tile.full_size)) {
+    return;
+  }
+
+  if (tile.size.x != result_->width || tile.size.y != result_->height) {
+    log_("Render size does not match shared render result");
+    return;
+  }
+
+  if (!tile.get_pass_pixels(pass_, 4, result_->pixels())) {
+    log_("Failed to read render pass pixels");
+    return;
+  }
+
+  result_->samples = samples_;
+}
+
+CCL_NAMESPACE_END
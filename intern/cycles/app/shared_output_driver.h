@@ -0,0 +1,53 @@
+/* SPDX-FileCopyrightText: 2011-2022 Blender Foundation
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include "session/output_driver.h"
+
+#include "util/function.h"
+#include "util/string.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Render result of a worker process, placed in memory shared with the process that merges
+ * the results. The RGBA pixels of the output pass directly follow this header. */
+struct SharedRenderResult {
+  int width;
+  int height;
+  /* Number of samples the pixels were rendered with, zero until written. */
+  int samples;
+  /* Set by the worker when the scene uses denoising, which is not supported because every
+   * worker only renders part of the samples. */
+  bool use_denoise;
+
+  float *pixels()
+  {
+    return reinterpret_cast<float *>(this + 1);
+  }
+
+  static size_t size(const int width, const int height)
+  {
+    return sizeof(SharedRenderResult) + sizeof(float) * 4 * width * height;
+  }
+};
+
+class SharedOutputDriver : public OutputDriver {
+ public:
+  typedef function<void(const string &)> LogFunction;
+
+  SharedOutputDriver(SharedRenderResult *result,
+                     const string_view pass,
+                     const int samples,
+                     LogFunction log);
+  virtual ~SharedOutputDriver();
+
+  void write_render_tile(const Tile &tile) override;
+
+ protected:
+  SharedRenderResult *result_;
+  string pass_;
+  int samples_;
+  LogFunction log_;
+};
+
+CCL_NAMESPACE_END
@@ -54,6 +54,11 @@ enum_bvh_types = (
     ('STATIC_BVH', "Static BVH", "Any object modification requires a complete BVH rebuild, but renders faster"),
 )
 
+enum_bvh_build_qualities = (
+    ('HIGH', "High", "Build the BVH for best render speed"),
+    ('FAST', "Fast", "Build the BVH quickly and refit it when only vertices move, at the cost of slower render time"),
+)
+
 enum_filter_types = (
     ('BOX', "Box", "Box filter"),
     ('GAUSSIAN', "Gaussian", "Gaussian filter"),
@@ -898,6 +903,12 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
         items=enum_bvh_types,
         default='DYNAMIC_BVH',
     )
+    debug_bvh_build_quality: EnumProperty(
+        name="Viewport BVH Build Quality",
+        description="Choose between faster updates of deforming objects, or faster render, when using the BVH2 layout",
+        items=enum_bvh_build_qualities,
+        default='HIGH',
+    )
     debug_use_spatial_splits: BoolProperty(
         name="Use Spatial Splits",
         description="Use BVH spatial splits: longer builder time, faster render",
@@ -1040,6 +1051,13 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
         description="",
         min=8, max=8192,
     )
+    texture_cache_size: IntProperty(
+        name="Texture Cache",
+        description="Memory limit in megabytes for image textures that are loaded on demand while rendering on the CPU. "
+        "Only images stored as tiles, like .tx and tiled OpenEXR files, are loaded this way. 0 loads all images fully",
+        default=0,
+        min=0, max=1024 * 1024,
+    )
 
     # Various fine-tuning debug flags
 
@@ -1055,6 +1073,11 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
         items=enum_bvh_layouts,
         default='EMBREE',
     )
+    debug_use_cpu_wavefront: BoolProperty(
+        name="Wavefront",
+        description="Render many paths at once, sorted by kernel and shader, instead of one path after the other",
+        default=False,
+    )
 
     debug_use_cuda_adaptive_compile: BoolProperty(name="Adaptive Compile", default=False)
 
@@ -856,6 +856,13 @@ SceneParams BlenderSync::get_scene_params(BL::Scene &b_scene,
     params.bvh_type = BVH_TYPE_DYNAMIC;
   }
 
+  if (!background && use_developer_ui) {
+    params.bvh_build_quality = (BVHBuildQuality)get_enum(cscene, "debug_bvh_build_quality");
+  }
+  else {
+    params.bvh_build_quality = BVH_BUILD_QUALITY_HIGH;
+  }
+
   params.use_bvh_spatial_split = RNA_boolean_get(&cscene, "debug_use_spatial_splits");
   params.use_bvh_compact_structure = RNA_boolean_get(&cscene, "debug_use_compact_bvh");
   params.use_bvh_unaligned_nodes = RNA_boolean_get(&cscene, "debug_use_hair_bvh");
@@ -880,6 +887,8 @@ SceneParams BlenderSync::get_scene_params(BL::Scene &b_scene,
     params.texture_limit = 0;
   }
 
+  params.texture_cache_size = size_t(get_int(cscene, "texture_cache_size")) * 1024 * 1024;
+
   params.bvh_layout = DebugFlags().cpu.bvh_layout;
 
   params.background = background;
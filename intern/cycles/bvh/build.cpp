@@ -26,6 +26,7 @@
 #include "util/queue.h"
 #include "util/simd.h"
 #include "util/stack_allocator.h"
+#include "util/tbb.h"
 #include "util/time.h"
 
 CCL_NAMESPACE_BEGIN
@@ -491,6 +492,12 @@ BVHNode *BVHBuild::run()
     params.use_spatial_split = false;
   }
 
+  const bool use_linear_build = (params.build_quality == BVH_BUILD_QUALITY_FAST);
+  if (use_linear_build) {
+    params.use_spatial_split = false;
+    params.use_unaligned_nodes = false;
+  }
+
   spatial_min_overlap = root.bounds().safe_area() * params.spatial_split_alpha;
   spatial_free_index = 0;
 
@@ -516,7 +523,11 @@ BVHNode *BVHBuild::run()
   /* build recursively */
   BVHNode *rootnode;
 
-  if (params.use_spatial_split) {
+  if (use_linear_build) {
+    /* Perform multithreaded linear build. */
+    rootnode = build_linear(root);
+  }
+  else if (params.use_spatial_split) {
     /* Perform multithreaded spatial split build. */
     BVHSpatialStorage *local_storage = &spatial_storage.local();
     rootnode = build_node(root, references, 0, local_storage);
@@ -531,6 +542,7 @@ BVHNode *BVHBuild::run()
 
   /* clean up temporary memory usage by threads */
   spatial_storage.clear();
+  morton_codes.free_memory();
 
   /* delete if we canceled */
   if (rootnode) {
@@ -633,6 +645,31 @@ void BVHBuild::thread_build_spatial_split_node(InnerNode *inner,
   inner->children[child] = node;
 }
 
+void BVHBuild::thread_build_linear_node(InnerNode *inner,
+                                        int child,
+                                        int start,
+                                        int end,
+                                        int level)
+{
+  if (progress.get_cancel()) {
+    return;
+  }
+
+  /* build nodes */
+  BVHNode *node = build_linear_node(start, end, level);
+
+  /* set child in inner node */
+  inner->children[child] = node;
+
+  /* update progress */
+  if (end - start < THREAD_TASK_SIZE) {
+    thread_scoped_lock lock(build_mutex);
+
+    progress_count += end - start;
+    progress_update();
+  }
+}
+
 bool BVHBuild::range_within_max_leaf_size(const BVHRange &range,
                                           const vector<BVHReference> &references) const
 {
@@ -894,8 +931,177 @@ BVHNode *BVHBuild::build_node(const BVHRange &range,
   return inner;
 }
 
+/* Linear BVH builder
+ *
+ * References are sorted along a Morton curve through the centers of their bounds, and the
+ * tree is built top-down by splitting ranges where the highest differing bit of their Morton
+ * codes changes. No cost evaluation is involved, so this is much faster than the binning
+ * builder, at the cost of a less efficient tree. */
+
+/* Insert two zero bits between each of the lower 10 bits of the value. */
+static inline uint morton_expand_bits(uint v)
+{
+  v = (v * 0x00010001u) & 0xFF0000FFu;
+  v = (v * 0x00000101u) & 0x0F00F00Fu;
+  v = (v * 0x00000011u) & 0xC30C30C3u;
+  v = (v * 0x00000005u) & 0x49249249u;
+  return v;
+}
+
+/* 30 bit Morton code of a position normalized to the unit cube. */
+static inline uint morton_code(const float3 p)
+{
+  const float3 q = clamp(p * 1024.0f, zero_float3(), make_float3(1023.0f));
+  return (morton_expand_bits(uint(q.x)) << 2) | (morton_expand_bits(uint(q.y)) << 1) |
+         morton_expand_bits(uint(q.z));
+}
+
+/* Inner nodes built in parallel are created before the bounds of their children are known, and
+ * get their bounds once the whole tree is built. */
+static void linear_node_update_bounds(BVHNode *node)
+{
+  if (node->is_leaf() || node->bounds.valid()) {
+    return;
+  }
+  for (int i = 0; i < node->num_children(); i++) {
+    BVHNode *child = node->get_child(i);
+    linear_node_update_bounds(child);
+    node->bounds.grow(child->bounds);
+  }
+}
+
+BVHNode *BVHBuild::build_linear(const BVHRange &range)
+{
+  const size_t num_references = references.size();
+
+  /* Morton codes of the reference centers, in a cube around the centroid bounds of all
+   * references. The same scale is used along all axes so flat scenes keep their proportions. */
+  const BoundBox &cent_bounds = range.cent_bounds();
+  const float cent_size = reduce_max(cent_bounds.size());
+  const float cent_scale = (cent_size > 0.0f) ? 1.0f / cent_size : 0.0f;
+
+  vector<std::pair<uint, int>> order(num_references);
+  parallel_for(blocked_range<size_t>(0, num_references, 1024),
+               [&](const blocked_range<size_t> &r) {
+                 for (size_t i = r.begin(); i != r.end(); i++) {
+                   const float3 center = references[i].bounds().center2();
+                   order[i] = {morton_code((center - cent_bounds.min) * cent_scale), int(i)};
+                 }
+               });
+  parallel_sort(order.begin(), order.end());
+
+  if (progress.get_cancel()) {
+    return NULL;
+  }
+
+  /* Reorder references along the curve. */
+  vector<BVHReference> sorted_references(num_references);
+  morton_codes.resize(num_references);
+  parallel_for(blocked_range<size_t>(0, num_references, 1024),
+               [&](const blocked_range<size_t> &r) {
+                 for (size_t i = r.begin(); i != r.end(); i++) {
+                   sorted_references[i] = references[order[i].second];
+                   morton_codes[i] = order[i].first;
+                 }
+               });
+  references.swap(sorted_references);
+
+  BVHNode *rootnode = build_linear_node(0, num_references, 0);
+  task_pool.wait_work();
+
+  if (rootnode && !progress.get_cancel()) {
+    linear_node_update_bounds(rootnode);
+  }
+
+  return rootnode;
+}
+
+BVHNode *BVHBuild::build_linear_node(int start, int end, int level)
+{
+  const int size = end - start;
+
+  /* Have at least one inner node on top level, for performance and correct
+   * visibility tests, since object instances do not check visibility flag.
+   */
+  if (!(size > 0 && params.top_level && level == 0)) {
+    if (params.small_enough_for_leaf(size, level) || size <= LINEAR_MAX_LEAF_SIZE) {
+      BoundBox bounds = BoundBox::empty;
+      bool is_single_primitive_type = (size > 0);
+      for (int i = start; i < end; i++) {
+        const BVHReference &ref = references[i];
+        bounds.grow(ref.bounds());
+        is_single_primitive_type &= (ref.prim_index() != -1 &&
+                                     ref.prim_type() == references[start].prim_type());
+      }
+      const BVHRange range(bounds, start, size);
+      if (range_within_max_leaf_size(range, references)) {
+        if (is_single_primitive_type) {
+          return create_linear_leaf_node(range);
+        }
+        return create_leaf_node(range, references);
+      }
+    }
+  }
+
+  /* Split where the highest bit in which the Morton codes of the range differ changes, or in
+   * the middle when all codes are equal. */
+  const uint first_code = morton_codes[start];
+  const uint last_code = morton_codes[end - 1];
+  int split = start + size / 2;
+  if (first_code != last_code) {
+    const int bit = 31 - count_leading_zeros(first_code ^ last_code);
+    const uint split_code = ((first_code >> bit) | 1) << bit;
+    const uint *codes = morton_codes.data();
+    split = std::lower_bound(codes + start, codes + end, split_code) - codes;
+  }
+
+  /* Create inner node. */
+  InnerNode *inner;
+  if (size < THREAD_TASK_SIZE) {
+    /* local build */
+    BVHNode *leftnode = build_linear_node(start, split, level + 1);
+    BVHNode *rightnode = build_linear_node(split, end, level + 1);
+
+    inner = new InnerNode(merge(leftnode->bounds, rightnode->bounds), leftnode, rightnode);
+  }
+  else {
+    /* Threaded build */
+    inner = new InnerNode(BoundBox::empty);
+
+    task_pool.push([=] { thread_build_linear_node(inner, 0, start, split, level + 1); });
+    task_pool.push([=] { thread_build_linear_node(inner, 1, split, end, level + 1); });
+  }
+
+  return inner;
+}
+
 /* Create Nodes */
 
+BVHNode *BVHBuild::create_linear_leaf_node(const BVHRange &range)
+{
+  /* Simplified create_leaf_node() for primitives of a single type, which are already in place
+   * since the linear builder neither splits references nor uses unaligned nodes. */
+  uint visibility = 0;
+  float time_from = 1.0f, time_to = 0.0f;
+  for (int i = range.start(); i < range.end(); i++) {
+    const BVHReference &ref = references[i];
+    prim_type[i] = ref.prim_type();
+    prim_index[i] = ref.prim_index();
+    prim_object[i] = ref.prim_object();
+    if (need_prim_time) {
+      prim_time[i] = make_float2(ref.time_from(), ref.time_to());
+    }
+    visibility |= objects[ref.prim_object()]->visibility_for_tracing();
+    time_from = min(time_from, ref.time_from());
+    time_to = max(time_to, ref.time_to());
+  }
+
+  LeafNode *leaf_node = new LeafNode(range.bounds(), visibility, range.start(), range.end());
+  leaf_node->time_from = time_from;
+  leaf_node->time_to = time_to;
+  return leaf_node;
+}
+
 BVHNode *BVHBuild::create_object_leaf_nodes(const BVHReference *ref, int start, int num)
 {
   if (num == 0) {
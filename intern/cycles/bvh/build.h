@@ -73,12 +73,18 @@ class BVHBuild {
   BVHNode *create_leaf_node(const BVHRange &range, const vector<BVHReference> &references);
   BVHNode *create_object_leaf_nodes(const BVHReference *ref, int start, int num);
 
+  /* Linear BVH building. */
+  BVHNode *build_linear(const BVHRange &range);
+  BVHNode *build_linear_node(int start, int end, int level);
+  BVHNode *create_linear_leaf_node(const BVHRange &range);
+
   bool range_within_max_leaf_size(const BVHRange &range,
                                   const vector<BVHReference> &references) const;
 
   /* Threads. */
   enum { THREAD_TASK_SIZE = 4096 };
   void thread_build_node(InnerNode *node, int child, const BVHObjectBinning &range, int level);
+  void thread_build_linear_node(InnerNode *node, int child, int start, int end, int level);
   void thread_build_spatial_split_node(InnerNode *node,
                                        int child,
                                        const BVHRange &range,
@@ -116,6 +122,10 @@ class BVHBuild {
   size_t progress_total;
   size_t progress_original_total;
 
+  /* Linear building, Morton codes of the sorted references. */
+  enum { LINEAR_MAX_LEAF_SIZE = 4 };
+  vector<uint> morton_codes;
+
   /* Spatial splitting. */
   float spatial_min_overlap;
   enumerable_thread_specific<BVHSpatialStorage> spatial_storage;
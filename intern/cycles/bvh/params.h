@@ -43,6 +43,23 @@ enum BVHType {
   BVH_NUM_TYPES,
 };
 
+/* Trade-off between the time it takes to build the BVH and the time it takes to trace rays
+ * through it. Only used by the BVH2 builder.
+ */
+enum BVHBuildQuality {
+  /* Binned SAH build with optional spatial splits.
+   *
+   * Slower to build, but gives best possible render speed.
+   */
+  BVH_BUILD_QUALITY_HIGH = 0,
+  /* Linear BVH build from primitives sorted along a Morton curve, and refit instead of rebuild
+   * of the scene BVH when only vertex positions change.
+   *
+   * Much faster to update for interactive changes of deforming geometry, but slower to render.
+   */
+  BVH_BUILD_QUALITY_FAST = 1,
+};
+
 /* Names bit-flag type to denote which BVH layouts are supported by
  * particular area.
  *
@@ -104,6 +121,7 @@ class BVHParams {
 
   /* Same as in SceneParams. */
   int bvh_type;
+  BVHBuildQuality build_quality;
 
   /* These are needed for Embree. */
   int curve_subdivisions;
@@ -141,6 +159,7 @@ class BVHParams {
     num_motion_point_steps = 0;
 
     bvh_type = 0;
+    build_quality = BVH_BUILD_QUALITY_HIGH;
 
     curve_subdivisions = 4;
   }
@@ -154,6 +154,14 @@ void CPUDevice::mem_copy_to(device_memory &mem)
   }
 }
 
+void CPUDevice::mem_copy_to_range(device_memory &mem, size_t /*size*/, size_t /*offset*/)
+{
+  /* Device memory aliases the host memory, so once it is allocated there is nothing to copy. */
+  if (!mem.device_pointer) {
+    mem_copy_to(mem);
+  }
+}
+
 void CPUDevice::mem_copy_from(
     device_memory & /*mem*/, size_t /*y*/, size_t /*w*/, size_t /*h*/, size_t /*elem*/)
 {
@@ -236,7 +244,9 @@ void CPUDevice::tex_alloc(device_texture &mem)
             << string_human_readable_number(mem.memory_size()) << " bytes. ("
             << string_human_readable_size(mem.memory_size()) << ")";
 
-  mem.device_pointer = (device_ptr)mem.host_pointer;
+  /* Cached textures point to the texture cache instead, which allocates tiles on demand. */
+  mem.device_pointer = mem.info.use_texture_cache ? (device_ptr)mem.info.data :
+                                                    (device_ptr)mem.host_pointer;
   mem.device_size = mem.memory_size();
   stats.mem_alloc(mem.device_size);
 
@@ -247,7 +257,7 @@ void CPUDevice::tex_alloc(device_texture &mem)
   }
 
   texture_info[slot] = mem.info;
-  texture_info[slot].data = (uint64_t)mem.host_pointer;
+  texture_info[slot].data = (uint64_t)mem.device_pointer;
   need_texture_info = true;
 }
 
@@ -42,6 +42,7 @@ class CPUKernels {
   IntegratorShadeFunction integrator_shade_volume;
   IntegratorShadeFunction integrator_shade_dedicated_light;
   IntegratorShadeFunction integrator_megakernel;
+  IntegratorShadeFunction integrator_megakernel_step;
 
   /* Shader evaluation. */
 
@@ -49,6 +49,11 @@ uint Device::devices_initialized_mask = 0;
 
 Device::~Device() noexcept(false) {}
 
+void Device::mem_copy_to_range(device_memory &mem, size_t /*size*/, size_t /*offset*/)
+{
+  mem_copy_to(mem);
+}
+
 void Device::build_bvh(BVH *bvh, Progress &progress, bool refit)
 {
   assert(bvh->params.bvh_layout == BVH_LAYOUT_BVH2);
@@ -802,6 +807,24 @@ void GPUDevice::generic_copy_to(device_memory &mem)
   }
 }
 
+void GPUDevice::mem_copy_to_range(device_memory &mem, size_t size, size_t offset)
+{
+  /* Textures are stored in backend specific layouts, and memory which is not allocated yet has to
+   * go through the regular allocation path. */
+  if (mem.type == MEM_TEXTURE || !mem.host_pointer || !mem.device_pointer) {
+    mem_copy_to(mem);
+    return;
+  }
+
+  assert(offset + size <= mem.memory_size());
+
+  thread_scoped_lock lock(device_mem_map_mutex);
+  if (!device_mem_map[&mem].use_mapped_host || mem.host_pointer != mem.shared_pointer) {
+    copy_host_to_device(
+        (char *)mem.device_pointer + offset, (char *)mem.host_pointer + offset, size);
+  }
+}
+
 /* DeviceInfo */
 
 CCL_NAMESPACE_END
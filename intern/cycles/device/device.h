@@ -308,9 +308,13 @@ class Device {
   friend class MultiDevice;
   friend class DeviceServer;
   friend class device_memory;
+  friend class device_texture;
 
   virtual void mem_alloc(device_memory &mem) = 0;
   virtual void mem_copy_to(device_memory &mem) = 0;
+  /* Copy a byte range of host memory to already allocated device memory. Devices which can not
+   * update part of an allocation copy the whole memory instead. */
+  virtual void mem_copy_to_range(device_memory &mem, size_t size, size_t offset);
   virtual void mem_copy_from(device_memory &mem, size_t y, size_t w, size_t h, size_t elem) = 0;
   virtual void mem_zero(device_memory &mem) = 0;
   virtual void mem_free(device_memory &mem) = 0;
@@ -394,6 +398,8 @@ class GPUDevice : public Device {
   virtual void generic_free(device_memory &mem);
   virtual void generic_copy_to(device_memory &mem);
 
+  void mem_copy_to_range(device_memory &mem, size_t size, size_t offset) override;
+
   /* total - amount of device memory, free - amount of available device memory */
   virtual void get_device_memory_info(size_t &total, size_t &free) = 0;
 
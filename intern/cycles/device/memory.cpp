@@ -86,6 +86,13 @@ void device_memory::device_copy_to()
   }
 }
 
+void device_memory::device_copy_to(size_t size, size_t offset)
+{
+  if (host_pointer) {
+    device->mem_copy_to_range(*this, size, offset);
+  }
+}
+
 void device_memory::device_copy_from(size_t y, size_t w, size_t h, size_t elem)
 {
   assert(type != MEM_TEXTURE && type != MEM_READ_ONLY && type != MEM_GLOBAL);
@@ -231,6 +238,11 @@ void *device_texture::alloc(const size_t width, const size_t height, const size_
 
 void device_texture::copy_to_device()
 {
+  if (info.use_texture_cache) {
+    /* Pixels are owned by the texture cache, there is no host memory. */
+    device->mem_copy_to(*this);
+    return;
+  }
   device_copy_to();
 }
 
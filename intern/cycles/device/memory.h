@@ -283,6 +283,7 @@ class device_memory {
   void device_alloc();
   void device_free();
   void device_copy_to();
+  void device_copy_to(size_t size, size_t offset);
   void device_copy_from(size_t y, size_t w, size_t h, size_t elem);
   void device_zero();
 
@@ -367,6 +368,8 @@ template<typename T> class device_vector : public device_memory {
     data_elements = device_type_traits<T>::num_elements;
     modified = true;
     need_realloc_ = true;
+    modified_begin_ = 0;
+    modified_end_ = SIZE_MAX;
 
     assert(data_elements > 0);
   }
@@ -385,7 +388,7 @@ template<typename T> class device_vector : public device_memory {
       device_free();
       host_free();
       host_pointer = host_alloc(sizeof(T) * new_size);
-      modified = true;
+      tag_modified();
       assert(device_pointer == 0);
     }
 
@@ -463,8 +466,7 @@ template<typename T> class device_vector : public device_memory {
     data_height = 0;
     data_depth = 0;
     host_pointer = 0;
-    modified = true;
-    need_realloc_ = true;
+    tag_realloc();
     assert(device_pointer == 0);
   }
 
@@ -488,6 +490,27 @@ template<typename T> class device_vector : public device_memory {
   void tag_modified()
   {
     modified = true;
+    modified_begin_ = 0;
+    modified_end_ = SIZE_MAX;
+  }
+
+  /* Tag only a range of elements as modified. While the device memory does not need to be
+   * reallocated, copy_to_device_if_modified() then only copies the union of the tagged ranges. */
+  void tag_modified(size_t offset, size_t num)
+  {
+    if (num == 0) {
+      return;
+    }
+
+    if (!modified) {
+      modified = true;
+      modified_begin_ = offset;
+      modified_end_ = offset + num;
+    }
+    else {
+      modified_begin_ = min(modified_begin_, offset);
+      modified_end_ = max(modified_end_, offset + num);
+    }
   }
 
   void tag_realloc()
@@ -524,19 +547,34 @@ template<typename T> class device_vector : public device_memory {
     }
   }
 
+  void copy_to_device(size_t num, size_t offset)
+  {
+    if (num != 0) {
+      device_copy_to(sizeof(T) * num, sizeof(T) * offset);
+    }
+  }
+
   void copy_to_device_if_modified()
   {
     if (!modified) {
       return;
     }
 
-    copy_to_device();
+    /* Memory which was (re)allocated on the host is not on the device yet, copy all of it. */
+    if (device_pointer == 0 || modified_end_ > data_size) {
+      copy_to_device();
+      return;
+    }
+
+    copy_to_device(modified_end_ - modified_begin_, modified_begin_);
   }
 
   void clear_modified()
   {
     modified = false;
     need_realloc_ = false;
+    modified_begin_ = 0;
+    modified_end_ = 0;
   }
 
   void copy_from_device()
@@ -563,6 +601,10 @@ template<typename T> class device_vector : public device_memory {
   }
 
  protected:
+  /* Range of elements modified since the last clear_modified(). */
+  size_t modified_begin_;
+  size_t modified_end_;
+
   size_t size(size_t width, size_t height, size_t depth)
   {
     return width * ((height == 0) ? 1 : height) * ((depth == 0) ? 1 : depth);
@@ -366,6 +366,28 @@ class MultiDevice : public Device {
     stats.mem_alloc(mem.device_size - existing_size);
   }
 
+  void mem_copy_to_range(device_memory &mem, size_t size, size_t offset) override
+  {
+    device_ptr key = mem.device_pointer;
+    if (!key) {
+      mem_copy_to(mem);
+      return;
+    }
+
+    /* The allocation does not change, so only the owner device of each island needs to copy
+     * and kernel globals on the other devices stay valid. */
+    foreach (const vector<SubDevice *> &island, peer_islands) {
+      SubDevice *owner_sub = find_suitable_mem_device(key, island);
+      mem.device = owner_sub->device;
+      mem.device_pointer = owner_sub->ptr_map[key];
+
+      owner_sub->device->mem_copy_to_range(mem, size, offset);
+    }
+
+    mem.device = this;
+    mem.device_pointer = key;
+  }
+
   void mem_copy_from(device_memory &mem, size_t y, size_t w, size_t h, size_t elem) override
   {
     device_ptr key = mem.device_pointer;
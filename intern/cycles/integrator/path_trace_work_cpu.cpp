@@ -16,7 +16,9 @@
 #include "scene/scene.h"
 #include "session/buffers.h"
 
+#include "util/algorithm.h"
 #include "util/atomic.h"
+#include "util/debug.h"
 #include "util/log.h"
 #include "util/tbb.h"
 
@@ -42,6 +44,33 @@ static inline CPUKernelThreadGlobals *kernel_thread_globals_get(
   return &kernel_thread_globals[thread_index];
 }
 
+/* Number of pixels rendered together by a thread in wavefront mode. Large enough for many paths
+ * to use the same shader, small enough for the path states to stay in the CPU cache. */
+static constexpr int64_t wavefront_batch_size = 256;
+
+/* Sort key of the next kernel to execute for a path in wavefront mode, zero when the path is
+ * done. Shadow paths come first like in the megakernel. Surface shading is sorted by shader,
+ * other kernels keep the pixel order so that neighboring rays are traced together. */
+static inline uint64_t wavefront_sort_key(const IntegratorStateCPU &state)
+{
+  if (state.shadow.shadow_path.queued_kernel) {
+    return uint64_t(state.shadow.shadow_path.queued_kernel) << 32;
+  }
+  if (state.ao.shadow_path.queued_kernel) {
+    return uint64_t(state.ao.shadow_path.queued_kernel) << 32;
+  }
+
+  const uint32_t queued_kernel = state.path.queued_kernel;
+  switch (queued_kernel) {
+    case DEVICE_KERNEL_INTEGRATOR_SHADE_SURFACE:
+    case DEVICE_KERNEL_INTEGRATOR_SHADE_SURFACE_RAYTRACE:
+    case DEVICE_KERNEL_INTEGRATOR_SHADE_SURFACE_MNEE:
+      return (uint64_t(queued_kernel) << 32) | state.path.shader_sort_key;
+    default:
+      return uint64_t(queued_kernel) << 32;
+  }
+}
+
 PathTraceWorkCPU::PathTraceWorkCPU(Device *device,
                                    Film *film,
                                    DeviceScene *device_scene,
@@ -73,8 +102,46 @@ void PathTraceWorkCPU::render_samples(RenderStatistics &statistics,
     }
   }
 
+  /* Path guiding keeps the segments of a single path per thread, so it needs the megakernel. */
+  const bool use_wavefront = DebugFlags().cpu.wavefront &&
+                             !device_scene_->data.integrator.use_guiding;
+  if (use_wavefront) {
+    wavefront_states_.resize(kernel_thread_globals_.size());
+  }
+
   tbb::task_arena local_arena = local_tbb_arena_create(device_);
   local_arena.execute([&]() {
+    if (use_wavefront) {
+      const int64_t batches_num = divide_up(total_pixels_num, wavefront_batch_size);
+      parallel_for(int64_t(0), batches_num, [&](int64_t batch_index) {
+        if (is_cancel_requested()) {
+          return;
+        }
+
+        const int64_t first_work_index = batch_index * wavefront_batch_size;
+        const int64_t work_num = std::min(wavefront_batch_size,
+                                          total_pixels_num - first_work_index);
+
+        KernelWorkTile work_tile;
+        work_tile.w = 1;
+        work_tile.h = 1;
+        work_tile.start_sample = start_sample;
+        work_tile.sample_offset = sample_offset;
+        work_tile.num_samples = 1;
+        work_tile.offset = effective_buffer_params_.offset;
+        work_tile.stride = effective_buffer_params_.stride;
+
+        const int thread_index = tbb::this_task_arena::current_thread_index();
+        render_samples_wavefront(kernel_thread_globals_get(kernel_thread_globals_),
+                                 wavefront_states_[thread_index],
+                                 work_tile,
+                                 first_work_index,
+                                 work_num,
+                                 samples_num);
+      });
+      return;
+    }
+
     parallel_for(int64_t(0), total_pixels_num, [&](int64_t work_index) {
       if (is_cancel_requested()) {
         return;
@@ -164,6 +231,86 @@ void PathTraceWorkCPU::render_samples_full_pipeline(KernelGlobalsCPU *kernel_glo
   }
 }
 
+void PathTraceWorkCPU::render_samples_wavefront(KernelGlobalsCPU *kernel_globals,
+                                                vector<IntegratorStateCPU> &states,
+                                                const KernelWorkTile &work_tile,
+                                                const int64_t first_work_index,
+                                                const int64_t work_num,
+                                                const int samples_num)
+{
+  const bool has_bake = device_scene_->data.bake.use;
+  const int64_t image_width = effective_buffer_params_.width;
+
+  /* The shadow catcher path is split off into the state after the one of the main path. */
+  const int64_t states_per_path = device_scene_->data.integrator.has_shadow_catcher ? 2 : 1;
+  const int64_t states_num = work_num * states_per_path;
+  if (states.size() < states_num) {
+    states.resize(wavefront_batch_size * states_per_path);
+  }
+  for (int64_t i = 0; i < states_num; i++) {
+    path_state_init_queues(&states[i]);
+  }
+
+  /* Pixels that don't need any more samples. */
+  vector<bool> pixel_done(work_num, false);
+  /* Sort key and index of the paths that execute a kernel in the current step. */
+  vector<std::pair<uint64_t, int>> step_order;
+  step_order.reserve(states_num);
+
+  KernelWorkTile sample_work_tile = work_tile;
+  float *render_buffer = buffers_->buffer.data();
+
+  for (int sample = 0; sample < samples_num; ++sample) {
+    if (is_cancel_requested()) {
+      break;
+    }
+
+    for (int64_t i = 0; i < work_num; i++) {
+      if (pixel_done[i]) {
+        continue;
+      }
+
+      const int64_t work_index = first_work_index + i;
+      const int y = work_index / image_width;
+      const int x = work_index - y * image_width;
+      sample_work_tile.x = effective_buffer_params_.full_x + x;
+      sample_work_tile.y = effective_buffer_params_.full_y + y;
+
+      IntegratorStateCPU *state = &states[i * states_per_path];
+      const bool is_initialized =
+          (has_bake) ? kernels_.integrator_init_from_bake(
+                           kernel_globals, state, &sample_work_tile, render_buffer) :
+                       kernels_.integrator_init_from_camera(
+                           kernel_globals, state, &sample_work_tile, render_buffer);
+      if (!is_initialized) {
+        path_state_init_queues(state);
+        pixel_done[i] = true;
+      }
+    }
+
+    /* Execute one kernel for every path at a time, until all paths are done. */
+    while (true) {
+      step_order.clear();
+      for (int64_t i = 0; i < states_num; i++) {
+        const uint64_t key = wavefront_sort_key(states[i]);
+        if (key) {
+          step_order.emplace_back(key, int(i));
+        }
+      }
+      if (step_order.empty()) {
+        break;
+      }
+
+      sort(step_order.begin(), step_order.end());
+      for (const std::pair<uint64_t, int> &item : step_order) {
+        kernels_.integrator_megakernel_step(kernel_globals, &states[item.second], render_buffer);
+      }
+    }
+
+    ++sample_work_tile.start_sample;
+  }
+}
+
 void PathTraceWorkCPU::copy_to_display(PathTraceDisplay *display,
                                        PassMode pass_mode,
                                        int num_samples)
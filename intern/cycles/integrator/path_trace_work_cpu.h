@@ -74,6 +74,16 @@ class PathTraceWorkCPU : public PathTraceWork {
                                     const KernelWorkTile &work_tile,
                                     const int samples_num);
 
+  /* Render a batch of pixels by executing the kernels of all their paths step by step. Before
+   * each step the paths are sorted by kernel and shader, so that paths which run the same code
+   * are executed one after the other. */
+  void render_samples_wavefront(KernelGlobalsCPU *kernel_globals,
+                                vector<IntegratorStateCPU> &states,
+                                const KernelWorkTile &work_tile,
+                                const int64_t first_work_index,
+                                const int64_t work_num,
+                                const int samples_num);
+
   /* CPU kernels. */
   const CPUKernels &kernels_;
 
@@ -83,6 +93,9 @@ class PathTraceWorkCPU : public PathTraceWork {
    * accessing it, but some "localization" is required to decouple from kernel globals stored
    * on the device level. */
   vector<CPUKernelThreadGlobals> kernel_thread_globals_;
+
+  /* Path states of every thread for wavefront rendering, allocated on first use. */
+  vector<vector<IntegratorStateCPU>> wavefront_states_;
 };
 
 CCL_NAMESPACE_END
@@ -8,6 +8,8 @@
 #  include "kernel/util/nanovdb.h"
 #endif
 
+#include "util/texture_cache.h"
+
 CCL_NAMESPACE_BEGIN
 
 /* Make template functions private so symbols don't conflict between kernels with different
@@ -30,6 +32,62 @@ ccl_device_inline float frac(float x, int *ix)
   return x - (float)i;
 }
 
+/* Pixel access for textures in the texture cache. Tiles stay acquired until the lookup is done,
+ * so that neighboring pixels of the same tile don't need to acquire it again. */
+template<typename TexT> class CachedTexturePixels {
+ public:
+  explicit CachedTexturePixels(TextureCache::Texture &texture) : texture_(texture) {}
+
+  ~CachedTexturePixels()
+  {
+    release_tiles();
+  }
+
+  ccl_always_inline TexT get(const int x, const int y)
+  {
+    /* Tiles store rows from top to bottom like the image file, unlike fully loaded images. */
+    const int flipped_y = texture_.height - 1 - y;
+    const int tile_x = x >> texture_.tile_size_log2;
+    const int tile_y = flipped_y >> texture_.tile_size_log2;
+    const int mask = texture_.tile_size - 1;
+    const int index = (flipped_y & mask) * texture_.tile_width(tile_x) + (x & mask);
+
+    for (int i = 0; i < tiles_num_; i++) {
+      if (tiles_[i].x == tile_x && tiles_[i].y == tile_y) {
+        return tiles_[i].pixels[index];
+      }
+    }
+    if (tiles_num_ == max_tiles) {
+      /* Only happens for cubic lookups near small tiles at the border. */
+      release_tiles();
+    }
+    const TexT *pixels = static_cast<const TexT *>(texture_.acquire_tile(tile_x, tile_y));
+    tiles_[tiles_num_++] = {tile_x, tile_y, pixels};
+    return pixels[index];
+  }
+
+ private:
+  ccl_always_inline void release_tiles()
+  {
+    for (int i = 0; i < tiles_num_; i++) {
+      texture_.release_tile(tiles_[i].x, tiles_[i].y);
+    }
+    tiles_num_ = 0;
+  }
+
+  /* A 4x4 cubic footprint touches at most 2x2 tiles, except near the border. */
+  static constexpr int max_tiles = 4;
+
+  struct AcquiredTile {
+    int x, y;
+    const TexT *pixels;
+  };
+
+  TextureCache::Texture &texture_;
+  AcquiredTile tiles_[max_tiles];
+  int tiles_num_ = 0;
+};
+
 template<typename TexT, typename OutT = float4> struct TextureInterpolator {
 
   static ccl_always_inline OutT zero()
@@ -101,6 +159,22 @@ template<typename TexT, typename OutT = float4> struct TextureInterpolator {
     return read(data[y * width + x]);
   }
 
+  /* Read 2D Texture Data from the texture cache. */
+  static ccl_always_inline OutT
+  read(CachedTexturePixels<TexT> &pixels, int x, int y, int width, int height)
+  {
+    return read(pixels.get(x, y));
+  }
+
+  static ccl_always_inline OutT
+  read_clip(CachedTexturePixels<TexT> &pixels, int x, int y, int width, int height)
+  {
+    if (x < 0 || x >= width || y < 0 || y >= height) {
+      return zero();
+    }
+    return read(pixels.get(x, y));
+  }
+
   /* Read 3D Texture Data
    * Does not check if data request is in bounds. */
   static ccl_always_inline OutT
@@ -211,7 +285,11 @@ template<typename TexT, typename OutT = float4> struct TextureInterpolator {
 
   /* ********  2D interpolation ******** */
 
-  static ccl_always_inline OutT interp_closest(const TextureInfo &info, float x, float y)
+  template<typename Data>
+  static ccl_always_inline OutT interp_closest(const TextureInfo &info,
+                                               Data &data,
+                                               float x,
+                                               float y)
   {
     const int width = info.width;
     const int height = info.height;
@@ -242,11 +320,11 @@ template<typename TexT, typename OutT = float4> struct TextureInterpolator {
         return zero();
     }
 
-    const TexT *data = (const TexT *)info.data;
-    return read((const TexT *)data, ix, iy, width, height);
+    return read(data, ix, iy, width, height);
   }
 
-  static ccl_always_inline OutT interp_linear(const TextureInfo &info, float x, float y)
+  template<typename Data>
+  static ccl_always_inline OutT interp_linear(const TextureInfo &info, Data &data, float x, float y)
   {
     const int width = info.width;
     const int height = info.height;
@@ -256,7 +334,6 @@ template<typename TexT, typename OutT = float4> struct TextureInterpolator {
     int nix, niy;
     const float tx = frac(x * (float)width - 0.5f, &ix);
     const float ty = frac(y * (float)height - 0.5f, &iy);
-    const TexT *data = (const TexT *)info.data;
 
     switch (info.extension) {
       case EXTENSION_REPEAT:
@@ -300,7 +377,8 @@ template<typename TexT, typename OutT = float4> struct TextureInterpolator {
            ty * tx * read(data, nix, niy, width, height);
   }
 
-  static ccl_always_inline OutT interp_cubic(const TextureInfo &info, float x, float y)
+  template<typename Data>
+  static ccl_always_inline OutT interp_cubic(const TextureInfo &info, Data &data, float x, float y)
   {
     const int width = info.width;
     const int height = info.height;
@@ -367,7 +445,6 @@ template<typename TexT, typename OutT = float4> struct TextureInterpolator {
         return zero();
     }
 
-    const TexT *data = (const TexT *)info.data;
     const int xc[4] = {pix, ix, nix, nnix};
     const int yc[4] = {piy, iy, niy, nniy};
     float u[4], v[4];
@@ -389,16 +466,27 @@ template<typename TexT, typename OutT = float4> struct TextureInterpolator {
 #undef DATA
   }
 
-  static ccl_always_inline OutT interp(const TextureInfo &info, float x, float y)
+  template<typename Data>
+  static ccl_always_inline OutT interp(const TextureInfo &info, Data &data, float x, float y)
   {
     switch (info.interpolation) {
       case INTERPOLATION_CLOSEST:
-        return interp_closest(info, x, y);
+        return interp_closest(info, data, x, y);
       case INTERPOLATION_LINEAR:
-        return interp_linear(info, x, y);
+        return interp_linear(info, data, x, y);
       default:
-        return interp_cubic(info, x, y);
+        return interp_cubic(info, data, x, y);
+    }
+  }
+
+  static ccl_always_inline OutT interp(const TextureInfo &info, float x, float y)
+  {
+    if (info.use_texture_cache) {
+      CachedTexturePixels<TexT> pixels(*(TextureCache::Texture *)info.data);
+      return interp(info, pixels, x, y);
     }
+    const TexT *data = (const TexT *)info.data;
+    return interp(info, data, x, y);
   }
 
   /* ********  3D interpolation ******** */
@@ -865,6 +953,10 @@ ccl_device float4 kernel_tex_image_interp_3d(KernelGlobals kg,
   if (info.use_transform_3d) {
     P = transform_point(&info.transform_3d, P);
   }
+  if (info.use_texture_cache) {
+    /* Only 2D images are stored in the texture cache. */
+    return kernel_tex_image_interp(kg, id, P.x, P.y);
+  }
   switch (info.data_type) {
     case IMAGE_DATA_TYPE_HALF: {
       const float f = TextureInterpolator<half, float>::interp_3d(info, P.x, P.y, P.z, interp);
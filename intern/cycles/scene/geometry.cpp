@@ -547,60 +547,30 @@ void GeometryManager::device_update_preprocess(Device *device, Scene *scene, Pro
     dscene->attributes_map.tag_realloc();
     dscene->attributes_float.tag_realloc();
   }
-  else if (device_update_flags & ATTR_FLOAT_MODIFIED) {
-    dscene->attributes_float.tag_modified();
-  }
 
   if (device_update_flags & ATTR_FLOAT2_NEEDS_REALLOC) {
     dscene->attributes_map.tag_realloc();
     dscene->attributes_float2.tag_realloc();
   }
-  else if (device_update_flags & ATTR_FLOAT2_MODIFIED) {
-    dscene->attributes_float2.tag_modified();
-  }
 
   if (device_update_flags & ATTR_FLOAT3_NEEDS_REALLOC) {
     dscene->attributes_map.tag_realloc();
     dscene->attributes_float3.tag_realloc();
   }
-  else if (device_update_flags & ATTR_FLOAT3_MODIFIED) {
-    dscene->attributes_float3.tag_modified();
-  }
 
   if (device_update_flags & ATTR_FLOAT4_NEEDS_REALLOC) {
     dscene->attributes_map.tag_realloc();
     dscene->attributes_float4.tag_realloc();
   }
-  else if (device_update_flags & ATTR_FLOAT4_MODIFIED) {
-    dscene->attributes_float4.tag_modified();
-  }
 
   if (device_update_flags & ATTR_UCHAR4_NEEDS_REALLOC) {
     dscene->attributes_map.tag_realloc();
     dscene->attributes_uchar4.tag_realloc();
   }
-  else if (device_update_flags & ATTR_UCHAR4_MODIFIED) {
-    dscene->attributes_uchar4.tag_modified();
-  }
-
-  if (device_update_flags & DEVICE_MESH_DATA_MODIFIED) {
-    /* if anything else than vertices or shaders are modified, we would need to reallocate, so
-     * these are the only arrays that can be updated */
-    dscene->tri_verts.tag_modified();
-    dscene->tri_vnormal.tag_modified();
-    dscene->tri_shader.tag_modified();
-  }
-
-  if (device_update_flags & DEVICE_CURVE_DATA_MODIFIED) {
-    dscene->curve_keys.tag_modified();
-    dscene->curves.tag_modified();
-    dscene->curve_segments.tag_modified();
-  }
 
-  if (device_update_flags & DEVICE_POINT_DATA_MODIFIED) {
-    dscene->points.tag_modified();
-    dscene->points_shader.tag_modified();
-  }
+  /* Modified geometry and attributes which do not need reallocation are tagged per range while
+   * packing them in device_update_mesh() and device_update_attributes(), so that only the ranges
+   * that changed are copied to the device. */
 
   need_flags_update = false;
 }
@@ -933,6 +903,11 @@ void GeometryManager::device_update(Device *device,
    * change. */
   bool need_update_scene_bvh = (scene->bvh == nullptr ||
                                 (update_flags & (TRANSFORM_MODIFIED | VISIBILITY_MODIFIED)) != 0);
+  /* A BVH2 scene BVH can be refit instead of rebuilt when the same objects and primitives are in
+   * it, and only vertex positions of geometry that is not instanced changed. */
+  bool can_refit_scene_bvh2 = (scene->params.bvh_build_quality == BVH_BUILD_QUALITY_FAST &&
+                               (update_flags & (GEOMETRY_ADDED | GEOMETRY_REMOVED |
+                                                TRANSFORM_MODIFIED | VISIBILITY_MODIFIED)) == 0);
   {
     scoped_callback_timer timer([scene](double time) {
       if (scene->update_stats) {
@@ -945,6 +920,11 @@ void GeometryManager::device_update(Device *device,
     foreach (Geometry *geom, scene->geometry) {
       if (geom->is_modified() || geom->need_update_bvh_for_offset) {
         need_update_scene_bvh = true;
+        if (geom->need_update_rebuild || geom->need_update_bvh_for_offset ||
+            geom->need_build_bvh(bvh_layout))
+        {
+          can_refit_scene_bvh2 = false;
+        }
         pool.push(function_bind(
             &Geometry::compute_bvh, geom, device, dscene, &scene->params, &progress, i, num_bvh));
         if (geom->need_build_bvh(bvh_layout)) {
@@ -958,6 +938,16 @@ void GeometryManager::device_update(Device *device,
     VLOG_WORK << "Objects BVH build pool statistics:\n" << summary.full_report();
   }
 
+  if (need_update_scene_bvh && !can_refit_scene_bvh2 && scene->bvh &&
+      scene->bvh->params.bvh_layout == BVH_LAYOUT_BVH2 &&
+      scene->bvh->params.build_quality == BVH_BUILD_QUALITY_FAST)
+  {
+    /* The geometry no longer remembers what changed, so make sure the scene BVH is built from
+     * scratch even if this update gets canceled. */
+    delete scene->bvh;
+    scene->bvh = nullptr;
+  }
+
   foreach (Shader *shader, scene->shaders) {
     shader->need_update_uvs = false;
     shader->need_update_attribute = false;
@@ -989,7 +979,7 @@ void GeometryManager::device_update(Device *device,
         scene->update_stats->geometry.times.add_entry({"device_update (build scene BVH)", time});
       }
     });
-    device_update_bvh(device, dscene, scene, progress);
+    device_update_bvh(device, dscene, scene, can_refit_scene_bvh2, progress);
     if (progress.get_cancel()) {
       return;
     }
@@ -315,7 +315,7 @@ void GeometryManager::update_attribute_element_offset(Geometry *geom,
         for (size_t k = 0; k < size; k++) {
           attr_uchar4[offset + k] = data[k];
         }
-        attr_uchar4.tag_modified();
+        attr_uchar4.tag_modified(offset, size);
       }
       attr_uchar4_offset += size;
     }
@@ -328,7 +328,7 @@ void GeometryManager::update_attribute_element_offset(Geometry *geom,
         for (size_t k = 0; k < size; k++) {
           attr_float[offset + k] = data[k];
         }
-        attr_float.tag_modified();
+        attr_float.tag_modified(offset, size);
       }
       attr_float_offset += size;
     }
@@ -341,7 +341,7 @@ void GeometryManager::update_attribute_element_offset(Geometry *geom,
         for (size_t k = 0; k < size; k++) {
           attr_float2[offset + k] = data[k];
         }
-        attr_float2.tag_modified();
+        attr_float2.tag_modified(offset, size);
       }
       attr_float2_offset += size;
     }
@@ -354,7 +354,7 @@ void GeometryManager::update_attribute_element_offset(Geometry *geom,
         for (size_t k = 0; k < size * 3; k++) {
           attr_float4[offset + k] = (&tfm->x)[k];
         }
-        attr_float4.tag_modified();
+        attr_float4.tag_modified(offset, size * 3);
       }
       attr_float4_offset += size * 3;
     }
@@ -367,7 +367,7 @@ void GeometryManager::update_attribute_element_offset(Geometry *geom,
         for (size_t k = 0; k < size; k++) {
           attr_float4[offset + k] = data[k];
         }
-        attr_float4.tag_modified();
+        attr_float4.tag_modified(offset, size);
       }
       attr_float4_offset += size;
     }
@@ -380,7 +380,7 @@ void GeometryManager::update_attribute_element_offset(Geometry *geom,
         for (size_t k = 0; k < size; k++) {
           attr_float3[offset + k] = data[k];
         }
-        attr_float3.tag_modified();
+        attr_float3.tag_modified(offset, size);
       }
       attr_float3_offset += size;
     }
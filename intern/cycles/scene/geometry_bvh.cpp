@@ -91,6 +91,7 @@ void Geometry::compute_bvh(Device *device,
       bparams.num_motion_curve_steps = params->num_bvh_time_steps;
       bparams.num_motion_point_steps = params->num_bvh_time_steps;
       bparams.bvh_type = params->bvh_type;
+      bparams.build_quality = params->bvh_build_quality;
       bparams.curve_subdivisions = params->curve_subdivisions();
 
       delete bvh;
@@ -106,6 +107,7 @@ void Geometry::compute_bvh(Device *device,
 void GeometryManager::device_update_bvh(Device *device,
                                         DeviceScene *dscene,
                                         Scene *scene,
+                                        const bool can_refit_bvh2,
                                         Progress &progress)
 {
   /* bvh build */
@@ -122,13 +124,15 @@ void GeometryManager::device_update_bvh(Device *device,
   bparams.num_motion_curve_steps = scene->params.num_bvh_time_steps;
   bparams.num_motion_point_steps = scene->params.num_bvh_time_steps;
   bparams.bvh_type = scene->params.bvh_type;
+  bparams.build_quality = scene->params.bvh_build_quality;
   bparams.curve_subdivisions = scene->params.curve_subdivisions();
 
   VLOG_INFO << "Using " << bvh_layout_name(bparams.bvh_layout) << " layout.";
 
   const bool can_refit = scene->bvh != nullptr &&
                          (bparams.bvh_layout == BVHLayout::BVH_LAYOUT_OPTIX ||
-                          bparams.bvh_layout == BVHLayout::BVH_LAYOUT_METAL);
+                          bparams.bvh_layout == BVHLayout::BVH_LAYOUT_METAL ||
+                          (bparams.bvh_layout == BVHLayout::BVH_LAYOUT_BVH2 && can_refit_bvh2));
 
   BVH *bvh = scene->bvh;
   if (!scene->bvh) {
@@ -138,6 +142,13 @@ void GeometryManager::device_update_bvh(Device *device,
   device->build_bvh(bvh, progress, can_refit);
 
   if (progress.get_cancel()) {
+    if (bparams.bvh_layout == BVH_LAYOUT_BVH2 &&
+        bparams.build_quality == BVH_BUILD_QUALITY_FAST)
+    {
+      /* A partially built BVH can't be refit, build it again on the next update. */
+      delete scene->bvh;
+      scene->bvh = nullptr;
+    }
     return;
   }
 
@@ -145,7 +156,14 @@ void GeometryManager::device_update_bvh(Device *device,
 
   PackedBVH pack;
   if (has_bvh2_layout) {
-    pack = std::move(static_cast<BVH2 *>(bvh)->pack);
+    BVH2 *bvh2 = static_cast<BVH2 *>(bvh);
+    if (bparams.build_quality == BVH_BUILD_QUALITY_FAST) {
+      /* Keep a copy of the nodes and primitives for refitting on the next update. */
+      pack = bvh2->pack;
+    }
+    else {
+      pack = std::move(bvh2->pack);
+    }
   }
   else {
     pack.root_index = -1;
@@ -110,10 +110,12 @@ void GeometryManager::device_update_mesh(Device *,
             mesh->triangles_is_modified() || copy_all_data)
         {
           mesh->pack_shaders(scene, &tri_shader[mesh->prim_offset]);
+          dscene->tri_shader.tag_modified(mesh->prim_offset, mesh->num_triangles());
         }
 
         if (mesh->verts_is_modified() || copy_all_data) {
           mesh->pack_normals(&vnormal[mesh->vert_offset]);
+          dscene->tri_vnormal.tag_modified(mesh->vert_offset, mesh->verts.size());
         }
 
         if (mesh->verts_is_modified() || mesh->triangles_is_modified() ||
@@ -123,6 +125,8 @@ void GeometryManager::device_update_mesh(Device *,
                            &tri_vindex[mesh->prim_offset],
                            &tri_patch[mesh->prim_offset],
                            &tri_patch_uv[mesh->vert_offset]);
+          /* Indices and patch data only change along with a reallocation. */
+          dscene->tri_verts.tag_modified(mesh->vert_offset, mesh->verts.size());
         }
 
         if (progress.get_cancel()) {
@@ -170,6 +174,10 @@ void GeometryManager::device_update_mesh(Device *,
                           &curve_keys[hair->curve_key_offset],
                           &curves[hair->prim_offset],
                           &curve_segments[hair->curve_segment_offset]);
+        dscene->curve_keys.tag_modified(hair->curve_key_offset, hair->get_curve_keys().size());
+        dscene->curves.tag_modified(hair->prim_offset, hair->num_curves());
+        dscene->curve_segments.tag_modified(hair->curve_segment_offset, hair->num_segments());
+
         if (progress.get_cancel()) {
           return;
         }
@@ -187,19 +195,30 @@ void GeometryManager::device_update_mesh(Device *,
     float4 *points = dscene->points.alloc(point_size);
     uint *points_shader = dscene->points_shader.alloc(point_size);
 
+    const bool copy_all_data = dscene->points.need_realloc() ||
+                               dscene->points_shader.need_realloc();
+
     foreach (Geometry *geom, scene->geometry) {
       if (geom->is_pointcloud()) {
         PointCloud *pointcloud = static_cast<PointCloud *>(geom);
+
+        if (!pointcloud->is_modified() && !copy_all_data) {
+          continue;
+        }
+
         pointcloud->pack(
             scene, &points[pointcloud->prim_offset], &points_shader[pointcloud->prim_offset]);
+        dscene->points.tag_modified(pointcloud->prim_offset, pointcloud->num_points());
+        dscene->points_shader.tag_modified(pointcloud->prim_offset, pointcloud->num_points());
+
         if (progress.get_cancel()) {
           return;
         }
       }
     }
 
-    dscene->points.copy_to_device();
-    dscene->points_shader.copy_to_device();
+    dscene->points.copy_to_device_if_modified();
+    dscene->points_shader.copy_to_device_if_modified();
   }
 
   if (patch_size != 0 && dscene->patches.need_realloc()) {
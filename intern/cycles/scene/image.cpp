@@ -229,6 +229,7 @@ ImageMetaData::ImageMetaData()
       colorspace(u_colorspace_raw),
       colorspace_file_format(""),
       use_transform_3d(false),
+      tile_size(0),
       compress_as_srgb(false)
 {
 }
@@ -287,6 +288,18 @@ int ImageLoader::get_tile_number() const
   return 0;
 }
 
+bool ImageLoader::load_pixels_tile(const ImageMetaData & /*metadata*/,
+                                   const int /*mip_level*/,
+                                   const int /*x*/,
+                                   const int /*y*/,
+                                   const int /*width*/,
+                                   const int /*height*/,
+                                   void * /*pixels*/,
+                                   const bool /*associate_alpha*/)
+{
+  return false;
+}
+
 bool ImageLoader::equals(const ImageLoader *a, const ImageLoader *b)
 {
   if (a == NULL && b == NULL) {
@@ -312,6 +325,7 @@ ImageManager::ImageManager(const DeviceInfo &info)
 
   /* Set image limits */
   features.has_nanovdb = info.has_nanovdb;
+  features.has_texture_cache = info.type == DEVICE_CPU;
 }
 
 ImageManager::~ImageManager()
@@ -474,6 +488,7 @@ size_t ImageManager::add_image_slot(ImageLoader *loader,
   img->builtin = builtin;
   img->users = 1;
   img->mem = NULL;
+  img->cache_texture = NULL;
 
   images[slot] = img;
 
@@ -508,7 +523,7 @@ void ImageManager::remove_image_user(size_t slot)
   }
 }
 
-static bool image_associate_alpha(ImageManager::Image *img)
+static bool image_associate_alpha(const ImageManager::Image *img)
 {
   /* For typical RGBA images we let OIIO convert to associated alpha,
    * but some types we want to leave the RGB channels untouched. */
@@ -517,54 +532,24 @@ static bool image_associate_alpha(ImageManager::Image *img)
            img->params.alpha_type == IMAGE_ALPHA_CHANNEL_PACKED);
 }
 
-template<TypeDesc::BASETYPE FileFormat, typename StorageType>
-bool ImageManager::file_load_image(Image *img, int texture_limit)
+static bool image_is_rgba(const ImageManager::Image *img)
 {
-  /* Ignore empty images. */
-  if (!(img->metadata.channels > 0)) {
-    return false;
-  }
-
-  /* Get metadata. */
-  int width = img->metadata.width;
-  int height = img->metadata.height;
-  int depth = img->metadata.depth;
-  int components = img->metadata.channels;
-
-  /* Read pixels. */
-  vector<StorageType> pixels_storage;
-  StorageType *pixels;
-  const size_t max_size = max(max(width, height), depth);
-  if (max_size == 0) {
-    /* Don't bother with empty images. */
-    return false;
-  }
-
-  /* Allocate memory as needed, may be smaller to resize down. */
-  if (texture_limit > 0 && max_size > texture_limit) {
-    pixels_storage.resize(((size_t)width) * height * depth * 4);
-    pixels = &pixels_storage[0];
-  }
-  else {
-    thread_scoped_lock device_lock(device_mutex);
-    pixels = (StorageType *)img->mem->alloc(width, height, depth);
-  }
-
-  if (pixels == NULL) {
-    /* Could be that we've run out of memory. */
-    return false;
-  }
-
-  const size_t num_pixels = ((size_t)width) * height * depth;
-  img->loader->load_pixels(
-      img->metadata, pixels, num_pixels * components, image_associate_alpha(img));
-
   /* The kernel can handle 1 and 4 channel images. Anything that is not a single
    * channel image is converted to RGBA format. */
-  bool is_rgba = (img->metadata.type == IMAGE_DATA_TYPE_FLOAT4 ||
-                  img->metadata.type == IMAGE_DATA_TYPE_HALF4 ||
-                  img->metadata.type == IMAGE_DATA_TYPE_BYTE4 ||
-                  img->metadata.type == IMAGE_DATA_TYPE_USHORT4);
+  return (img->metadata.type == IMAGE_DATA_TYPE_FLOAT4 ||
+          img->metadata.type == IMAGE_DATA_TYPE_HALF4 ||
+          img->metadata.type == IMAGE_DATA_TYPE_BYTE4 ||
+          img->metadata.type == IMAGE_DATA_TYPE_USHORT4);
+}
+
+/* Convert pixels as loaded by the image loader to the format used by the kernel. */
+template<TypeDesc::BASETYPE FileFormat, typename StorageType>
+static void image_process_pixels(const ImageManager::Image *img,
+                                 StorageType *pixels,
+                                 const size_t num_pixels)
+{
+  const int components = img->metadata.channels;
+  const bool is_rgba = image_is_rgba(img);
 
   if (is_rgba) {
     const StorageType one = util_image_cast_from_float<StorageType>(1.0f);
@@ -640,6 +625,52 @@ bool ImageManager::file_load_image(Image *img, int texture_limit)
       }
     }
   }
+}
+
+template<TypeDesc::BASETYPE FileFormat, typename StorageType>
+bool ImageManager::file_load_image(Image *img, int texture_limit)
+{
+  /* Ignore empty images. */
+  if (!(img->metadata.channels > 0)) {
+    return false;
+  }
+
+  /* Get metadata. */
+  int width = img->metadata.width;
+  int height = img->metadata.height;
+  int depth = img->metadata.depth;
+  int components = img->metadata.channels;
+
+  /* Read pixels. */
+  vector<StorageType> pixels_storage;
+  StorageType *pixels;
+  const size_t max_size = max(max(width, height), depth);
+  if (max_size == 0) {
+    /* Don't bother with empty images. */
+    return false;
+  }
+
+  /* Allocate memory as needed, may be smaller to resize down. */
+  if (texture_limit > 0 && max_size > texture_limit) {
+    pixels_storage.resize(((size_t)width) * height * depth * 4);
+    pixels = &pixels_storage[0];
+  }
+  else {
+    thread_scoped_lock device_lock(device_mutex);
+    pixels = (StorageType *)img->mem->alloc(width, height, depth);
+  }
+
+  if (pixels == NULL) {
+    /* Could be that we've run out of memory. */
+    return false;
+  }
+
+  const size_t num_pixels = ((size_t)width) * height * depth;
+  img->loader->load_pixels(
+      img->metadata, pixels, num_pixels * components, image_associate_alpha(img));
+
+  const bool is_rgba = image_is_rgba(img);
+  image_process_pixels<FileFormat, StorageType>(img, pixels, num_pixels);
 
   /* Scale image down if needed. */
   if (pixels_storage.size() > 0) {
@@ -675,6 +706,115 @@ bool ImageManager::file_load_image(Image *img, int texture_limit)
   return true;
 }
 
+/* Loads tiles of an image for the texture cache, while rendering. */
+template<TypeDesc::BASETYPE FileFormat, typename StorageType>
+class ImageTileLoader : public TextureTileLoader {
+ public:
+  ImageTileLoader(const ImageManager::Image *img, const int mip_level)
+      : img_(img), mip_level_(mip_level), associate_alpha_(image_associate_alpha(img))
+  {
+  }
+
+  void load_tile(const int x,
+                 const int y,
+                 const int width,
+                 const int height,
+                 void *pixels) override
+  {
+    StorageType *tile_pixels = (StorageType *)pixels;
+    const size_t num_pixels = ((size_t)width) * height;
+
+    if (!img_->loader->load_pixels_tile(
+            img_->metadata, mip_level_, x, y, width, height, pixels, associate_alpha_))
+    {
+      /* On failure to load, fill the tile with pink like missing images. */
+      const float missing[4] = {
+          TEX_IMAGE_MISSING_R, TEX_IMAGE_MISSING_G, TEX_IMAGE_MISSING_B, TEX_IMAGE_MISSING_A};
+      const int channels = image_is_rgba(img_) ? 4 : 1;
+      for (size_t i = 0; i < num_pixels * channels; i++) {
+        tile_pixels[i] = util_image_cast_from_float<StorageType>(missing[i % channels]);
+      }
+      return;
+    }
+
+    image_process_pixels<FileFormat, StorageType>(img_, tile_pixels, num_pixels);
+  }
+
+ protected:
+  const ImageManager::Image *img_;
+  int mip_level_;
+  bool associate_alpha_;
+};
+
+bool ImageManager::texture_cache_load_image(Scene *scene, Image *img, const int texture_limit)
+{
+  const ImageMetaData &metadata = img->metadata;
+  if (!features.has_texture_cache || scene->params.texture_cache_size == 0 ||
+      metadata.tile_size == 0 || metadata.channels == 0 || metadata.depth > 1 ||
+      img->loader->is_vdb_loader())
+  {
+    return false;
+  }
+
+  /* Use the first mip level within the texture limit, instead of scaling down the full
+   * resolution image. When the file has no such level, it is loaded and scaled as usual. */
+  const int mip_levels_num = metadata.mip_level_sizes.size();
+  int mip_level = 0;
+  if (texture_limit > 0) {
+    while (mip_level < mip_levels_num &&
+           max(metadata.mip_level_sizes[mip_level].x, metadata.mip_level_sizes[mip_level].y) >
+               texture_limit)
+    {
+      mip_level++;
+    }
+  }
+  if (mip_level == mip_levels_num) {
+    return false;
+  }
+  const int2 size = metadata.mip_level_sizes[mip_level];
+
+  unique_ptr<TextureTileLoader> tile_loader;
+  switch (metadata.type) {
+    case IMAGE_DATA_TYPE_FLOAT4:
+    case IMAGE_DATA_TYPE_FLOAT:
+      tile_loader = make_unique<ImageTileLoader<TypeDesc::FLOAT, float>>(img, mip_level);
+      break;
+    case IMAGE_DATA_TYPE_BYTE4:
+    case IMAGE_DATA_TYPE_BYTE:
+      tile_loader = make_unique<ImageTileLoader<TypeDesc::UINT8, uchar>>(img, mip_level);
+      break;
+    case IMAGE_DATA_TYPE_HALF4:
+    case IMAGE_DATA_TYPE_HALF:
+      tile_loader = make_unique<ImageTileLoader<TypeDesc::HALF, half>>(img, mip_level);
+      break;
+    case IMAGE_DATA_TYPE_USHORT4:
+    case IMAGE_DATA_TYPE_USHORT:
+      tile_loader = make_unique<ImageTileLoader<TypeDesc::USHORT, uint16_t>>(img, mip_level);
+      break;
+    default:
+      return false;
+  }
+
+  thread_scoped_lock device_lock(device_mutex);
+  if (!texture_cache) {
+    texture_cache = make_unique<TextureCache>(scene->params.texture_cache_size);
+  }
+
+  const size_t pixel_size = img->mem->data_elements * datatype_size(img->mem->data_type);
+  img->cache_texture = texture_cache->add_texture(
+      std::move(tile_loader), size.x, size.y, metadata.tile_size, pixel_size);
+
+  img->mem->info.use_texture_cache = true;
+  img->mem->info.data = (uint64_t)img->cache_texture;
+  img->mem->info.width = size.x;
+  img->mem->info.height = size.y;
+  img->mem->info.depth = 1;
+
+  VLOG_WORK << "Loading image " << img->loader->name() << " on demand through the texture cache"
+            << ", mip level " << mip_level << ".";
+  return true;
+}
+
 void ImageManager::device_load_image(Device *device, Scene *scene, size_t slot, Progress *progress)
 {
   if (progress->get_cancel()) {
@@ -699,6 +839,11 @@ void ImageManager::device_load_image(Device *device, Scene *scene, size_t slot,
     delete img->mem;
     img->mem = NULL;
   }
+  if (img->cache_texture) {
+    thread_scoped_lock device_lock(device_mutex);
+    texture_cache->remove_texture(img->cache_texture);
+    img->cache_texture = NULL;
+  }
 
   img->mem = new device_texture(
       device, img->mem_name.c_str(), slot, type, img->params.interpolation, img->params.extension);
@@ -706,7 +851,10 @@ void ImageManager::device_load_image(Device *device, Scene *scene, size_t slot,
   img->mem->info.transform_3d = img->metadata.transform_3d;
 
   /* Create new texture. */
-  if (type == IMAGE_DATA_TYPE_FLOAT4) {
+  if (texture_cache_load_image(scene, img, texture_limit)) {
+    /* Pixels are loaded on demand while rendering. */
+  }
+  else if (type == IMAGE_DATA_TYPE_FLOAT4) {
     if (!file_load_image<TypeDesc::FLOAT, float>(img, texture_limit)) {
       /* on failure to load, we set a 1x1 pixels pink image */
       thread_scoped_lock device_lock(device_mutex);
@@ -833,6 +981,10 @@ void ImageManager::device_free_image(Device *, size_t slot)
     thread_scoped_lock device_lock(device_mutex);
     delete img->mem;
   }
+  if (img->cache_texture) {
+    thread_scoped_lock device_lock(device_mutex);
+    texture_cache->remove_texture(img->cache_texture);
+  }
 
   delete img->loader;
   delete img;
@@ -929,8 +1081,15 @@ void ImageManager::collect_statistics(RenderStats *stats)
       /* Image may have been freed due to lack of users. */
       continue;
     }
-    stats->image.textures.add_entry(
-        NamedSizeEntry(image->loader->name(), image->mem->memory_size()));
+    /* Only the tiles that are currently loaded use memory for cached images. */
+    const size_t memory_size = (image->cache_texture) ? image->cache_texture->memory_size() :
+                                                        image->mem->memory_size();
+    stats->image.textures.add_entry(NamedSizeEntry(image->loader->name(), memory_size));
+  }
+
+  if (texture_cache) {
+    stats->image.use_texture_cache = true;
+    stats->image.texture_cache = texture_cache->get_stats();
   }
 }
 
@@ -10,6 +10,7 @@
 #include "scene/colorspace.h"
 
 #include "util/string.h"
+#include "util/texture_cache.h"
 #include "util/thread.h"
 #include "util/transform.h"
 #include "util/unique_ptr.h"
@@ -77,6 +78,12 @@ class ImageMetaData {
   bool use_transform_3d;
   Transform transform_3d;
 
+  /* Optional for files stored as square tiles, which can be loaded on demand. Zero when the
+   * file is not tiled. The size of each mip level stored in the file, starting with the full
+   * resolution image, all with the same tile size. */
+  int tile_size;
+  vector<int2> mip_level_sizes;
+
   /* Automatically set. */
   bool compress_as_srgb;
 
@@ -90,6 +97,8 @@ class ImageMetaData {
 class ImageDeviceFeatures {
  public:
   bool has_nanovdb;
+  /* Tiled images can be loaded on demand by the kernel. */
+  bool has_texture_cache;
 };
 
 /* Image loader base class, that can be subclassed to load image data
@@ -108,6 +117,17 @@ class ImageLoader {
                            const size_t pixels_size,
                            const bool associate_alpha) = 0;
 
+  /* Optional for tiled images, load the pixels of one tile of a mip level. Rows are stored from
+   * top to bottom, with the channels of the file. */
+  virtual bool load_pixels_tile(const ImageMetaData &metadata,
+                                const int mip_level,
+                                const int x,
+                                const int y,
+                                const int width,
+                                const int height,
+                                void *pixels,
+                                const bool associate_alpha);
+
   /* Name for logs and stats. */
   virtual string name() const = 0;
 
@@ -207,6 +227,8 @@ class ImageManager {
 
     string mem_name;
     device_texture *mem;
+    /* Set when the pixels are loaded on demand through the texture cache. */
+    TextureCache::Texture *cache_texture;
 
     int users;
     thread_mutex mutex;
@@ -223,6 +245,7 @@ class ImageManager {
 
   vector<Image *> images;
   void *osl_texture_system;
+  unique_ptr<TextureCache> texture_cache;
 
   size_t add_image_slot(ImageLoader *loader, const ImageParams &params, const bool builtin);
   void add_image_user(size_t slot);
@@ -232,6 +255,7 @@ class ImageManager {
 
   template<TypeDesc::BASETYPE FileFormat, typename StorageType>
   bool file_load_image(Image *img, int texture_limit);
+  bool texture_cache_load_image(Scene *scene, Image *img, int texture_limit);
 
   void device_load_image(Device *device, Scene *scene, size_t slot, Progress *progress);
   void device_free_image(Device *device, size_t slot);
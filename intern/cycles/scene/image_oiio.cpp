@@ -10,11 +10,56 @@
 
 CCL_NAMESPACE_BEGIN
 
+/* Loaders with an open tile input, most recently used first. Scenes can have many more tiled
+ * images than a process can have open files, so the least recently used files are closed and
+ * opened again when needed. The limit matches the default of the OIIO image cache. */
+static thread_mutex tile_inputs_mutex;
+static list<OIIOImageLoader *> tile_inputs;
+static constexpr size_t tile_inputs_max_open = 100;
+
 OIIOImageLoader::OIIOImageLoader(const string &filepath) : filepath(filepath) {}
 
-OIIOImageLoader::~OIIOImageLoader() {}
+OIIOImageLoader::~OIIOImageLoader()
+{
+  {
+    thread_scoped_lock lock(tile_inputs_mutex);
+    if (tile_input_in_lru) {
+      tile_inputs.erase(tile_input_lru);
+    }
+  }
+  if (tile_input) {
+    tile_input->close();
+  }
+}
 
-bool OIIOImageLoader::load_metadata(const ImageDeviceFeatures & /*features*/,
+void OIIOImageLoader::tile_input_mark_used()
+{
+  thread_scoped_lock lock(tile_inputs_mutex);
+  if (tile_input_in_lru) {
+    tile_inputs.splice(tile_inputs.begin(), tile_inputs, tile_input_lru);
+    return;
+  }
+  tile_inputs.push_front(this);
+  tile_input_lru = tile_inputs.begin();
+  tile_input_in_lru = true;
+
+  /* Close the least recently used files. Files that are being read from right now are skipped,
+   * waiting for them could deadlock with the thread reading and they are not unused anyway. */
+  auto it = tile_inputs.end();
+  while (tile_inputs.size() > tile_inputs_max_open && --it != tile_inputs.begin()) {
+    OIIOImageLoader *loader = *it;
+    if (!loader->tile_mutex.try_lock()) {
+      continue;
+    }
+    loader->tile_input->close();
+    loader->tile_input.reset();
+    loader->tile_input_in_lru = false;
+    loader->tile_mutex.unlock();
+    it = tile_inputs.erase(it);
+  }
+}
+
+bool OIIOImageLoader::load_metadata(const ImageDeviceFeatures &features,
                                     ImageMetaData &metadata)
 {
   /* Perform preliminary checks, with meaningful logging. */
@@ -84,11 +129,41 @@ bool OIIOImageLoader::load_metadata(const ImageDeviceFeatures & /*features*/,
   metadata.colorspace_file_format = in->format_name();
   metadata.colorspace_file_hint = spec.get_string_attribute("oiio:ColorSpace");
 
+  /* Files stored as square tiles can be loaded on demand through the texture cache. Mip levels
+   * are only used when they have the same tile size. */
+  metadata.tile_size = 0;
+  metadata.mip_level_sizes.clear();
+  if (features.has_texture_cache && spec.tile_width > 0 && spec.tile_width == spec.tile_height &&
+      spec.tile_depth <= 1 && spec.depth <= 1 && is_power_of_two(spec.tile_width) &&
+      spec.x == 0 && spec.y == 0)
+  {
+    metadata.tile_size = spec.tile_width;
+    for (int level = 0; in->seek_subimage(0, level); level++) {
+      const ImageSpec &level_spec = in->spec();
+      if (level_spec.tile_width != spec.tile_width || level_spec.tile_height != spec.tile_height)
+      {
+        break;
+      }
+      metadata.mip_level_sizes.push_back(make_int2(level_spec.width, level_spec.height));
+    }
+  }
+
   in->close();
 
   return true;
 }
 
+template<typename StorageType>
+static void oiio_associate_alpha(StorageType *pixels, const size_t num_pixels)
+{
+  for (size_t i = num_pixels - 1, pixel = 0; pixel < num_pixels; pixel++, i--) {
+    const StorageType alpha = pixels[i * 4 + 3];
+    pixels[i * 4 + 0] = util_image_multiply_native(pixels[i * 4 + 0], alpha);
+    pixels[i * 4 + 1] = util_image_multiply_native(pixels[i * 4 + 1], alpha);
+    pixels[i * 4 + 2] = util_image_multiply_native(pixels[i * 4 + 2], alpha);
+  }
+}
+
 template<TypeDesc::BASETYPE FileFormat, typename StorageType>
 static void oiio_load_pixels(const ImageMetaData &metadata,
                              const unique_ptr<ImageInput> &in,
@@ -154,14 +229,71 @@ static void oiio_load_pixels(const ImageMetaData &metadata,
   }
 
   if (components == 4 && associate_alpha) {
-    size_t dimensions = width * height;
-    for (size_t i = dimensions - 1, pixel = 0; pixel < dimensions; pixel++, i--) {
-      const StorageType alpha = pixels[i * 4 + 3];
-      pixels[i * 4 + 0] = util_image_multiply_native(pixels[i * 4 + 0], alpha);
-      pixels[i * 4 + 1] = util_image_multiply_native(pixels[i * 4 + 1], alpha);
-      pixels[i * 4 + 2] = util_image_multiply_native(pixels[i * 4 + 2], alpha);
+    oiio_associate_alpha(pixels, width * height);
+  }
+}
+
+template<TypeDesc::BASETYPE FileFormat, typename StorageType>
+static bool oiio_load_pixels_tile(const ImageMetaData &metadata,
+                                  const unique_ptr<ImageInput> &in,
+                                  const int mip_level,
+                                  const int x,
+                                  const int y,
+                                  const int width,
+                                  const int height,
+                                  const bool associate_alpha,
+                                  StorageType *pixels)
+{
+  /* Channels after RGBA are not used, so they are not read either. */
+  const int components = min(metadata.channels, 4);
+  if (!in->read_tiles(0,
+                      mip_level,
+                      x,
+                      x + width,
+                      y,
+                      y + height,
+                      0,
+                      1,
+                      0,
+                      components,
+                      FileFormat,
+                      pixels))
+  {
+    return false;
+  }
+
+  if (components == 4 && associate_alpha) {
+    oiio_associate_alpha(pixels, size_t(width) * height);
+  }
+  return true;
+}
+
+static bool oiio_do_associate_alpha(const unique_ptr<ImageInput> &in,
+                                    const ImageSpec &spec,
+                                    const bool associate_alpha)
+{
+  bool do_associate_alpha = false;
+  if (associate_alpha) {
+    do_associate_alpha = spec.get_int_attribute("oiio:UnassociatedAlpha", 0);
+
+    if (!do_associate_alpha && spec.alpha_channel != -1) {
+      /* Workaround OIIO not detecting TGA file alpha the same as Blender (since #3019).
+       * We want anything not marked as premultiplied alpha to get associated. */
+      if (strcmp(in->format_name(), "targa") == 0) {
+        do_associate_alpha = spec.get_int_attribute("targa:alpha_type", -1) != 4;
+      }
+      /* OIIO DDS reader never sets UnassociatedAlpha attribute. */
+      if (strcmp(in->format_name(), "dds") == 0) {
+        do_associate_alpha = true;
+      }
+      /* Workaround OIIO bug that sets oiio:UnassociatedAlpha on the last layer
+       * but not composite image that we read. */
+      if (strcmp(in->format_name(), "psd") == 0) {
+        do_associate_alpha = true;
+      }
     }
   }
+  return do_associate_alpha;
 }
 
 bool OIIOImageLoader::load_pixels(const ImageMetaData &metadata,
@@ -194,27 +326,7 @@ bool OIIOImageLoader::load_pixels(const ImageMetaData &metadata,
     return false;
   }
 
-  bool do_associate_alpha = false;
-  if (associate_alpha) {
-    do_associate_alpha = spec.get_int_attribute("oiio:UnassociatedAlpha", 0);
-
-    if (!do_associate_alpha && spec.alpha_channel != -1) {
-      /* Workaround OIIO not detecting TGA file alpha the same as Blender (since #3019).
-       * We want anything not marked as premultiplied alpha to get associated. */
-      if (strcmp(in->format_name(), "targa") == 0) {
-        do_associate_alpha = spec.get_int_attribute("targa:alpha_type", -1) != 4;
-      }
-      /* OIIO DDS reader never sets UnassociatedAlpha attribute. */
-      if (strcmp(in->format_name(), "dds") == 0) {
-        do_associate_alpha = true;
-      }
-      /* Workaround OIIO bug that sets oiio:UnassociatedAlpha on the last layer
-       * but not composite image that we read. */
-      if (strcmp(in->format_name(), "psd") == 0) {
-        do_associate_alpha = true;
-      }
-    }
-  }
+  const bool do_associate_alpha = oiio_do_associate_alpha(in, spec, associate_alpha);
 
   switch (metadata.type) {
     case IMAGE_DATA_TYPE_BYTE:
@@ -246,6 +358,91 @@ bool OIIOImageLoader::load_pixels(const ImageMetaData &metadata,
   return true;
 }
 
+bool OIIOImageLoader::load_pixels_tile(const ImageMetaData &metadata,
+                                       const int mip_level,
+                                       const int x,
+                                       const int y,
+                                       const int width,
+                                       const int height,
+                                       void *pixels,
+                                       const bool associate_alpha)
+{
+  /* OIIO serializes reads from the same file anyway, so a single open file is shared by all
+   * threads loading tiles. It may have been closed in the meantime to limit the open files. */
+  thread_scoped_lock lock(tile_mutex);
+
+  if (!tile_input) {
+    tile_input = unique_ptr<ImageInput>(ImageInput::create(filepath.string()));
+    if (!tile_input) {
+      return false;
+    }
+
+    ImageSpec spec = ImageSpec();
+    ImageSpec config = ImageSpec();
+    config.attribute("oiio:UnassociatedAlpha", 1);
+    if (!tile_input->open(filepath.string(), spec, config)) {
+      tile_input.reset();
+      return false;
+    }
+    tile_do_associate_alpha = oiio_do_associate_alpha(tile_input, spec, associate_alpha);
+  }
+  tile_input_mark_used();
+
+  switch (metadata.type) {
+    case IMAGE_DATA_TYPE_BYTE:
+    case IMAGE_DATA_TYPE_BYTE4:
+      return oiio_load_pixels_tile<TypeDesc::UINT8, uchar>(metadata,
+                                                           tile_input,
+                                                           mip_level,
+                                                           x,
+                                                           y,
+                                                           width,
+                                                           height,
+                                                           tile_do_associate_alpha,
+                                                           (uchar *)pixels);
+    case IMAGE_DATA_TYPE_USHORT:
+    case IMAGE_DATA_TYPE_USHORT4:
+      return oiio_load_pixels_tile<TypeDesc::USHORT, uint16_t>(metadata,
+                                                               tile_input,
+                                                               mip_level,
+                                                               x,
+                                                               y,
+                                                               width,
+                                                               height,
+                                                               tile_do_associate_alpha,
+                                                               (uint16_t *)pixels);
+    case IMAGE_DATA_TYPE_HALF:
+    case IMAGE_DATA_TYPE_HALF4:
+      return oiio_load_pixels_tile<TypeDesc::HALF, half>(metadata,
+                                                         tile_input,
+                                                         mip_level,
+                                                         x,
+                                                         y,
+                                                         width,
+                                                         height,
+                                                         tile_do_associate_alpha,
+                                                         (half *)pixels);
+    case IMAGE_DATA_TYPE_FLOAT:
+    case IMAGE_DATA_TYPE_FLOAT4:
+      return oiio_load_pixels_tile<TypeDesc::FLOAT, float>(metadata,
+                                                           tile_input,
+                                                           mip_level,
+                                                           x,
+                                                           y,
+                                                           width,
+                                                           height,
+                                                           tile_do_associate_alpha,
+                                                           (float *)pixels);
+    case IMAGE_DATA_TYPE_NANOVDB_FLOAT:
+    case IMAGE_DATA_TYPE_NANOVDB_FLOAT3:
+    case IMAGE_DATA_TYPE_NANOVDB_FPN:
+    case IMAGE_DATA_TYPE_NANOVDB_FP16:
+    case IMAGE_DATA_NUM_TYPES:
+      break;
+  }
+  return false;
+}
+
 string OIIOImageLoader::name() const
 {
   return path_filename(filepath.string());
@@ -7,6 +7,9 @@
 
 #include "scene/image.h"
 
+#include "util/image.h"
+#include "util/list.h"
+
 CCL_NAMESPACE_BEGIN
 
 class OIIOImageLoader : public ImageLoader {
@@ -21,6 +24,15 @@ class OIIOImageLoader : public ImageLoader {
                    const size_t pixels_size,
                    const bool associate_alpha) override;
 
+  bool load_pixels_tile(const ImageMetaData &metadata,
+                        const int mip_level,
+                        const int x,
+                        const int y,
+                        const int width,
+                        const int height,
+                        void *pixels,
+                        const bool associate_alpha) override;
+
   string name() const override;
 
   ustring osl_filepath() const override;
@@ -29,6 +41,17 @@ class OIIOImageLoader : public ImageLoader {
 
  protected:
   ustring filepath;
+
+  /* File kept open for loading tiles on demand while rendering. */
+  thread_mutex tile_mutex;
+  unique_ptr<ImageInput> tile_input;
+  bool tile_do_associate_alpha = false;
+
+  /* Position in the list of loaders with an open tile input, protected by the list mutex. */
+  list<OIIOImageLoader *>::iterator tile_input_lru;
+  bool tile_input_in_lru = false;
+
+  void tile_input_mark_used();
 };
 
 CCL_NAMESPACE_END
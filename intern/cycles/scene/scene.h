@@ -64,6 +64,7 @@ class SceneParams {
   BVHLayout bvh_layout;
 
   BVHType bvh_type;
+  BVHBuildQuality bvh_build_quality;
   bool use_bvh_spatial_split;
   bool use_bvh_compact_structure;
   bool use_bvh_unaligned_nodes;
@@ -71,6 +72,9 @@ class SceneParams {
   int hair_subdivisions;
   CurveShapeType hair_shape;
   int texture_limit;
+  /* Memory limit in bytes for image tiles that are loaded on demand, zero to load all images
+   * fully before rendering. */
+  size_t texture_cache_size;
 
   bool background;
 
@@ -79,6 +83,7 @@ class SceneParams {
     shadingsystem = SHADINGSYSTEM_SVM;
     bvh_layout = BVH_LAYOUT_AUTO;
     bvh_type = BVH_TYPE_DYNAMIC;
+    bvh_build_quality = BVH_BUILD_QUALITY_HIGH;
     use_bvh_spatial_split = false;
     use_bvh_compact_structure = true;
     use_bvh_unaligned_nodes = true;
@@ -86,19 +91,21 @@ class SceneParams {
     hair_subdivisions = 3;
     hair_shape = CURVE_RIBBON;
     texture_limit = 0;
+    texture_cache_size = 0;
     background = true;
   }
 
   bool modified(const SceneParams &params) const
   {
     return !(shadingsystem == params.shadingsystem && bvh_layout == params.bvh_layout &&
-             bvh_type == params.bvh_type &&
+             bvh_type == params.bvh_type && bvh_build_quality == params.bvh_build_quality &&
              use_bvh_spatial_split == params.use_bvh_spatial_split &&
              use_bvh_compact_structure == params.use_bvh_compact_structure &&
              use_bvh_unaligned_nodes == params.use_bvh_unaligned_nodes &&
              num_bvh_time_steps == params.num_bvh_time_steps &&
              hair_subdivisions == params.hair_subdivisions && hair_shape == params.hair_shape &&
-             texture_limit == params.texture_limit);
+             texture_limit == params.texture_limit &&
+             texture_cache_size == params.texture_cache_size);
   }
 
   int curve_subdivisions()
@@ -212,13 +212,30 @@ string MeshStats::full_report(int indent_level)
 
 /* Image statistics. */
 
-ImageStats::ImageStats() {}
+ImageStats::ImageStats() : use_texture_cache(false) {}
 
 string ImageStats::full_report(int indent_level)
 {
   const string indent(indent_level * kIndentNumSpaces, ' ');
   string result = "";
   result += indent + "Textures:\n" + textures.full_report(indent_level + 1);
+  if (use_texture_cache) {
+    const string cache_indent((indent_level + 1) * kIndentNumSpaces, ' ');
+    const uint64_t lookups = texture_cache.hits + texture_cache.misses;
+    const double hit_percent = (lookups) ? 100.0 * texture_cache.hits / lookups : 0.0;
+    result += indent + "Texture cache:\n";
+    result += cache_indent + string_printf("Hits: %llu (%.2f%%)\n",
+                                           (unsigned long long)texture_cache.hits,
+                                           hit_percent);
+    result += cache_indent +
+              string_printf("Misses: %llu\n", (unsigned long long)texture_cache.misses);
+    result += cache_indent +
+              string_printf("Evictions: %llu\n", (unsigned long long)texture_cache.evictions);
+    result += cache_indent + "Memory limit: " +
+              string_human_readable_size(texture_cache.memory_limit) + "\n";
+    result += cache_indent + "Peak memory: " +
+              string_human_readable_size(texture_cache.memory_peak) + "\n";
+  }
   return result;
 }
 
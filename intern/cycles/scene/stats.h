@@ -9,6 +9,7 @@
 
 #include "util/stats.h"
 #include "util/string.h"
+#include "util/texture_cache.h"
 #include "util/vector.h"
 
 CCL_NAMESPACE_BEGIN
@@ -159,6 +160,10 @@ class ImageStats {
   string full_report(int indent_level = 0);
 
   NamedSizeStats textures;
+
+  /* Only reported when textures were loaded through the texture cache. */
+  bool use_texture_cache;
+  TextureCache::Stats texture_cache;
 };
 
 /* Render process statistics. */
@@ -96,6 +96,12 @@ static MergeChannelOp parse_channel_operation(const string &pass_name)
   }
 }
 
+/* Weight of a render with the given number of samples in the average of all renders. */
+static float merge_average_weight(const float samples, const float total_samples)
+{
+  return samples / total_samples;
+}
+
 /* Splits in at its last dot, setting suffix to the part after the dot and
  * into the part before it. Returns whether a dot was found. */
 static bool split_last_dot(string &in, string &suffix)
@@ -453,7 +459,8 @@ static bool merge_pixels(const vector<MergeImage> &images,
                 layer_samples = layer.samples;
               }
 
-              out_pixels[out_offset] += pixels[offset] * (1.0f * layer_samples / total_samples);
+              out_pixels[out_offset] += pixels[offset] *
+                                        merge_average_weight(layer_samples, total_samples);
             }
             break;
           }
@@ -611,4 +618,43 @@ bool ImageMerger::run()
   return save_output(output, out_spec, out_pixels, error);
 }
 
+/* Buffer Merger */
+
+BufferMerger::BufferMerger() : size(0), output(nullptr) {}
+
+bool BufferMerger::run()
+{
+  if (input.empty()) {
+    error = "No input buffers specified.";
+    return false;
+  }
+  if (output == nullptr) {
+    error = "No output buffer specified.";
+    return false;
+  }
+
+  int total_samples = 0;
+  for (const Input &buffer : input) {
+    if (buffer.pixels == nullptr || buffer.samples < 1) {
+      error = "Input buffer was not rendered.";
+      return false;
+    }
+    total_samples += buffer.samples;
+  }
+
+  /* Accumulate in a separate buffer, so the output can be one of the inputs. */
+  array<float> out_pixels(size);
+  memset(out_pixels.data(), 0, out_pixels.size() * sizeof(float));
+
+  for (const Input &buffer : input) {
+    const float weight = merge_average_weight(buffer.samples, total_samples);
+    for (size_t i = 0; i < size; i++) {
+      out_pixels[i] += buffer.pixels[i] * weight;
+    }
+  }
+
+  memcpy(output, out_pixels.data(), size * sizeof(float));
+  return true;
+}
+
 CCL_NAMESPACE_END
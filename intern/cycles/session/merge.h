@@ -26,6 +26,33 @@ class ImageMerger {
   string output;
 };
 
+/* Merge renders of the same image held in memory, for example rendered by multiple processes
+ * with disjoint sample ranges. Like for images, pixels are averaged weighted by the number of
+ * samples of each render. */
+
+class BufferMerger {
+ public:
+  struct Input {
+    /* Pixels of the render, all inputs must use the same layout. */
+    const float *pixels;
+    /* Number of samples used for rendering. */
+    int samples;
+  };
+
+  BufferMerger();
+  bool run();
+
+  /* Error message after running, in case of failure. */
+  string error;
+
+  /* List of renders to merge. */
+  vector<Input> input;
+  /* Number of floats in each input and the output. */
+  size_t size;
+  /* Output pixels, may point to one of the inputs. */
+  float *output;
+};
+
 CCL_NAMESPACE_END
 
 #endif /* __MERGE_H__ */
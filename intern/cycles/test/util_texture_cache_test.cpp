@@ -0,0 +1,156 @@
+/* SPDX-FileCopyrightText: 2011-2022 Blender Foundation
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include <thread>
+
+#include "util/texture_cache.h"
+
+CCL_NAMESPACE_BEGIN
+
+namespace {
+
+/* Fills every pixel with its position in the texture. */
+class PositionTileLoader : public TextureTileLoader {
+ public:
+  void load_tile(const int x, const int y, const int width, const int height, void *pixels) override
+  {
+    int2 *tile_pixels = static_cast<int2 *>(pixels);
+    for (int j = 0; j < height; j++) {
+      for (int i = 0; i < width; i++) {
+        tile_pixels[j * width + i] = make_int2(x + i, y + j);
+      }
+    }
+    loaded_tiles++;
+  }
+
+  std::atomic<int> loaded_tiles = 0;
+};
+
+int2 read_pixel(TextureCache::Texture &texture, const int x, const int y)
+{
+  const int tile_x = x >> texture.tile_size_log2;
+  const int tile_y = y >> texture.tile_size_log2;
+  const int2 *pixels = static_cast<const int2 *>(texture.acquire_tile(tile_x, tile_y));
+  const int local_x = x & (texture.tile_size - 1);
+  const int local_y = y & (texture.tile_size - 1);
+  const int2 pixel = pixels[local_y * texture.tile_width(tile_x) + local_x];
+  texture.release_tile(tile_x, tile_y);
+  return pixel;
+}
+
+}  // namespace
+
+TEST(util_texture_cache, read_pixels)
+{
+  TextureCache cache(1024 * 1024);
+  unique_ptr<PositionTileLoader> loader = make_unique<PositionTileLoader>();
+  PositionTileLoader *loader_ptr = loader.get();
+  TextureCache::Texture *texture = cache.add_texture(std::move(loader), 100, 70, 32, sizeof(int2));
+
+  EXPECT_EQ(texture->tiles_x, 4);
+  EXPECT_EQ(texture->tiles_y, 3);
+  EXPECT_EQ(texture->tile_width(3), 4);
+  EXPECT_EQ(texture->tile_height(2), 6);
+
+  for (const int2 position : {make_int2(0, 0), make_int2(99, 69), make_int2(40, 33)}) {
+    const int2 pixel = read_pixel(*texture, position.x, position.y);
+    EXPECT_EQ(pixel.x, position.x);
+    EXPECT_EQ(pixel.y, position.y);
+  }
+  /* Reading a loaded tile again does not load it again. */
+  read_pixel(*texture, 1, 1);
+  EXPECT_EQ(loader_ptr->loaded_tiles, 3);
+
+  const TextureCache::Stats stats = cache.get_stats();
+  EXPECT_EQ(stats.misses, 3);
+  EXPECT_EQ(stats.hits, 1);
+  EXPECT_EQ(stats.evictions, 0);
+  EXPECT_EQ(texture->memory_size(), (32 * 32 + 4 * 6 + 32 * 32) * sizeof(int2));
+}
+
+TEST(util_texture_cache, evict_least_recently_used)
+{
+  /* Room for four tiles. */
+  const size_t tile_memory_size = 16 * 16 * sizeof(int2);
+  TextureCache cache(4 * tile_memory_size);
+  unique_ptr<PositionTileLoader> loader = make_unique<PositionTileLoader>();
+  PositionTileLoader *loader_ptr = loader.get();
+  TextureCache::Texture *texture = cache.add_texture(std::move(loader), 256, 16, 16, sizeof(int2));
+
+  for (int tile = 0; tile < 4; tile++) {
+    read_pixel(*texture, tile * 16, 0);
+  }
+  /* Use the first tile again, so that it is not the least recently used one. */
+  read_pixel(*texture, 0, 0);
+  /* Loading a fifth tile evicts the two least recently used tiles, since a bit more memory than
+   * necessary is freed. */
+  read_pixel(*texture, 4 * 16, 0);
+  EXPECT_EQ(texture->memory_size(), 3 * tile_memory_size);
+  EXPECT_EQ(cache.get_stats().evictions, 2);
+
+  read_pixel(*texture, 0, 0);
+  EXPECT_EQ(loader_ptr->loaded_tiles, 5);
+  read_pixel(*texture, 16, 0);
+  EXPECT_EQ(loader_ptr->loaded_tiles, 6);
+}
+
+TEST(util_texture_cache, acquired_tiles_are_not_evicted)
+{
+  const size_t tile_memory_size = 16 * 16 * sizeof(int2);
+  TextureCache cache(tile_memory_size);
+  TextureCache::Texture *texture = cache.add_texture(
+      make_unique<PositionTileLoader>(), 64, 16, 16, sizeof(int2));
+
+  const int2 *pixels = static_cast<const int2 *>(texture->acquire_tile(0, 0));
+  for (int tile = 1; tile < 4; tile++) {
+    read_pixel(*texture, tile * 16, 0);
+  }
+  EXPECT_EQ(pixels[17].x, 1);
+  EXPECT_EQ(pixels[17].y, 1);
+  /* The tile that was loaded last is in use while it is loaded, so it is kept as well. */
+  EXPECT_EQ(texture->memory_size(), 2 * tile_memory_size);
+  texture->release_tile(0, 0);
+
+  cache.remove_texture(texture);
+  const TextureCache::Stats stats = cache.get_stats();
+  EXPECT_EQ(stats.evictions, 2);
+  EXPECT_EQ(stats.memory_peak, 3 * tile_memory_size);
+}
+
+TEST(util_texture_cache, concurrent_reads)
+{
+  /* Much less memory than the texture needs, so tiles are evicted while other threads read. */
+  TextureCache cache(8 * 16 * 16 * sizeof(int2));
+  TextureCache::Texture *texture = cache.add_texture(
+      make_unique<PositionTileLoader>(), 300, 200, 16, sizeof(int2));
+
+  std::atomic<int> wrong_pixels = 0;
+  vector<std::thread> threads;
+  for (int thread_index = 0; thread_index < 8; thread_index++) {
+    threads.emplace_back([&, thread_index]() {
+      uint state = thread_index + 1;
+      for (int i = 0; i < 20000; i++) {
+        state = state * 1664525u + 1013904223u;
+        const int x = (state >> 8) % 300;
+        const int y = (state >> 20) % 200;
+        const int2 pixel = read_pixel(*texture, x, y);
+        if (pixel.x != x || pixel.y != y) {
+          wrong_pixels++;
+        }
+      }
+    });
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(wrong_pixels, 0);
+  const TextureCache::Stats stats = cache.get_stats();
+  EXPECT_EQ(stats.hits + stats.misses, 8 * 20000);
+  EXPECT_GT(stats.evictions, 0);
+}
+
+CCL_NAMESPACE_END
@@ -46,6 +46,10 @@ class DebugFlags {
      * CPUs and GPUs can be selected here instead.
      */
     BVHLayout bvh_layout = BVH_LAYOUT_AUTO;
+
+    /* Schedule the kernels of many paths at once, sorted by kernel and shader, instead of
+     * rendering one path after the other with the megakernel. */
+    bool wavefront = false;
   };
 
   /* Descriptor of CUDA feature-set to be used. */
@@ -27,6 +27,10 @@ OIIO_NAMESPACE_USING
 #  include <unistd.h>
 #endif
 
+#ifdef __linux__
+#  include <sched.h>
+#endif
+
 CCL_NAMESPACE_BEGIN
 
 int system_console_width()
@@ -261,4 +265,84 @@ uint64_t system_self_process_id()
 #endif
 }
 
+#ifdef __linux__
+/* Parse list of processors of a NUMA node in the "0-15,32-47" format used by sysfs. */
+static bool system_numa_node_cpu_set(int node, cpu_set_t &cpu_set)
+{
+  const string filepath = string_printf("/sys/devices/system/node/node%d/cpulist", node);
+  FILE *file = fopen(filepath.c_str(), "r");
+  if (!file) {
+    return false;
+  }
+
+  char line[4096];
+  const bool read = (fgets(line, sizeof(line), file) != nullptr);
+  fclose(file);
+  if (!read) {
+    return false;
+  }
+
+  CPU_ZERO(&cpu_set);
+
+  vector<string> ranges;
+  string_split(ranges, line, ",\n");
+  for (const string &range : ranges) {
+    int first, last;
+    const int num = sscanf(range.c_str(), "%d-%d", &first, &last);
+    if (num < 1) {
+      continue;
+    }
+    if (num == 1) {
+      last = first;
+    }
+    for (int cpu = first; cpu <= last && cpu < CPU_SETSIZE; cpu++) {
+      CPU_SET(cpu, &cpu_set);
+    }
+  }
+
+  return CPU_COUNT(&cpu_set) > 0;
+}
+#endif
+
+int system_numa_node_count()
+{
+#ifdef __linux__
+  int num_nodes = 0;
+  while (access(string_printf("/sys/devices/system/node/node%d", num_nodes).c_str(), F_OK) == 0)
+  {
+    num_nodes++;
+  }
+  return (num_nodes > 0) ? num_nodes : 1;
+#else
+  return 1;
+#endif
+}
+
+int system_numa_node_num_processors(int node)
+{
+#ifdef __linux__
+  cpu_set_t cpu_set;
+  if (system_numa_node_cpu_set(node, cpu_set)) {
+    return CPU_COUNT(&cpu_set);
+  }
+#else
+  (void)node;
+#endif
+  return 0;
+}
+
+bool system_numa_node_bind(int node)
+{
+#ifdef __linux__
+  cpu_set_t cpu_set;
+  if (!system_numa_node_cpu_set(node, cpu_set)) {
+    return false;
+  }
+  return sched_setaffinity(0, sizeof(cpu_set), &cpu_set) == 0;
+#else
+  (void)node;
+  return false;
+#endif
+}
+
 CCL_NAMESPACE_END
@@ -25,6 +25,14 @@ size_t system_physical_ram();
 /* Get identifier of the currently running process. */
 uint64_t system_self_process_id();
 
+/* Number of NUMA nodes in the system, 1 when NUMA topology is unknown. */
+int system_numa_node_count();
+/* Number of processors on the given NUMA node, 0 when unknown. */
+int system_numa_node_num_processors(int node);
+/* Restrict the current process to the processors of the given NUMA node. Memory is then
+ * allocated on that node too, following the default first touch policy. */
+bool system_numa_node_bind(int node);
+
 CCL_NAMESPACE_END
 
 #endif /* __UTIL_SYSTEM_H__ */
@@ -13,6 +13,7 @@
 #include <tbb/parallel_for.h>
 #include <tbb/parallel_for_each.h>
 #include <tbb/parallel_reduce.h>
+#include <tbb/parallel_sort.h>
 #include <tbb/task_arena.h>
 #include <tbb/task_group.h>
 
@@ -29,6 +30,7 @@ using tbb::enumerable_thread_specific;
 using tbb::parallel_for;
 using tbb::parallel_for_each;
 using tbb::parallel_reduce;
+using tbb::parallel_sort;
 
 static inline void thread_capture_fp_settings()
 {
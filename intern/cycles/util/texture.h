@@ -83,6 +83,8 @@ typedef struct TextureInfo {
   uint width, height, depth;
   /* Transform for 3D textures. */
   uint use_transform_3d;
+  /* CPU only: data points to a TextureCache::Texture, whose tiles are loaded on demand. */
+  uint use_texture_cache;
   Transform transform_3d;
 } TextureInfo;
 
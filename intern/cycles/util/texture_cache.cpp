@@ -0,0 +1,211 @@
+/* SPDX-FileCopyrightText: 2011-2022 Blender Foundation
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include "util/texture_cache.h"
+
+#include "util/algorithm.h"
+#include "util/aligned_malloc.h"
+#include "util/guarded_allocator.h"
+#include "util/log.h"
+#include "util/math.h"
+#include "util/string.h"
+
+CCL_NAMESPACE_BEGIN
+
+static size_t tile_memory_size(const TextureCache::Texture &texture, const int tile_index)
+{
+  const int tile_x = tile_index % texture.tiles_x;
+  const int tile_y = tile_index / texture.tiles_x;
+  return size_t(texture.tile_width(tile_x)) * texture.tile_height(tile_y) * texture.pixel_size;
+}
+
+static void free_tile_pixels(void *pixels, const size_t size)
+{
+  util_guarded_mem_free(size);
+  util_aligned_free(pixels);
+}
+
+TextureCache::TextureCache(const size_t memory_limit) : memory_limit_(memory_limit)
+{
+  stats_.memory_limit = memory_limit;
+}
+
+TextureCache::~TextureCache()
+{
+  while (!textures_.empty()) {
+    remove_texture(textures_.back().get());
+  }
+}
+
+TextureCache::Texture *TextureCache::add_texture(unique_ptr<TextureTileLoader> loader,
+                                                 const int width,
+                                                 const int height,
+                                                 const int tile_size,
+                                                 const size_t pixel_size)
+{
+  assert(is_power_of_two(tile_size));
+
+  unique_ptr<Texture> texture = make_unique<Texture>();
+  texture->cache = this;
+  texture->loader = std::move(loader);
+  texture->width = width;
+  texture->height = height;
+  texture->tile_size = tile_size;
+  texture->tile_size_log2 = count_trailing_zeros(tile_size);
+  texture->tiles_x = divide_up(width, tile_size);
+  texture->tiles_y = divide_up(height, tile_size);
+  texture->pixel_size = pixel_size;
+  texture->tiles = make_unique<Tile[]>(size_t(texture->tiles_x) * texture->tiles_y);
+
+  thread_scoped_lock lock(mutex_);
+  textures_.push_back(std::move(texture));
+  return textures_.back().get();
+}
+
+void TextureCache::remove_texture(Texture *texture)
+{
+  thread_scoped_lock lock(mutex_);
+
+  size_t resident_num = 0;
+  for (const ResidentTile &resident : resident_tiles_) {
+    if (resident.texture != texture) {
+      resident_tiles_[resident_num++] = resident;
+      continue;
+    }
+    Tile &tile = texture->tiles[resident.tile_index];
+    const size_t size = tile_memory_size(*texture, resident.tile_index);
+    free_tile_pixels(tile.pixels.exchange(nullptr), size);
+    stats_.hits += tile.hits.load(std::memory_order_relaxed);
+    memory_used_ -= size;
+  }
+  resident_tiles_.resize(resident_num);
+
+  for (auto it = textures_.begin(); it != textures_.end(); ++it) {
+    if (it->get() == texture) {
+      textures_.erase(it);
+      break;
+    }
+  }
+}
+
+TextureCache::Stats TextureCache::get_stats()
+{
+  thread_scoped_lock lock(mutex_);
+
+  Stats stats = stats_;
+  for (const ResidentTile &resident : resident_tiles_) {
+    stats.hits += resident.texture->tiles[resident.tile_index].hits.load(
+        std::memory_order_relaxed);
+  }
+  return stats;
+}
+
+void *TextureCache::load_tile(Texture &texture, const int tile_x, const int tile_y)
+{
+  const int tile_index = tile_y * texture.tiles_x + tile_x;
+  Tile &tile = texture.tiles[tile_index];
+
+  thread_scoped_lock lock(mutex_);
+  while (tile.is_loading) {
+    tile_loaded_cond_.wait(lock);
+  }
+  if (void *pixels = tile.pixels.load()) {
+    /* Loaded by another thread in the meantime. */
+    tile.hits.fetch_add(1, std::memory_order_relaxed);
+    return pixels;
+  }
+  tile.is_loading = true;
+  stats_.misses++;
+  lock.unlock();
+
+  /* Load outside of the lock, so that multiple tiles can be loaded at the same time. */
+  const int width = texture.tile_width(tile_x);
+  const int height = texture.tile_height(tile_y);
+  const size_t size = size_t(width) * height * texture.pixel_size;
+  void *pixels = util_aligned_malloc(size, MIN_ALIGNMENT_CPU_DATA_TYPES);
+  if (pixels == nullptr) {
+    throw std::bad_alloc();
+  }
+  util_guarded_mem_alloc(size);
+  texture.loader->load_tile(tile_x << texture.tile_size_log2,
+                            tile_y << texture.tile_size_log2,
+                            width,
+                            height,
+                            pixels);
+
+  lock.lock();
+  tile.last_used.store(clock.fetch_add(1, std::memory_order_relaxed) + 1,
+                       std::memory_order_relaxed);
+  tile.pixels.store(pixels);
+  tile.is_loading = false;
+  texture.memory_used.fetch_add(size, std::memory_order_relaxed);
+  memory_used_ += size;
+  stats_.memory_peak = max(stats_.memory_peak, memory_used_);
+  resident_tiles_.push_back({&texture, tile_index});
+
+  if (memory_used_ > memory_limit_) {
+    evict_tiles();
+  }
+  lock.unlock();
+
+  tile_loaded_cond_.notify_all();
+  return pixels;
+}
+
+void TextureCache::evict_tiles()
+{
+  /* Free a bit more memory than necessary, so that the tiles don't have to be sorted again for
+   * every tile that is loaded afterwards. */
+  const size_t target_memory = memory_limit_ - memory_limit_ / 8;
+
+  /* Sort by a copy of the last use, since it may be changed by the kernel while sorting. */
+  vector<std::pair<uint64_t, size_t>> order;
+  order.reserve(resident_tiles_.size());
+  for (size_t i = 0; i < resident_tiles_.size(); i++) {
+    const ResidentTile &resident = resident_tiles_[i];
+    order.emplace_back(
+        resident.texture->tiles[resident.tile_index].last_used.load(std::memory_order_relaxed),
+        i);
+  }
+  sort(order.begin(), order.end());
+
+  vector<bool> evicted(resident_tiles_.size(), false);
+  for (const std::pair<uint64_t, size_t> &item : order) {
+    if (memory_used_ <= target_memory) {
+      break;
+    }
+    const ResidentTile &resident = resident_tiles_[item.second];
+    Texture &texture = *resident.texture;
+    Tile &tile = texture.tiles[resident.tile_index];
+
+    /* A lookup registers itself as user before reading the pixels pointer. So when there are no
+     * users after the pointer is cleared, no lookup can still be reading the pixels. */
+    void *pixels = tile.pixels.exchange(nullptr);
+    if (tile.users.load() != 0) {
+      tile.pixels.store(pixels);
+      continue;
+    }
+
+    const size_t size = tile_memory_size(texture, resident.tile_index);
+    free_tile_pixels(pixels, size);
+    texture.memory_used.fetch_sub(size, std::memory_order_relaxed);
+    memory_used_ -= size;
+    stats_.hits += tile.hits.exchange(0, std::memory_order_relaxed);
+    stats_.evictions++;
+    evicted[item.second] = true;
+  }
+
+  size_t resident_num = 0;
+  for (size_t i = 0; i < resident_tiles_.size(); i++) {
+    if (!evicted[i]) {
+      resident_tiles_[resident_num++] = resident_tiles_[i];
+    }
+  }
+  resident_tiles_.resize(resident_num);
+
+  VLOG_DEBUG << "Texture cache evicted tiles, using " << string_human_readable_size(memory_used_)
+             << " of " << string_human_readable_size(memory_limit_) << ".";
+}
+
+CCL_NAMESPACE_END
@@ -0,0 +1,161 @@
+/* SPDX-FileCopyrightText: 2011-2022 Blender Foundation
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#ifndef __UTIL_TEXTURE_CACHE_H__
+#define __UTIL_TEXTURE_CACHE_H__
+
+#include <atomic>
+
+#include "util/math.h"
+#include "util/thread.h"
+#include "util/types.h"
+#include "util/unique_ptr.h"
+#include "util/vector.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Loads the pixels of texture tiles for the texture cache. */
+class TextureTileLoader {
+ public:
+  virtual ~TextureTileLoader() = default;
+
+  /* Fill the pixels of the tile with the given bounds, tightly packed. Rows are stored from top
+   * to bottom like in image files. Called from multiple threads at once. When the pixels can't be
+   * loaded the loader fills them with a placeholder color, the cache uses the pixels either way. */
+  virtual void load_tile(int x, int y, int width, int height, void *pixels) = 0;
+};
+
+/* Texture Cache
+ *
+ * Keeps image textures in memory as square tiles, which are loaded when the CPU kernel first
+ * reads them. When the memory used by tiles exceeds the limit, the least recently used tiles are
+ * freed again. This makes it possible to render scenes with more texture data than fits in
+ * memory, as long as each render only sees part of it. */
+class TextureCache {
+ public:
+  struct Tile {
+    /* Null until the tile is loaded and after it is evicted. */
+    std::atomic<void *> pixels = nullptr;
+    /* Number of lookups that are currently reading the pixels, these tiles are not evicted. */
+    std::atomic<int> users = 0;
+    /* Number of lookups that found the tile in memory since it was loaded. */
+    std::atomic<uint> hits = 0;
+    /* Value of the cache clock at the last lookup, to find the least recently used tiles. */
+    std::atomic<uint64_t> last_used = 0;
+    /* Protected by the cache mutex. */
+    bool is_loading = false;
+  };
+
+  class Texture {
+   public:
+    /* Get the pixels of a tile, loading them first if necessary. The pixels stay valid until the
+     * tile is released again. */
+    ccl_always_inline const void *acquire_tile(const int tile_x, const int tile_y)
+    {
+      Tile &tile = tiles[tile_y * tiles_x + tile_x];
+      /* Registering the user before reading the pointer guarantees that the tile is not evicted
+       * while it is read, see #TextureCache::evict_tiles. */
+      tile.users.fetch_add(1);
+      void *pixels = tile.pixels.load();
+      if (pixels == nullptr) {
+        return cache->load_tile(*this, tile_x, tile_y);
+      }
+      tile.hits.fetch_add(1, std::memory_order_relaxed);
+      const uint64_t clock = cache->clock.load(std::memory_order_relaxed);
+      if (tile.last_used.load(std::memory_order_relaxed) != clock) {
+        tile.last_used.store(clock, std::memory_order_relaxed);
+      }
+      return pixels;
+    }
+
+    ccl_always_inline void release_tile(const int tile_x, const int tile_y)
+    {
+      tiles[tile_y * tiles_x + tile_x].users.fetch_sub(1);
+    }
+
+    /* Tiles at the right and top border may be smaller than the tile size. */
+    ccl_always_inline int tile_width(const int tile_x) const
+    {
+      return min(tile_size, width - (tile_x << tile_size_log2));
+    }
+
+    ccl_always_inline int tile_height(const int tile_y) const
+    {
+      return min(tile_size, height - (tile_y << tile_size_log2));
+    }
+
+    /* Memory used by the tiles of this texture that are currently loaded. */
+    size_t memory_size() const
+    {
+      return memory_used.load(std::memory_order_relaxed);
+    }
+
+    /* Size of the texture in pixels. */
+    int width = 0;
+    int height = 0;
+    /* Tiles are squares with a size that is a power of two. */
+    int tile_size = 0;
+    int tile_size_log2 = 0;
+    int tiles_x = 0;
+    int tiles_y = 0;
+    size_t pixel_size = 0;
+
+   protected:
+    TextureCache *cache = nullptr;
+    unique_ptr<TextureTileLoader> loader;
+    unique_ptr<Tile[]> tiles;
+    std::atomic<size_t> memory_used = 0;
+
+    friend class TextureCache;
+  };
+
+  struct Stats {
+    /* Tile lookups that found the tile in memory. */
+    uint64_t hits = 0;
+    /* Tile lookups that had to load the tile. */
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    size_t memory_limit = 0;
+    size_t memory_peak = 0;
+  };
+
+  explicit TextureCache(size_t memory_limit);
+  ~TextureCache();
+
+  /* Add a texture to the cache, no tiles are loaded yet. The texture stays valid until it is
+   * removed again. Must not be called while the kernel is reading from the cache. */
+  Texture *add_texture(unique_ptr<TextureTileLoader> loader,
+                       int width,
+                       int height,
+                       int tile_size,
+                       size_t pixel_size);
+  void remove_texture(Texture *texture);
+
+  Stats get_stats();
+
+ protected:
+  void *load_tile(Texture &texture, int tile_x, int tile_y);
+  void evict_tiles();
+
+  struct ResidentTile {
+    Texture *texture;
+    int tile_index;
+  };
+
+  size_t memory_limit_;
+  size_t memory_used_ = 0;
+  Stats stats_;
+
+  /* Incremented for every loaded tile, so the least recently used tiles have the oldest value. */
+  std::atomic<uint64_t> clock = 0;
+
+  thread_mutex mutex_;
+  thread_condition_variable tile_loaded_cond_;
+  vector<unique_ptr<Texture>> textures_;
+  vector<ResidentTile> resident_tiles_;
+};
+
+CCL_NAMESPACE_END
+
+#endif /* __UTIL_TEXTURE_CACHE_H__ */
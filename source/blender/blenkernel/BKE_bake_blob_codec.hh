@@ -0,0 +1,69 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#pragma once
+
+/** \file
+ * \ingroup bke
+ *
+ * Lossless compression of arrays that are stored in bake blobs. Arrays are split into chunks that
+ * are compressed and decompressed independently, which allows processing them in parallel.
+ */
+
+#include <optional>
+
+#include "BLI_generic_span.hh"
+#include "BLI_string_ref.hh"
+#include "BLI_vector.hh"
+
+namespace blender::bke::bake {
+
+enum class BlobCodec {
+  /** Compress the bytes as they are. */
+  Zstd,
+  /**
+   * Group the n-th bytes of all elements before compressing them. This works well for floating
+   * point data, where the sign and exponent bytes of neighboring values are often similar.
+   */
+  ShuffleZstd,
+  /**
+   * Store the difference of every 32-bit integer component to the previous element before
+   * shuffling the bytes. This works well for indices and sorted identifiers.
+   */
+  DeltaZstd,
+};
+
+StringRefNull blob_codec_io_name(BlobCodec codec);
+std::optional<BlobCodec> blob_codec_from_io_name(StringRef io_name);
+
+/**
+ * Choose a codec that works well for arrays of the given type.
+ * \return None if arrays of that type are not compressed.
+ */
+std::optional<BlobCodec> blob_codec_for_type(const CPPType &type);
+
+struct CompressedBlob {
+  /** Number of elements in every chunk except for the last one. */
+  int64_t chunk_size = 0;
+  /** Compressed size of every chunk in bytes. */
+  Vector<int64_t> chunk_sizes;
+  /** All compressed chunks, one after the other. */
+  Vector<char> data;
+};
+
+/**
+ * \return None if the compression failed.
+ */
+std::optional<CompressedBlob> compress_blob(BlobCodec codec, GSpan data);
+
+/**
+ * \return False if the compressed data is invalid or doesn't match the size of the output array.
+ */
+[[nodiscard]] bool decompress_blob(BlobCodec codec,
+                                   Span<char> compressed_data,
+                                   int64_t chunk_size,
+                                   Span<int64_t> chunk_sizes,
+                                   GMutableSpan r_data);
+
+}  // namespace blender::bke::bake
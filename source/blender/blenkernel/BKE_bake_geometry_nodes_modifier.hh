@@ -14,6 +14,7 @@ struct NodesModifierData;
 struct Main;
 struct Object;
 struct Scene;
+struct TaskPool;
 
 namespace blender::bke::bake {
 
@@ -39,6 +40,70 @@ struct FrameCache {
   std::optional<std::string> meta_path;
 };
 
+/**
+ * Loads baked frames from disk on worker threads before they are needed. The upcoming frames are
+ * predicted from the direction in which the current frame changed, so that playing back heavy
+ * bakes doesn't have to wait for reading and parsing the data of every frame.
+ */
+class FramePrefetcher : NonCopyable, NonMovable {
+ public:
+  struct Stats {
+    /** Requested frames that were loaded in advance already. */
+    int64_t hits = 0;
+    /** Requested frames that were still being loaded in the background. */
+    int64_t waits = 0;
+    /** Requested frames that were not prefetched and had to be loaded when needed. */
+    int64_t misses = 0;
+  };
+
+ private:
+  /** Maximum number of upcoming frames that are loaded in advance. */
+  static constexpr int prefetch_frames_num = 4;
+
+  struct LoadTask;
+  struct LoadTaskData;
+
+  std::string blobs_dir_;
+  const BlobReadSharing &blob_sharing_;
+  TaskPool *task_pool_;
+  /** Frames that are loaded in the background, by their index in #NodeBakeCache::frames. */
+  Map<int, std::shared_ptr<LoadTask>> tasks_;
+  std::optional<SubFrame> last_frame_;
+  int direction_ = 1;
+  Stats stats_;
+
+ public:
+  FramePrefetcher(std::string blobs_dir, const BlobReadSharing &blob_sharing);
+  ~FramePrefetcher();
+
+  /**
+   * Load the baked frame, using the result of a previous prefetch if possible. Must not be called
+   * from multiple threads at the same time.
+   */
+  std::optional<BakeState> load(const FrameCache &frame_cache, int frame_index);
+
+  /**
+   * Start loading the frames that are likely needed after the current frame in the background.
+   * Prefetched frames that are not needed anymore are discarded.
+   */
+  void prefetch(Span<std::unique_ptr<FrameCache>> frames, SubFrame current_frame);
+
+  /** Wait until all frames that are loaded in the background are ready, mainly for tests. */
+  void wait_for_prefetch();
+
+  const Stats &stats() const;
+
+ private:
+  static void load_task_run(TaskPool *pool, void *taskdata);
+};
+
+/**
+ * Read the state of a baked frame from disk.
+ */
+std::optional<BakeState> load_baked_frame(StringRefNull blobs_dir,
+                                          StringRefNull meta_path,
+                                          const BlobReadSharing &blob_sharing);
+
 /**
  * Stores the state after the previous simulation step. This is only used, when the frame-cache is
  * not used.
@@ -61,6 +126,11 @@ struct NodeBakeCache {
   std::unique_ptr<BlobReadSharing> blob_sharing;
   /** Used to avoid checking if a bake exists many times. */
   bool failed_finding_bake = false;
+  /**
+   * Loads upcoming frames in the background when the baked data is loaded lazily. This is
+   * declared after #blob_sharing so that it's destructed first, which waits for running tasks.
+   */
+  std::unique_ptr<FramePrefetcher> prefetcher;
 
   /** Range spanning from the first to the last baked frame. */
   IndexRange frame_range() const;
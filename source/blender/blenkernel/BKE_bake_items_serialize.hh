@@ -6,6 +6,7 @@
 
 #include "BLI_fileops.hh"
 #include "BLI_function_ref.hh"
+#include "BLI_generic_span.hh"
 #include "BLI_serialize.hh"
 
 #include "BKE_bake_items.hh"
@@ -41,12 +42,26 @@ class BlobReader {
    */
   [[nodiscard]] virtual bool read_as_stream(const BlobSlice &slice,
                                             FunctionRef<bool(std::istream &)> fn) const;
+
+  /**
+   * Provides access to the data of the given slice without copying it, e.g. by memory-mapping the
+   * file that contains it. The data is owned by the returned sharing info and may be modified,
+   * which never changes the stored blob. This is optional and generally only done for large
+   * slices.
+   * \param alignment: Required alignment of the returned data.
+   * \return The data, or none if it can't be accessed directly. #read should be used then.
+   */
+  [[nodiscard]] virtual std::optional<ImplicitSharingInfoAndData> read_mapped(
+      const BlobSlice &slice, int64_t alignment) const;
 };
 
 /**
  * Abstract base class for writing binary data.
  */
 class BlobWriter {
+ protected:
+  bool compress_arrays_ = false;
+
  public:
   /**
    * Write the provided binary data.
@@ -62,6 +77,20 @@ class BlobWriter {
    */
   virtual BlobSlice write_as_stream(StringRef file_extension,
                                     FunctionRef<void(std::ostream &)> fn);
+
+  /**
+   * When enabled, large arrays are compressed before they are written. Compressed arrays take
+   * less space but can't be memory mapped when they are loaded.
+   */
+  void set_compress_arrays(const bool compress)
+  {
+    compress_arrays_ = compress;
+  }
+
+  bool compress_arrays() const
+  {
+    return compress_arrays_;
+  }
 };
 
 /**
@@ -95,6 +124,12 @@ class BlobWriteSharing : NonCopyable, NonMovable {
    */
   Map<uint64_t, BlobSlice> slice_by_content_hash_;
 
+  /**
+   * Same as above, but for data that is not stored as is (e.g. because it is compressed). The
+   * hash also depends on the type of the data.
+   */
+  Map<uint64_t, std::shared_ptr<io::serialize::DictionaryValue>> io_data_by_content_hash_;
+
  public:
   ~BlobWriteSharing();
 
@@ -115,6 +150,12 @@ class BlobWriteSharing : NonCopyable, NonMovable {
    */
   [[nodiscard]] std::shared_ptr<io::serialize::DictionaryValue> write_deduplicated(
       BlobWriter &writer, const void *data, int64_t size_in_bytes);
+
+  /**
+   * Same as above, but the data is written by the given function which may transform it first.
+   */
+  [[nodiscard]] std::shared_ptr<io::serialize::DictionaryValue> write_deduplicated(
+      GSpan data, FunctionRef<std::shared_ptr<io::serialize::DictionaryValue>()> write_fn);
 };
 
 /**
@@ -144,6 +185,16 @@ class BlobReadSharing : NonCopyable, NonMovable {
       FunctionRef<std::optional<ImplicitSharingInfoAndData>()> read_fn) const;
 };
 
+/**
+ * Blobs written by #DiskBlobWriter that are at least this large start at a multiple of
+ * #mapped_blob_alignment in the file. This allows #DiskBlobReader to memory-map them, so that
+ * only the pages that are actually used are loaded.
+ */
+constexpr int64_t mapped_blob_min_size = 64 * 1024;
+constexpr int64_t mapped_blob_alignment = 4096;
+
+class MappedBlobFile;
+
 /**
  * A specific #BlobReader that reads from disk.
  */
@@ -152,10 +203,14 @@ class DiskBlobReader : public BlobReader {
   const std::string blobs_dir_;
   mutable std::mutex mutex_;
   mutable Map<std::string, std::unique_ptr<fstream>> open_input_streams_;
+  /** Memory-mapped blob files, the mapping is kept alive as long as any of its data is used. */
+  mutable Map<std::string, std::shared_ptr<MappedBlobFile>> mapped_files_;
 
  public:
   DiskBlobReader(std::string blobs_dir);
   [[nodiscard]] bool read(const BlobSlice &slice, void *r_data) const override;
+  [[nodiscard]] std::optional<ImplicitSharingInfoAndData> read_mapped(
+      const BlobSlice &slice, int64_t alignment) const override;
 };
 
 /**
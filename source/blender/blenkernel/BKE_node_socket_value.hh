@@ -121,6 +121,11 @@ class SocketValueVariant {
    */
   bool is_context_dependent_field() const;
 
+  /**
+   * The stored value is a single value that can be accessed with #get_single_ptr.
+   */
+  bool is_single() const;
+
   /**
    * The stored value is a volume grid.
    */
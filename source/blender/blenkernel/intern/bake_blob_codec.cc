@@ -0,0 +1,244 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup bke
+ */
+
+#include <atomic>
+
+#include "BKE_bake_blob_codec.hh"
+
+#include "BLI_array.hh"
+#include "BLI_color.hh"
+#include "BLI_math_matrix_types.hh"
+#include "BLI_math_quaternion_types.hh"
+#include "BLI_math_vector_types.hh"
+#include "BLI_offset_indices.hh"
+#include "BLI_task.hh"
+
+#include <zstd.h>
+
+namespace blender::bke::bake {
+
+/** Uncompressed size of a chunk. Smaller chunks allow for more parallelism but compress worse. */
+static constexpr int64_t chunk_size_in_bytes = 1024 * 1024;
+static constexpr int zstd_compression_level = 3;
+
+StringRefNull blob_codec_io_name(const BlobCodec codec)
+{
+  switch (codec) {
+    case BlobCodec::Zstd:
+      return "zstd";
+    case BlobCodec::ShuffleZstd:
+      return "shuffle_zstd";
+    case BlobCodec::DeltaZstd:
+      return "delta_zstd";
+  }
+  BLI_assert_unreachable();
+  return "";
+}
+
+std::optional<BlobCodec> blob_codec_from_io_name(const StringRef io_name)
+{
+  for (const BlobCodec codec : {BlobCodec::Zstd, BlobCodec::ShuffleZstd, BlobCodec::DeltaZstd}) {
+    if (io_name == blob_codec_io_name(codec)) {
+      return codec;
+    }
+  }
+  return std::nullopt;
+}
+
+std::optional<BlobCodec> blob_codec_for_type(const CPPType &type)
+{
+  if (type.size() == 1 || type.is<ColorGeometry4b>()) {
+    return BlobCodec::Zstd;
+  }
+  if (type.is_any<float, float2, float3, float4x4, ColorGeometry4f, math::Quaternion>()) {
+    return BlobCodec::ShuffleZstd;
+  }
+  if (type.is_any<int32_t, int2>()) {
+    return BlobCodec::DeltaZstd;
+  }
+  return std::nullopt;
+}
+
+static void shuffle_bytes(const Span<char> src, const int64_t stride, MutableSpan<char> dst)
+{
+  const int64_t elements_num = src.size() / stride;
+  for (const int64_t byte : IndexRange(stride)) {
+    char *dst_plane = dst.data() + byte * elements_num;
+    for (const int64_t i : IndexRange(elements_num)) {
+      dst_plane[i] = src[i * stride + byte];
+    }
+  }
+}
+
+static void unshuffle_bytes(const Span<char> src, const int64_t stride, MutableSpan<char> dst)
+{
+  const int64_t elements_num = src.size() / stride;
+  for (const int64_t byte : IndexRange(stride)) {
+    const char *src_plane = src.data() + byte * elements_num;
+    for (const int64_t i : IndexRange(elements_num)) {
+      dst[i * stride + byte] = src_plane[i];
+    }
+  }
+}
+
+/** Replace every integer by its difference to the same component of the previous element. */
+static void encode_delta(MutableSpan<char> bytes, const int64_t stride)
+{
+  MutableSpan<uint32_t> values(reinterpret_cast<uint32_t *>(bytes.data()),
+                               bytes.size() / sizeof(uint32_t));
+  const int64_t components_num = stride / sizeof(uint32_t);
+  for (int64_t i = values.size() - 1; i >= components_num; i--) {
+    values[i] -= values[i - components_num];
+  }
+}
+
+static void decode_delta(MutableSpan<char> bytes, const int64_t stride)
+{
+  MutableSpan<uint32_t> values(reinterpret_cast<uint32_t *>(bytes.data()),
+                               bytes.size() / sizeof(uint32_t));
+  const int64_t components_num = stride / sizeof(uint32_t);
+  for (const int64_t i : values.index_range().drop_front(components_num)) {
+    values[i] += values[i - components_num];
+  }
+}
+
+static int64_t get_chunk_size(const CPPType &type)
+{
+  return std::max<int64_t>(1, chunk_size_in_bytes / type.size());
+}
+
+static IndexRange get_chunk_elements(const int64_t chunk,
+                                     const int64_t chunk_size,
+                                     const int64_t elements_num)
+{
+  const int64_t start = chunk * chunk_size;
+  return IndexRange(start, std::min(chunk_size, elements_num - start));
+}
+
+std::optional<CompressedBlob> compress_blob(const BlobCodec codec, const GSpan data)
+{
+  const int64_t stride = data.type().size();
+  CompressedBlob result;
+  result.chunk_size = get_chunk_size(data.type());
+  const int64_t chunks_num = (data.size() + result.chunk_size - 1) / result.chunk_size;
+
+  Array<Vector<char>> compressed_chunks(chunks_num);
+  std::atomic<bool> failed = false;
+  threading::parallel_for(IndexRange(chunks_num), 1, [&](const IndexRange range) {
+    Vector<char> transformed;
+    for (const int64_t chunk : range) {
+      const GSpan src_elements = data.slice(
+          get_chunk_elements(chunk, result.chunk_size, data.size()));
+      Span<char> src(static_cast<const char *>(src_elements.data()),
+                     src_elements.size_in_bytes());
+
+      switch (codec) {
+        case BlobCodec::Zstd:
+          break;
+        case BlobCodec::ShuffleZstd:
+          transformed.resize(src.size());
+          shuffle_bytes(src, stride, transformed);
+          src = transformed;
+          break;
+        case BlobCodec::DeltaZstd: {
+          Vector<char> deltas(src);
+          encode_delta(deltas, stride);
+          transformed.resize(src.size());
+          shuffle_bytes(deltas, stride, transformed);
+          src = transformed;
+          break;
+        }
+      }
+
+      Vector<char> &compressed = compressed_chunks[chunk];
+      compressed.resize(ZSTD_compressBound(src.size()));
+      const size_t compressed_size = ZSTD_compress(
+          compressed.data(), compressed.size(), src.data(), src.size(), zstd_compression_level);
+      if (ZSTD_isError(compressed_size)) {
+        failed = true;
+        return;
+      }
+      compressed.resize(compressed_size);
+    }
+  });
+  if (failed) {
+    return std::nullopt;
+  }
+
+  for (const Vector<char> &compressed : compressed_chunks) {
+    result.chunk_sizes.append(compressed.size());
+    result.data.extend(compressed);
+  }
+  return result;
+}
+
+bool decompress_blob(const BlobCodec codec,
+                     const Span<char> compressed_data,
+                     const int64_t chunk_size,
+                     const Span<int64_t> chunk_sizes,
+                     GMutableSpan r_data)
+{
+  const int64_t stride = r_data.type().size();
+  if (chunk_size <= 0) {
+    return false;
+  }
+  if (chunk_sizes.size() != (r_data.size() + chunk_size - 1) / chunk_size) {
+    return false;
+  }
+  Array<int64_t> chunk_offsets_data(chunk_sizes.size() + 1);
+  chunk_offsets_data[0] = 0;
+  for (const int64_t chunk : chunk_sizes.index_range()) {
+    if (chunk_sizes[chunk] <= 0) {
+      return false;
+    }
+    chunk_offsets_data[chunk + 1] = chunk_offsets_data[chunk] + chunk_sizes[chunk];
+  }
+  const OffsetIndices<int64_t> chunk_offsets(chunk_offsets_data);
+  if (chunk_offsets.total_size() != compressed_data.size()) {
+    return false;
+  }
+
+  std::atomic<bool> success = true;
+  threading::parallel_for(chunk_offsets.index_range(), 1, [&](const IndexRange range) {
+    Vector<char> transformed;
+    for (const int64_t chunk : range) {
+      const GMutableSpan dst_elements = r_data.slice(
+          get_chunk_elements(chunk, chunk_size, r_data.size()));
+      MutableSpan<char> dst(static_cast<char *>(dst_elements.data()),
+                            dst_elements.size_in_bytes());
+      const Span<char> src = compressed_data.slice(chunk_offsets[chunk]);
+
+      MutableSpan<char> decompressed = dst;
+      if (codec != BlobCodec::Zstd) {
+        transformed.resize(dst.size());
+        decompressed = transformed;
+      }
+      const size_t decompressed_size = ZSTD_decompress(
+          decompressed.data(), decompressed.size(), src.data(), src.size());
+      if (ZSTD_isError(decompressed_size) || decompressed_size != decompressed.size()) {
+        success = false;
+        return;
+      }
+
+      switch (codec) {
+        case BlobCodec::Zstd:
+          break;
+        case BlobCodec::ShuffleZstd:
+          unshuffle_bytes(decompressed, stride, dst);
+          break;
+        case BlobCodec::DeltaZstd:
+          unshuffle_bytes(decompressed, stride, dst);
+          decode_delta(dst, stride);
+          break;
+      }
+    }
+  });
+  return success;
+}
+
+}  // namespace blender::bke::bake
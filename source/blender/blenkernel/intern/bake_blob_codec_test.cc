@@ -0,0 +1,87 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "testing/testing.h"
+
+#include "BKE_bake_blob_codec.hh"
+
+#include "BLI_array.hh"
+#include "BLI_math_vector_types.hh"
+
+namespace blender::bke::bake::tests {
+
+template<typename T> static void test_roundtrip(const Span<T> values)
+{
+  const std::optional<BlobCodec> codec = blob_codec_for_type(CPPType::get<T>());
+  ASSERT_TRUE(codec.has_value());
+  const std::optional<CompressedBlob> compressed_opt = compress_blob(*codec, values);
+  ASSERT_TRUE(compressed_opt.has_value());
+  const CompressedBlob &compressed = *compressed_opt;
+  EXPECT_LT(compressed.data.size(), values.size_in_bytes());
+
+  Array<T> decompressed(values.size());
+  EXPECT_TRUE(decompress_blob(*codec,
+                              compressed.data,
+                              compressed.chunk_size,
+                              compressed.chunk_sizes,
+                              decompressed.as_mutable_span()));
+  EXPECT_EQ(decompressed.as_span(), values);
+
+  /* Corrupted data is detected. */
+  Vector<char> corrupted = compressed.data;
+  corrupted.remove_last();
+  Vector<int64_t> corrupted_chunk_sizes = compressed.chunk_sizes;
+  corrupted_chunk_sizes.last()--;
+  EXPECT_FALSE(decompress_blob(*codec,
+                               corrupted,
+                               compressed.chunk_size,
+                               corrupted_chunk_sizes,
+                               decompressed.as_mutable_span()));
+}
+
+TEST(bake_blob_codec, roundtrip_float3)
+{
+  Array<float3> values(300'000);
+  for (const int i : values.index_range()) {
+    values[i] = float3(i % 100, i / 100, 0.5f) * 0.1f;
+  }
+  test_roundtrip(values.as_span());
+}
+
+TEST(bake_blob_codec, roundtrip_int)
+{
+  Array<int> values(500'000);
+  for (const int i : values.index_range()) {
+    values[i] = i * 3 + i % 2;
+  }
+  test_roundtrip(values.as_span());
+}
+
+TEST(bake_blob_codec, roundtrip_int2)
+{
+  Array<int2> values(1000);
+  for (const int i : values.index_range()) {
+    values[i] = int2(i, i + 1);
+  }
+  test_roundtrip(values.as_span());
+}
+
+TEST(bake_blob_codec, roundtrip_bytes)
+{
+  Array<bool> values(100'000);
+  for (const int i : values.index_range()) {
+    values[i] = i % 7 == 0;
+  }
+  test_roundtrip(values.as_span());
+}
+
+TEST(bake_blob_codec, io_names)
+{
+  for (const BlobCodec codec : {BlobCodec::Zstd, BlobCodec::ShuffleZstd, BlobCodec::DeltaZstd}) {
+    EXPECT_EQ(blob_codec_from_io_name(blob_codec_io_name(codec)), codec);
+  }
+  EXPECT_FALSE(blob_codec_from_io_name("unknown").has_value());
+}
+
+}  // namespace blender::bke::bake::tests
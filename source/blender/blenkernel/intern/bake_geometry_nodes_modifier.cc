@@ -2,6 +2,8 @@
  *
  * SPDX-License-Identifier: GPL-2.0-or-later */
 
+#include <cinttypes>
+#include <condition_variable>
 #include <sstream>
 
 #include "BKE_bake_geometry_nodes_modifier.hh"
@@ -15,9 +17,14 @@
 #include "BLI_fileops.hh"
 #include "BLI_path_util.h"
 #include "BLI_string.h"
+#include "BLI_task.h"
 
 #include "MOD_nodes.hh"
 
+#include "CLG_log.h"
+
+static CLG_LogRef LOG = {"bke.bake"};
+
 namespace blender::bke::bake {
 
 void SimulationNodeCache::reset()
@@ -48,6 +55,161 @@ IndexRange NodeBakeCache::frame_range() const
   return IndexRange::from_begin_end_inclusive(start_frame, end_frame);
 }
 
+std::optional<BakeState> load_baked_frame(const StringRefNull blobs_dir,
+                                          const StringRefNull meta_path,
+                                          const BlobReadSharing &blob_sharing)
+{
+  DiskBlobReader blob_reader{blobs_dir};
+  fstream meta_file{meta_path, std::ios::in};
+  return deserialize_bake(meta_file, blob_reader, blob_sharing);
+}
+
+struct FramePrefetcher::LoadTask {
+  /** Set by whoever starts loading the frame, the worker thread or the thread requesting it. */
+  std::atomic<bool> started = false;
+  std::mutex mutex;
+  std::condition_variable finished_cond;
+  bool finished = false;
+  std::optional<BakeState> state;
+  std::string meta_path;
+};
+
+struct FramePrefetcher::LoadTaskData {
+  FramePrefetcher *prefetcher;
+  std::shared_ptr<LoadTask> task;
+};
+
+FramePrefetcher::FramePrefetcher(std::string blobs_dir, const BlobReadSharing &blob_sharing)
+    : blobs_dir_(std::move(blobs_dir)), blob_sharing_(blob_sharing)
+{
+  task_pool_ = BLI_task_pool_create_background(this, TASK_PRIORITY_LOW);
+}
+
+FramePrefetcher::~FramePrefetcher()
+{
+  BLI_task_pool_cancel(task_pool_);
+  BLI_task_pool_free(task_pool_);
+  CLOG_INFO(&LOG,
+            1,
+            "Prefetched bake frames in %s: %" PRId64 " hits, %" PRId64 " waits, %" PRId64
+            " misses",
+            blobs_dir_.c_str(),
+            stats_.hits,
+            stats_.waits,
+            stats_.misses);
+}
+
+void FramePrefetcher::load_task_run(TaskPool * /*pool*/, void *taskdata)
+{
+  const LoadTaskData &data = *static_cast<const LoadTaskData *>(taskdata);
+  LoadTask &task = *data.task;
+  if (task.started.exchange(true)) {
+    /* The frame has been requested or discarded in the mean time. */
+    return;
+  }
+  std::optional<BakeState> state = load_baked_frame(
+      data.prefetcher->blobs_dir_, task.meta_path, data.prefetcher->blob_sharing_);
+  {
+    std::lock_guard lock{task.mutex};
+    task.state = std::move(state);
+    task.finished = true;
+  }
+  task.finished_cond.notify_all();
+}
+
+std::optional<BakeState> FramePrefetcher::load(const FrameCache &frame_cache,
+                                               const int frame_index)
+{
+  BLI_assert(frame_cache.meta_path);
+  std::shared_ptr<LoadTask> task = tasks_.pop_default(frame_index, nullptr);
+  if (task) {
+    if (task->started.exchange(true)) {
+      std::unique_lock lock{task->mutex};
+      if (task->finished) {
+        stats_.hits++;
+      }
+      else {
+        stats_.waits++;
+        task->finished_cond.wait(lock, [&]() { return task->finished; });
+      }
+      return std::move(task->state);
+    }
+  }
+  stats_.misses++;
+  return load_baked_frame(blobs_dir_, *frame_cache.meta_path, blob_sharing_);
+}
+
+void FramePrefetcher::prefetch(const Span<std::unique_ptr<FrameCache>> frames,
+                               const SubFrame current_frame)
+{
+  if (last_frame_ && *last_frame_ != current_frame) {
+    direction_ = current_frame > *last_frame_ ? 1 : -1;
+  }
+  last_frame_ = current_frame;
+
+  /* Find the frames that come after the current frame in the playback direction. */
+  IndexRange prefetch_range;
+  if (direction_ > 0) {
+    const int first_future_index = binary_search::find_predicate_begin(
+        frames, [&](const std::unique_ptr<FrameCache> &value) {
+          return value->frame > current_frame;
+        });
+    prefetch_range = IndexRange::from_begin_end(
+        first_future_index, std::min<int>(first_future_index + prefetch_frames_num, frames.size()));
+  }
+  else {
+    const int first_current_index = binary_search::find_predicate_begin(
+        frames, [&](const std::unique_ptr<FrameCache> &value) {
+          return value->frame >= current_frame;
+        });
+    prefetch_range = IndexRange::from_begin_end(
+        std::max(first_current_index - prefetch_frames_num, 0), first_current_index);
+  }
+
+  /* Discard frames that were prefetched for a different direction or position. */
+  tasks_.remove_if([&](const auto item) {
+    if (prefetch_range.contains(item.key)) {
+      return false;
+    }
+    item.value->started.store(true);
+    return true;
+  });
+
+  for (const int frame_index : prefetch_range) {
+    const FrameCache &frame_cache = *frames[frame_index];
+    if (!frame_cache.meta_path || !frame_cache.state.items_by_id.is_empty()) {
+      continue;
+    }
+    if (tasks_.contains(frame_index)) {
+      continue;
+    }
+    auto task = std::make_shared<LoadTask>();
+    task->meta_path = *frame_cache.meta_path;
+    tasks_.add_new(frame_index, task);
+    BLI_task_pool_push(
+        task_pool_,
+        load_task_run,
+        MEM_new<LoadTaskData>(__func__, LoadTaskData{this, std::move(task)}),
+        true,
+        [](TaskPool * /*pool*/, void *taskdata) {
+          MEM_delete(static_cast<LoadTaskData *>(taskdata));
+        });
+  }
+}
+
+void FramePrefetcher::wait_for_prefetch()
+{
+  for (const std::shared_ptr<LoadTask> &task : tasks_.values()) {
+    std::unique_lock lock{task->mutex};
+    task->finished_cond.wait(lock, [&]() { return task->finished; });
+  }
+}
+
+const FramePrefetcher::Stats &FramePrefetcher::stats() const
+{
+  return stats_;
+}
+
 SimulationNodeCache *ModifierCache::get_simulation_node_cache(const int id)
 {
   std::unique_ptr<SimulationNodeCache> *ptr = this->simulation_cache_by_id.lookup_ptr(id);
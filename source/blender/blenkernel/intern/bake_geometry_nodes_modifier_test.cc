@@ -0,0 +1,219 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include <atomic>
+#include <chrono>
+#include <sstream>
+#include <thread>
+
+#include "testing/testing.h"
+
+#include "BKE_appdir.hh"
+#include "BKE_bake_geometry_nodes_modifier.hh"
+
+#include "BLI_fileops.h"
+#include "BLI_path_util.h"
+
+#include "CLG_log.h"
+
+#ifndef _WIN32
+#  include <sys/stat.h>
+#endif
+
+namespace blender::bke::bake::tests {
+
+static constexpr int test_frames_num = 8;
+
+class BakeFramePrefetchTest : public testing::Test {
+ protected:
+  std::string blobs_dir_;
+  Vector<std::unique_ptr<FrameCache>> frames_;
+  /** Path and contents of the meta file of every frame. */
+  Vector<std::string> meta_paths_;
+  Vector<std::string> meta_contents_;
+
+  static void SetUpTestSuite()
+  {
+    /* The prefetcher logs its statistics when it's freed. */
+    CLG_init();
+  }
+
+  static void TearDownTestSuite()
+  {
+    CLG_exit();
+  }
+
+  void SetUp() override
+  {
+    BKE_tempdir_init(nullptr);
+    blobs_dir_ = BKE_tempdir_session();
+
+    /* Write a small bake with a single string item per frame. */
+    BlobWriteSharing blob_sharing;
+    for (const int i : IndexRange(test_frames_num)) {
+      BakeState state;
+      state.items_by_id.add_new(0, std::make_unique<StringBakeItem>(frame_value(i)));
+      DiskBlobWriter blob_writer{blobs_dir_, "frame_" + std::to_string(i)};
+      std::ostringstream meta;
+      serialize_bake(state, blob_writer, blob_sharing, meta);
+      meta_contents_.append(meta.str());
+
+      char meta_path[FILE_MAX];
+      BLI_path_join(meta_path,
+                    sizeof(meta_path),
+                    blobs_dir_.c_str(),
+                    ("frame_" + std::to_string(i) + ".json").c_str());
+      FILE *file = BLI_fopen(meta_path, "wb");
+      fwrite(meta_contents_.last().data(), 1, meta_contents_.last().size(), file);
+      fclose(file);
+      meta_paths_.append(meta_path);
+
+      auto frame_cache = std::make_unique<FrameCache>();
+      frame_cache->frame = SubFrame(i);
+      frame_cache->meta_path = meta_path;
+      frames_.append(std::move(frame_cache));
+    }
+  }
+
+  void TearDown() override
+  {
+    BKE_tempdir_session_purge();
+  }
+
+  static std::string frame_value(const int frame_index)
+  {
+    return "frame " + std::to_string(frame_index);
+  }
+
+  static std::string loaded_value(const std::optional<BakeState> &state)
+  {
+    if (!state) {
+      return "";
+    }
+    const std::unique_ptr<BakeItem> *item = state->items_by_id.lookup_ptr(0);
+    if (!item) {
+      return "";
+    }
+    const StringBakeItem *string_item = dynamic_cast<const StringBakeItem *>(item->get());
+    return string_item ? std::string(string_item->value()) : "";
+  }
+
+#ifndef _WIN32
+  /**
+   * Replace the meta file of the frame with a pipe, so that loading it blocks until
+   * #write_blocked_frame provides the data.
+   */
+  void block_frame(const int frame_index)
+  {
+    const char *meta_path = meta_paths_[frame_index].c_str();
+    BLI_delete(meta_path, false, false);
+    ASSERT_EQ(mkfifo(meta_path, 0600), 0);
+  }
+
+  /** Wait until a worker thread started loading the blocked frame and return the pipe. */
+  FILE *open_blocked_frame(const int frame_index)
+  {
+    return BLI_fopen(meta_paths_[frame_index].c_str(), "wb");
+  }
+
+  void write_blocked_frame(FILE *pipe, const int frame_index)
+  {
+    const std::string &contents = meta_contents_[frame_index];
+    fwrite(contents.data(), 1, contents.size(), pipe);
+    fflush(pipe);
+  }
+#endif
+};
+
+TEST_F(BakeFramePrefetchTest, hits_and_misses)
+{
+  BlobReadSharing blob_sharing;
+  FramePrefetcher prefetcher{blobs_dir_, blob_sharing};
+
+  /* Nothing is prefetched yet. */
+  EXPECT_EQ(loaded_value(prefetcher.load(*frames_[0], 0)), frame_value(0));
+  EXPECT_EQ(prefetcher.stats().misses, 1);
+
+  /* Frames after the current frame are loaded in advance. */
+  prefetcher.prefetch(frames_, frames_[0]->frame);
+  prefetcher.wait_for_prefetch();
+  for (const int i : IndexRange(1, 4)) {
+    EXPECT_EQ(loaded_value(prefetcher.load(*frames_[i], i)), frame_value(i));
+  }
+  EXPECT_EQ(prefetcher.stats().hits, 4);
+  EXPECT_EQ(prefetcher.stats().misses, 1);
+
+  /* Going backwards prefetches the frames before the current frame. */
+  prefetcher.prefetch(frames_, frames_[7]->frame);
+  prefetcher.prefetch(frames_, frames_[6]->frame);
+  prefetcher.wait_for_prefetch();
+  EXPECT_EQ(loaded_value(prefetcher.load(*frames_[5], 5)), frame_value(5));
+  EXPECT_EQ(prefetcher.stats().hits, 5);
+
+  /* Prefetched frames are only used once, requesting the frame again loads it when needed. */
+  EXPECT_EQ(loaded_value(prefetcher.load(*frames_[5], 5)), frame_value(5));
+  EXPECT_EQ(prefetcher.stats().hits, 5);
+  EXPECT_EQ(prefetcher.stats().waits, 0);
+  EXPECT_EQ(prefetcher.stats().misses, 2);
+}
+
+#ifndef _WIN32
+TEST_F(BakeFramePrefetchTest, wait_for_frame_in_flight)
+{
+  block_frame(1);
+  BlobReadSharing blob_sharing;
+  FramePrefetcher prefetcher{blobs_dir_, blob_sharing};
+  prefetcher.prefetch(frames_, frames_[0]->frame);
+
+  FILE *pipe = open_blocked_frame(1);
+  ASSERT_NE(pipe, nullptr);
+  std::thread writer([&]() {
+    /* Give the main thread time to request the frame while it's still loading. */
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    write_blocked_frame(pipe, 1);
+    fclose(pipe);
+  });
+  EXPECT_EQ(loaded_value(prefetcher.load(*frames_[1], 1)), frame_value(1));
+  writer.join();
+
+  EXPECT_EQ(prefetcher.stats().hits, 0);
+  EXPECT_EQ(prefetcher.stats().waits, 1);
+  EXPECT_EQ(prefetcher.stats().misses, 0);
+}
+
+/**
+ * Freeing the bake cache while a frame is loaded waits for the load, before the blob sharing the
+ * loading thread uses is freed.
+ */
+TEST_F(BakeFramePrefetchTest, free_with_frame_in_flight)
+{
+  block_frame(1);
+  NodeBakeCache bake_cache;
+  bake_cache.blobs_dir = blobs_dir_;
+  bake_cache.blob_sharing = std::make_unique<BlobReadSharing>();
+  bake_cache.prefetcher = std::make_unique<FramePrefetcher>(*bake_cache.blobs_dir,
+                                                            *bake_cache.blob_sharing);
+  for (std::unique_ptr<FrameCache> &frame_cache : frames_) {
+    bake_cache.frames.append(std::move(frame_cache));
+  }
+  bake_cache.prefetcher->prefetch(bake_cache.frames, bake_cache.frames[0]->frame);
+
+  FILE *pipe = open_blocked_frame(1);
+  ASSERT_NE(pipe, nullptr);
+  std::atomic<bool> written = false;
+  std::thread writer([&]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    write_blocked_frame(pipe, 1);
+    /* The load can only finish once the pipe is closed. */
+    written = true;
+    fclose(pipe);
+  });
+  bake_cache.reset();
+  EXPECT_TRUE(written);
+  writer.join();
+  EXPECT_EQ(bake_cache.prefetcher, nullptr);
+}
+#endif
+
+}  // namespace blender::bke::bake::tests
@@ -2,6 +2,7 @@
  *
  * SPDX-License-Identifier: GPL-2.0-or-later */
 
+#include "BKE_bake_blob_codec.hh"
 #include "BKE_bake_items.hh"
 #include "BKE_bake_items_serialize.hh"
 #include "BKE_curves.hh"
@@ -15,7 +16,9 @@
 
 #include "BLI_endian_defines.h"
 #include "BLI_endian_switch.h"
+#include "BLI_fileops.h"
 #include "BLI_math_matrix_types.hh"
+#include "BLI_mmap.h"
 #include "BLI_path_util.h"
 
 #include "DNA_material_types.h"
@@ -24,10 +27,18 @@
 #include "RNA_access.hh"
 #include "RNA_enum_types.hh"
 
+#include <array>
+#include <fcntl.h>
 #include <fmt/format.h>
 #include <sstream>
 #include <xxhash.h>
 
+#ifndef WIN32
+#  include <unistd.h> /* For close. */
+#else
+#  include <io.h>
+#endif
+
 #ifdef WITH_OPENVDB
 #  include <openvdb/io/Stream.h>
 #  include <openvdb/openvdb.h>
@@ -85,6 +96,70 @@ bool BlobReader::read_as_stream(const BlobSlice &slice, FunctionRef<bool(std::is
   return true;
 }
 
+std::optional<ImplicitSharingInfoAndData> BlobReader::read_mapped(
+    const BlobSlice & /*slice*/, const int64_t /*alignment*/) const
+{
+  return std::nullopt;
+}
+
+/**
+ * A blob file that is mapped into memory. The file is mapped copy-on-write, so that the data can
+ * be used directly in attributes that may be modified later on.
+ */
+class MappedBlobFile : NonCopyable, NonMovable {
+ private:
+  BLI_mmap_file *mmap_file_;
+
+ public:
+  MappedBlobFile(BLI_mmap_file *mmap_file) : mmap_file_(mmap_file) {}
+
+  ~MappedBlobFile()
+  {
+    BLI_mmap_free(mmap_file_);
+  }
+
+  static std::shared_ptr<MappedBlobFile> open(const char *path)
+  {
+    const int file = BLI_open(path, O_BINARY | O_RDONLY, 0);
+    if (file == -1) {
+      return {};
+    }
+    BLI_mmap_file *mmap_file = BLI_mmap_open_copy_on_write(file);
+    close(file);
+    if (!mmap_file) {
+      return {};
+    }
+    return std::make_shared<MappedBlobFile>(mmap_file);
+  }
+
+  Span<char> data() const
+  {
+    return {static_cast<const char *>(BLI_mmap_get_pointer(mmap_file_)),
+            int64_t(BLI_mmap_get_length(mmap_file_))};
+  }
+
+  /** True when reading from the mapped memory failed, it then only contains zeros. */
+  bool has_io_error() const
+  {
+    return BLI_mmap_any_io_error(mmap_file_);
+  }
+};
+
+/** Owns a slice of a mapped blob file that is used as data of e.g. an attribute. */
+class MappedBlobSharingInfo : public ImplicitSharingInfo {
+ private:
+  std::shared_ptr<MappedBlobFile> file_;
+
+ public:
+  MappedBlobSharingInfo(std::shared_ptr<MappedBlobFile> file) : file_(std::move(file)) {}
+
+ private:
+  void delete_self_with_data() override
+  {
+    MEM_delete(this);
+  }
+};
+
 DiskBlobReader::DiskBlobReader(std::string blobs_dir) : blobs_dir_(std::move(blobs_dir)) {}
 
 [[nodiscard]] bool DiskBlobReader::read(const BlobSlice &slice, void *r_data) const
@@ -108,6 +183,54 @@ DiskBlobReader::DiskBlobReader(std::string blobs_dir) : blobs_dir_(std::move(blo
   return true;
 }
 
+std::optional<ImplicitSharingInfoAndData> DiskBlobReader::read_mapped(
+    const BlobSlice &slice, const int64_t alignment) const
+{
+  /* Mapping small slices is not worth it, and unaligned slices would share pages with other data.
+   * Those are typically written by older versions. */
+  if (slice.range.size() < mapped_blob_min_size) {
+    return std::nullopt;
+  }
+  if (slice.range.start() % std::max(mapped_blob_alignment, alignment) != 0) {
+    return std::nullopt;
+  }
+#ifdef _WIN32
+  /* Files that are mapped can't be deleted on Windows. Mapped data may be kept alive by evaluated
+   * geometry for an arbitrary time, which would break deleting and re-baking. */
+  return std::nullopt;
+#else
+
+  char blob_path[FILE_MAX];
+  BLI_path_join(blob_path, sizeof(blob_path), blobs_dir_.c_str(), slice.name.c_str());
+
+  std::shared_ptr<MappedBlobFile> file;
+  {
+    std::lock_guard lock{mutex_};
+    file = mapped_files_.lookup_or_add_cb_as(blob_path,
+                                             [&]() { return MappedBlobFile::open(blob_path); });
+  }
+  if (!file) {
+    return std::nullopt;
+  }
+  const Span<char> file_data = file->data();
+  if (slice.range.one_after_last() > file_data.size()) {
+    return std::nullopt;
+  }
+  const Span<char> data = file_data.slice(slice.range);
+  /* Read every page of the slice once, so that IO errors are detected now and not when the data
+   * is used later. On failure, the data is read with #read instead, which reports the error. */
+  const volatile char *pages = data.data();
+  for (int64_t i = 0; i < data.size(); i += mapped_blob_alignment) {
+    (void)pages[i];
+  }
+  if (file->has_io_error()) {
+    return std::nullopt;
+  }
+  return ImplicitSharingInfoAndData{MEM_new<MappedBlobSharingInfo>(__func__, std::move(file)),
+                                    data.data()};
+#endif
+}
+
 DiskBlobWriter::DiskBlobWriter(std::string blob_dir, std::string base_name)
     : blob_dir_(std::move(blob_dir)), base_name_(std::move(base_name))
 {
@@ -123,6 +246,15 @@ BlobSlice DiskBlobWriter::write(const void *data, const int64_t size)
     blob_stream_.open(blob_path, std::ios::out | std::ios::binary);
   }
 
+  if (size >= mapped_blob_min_size) {
+    /* Align large blobs so that they can be memory-mapped when reading. */
+    const int64_t padding = (mapped_blob_alignment - current_offset_ % mapped_blob_alignment) %
+                            mapped_blob_alignment;
+    const std::array<char, mapped_blob_alignment> zeros{};
+    blob_stream_.write(zeros.data(), padding);
+    current_offset_ += padding;
+  }
+
   const int64_t old_offset = current_offset_;
   blob_stream_.write(static_cast<const char *>(data), size);
   current_offset_ += size;
@@ -199,6 +331,15 @@ std::shared_ptr<io::serialize::DictionaryValue> BlobWriteSharing::write_deduplic
   return slice.serialize();
 }
 
+std::shared_ptr<io::serialize::DictionaryValue> BlobWriteSharing::write_deduplicated(
+    const GSpan data, FunctionRef<std::shared_ptr<io::serialize::DictionaryValue>()> write_fn)
+{
+  /* The element size is part of the hash, because the stored data depends on it. */
+  const uint64_t content_hash = XXH3_64bits_withSeed(
+      data.data(), data.size_in_bytes(), uint64_t(data.type().size()));
+  return io_data_by_content_hash_.lookup_or_add_cb(content_hash, write_fn);
+}
+
 std::optional<ImplicitSharingInfoAndData> BlobReadSharing::read_shared(
     const DictionaryValue &io_data,
     FunctionRef<std::optional<ImplicitSharingInfoAndData>()> read_fn) const
@@ -282,6 +423,36 @@ static std::shared_ptr<DictionaryValue> write_blob_raw_data_with_endian(
   return io_data;
 }
 
+/**
+ * Perform an endian switch on the read data if it was written on a machine with a different
+ * endianness.
+ */
+[[nodiscard]] static bool switch_endian_if_necessary(const DictionaryValue &io_data,
+                                                     const int64_t element_size,
+                                                     const int64_t elements_num,
+                                                     void *r_data)
+{
+  const StringRefNull stored_endian = io_data.lookup_str("endian").value_or("little");
+  const StringRefNull current_endian = get_endian_io_name(ENDIAN_ORDER);
+  if (stored_endian == current_endian) {
+    return true;
+  }
+  switch (element_size) {
+    case 1:
+      return true;
+    case 2:
+      BLI_endian_switch_uint16_array(static_cast<uint16_t *>(r_data), elements_num);
+      return true;
+    case 4:
+      BLI_endian_switch_uint32_array(static_cast<uint32_t *>(r_data), elements_num);
+      return true;
+    case 8:
+      BLI_endian_switch_uint64_array(static_cast<uint64_t *>(r_data), elements_num);
+      return true;
+  }
+  return false;
+}
+
 /**
  * Read data of an into an array and optionally perform an endian switch if necessary.
  */
@@ -301,27 +472,7 @@ static std::shared_ptr<DictionaryValue> write_blob_raw_data_with_endian(
   if (!blob_reader.read(*slice, r_data)) {
     return false;
   }
-  const StringRefNull stored_endian = io_data.lookup_str("endian").value_or("little");
-  const StringRefNull current_endian = get_endian_io_name(ENDIAN_ORDER);
-  const bool need_endian_switch = stored_endian != current_endian;
-  if (need_endian_switch) {
-    switch (element_size) {
-      case 1:
-        break;
-      case 2:
-        BLI_endian_switch_uint16_array(static_cast<uint16_t *>(r_data), elements_num);
-        break;
-      case 4:
-        BLI_endian_switch_uint32_array(static_cast<uint32_t *>(r_data), elements_num);
-        break;
-      case 8:
-        BLI_endian_switch_uint64_array(static_cast<uint64_t *>(r_data), elements_num);
-        break;
-      default:
-        return false;
-    }
-  }
-  return true;
+  return switch_endian_if_necessary(io_data, element_size, elements_num, r_data);
 }
 
 /** Write bytes ignoring endianness. */
@@ -349,12 +500,107 @@ static std::shared_ptr<DictionaryValue> write_blob_raw_bytes(BlobWriter &blob_wr
   return blob_reader.read(*slice, r_data);
 }
 
+/** Smaller arrays are always stored uncompressed, because compressing them is not worth it. */
+static constexpr int64_t compressed_blob_min_size = 1024;
+
+/**
+ * Compress and write the array. The compressed chunk sizes are stored next to the #BlobSlice, so
+ * that all chunks can be decompressed in parallel when loading.
+ * \return None if compression fails or does not reduce the size of the data.
+ */
+static std::optional<std::shared_ptr<DictionaryValue>> write_blob_compressed_simple_gspan(
+    BlobWriter &blob_writer, BlobWriteSharing &blob_sharing, const GSpan data)
+{
+  const std::optional<BlobCodec> codec = blob_codec_for_type(data.type());
+  if (!codec) {
+    return std::nullopt;
+  }
+  std::shared_ptr<DictionaryValue> io_data = blob_sharing.write_deduplicated(
+      data, [&]() -> std::shared_ptr<DictionaryValue> {
+        const std::optional<CompressedBlob> compressed_opt = compress_blob(*codec, data);
+        if (!compressed_opt) {
+          return {};
+        }
+        const CompressedBlob &compressed = *compressed_opt;
+        if (compressed.data.size() >= data.size_in_bytes()) {
+          return {};
+        }
+        const BlobSlice slice = blob_writer.write(compressed.data.data(), compressed.data.size());
+        auto io_data = slice.serialize();
+        io_data->append_str("codec", blob_codec_io_name(*codec));
+        io_data->append_int("chunk_size", compressed.chunk_size);
+        auto io_chunks = io_data->append_array("chunks");
+        for (const int64_t chunk_size : compressed.chunk_sizes) {
+          io_chunks->append_int(int(chunk_size));
+        }
+        if (*codec != BlobCodec::Zstd && ENDIAN_ORDER == B_ENDIAN) {
+          io_data->append_str("endian", get_endian_io_name(ENDIAN_ORDER));
+        }
+        return io_data;
+      });
+  if (!io_data) {
+    return std::nullopt;
+  }
+  return io_data;
+}
+
+/**
+ * Read an array that has been written by #write_blob_compressed_simple_gspan.
+ */
+[[nodiscard]] static bool read_blob_compressed_simple_gspan(const BlobReader &blob_reader,
+                                                            const DictionaryValue &io_data,
+                                                            GMutableSpan r_data)
+{
+  const std::optional<BlobSlice> slice = BlobSlice::deserialize(io_data);
+  const std::optional<BlobCodec> codec = blob_codec_from_io_name(
+      io_data.lookup_str("codec").value_or(""));
+  const std::optional<int64_t> chunk_size = io_data.lookup_int("chunk_size");
+  const ArrayValue *io_chunks = io_data.lookup_array("chunks");
+  if (!slice || !codec || !chunk_size || !io_chunks) {
+    return false;
+  }
+  Vector<int64_t> chunk_sizes;
+  for (const auto &io_chunk : io_chunks->elements()) {
+    const IntValue *io_chunk_size = io_chunk->as_int_value();
+    if (!io_chunk_size) {
+      return false;
+    }
+    chunk_sizes.append(io_chunk_size->value());
+  }
+  const StringRefNull stored_endian = io_data.lookup_str("endian").value_or("little");
+  if (*codec == BlobCodec::DeltaZstd && stored_endian != get_endian_io_name(ENDIAN_ORDER)) {
+    /* Deltas are computed on integers with the byte order of the machine that wrote them. */
+    return false;
+  }
+
+  Array<char> compressed_data(slice->range.size(), NoInitialization());
+  if (!blob_reader.read(*slice, compressed_data.data())) {
+    return false;
+  }
+  if (!decompress_blob(*codec, compressed_data, *chunk_size, chunk_sizes, r_data)) {
+    return false;
+  }
+  if (*codec == BlobCodec::Zstd) {
+    return true;
+  }
+  /* All types that are compressed with the other codecs consist of 32-bit components. */
+  return switch_endian_if_necessary(
+      io_data, sizeof(uint32_t), r_data.size_in_bytes() / sizeof(uint32_t), r_data.data());
+}
+
 static std::shared_ptr<DictionaryValue> write_blob_simple_gspan(BlobWriter &blob_writer,
                                                                 BlobWriteSharing &blob_sharing,
                                                                 const GSpan data)
 {
   const CPPType &type = data.type();
   BLI_assert(type.is_trivial());
+  if (blob_writer.compress_arrays() && data.size_in_bytes() >= compressed_blob_min_size) {
+    if (std::optional<std::shared_ptr<DictionaryValue>> io_data =
+            write_blob_compressed_simple_gspan(blob_writer, blob_sharing, data))
+    {
+      return *io_data;
+    }
+  }
   if (type.size() == 1 || type.is<ColorGeometry4b>()) {
     return write_blob_raw_bytes(blob_writer, blob_sharing, data.data(), data.size_in_bytes());
   }
@@ -368,6 +614,9 @@ static std::shared_ptr<DictionaryValue> write_blob_simple_gspan(BlobWriter &blob
 {
   const CPPType &type = r_data.type();
   BLI_assert(type.is_trivial());
+  if (io_data.lookup("codec")) {
+    return read_blob_compressed_simple_gspan(blob_reader, io_data, r_data);
+  }
   if (type.size() == 1 || type.is<ColorGeometry4b>()) {
     return read_blob_raw_bytes(blob_reader, io_data, r_data.size_in_bytes(), r_data.data());
   }
@@ -408,6 +657,36 @@ static std::shared_ptr<DictionaryValue> write_blob_shared_simple_gspan(
       sharing_info, [&]() { return write_blob_simple_gspan(blob_writer, blob_sharing, data); });
 }
 
+/**
+ * Access the stored array directly without copying it, if the #BlobReader supports that. This is
+ * only possible when the data does not have to be converted or decompressed.
+ */
+static std::optional<ImplicitSharingInfoAndData> read_blob_mapped_simple_gspan(
+    const BlobReader &blob_reader,
+    const DictionaryValue &io_data,
+    const CPPType &cpp_type,
+    const int64_t size)
+{
+  if (io_data.lookup("codec")) {
+    return std::nullopt;
+  }
+  const std::optional<BlobSlice> slice = BlobSlice::deserialize(io_data);
+  if (!slice) {
+    return std::nullopt;
+  }
+  if (slice->range.size() != cpp_type.size() * size) {
+    return std::nullopt;
+  }
+  const bool is_bytes = cpp_type.size() == 1 || cpp_type.is<ColorGeometry4b>();
+  if (!is_bytes) {
+    const StringRefNull stored_endian = io_data.lookup_str("endian").value_or("little");
+    if (stored_endian != get_endian_io_name(ENDIAN_ORDER)) {
+      return std::nullopt;
+    }
+  }
+  return blob_reader.read_mapped(*slice, cpp_type.alignment());
+}
+
 [[nodiscard]] static const void *read_blob_shared_simple_gspan(
     const DictionaryValue &io_data,
     const BlobReader &blob_reader,
@@ -419,6 +698,11 @@ static std::shared_ptr<DictionaryValue> write_blob_shared_simple_gspan(
   const char *func = __func__;
   const std::optional<ImplicitSharingInfoAndData> sharing_info_and_data = blob_sharing.read_shared(
       io_data, [&]() -> std::optional<ImplicitSharingInfoAndData> {
+        if (std::optional<ImplicitSharingInfoAndData> mapped = read_blob_mapped_simple_gspan(
+                blob_reader, io_data, cpp_type, size))
+        {
+          return mapped;
+        }
         void *data_mem = MEM_mallocN_aligned(size * cpp_type.size(), cpp_type.alignment(), func);
         if (!read_blob_simple_gspan(blob_reader, io_data, {cpp_type, data_mem, size})) {
           MEM_freeN(data_mem);
@@ -0,0 +1,113 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "testing/testing.h"
+
+#include "BKE_appdir.hh"
+#include "BKE_bake_items_serialize.hh"
+
+#include "BLI_array.hh"
+#include "BLI_fileops.h"
+#include "BLI_path_util.h"
+
+#ifndef _WIN32
+#  include <unistd.h>
+#endif
+
+namespace blender::bke::bake::tests {
+
+class BakeBlobTest : public testing::Test {
+ protected:
+  void SetUp() override
+  {
+    BKE_tempdir_init(nullptr);
+  }
+
+  void TearDown() override
+  {
+    BKE_tempdir_session_purge();
+  }
+};
+
+TEST_F(BakeBlobTest, mapped_blobs)
+{
+  const std::string blobs_dir = BKE_tempdir_session();
+  Array<int> small_values(100);
+  Array<float> large_values(100'000);
+  for (const int i : small_values.index_range()) {
+    small_values[i] = i;
+  }
+  for (const int i : large_values.index_range()) {
+    large_values[i] = float(i) * 0.5f;
+  }
+
+  BlobSlice small_slice;
+  BlobSlice large_slice;
+  {
+    DiskBlobWriter writer{blobs_dir, "frame"};
+    small_slice = writer.write(small_values.data(), small_values.as_span().size_in_bytes());
+    large_slice = writer.write(large_values.data(), large_values.as_span().size_in_bytes());
+  }
+  EXPECT_EQ(large_slice.range.start() % mapped_blob_alignment, 0);
+
+  DiskBlobReader reader{blobs_dir};
+  EXPECT_FALSE(reader.read_mapped(small_slice, alignof(int)).has_value());
+  Array<int> small_read(small_values.size());
+  EXPECT_TRUE(reader.read(small_slice, small_read.data()));
+  EXPECT_EQ(small_read.as_span(), small_values.as_span());
+
+  std::optional<ImplicitSharingInfoAndData> mapped = reader.read_mapped(large_slice,
+                                                                        alignof(float));
+#ifdef _WIN32
+  /* Blob files are not mapped on Windows. */
+  EXPECT_FALSE(mapped.has_value());
+#else
+  ASSERT_TRUE(mapped.has_value());
+  const Span<float> mapped_values(static_cast<const float *>(mapped->data), large_values.size());
+  EXPECT_EQ(mapped_values, large_values.as_span());
+
+  /* Changing the mapped data does not change the stored blob. */
+  EXPECT_TRUE(mapped->sharing_info->is_mutable());
+  const_cast<float *>(mapped_values.data())[0] = -1.0f;
+  Array<float> large_read(large_values.size());
+  EXPECT_TRUE(reader.read(large_slice, large_read.data()));
+  EXPECT_EQ(large_read[0], 0.0f);
+
+  mapped->sharing_info->remove_user_and_delete_if_last();
+#endif
+}
+
+#ifndef _WIN32
+TEST_F(BakeBlobTest, mapped_blob_io_error)
+{
+  const std::string blobs_dir = BKE_tempdir_session();
+  Array<float> values(100'000, 1.0f);
+
+  BlobSlice first_slice;
+  BlobSlice second_slice;
+  {
+    DiskBlobWriter writer{blobs_dir, "frame"};
+    first_slice = writer.write(values.data(), values.as_span().size_in_bytes());
+    second_slice = writer.write(values.data(), values.as_span().size_in_bytes());
+  }
+
+  DiskBlobReader reader{blobs_dir};
+  std::optional<ImplicitSharingInfoAndData> mapped = reader.read_mapped(first_slice,
+                                                                        alignof(float));
+  ASSERT_TRUE(mapped.has_value());
+
+  /* Accessing the mapped memory past the end of the truncated file fails. The slice is then not
+   * mapped, and reading it reports the error. */
+  char blob_path[FILE_MAX];
+  BLI_path_join(blob_path, sizeof(blob_path), blobs_dir.c_str(), second_slice.name.c_str());
+  ASSERT_EQ(truncate(blob_path, first_slice.range.one_after_last()), 0);
+  EXPECT_FALSE(reader.read_mapped(second_slice, alignof(float)).has_value());
+  Array<float> second_read(values.size());
+  EXPECT_FALSE(reader.read(second_slice, second_read.data()));
+
+  mapped->sharing_info->remove_user_and_delete_if_last();
+}
+#endif
+
+}  // namespace blender::bke::bake::tests
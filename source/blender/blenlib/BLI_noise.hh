@@ -6,6 +6,7 @@
 
 #include "BLI_math_matrix_types.hh"
 #include "BLI_math_vector_types.hh"
+#include "BLI_span.hh"
 
 namespace blender::noise {
 
@@ -133,6 +134,36 @@ float3 perlin_float3_fractal_distorted(float4 position,
                                        int type,
                                        bool normalize);
 
+/* Batched versions of the functions above that evaluate many positions at once. They give the
+ * same results, but are faster because the noise is computed for multiple positions in parallel
+ * using SIMD instructions where available. */
+
+template<typename T> void perlin_signed(Span<T> positions, MutableSpan<float> r_values);
+
+template<typename T>
+void perlin_fractal_distorted(Span<T> positions,
+                              float detail,
+                              float roughness,
+                              float lacunarity,
+                              float offset,
+                              float gain,
+                              float distortion,
+                              int type,
+                              bool normalize,
+                              MutableSpan<float> r_values);
+
+template<typename T>
+void perlin_float3_fractal_distorted(Span<T> positions,
+                                     float detail,
+                                     float roughness,
+                                     float lacunarity,
+                                     float offset,
+                                     float gain,
+                                     float distortion,
+                                     int type,
+                                     bool normalize,
+                                     MutableSpan<float3> r_values);
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -11,6 +11,7 @@
 
 #include "BLI_filereader.h"
 #include "BLI_math_base.h"
+#include "BLI_task.h"
 
 #ifdef __BIG_ENDIAN__
 #  include "BLI_endian_switch.h"
@@ -18,6 +19,19 @@
 
 #include "MEM_guardedalloc.h"
 
+/** Number of decompressed frames of seekable files that are kept in memory. */
+#define ZSTD_CACHED_FRAMES_NUM 16
+/** Maximum number of frames that are decompressed at once when reading sequentially. */
+#define ZSTD_READAHEAD_FRAMES_NUM 8
+
+typedef struct ZstdCachedFrame {
+  /** Index of the frame, -1 when the slot is unused. */
+  int frame;
+  char *content;
+  /** Value of the cache clock when the frame was last accessed, used for LRU eviction. */
+  uint64_t last_use;
+} ZstdCachedFrame;
+
 typedef struct {
   FileReader reader;
 
@@ -32,8 +46,10 @@ typedef struct {
     size_t *compressed_ofs;
     size_t *uncompressed_ofs;
 
-    char *cached_content;
-    int cached_frame;
+    ZstdCachedFrame cache[ZSTD_CACHED_FRAMES_NUM];
+    uint64_t cache_clock;
+    /** Last accessed frame, to detect sequential reading. */
+    int last_frame;
   } seek;
 } ZstdReader;
 
@@ -129,7 +145,10 @@ static bool zstd_read_seek_table(ZstdReader *zstd)
     return false;
   }
 
-  zstd->seek.cached_frame = -1;
+  for (int i = 0; i < ZSTD_CACHED_FRAMES_NUM; i++) {
+    zstd->seek.cache[i].frame = -1;
+  }
+  zstd->seek.last_frame = -1;
 
   return true;
 }
@@ -157,42 +176,142 @@ static int zstd_frame_from_pos(ZstdReader *zstd, size_t pos)
   return low;
 }
 
-/* Ensure that the currently loaded frame is the correct one. */
-static const char *zstd_ensure_cache(ZstdReader *zstd, int frame)
+static ZstdCachedFrame *zstd_cache_find(ZstdReader *zstd, int frame)
 {
-  if (zstd->seek.cached_frame == frame) {
-    /* Cached frame matches, so just return it. */
-    return zstd->seek.cached_content;
+  for (int i = 0; i < ZSTD_CACHED_FRAMES_NUM; i++) {
+    if (zstd->seek.cache[i].frame == frame) {
+      return &zstd->seek.cache[i];
+    }
   }
+  return NULL;
+}
 
-  /* Cached frame doesn't match, so discard it and cache the wanted one instead. */
-  MEM_SAFE_FREE(zstd->seek.cached_content);
+/* Free the least recently used slot of the cache and assign it to the given frame. */
+static ZstdCachedFrame *zstd_cache_add(ZstdReader *zstd, int frame)
+{
+  ZstdCachedFrame *slot = &zstd->seek.cache[0];
+  for (int i = 1; i < ZSTD_CACHED_FRAMES_NUM; i++) {
+    if (zstd->seek.cache[i].last_use < slot->last_use) {
+      slot = &zstd->seek.cache[i];
+    }
+  }
+  MEM_SAFE_FREE(slot->content);
 
+  size_t uncompressed_size = zstd->seek.uncompressed_ofs[frame + 1] -
+                             zstd->seek.uncompressed_ofs[frame];
+  slot->frame = frame;
+  slot->content = MEM_mallocN(uncompressed_size, __func__);
+  slot->last_use = ++zstd->seek.cache_clock;
+  return slot;
+}
+
+/* Decompress a frame into its cache slot. On failure, the slot is cleared. */
+static void zstd_decompress_frame(ZstdReader *zstd,
+                                  ZSTD_DCtx *ctx,
+                                  ZstdCachedFrame *slot,
+                                  const char *compressed_data)
+{
+  const int frame = slot->frame;
   size_t compressed_size = zstd->seek.compressed_ofs[frame + 1] - zstd->seek.compressed_ofs[frame];
   size_t uncompressed_size = zstd->seek.uncompressed_ofs[frame + 1] -
                              zstd->seek.uncompressed_ofs[frame];
 
-  char *uncompressed_data = MEM_mallocN(uncompressed_size, __func__);
+  size_t res = ZSTD_decompressDCtx(
+      ctx, slot->content, uncompressed_size, compressed_data, compressed_size);
+  if (ZSTD_isError(res) || res < uncompressed_size) {
+    MEM_freeN(slot->content);
+    slot->content = NULL;
+    slot->frame = -1;
+  }
+}
+
+typedef struct ZstdDecompressData {
+  ZstdReader *zstd;
+  /** Compressed data of all frames, starting at the first frame. */
+  const char *compressed_data;
+  ZstdCachedFrame *slots[ZSTD_READAHEAD_FRAMES_NUM];
+} ZstdDecompressData;
+
+static void zstd_decompress_frame_task(void *__restrict userdata,
+                                       const int i,
+                                       const TaskParallelTLS *__restrict tls)
+{
+  ZstdDecompressData *data = userdata;
+  ZstdReader *zstd = data->zstd;
+  ZSTD_DCtx **ctx = tls->userdata_chunk;
+  if (*ctx == NULL) {
+    *ctx = ZSTD_createDCtx();
+  }
+  const int first_frame = data->slots[0]->frame;
+  const size_t offset = zstd->seek.compressed_ofs[first_frame + i] -
+                        zstd->seek.compressed_ofs[first_frame];
+  zstd_decompress_frame(zstd, *ctx, data->slots[i], data->compressed_data + offset);
+}
+
+static void zstd_decompress_frame_task_free(const void *__restrict UNUSED(userdata),
+                                            void *__restrict chunk)
+{
+  ZSTD_DCtx **ctx = chunk;
+  if (*ctx != NULL) {
+    ZSTD_freeDCtx(*ctx);
+  }
+}
+
+/* Ensure that the given frame is cached. When reading sequentially, the following frames are
+ * decompressed along with it in parallel, so that the whole file is not decompressed on a single
+ * thread. Random access only decompresses the frames that are actually needed. */
+static const char *zstd_ensure_cache(ZstdReader *zstd, int frame)
+{
+  const bool is_sequential = (frame == zstd->seek.last_frame + 1);
+  zstd->seek.last_frame = frame;
+
+  ZstdCachedFrame *cached = zstd_cache_find(zstd, frame);
+  if (cached != NULL) {
+    cached->last_use = ++zstd->seek.cache_clock;
+    return cached->content;
+  }
+
+  int frames_num = 1;
+  if (is_sequential) {
+    const int readahead_num = min_iii(ZSTD_READAHEAD_FRAMES_NUM,
+                                      BLI_task_scheduler_num_threads(),
+                                      zstd->seek.frames_num - frame);
+    while (frames_num < readahead_num && zstd_cache_find(zstd, frame + frames_num) == NULL) {
+      frames_num++;
+    }
+  }
+
+  /* The frames are stored contiguously, so read them all at once. */
+  size_t compressed_size = zstd->seek.compressed_ofs[frame + frames_num] -
+                           zstd->seek.compressed_ofs[frame];
   char *compressed_data = MEM_mallocN(compressed_size, __func__);
   if (zstd->base->seek(zstd->base, zstd->seek.compressed_ofs[frame], SEEK_SET) < 0 ||
       zstd->base->read(zstd->base, compressed_data, compressed_size) < compressed_size)
   {
     MEM_freeN(compressed_data);
-    MEM_freeN(uncompressed_data);
     return NULL;
   }
 
-  size_t res = ZSTD_decompressDCtx(
-      zstd->ctx, uncompressed_data, uncompressed_size, compressed_data, compressed_size);
-  MEM_freeN(compressed_data);
-  if (ZSTD_isError(res) || res < uncompressed_size) {
-    MEM_freeN(uncompressed_data);
-    return NULL;
+  ZstdDecompressData data = {zstd, compressed_data};
+  for (int i = 0; i < frames_num; i++) {
+    data.slots[i] = zstd_cache_add(zstd, frame + i);
   }
 
-  zstd->seek.cached_frame = frame;
-  zstd->seek.cached_content = uncompressed_data;
-  return uncompressed_data;
+  if (frames_num == 1) {
+    zstd_decompress_frame(zstd, zstd->ctx, data.slots[0], compressed_data);
+  }
+  else {
+    ZSTD_DCtx *ctx = NULL;
+    TaskParallelSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.userdata_chunk = &ctx;
+    settings.userdata_chunk_size = sizeof(ctx);
+    settings.func_free = zstd_decompress_frame_task_free;
+    BLI_task_parallel_range(0, frames_num, &data, zstd_decompress_frame_task, &settings);
+  }
+  MEM_freeN(compressed_data);
+
+  return data.slots[0]->content;
 }
 
 static int64_t zstd_read_seekable(FileReader *reader, void *buffer, size_t size)
@@ -285,9 +404,9 @@ static void zstd_close(FileReader *reader)
   if (zstd->reader.seek) {
     MEM_freeN(zstd->seek.uncompressed_ofs);
     MEM_freeN(zstd->seek.compressed_ofs);
-    /* When an error has occurred this may be NULL, see: #99744. */
-    if (zstd->seek.cached_content) {
-      MEM_freeN(zstd->seek.cached_content);
+    for (int i = 0; i < ZSTD_CACHED_FRAMES_NUM; i++) {
+      /* When an error has occurred this may be NULL, see: #99744. */
+      MEM_SAFE_FREE(zstd->seek.cache[i].content);
     }
   }
   else {
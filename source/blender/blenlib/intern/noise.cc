@@ -5,6 +5,7 @@
  * SPDX-License-Identifier: GPL-2.0-or-later AND BSD-3-Clause */
 
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <cstdint>
 
@@ -14,6 +15,7 @@
 #include "BLI_math_numbers.hh"
 #include "BLI_math_vector.hh"
 #include "BLI_noise.hh"
+#include "BLI_simd.hh"
 #include "BLI_utildefines.h"
 
 namespace blender::noise {
@@ -1009,6 +1011,618 @@ float3 perlin_float3_fractal_distorted(float4 position,
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Batched Perlin Noise
+ *
+ * Evaluates perlin noise for many positions at once. The octave loops of the fractal noise types
+ * run over all positions of a batch, so that the innermost noise evaluation can process multiple
+ * positions with SIMD instructions. The results are identical to the per-position functions.
+ * \{ */
+
+/** Number of positions that are processed together. Temporary buffers of that size are used. */
+static constexpr int64_t perlin_batch_size = 64;
+
+#if BLI_HAVE_SSE4
+
+template<int K> BLI_INLINE __m128i hash_bit_rotate_x4(const __m128i x)
+{
+  return _mm_or_si128(_mm_slli_epi32(x, K), _mm_srli_epi32(x, 32 - K));
+}
+
+BLI_INLINE void hash_bit_final_x4(__m128i &a, __m128i &b, __m128i &c)
+{
+  c = _mm_xor_si128(c, b);
+  c = _mm_sub_epi32(c, hash_bit_rotate_x4<14>(b));
+  a = _mm_xor_si128(a, c);
+  a = _mm_sub_epi32(a, hash_bit_rotate_x4<11>(c));
+  b = _mm_xor_si128(b, a);
+  b = _mm_sub_epi32(b, hash_bit_rotate_x4<25>(a));
+  c = _mm_xor_si128(c, b);
+  c = _mm_sub_epi32(c, hash_bit_rotate_x4<16>(b));
+  a = _mm_xor_si128(a, c);
+  a = _mm_sub_epi32(a, hash_bit_rotate_x4<4>(c));
+  b = _mm_xor_si128(b, a);
+  b = _mm_sub_epi32(b, hash_bit_rotate_x4<14>(a));
+  c = _mm_xor_si128(c, b);
+  c = _mm_sub_epi32(c, hash_bit_rotate_x4<24>(b));
+}
+
+BLI_INLINE __m128i hash_x4(const __m128i kx, const __m128i ky, const __m128i kz)
+{
+  const __m128i init = _mm_set1_epi32(int(0xdeadbeefu + (3u << 2) + 13u));
+  __m128i a = _mm_add_epi32(init, kx);
+  __m128i b = _mm_add_epi32(init, ky);
+  __m128i c = _mm_add_epi32(init, kz);
+  hash_bit_final_x4(a, b, c);
+  return c;
+}
+
+BLI_INLINE __m128d fade_x2(const __m128d t, const __m128d t_cubed)
+{
+  const __m128d t6 = _mm_sub_pd(_mm_mul_pd(t, _mm_set1_pd(6.0)), _mm_set1_pd(15.0));
+  return _mm_mul_pd(t_cubed, _mm_add_pd(_mm_mul_pd(t, t6), _mm_set1_pd(10.0)));
+}
+
+BLI_INLINE __m128 fade_x4(const __m128 t)
+{
+  /* Partially compute in double precision like #fade to get the same result. */
+  const __m128 t_cubed = _mm_mul_ps(_mm_mul_ps(t, t), t);
+  const __m128d low = fade_x2(_mm_cvtps_pd(t), _mm_cvtps_pd(t_cubed));
+  const __m128d high = fade_x2(_mm_cvtps_pd(_mm_movehl_ps(t, t)),
+                               _mm_cvtps_pd(_mm_movehl_ps(t_cubed, t_cubed)));
+  return _mm_movelh_ps(_mm_cvtpd_ps(low), _mm_cvtpd_ps(high));
+}
+
+BLI_INLINE __m128 noise_grad_x4(const __m128i hash, const __m128 x, const __m128 y, const __m128 z)
+{
+  const __m128i h = _mm_and_si128(hash, _mm_set1_epi32(15));
+  const __m128i h_lt_4 = _mm_cmplt_epi32(h, _mm_set1_epi32(4));
+  const __m128i h_lt_8 = _mm_cmplt_epi32(h, _mm_set1_epi32(8));
+  const __m128i h_12_or_14 = _mm_or_si128(_mm_cmpeq_epi32(h, _mm_set1_epi32(12)),
+                                          _mm_cmpeq_epi32(h, _mm_set1_epi32(14)));
+  const __m128 u = _mm_blendv_ps(y, x, _mm_castsi128_ps(h_lt_8));
+  const __m128 vt = _mm_blendv_ps(z, x, _mm_castsi128_ps(h_12_or_14));
+  const __m128 v = _mm_blendv_ps(vt, y, _mm_castsi128_ps(h_lt_4));
+  /* Negate by flipping the sign bit depending on the two lowest bits of the hash. */
+  const __m128 u_sign = _mm_castsi128_ps(_mm_slli_epi32(h, 31));
+  const __m128 v_sign = _mm_castsi128_ps(_mm_slli_epi32(_mm_srli_epi32(h, 1), 31));
+  return _mm_add_ps(_mm_xor_ps(u, u_sign), _mm_xor_ps(v, v_sign));
+}
+
+BLI_INLINE __m128 mix_x4(const __m128 v0,
+                         const __m128 v1,
+                         const __m128 v2,
+                         const __m128 v3,
+                         const __m128 v4,
+                         const __m128 v5,
+                         const __m128 v6,
+                         const __m128 v7,
+                         const __m128 x,
+                         const __m128 y,
+                         const __m128 z)
+{
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 x1 = _mm_sub_ps(one, x);
+  const __m128 y1 = _mm_sub_ps(one, y);
+  const __m128 z1 = _mm_sub_ps(one, z);
+  const auto mix_x = [&](const __m128 a, const __m128 b) {
+    return _mm_add_ps(_mm_mul_ps(a, x1), _mm_mul_ps(b, x));
+  };
+  const auto mix_y = [&](const __m128 a, const __m128 b) {
+    return _mm_add_ps(_mm_mul_ps(y1, a), _mm_mul_ps(y, b));
+  };
+  return _mm_add_ps(_mm_mul_ps(z1, mix_y(mix_x(v0, v1), mix_x(v2, v3))),
+                    _mm_mul_ps(z, mix_y(mix_x(v4, v5), mix_x(v6, v7))));
+}
+
+BLI_INLINE __m128 perlin_noise_x4(const __m128 x, const __m128 y, const __m128 z)
+{
+  const __m128 x_floor = _mm_floor_ps(x);
+  const __m128 y_floor = _mm_floor_ps(y);
+  const __m128 z_floor = _mm_floor_ps(z);
+  const __m128i X = _mm_cvttps_epi32(x_floor);
+  const __m128i Y = _mm_cvttps_epi32(y_floor);
+  const __m128i Z = _mm_cvttps_epi32(z_floor);
+  const __m128 fx = _mm_sub_ps(x, x_floor);
+  const __m128 fy = _mm_sub_ps(y, y_floor);
+  const __m128 fz = _mm_sub_ps(z, z_floor);
+
+  const __m128 u = fade_x4(fx);
+  const __m128 v = fade_x4(fy);
+  const __m128 w = fade_x4(fz);
+
+  const __m128i one_i = _mm_set1_epi32(1);
+  const __m128i X1 = _mm_add_epi32(X, one_i);
+  const __m128i Y1 = _mm_add_epi32(Y, one_i);
+  const __m128i Z1 = _mm_add_epi32(Z, one_i);
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 fx1 = _mm_sub_ps(fx, one);
+  const __m128 fy1 = _mm_sub_ps(fy, one);
+  const __m128 fz1 = _mm_sub_ps(fz, one);
+
+  return mix_x4(noise_grad_x4(hash_x4(X, Y, Z), fx, fy, fz),
+                noise_grad_x4(hash_x4(X1, Y, Z), fx1, fy, fz),
+                noise_grad_x4(hash_x4(X, Y1, Z), fx, fy1, fz),
+                noise_grad_x4(hash_x4(X1, Y1, Z), fx1, fy1, fz),
+                noise_grad_x4(hash_x4(X, Y, Z1), fx, fy, fz1),
+                noise_grad_x4(hash_x4(X1, Y, Z1), fx1, fy, fz1),
+                noise_grad_x4(hash_x4(X, Y1, Z1), fx, fy1, fz1),
+                noise_grad_x4(hash_x4(X1, Y1, Z1), fx1, fy1, fz1),
+                u,
+                v,
+                w);
+}
+
+/** Same as the wrapping of the position in #perlin_signed. */
+BLI_INLINE __m128 perlin_wrap_x4(__m128 x)
+{
+  const __m128 x_abs = _mm_andnot_ps(_mm_set1_ps(-0.0f), x);
+  const __m128 precision_correction = _mm_and_ps(_mm_cmpge_ps(x_abs, _mm_set1_ps(1000000.0f)),
+                                                 _mm_set1_ps(0.5f));
+  /* The modulo does not change smaller values, so it is only computed when necessary. */
+  if (_mm_movemask_ps(_mm_cmpge_ps(x_abs, _mm_set1_ps(100000.0f))) != 0) {
+    alignas(16) float values[4];
+    _mm_store_ps(values, x);
+    for (float &value : values) {
+      value = math::mod(value, 100000.0f);
+    }
+    x = _mm_load_ps(values);
+  }
+  return _mm_add_ps(x, precision_correction);
+}
+
+BLI_INLINE __m128 perlin_signed_x4(const float3 *positions)
+{
+  const __m128 x = _mm_setr_ps(positions[0].x, positions[1].x, positions[2].x, positions[3].x);
+  const __m128 y = _mm_setr_ps(positions[0].y, positions[1].y, positions[2].y, positions[3].y);
+  const __m128 z = _mm_setr_ps(positions[0].z, positions[1].z, positions[2].z, positions[3].z);
+  const __m128 noise = perlin_noise_x4(perlin_wrap_x4(x), perlin_wrap_x4(y), perlin_wrap_x4(z));
+  return _mm_mul_ps(noise, _mm_set1_ps(0.9820f));
+}
+
+#endif
+
+template<typename T> void perlin_signed(const Span<T> positions, MutableSpan<float> r_values)
+{
+  BLI_assert(positions.size() == r_values.size());
+  int64_t i = 0;
+#if BLI_HAVE_SSE4
+  if constexpr (std::is_same_v<T, float3>) {
+    for (; i + 4 <= positions.size(); i += 4) {
+      _mm_storeu_ps(r_values.data() + i, perlin_signed_x4(positions.data() + i));
+    }
+  }
+#endif
+  for (; i < positions.size(); i++) {
+    r_values[i] = perlin_signed(positions[i]);
+  }
+}
+
+template void perlin_signed<float>(Span<float> positions, MutableSpan<float> r_values);
+template void perlin_signed<float2>(Span<float2> positions, MutableSpan<float> r_values);
+template void perlin_signed<float3>(Span<float3> positions, MutableSpan<float> r_values);
+template void perlin_signed<float4>(Span<float4> positions, MutableSpan<float> r_values);
+
+template<typename T> static constexpr int perlin_dimensions_num()
+{
+  if constexpr (std::is_same_v<T, float>) {
+    return 1;
+  }
+  else {
+    return T::type_length;
+  }
+}
+
+template<typename T> BLI_INLINE T random_offset(const float seed)
+{
+  if constexpr (std::is_same_v<T, float>) {
+    return random_float_offset(seed);
+  }
+  else if constexpr (std::is_same_v<T, float2>) {
+    return random_float2_offset(seed);
+  }
+  else if constexpr (std::is_same_v<T, float3>) {
+    return random_float3_offset(seed);
+  }
+  else {
+    return random_float4_offset(seed);
+  }
+}
+
+/** Batched version of #perlin_distortion that is added to the positions directly. */
+template<typename T>
+static void perlin_distort_batch(MutableSpan<T> positions, const float strength)
+{
+  constexpr int dimensions_num = perlin_dimensions_num<T>();
+  const int64_t size = positions.size();
+  std::array<T, perlin_batch_size> offset_positions_buffer;
+  std::array<float, perlin_batch_size * dimensions_num> distortion_buffer;
+  MutableSpan<T> offset_positions(offset_positions_buffer.data(), size);
+  MutableSpan<float> distortion(distortion_buffer.data(), size * dimensions_num);
+
+  for (const int axis : IndexRange(dimensions_num)) {
+    const T offset = random_offset<T>(float(axis));
+    for (const int64_t i : positions.index_range()) {
+      offset_positions[i] = positions[i] + offset;
+    }
+    perlin_signed<T>(offset_positions, distortion.slice(axis * size, size));
+  }
+  for (const int axis : IndexRange(dimensions_num)) {
+    const Span<float> axis_distortion = distortion.slice(axis * size, size);
+    for (const int64_t i : positions.index_range()) {
+      if constexpr (dimensions_num == 1) {
+        positions[i] += axis_distortion[i] * strength;
+      }
+      else {
+        positions[i][axis] += axis_distortion[i] * strength;
+      }
+    }
+  }
+}
+
+/* Batched versions of the fractal noise functions. The positions may be modified. */
+
+template<typename T>
+static void perlin_fbm_batch(const Span<T> p,
+                             const float detail,
+                             const float roughness,
+                             const float lacunarity,
+                             const bool normalize,
+                             MutableSpan<float> r_values)
+{
+  std::array<T, perlin_batch_size> scaled_buffer;
+  std::array<float, perlin_batch_size> noise_buffer;
+  MutableSpan<T> scaled(scaled_buffer.data(), p.size());
+  MutableSpan<float> noise(noise_buffer.data(), p.size());
+  const auto evaluate_octave = [&](const float fscale) {
+    for (const int64_t i : p.index_range()) {
+      scaled[i] = fscale * p[i];
+    }
+    perlin_signed<T>(scaled, noise);
+  };
+
+  float fscale = 1.0f;
+  float amp = 1.0f;
+  float maxamp = 0.0f;
+  MutableSpan<float> sum = r_values;
+  sum.fill(0.0f);
+
+  for (int octave = 0; octave <= int(detail); octave++) {
+    evaluate_octave(fscale);
+    for (const int64_t i : p.index_range()) {
+      sum[i] += noise[i] * amp;
+    }
+    maxamp += amp;
+    amp *= roughness;
+    fscale *= lacunarity;
+  }
+  const float rmd = detail - std::floor(detail);
+  if (rmd != 0.0f) {
+    evaluate_octave(fscale);
+    for (const int64_t i : p.index_range()) {
+      const float sum1 = sum[i];
+      const float sum2 = sum1 + noise[i] * amp;
+      r_values[i] = normalize ? mix(0.5f * sum1 / maxamp + 0.5f,
+                                    0.5f * sum2 / (maxamp + amp) + 0.5f,
+                                    rmd) :
+                                mix(sum1, sum2, rmd);
+    }
+  }
+  else if (normalize) {
+    for (const int64_t i : p.index_range()) {
+      r_values[i] = 0.5f * sum[i] / maxamp + 0.5f;
+    }
+  }
+}
+
+template<typename T>
+static void perlin_multi_fractal_batch(MutableSpan<T> p,
+                                       const float detail,
+                                       const float roughness,
+                                       const float lacunarity,
+                                       MutableSpan<float> r_values)
+{
+  std::array<float, perlin_batch_size> noise_buffer;
+  MutableSpan<float> noise(noise_buffer.data(), p.size());
+  MutableSpan<float> value = r_values;
+  value.fill(1.0f);
+  float pwr = 1.0f;
+
+  for (int octave = 0; octave <= int(detail); octave++) {
+    perlin_signed<T>(p, noise);
+    for (const int64_t i : p.index_range()) {
+      value[i] *= (pwr * noise[i] + 1.0f);
+      p[i] *= lacunarity;
+    }
+    pwr *= roughness;
+  }
+
+  const float rmd = detail - floorf(detail);
+  if (rmd != 0.0f) {
+    perlin_signed<T>(p, noise);
+    for (const int64_t i : p.index_range()) {
+      value[i] *= (rmd * pwr * noise[i] + 1.0f);
+    }
+  }
+}
+
+template<typename T>
+static void perlin_hetero_terrain_batch(MutableSpan<T> p,
+                                        const float detail,
+                                        const float roughness,
+                                        const float lacunarity,
+                                        const float offset,
+                                        MutableSpan<float> r_values)
+{
+  std::array<float, perlin_batch_size> noise_buffer;
+  MutableSpan<float> noise(noise_buffer.data(), p.size());
+  MutableSpan<float> value = r_values;
+  float pwr = roughness;
+
+  /* First unscaled octave of function; later octaves are scaled. */
+  perlin_signed<T>(p, noise);
+  for (const int64_t i : p.index_range()) {
+    value[i] = offset + noise[i];
+    p[i] *= lacunarity;
+  }
+
+  for (int octave = 1; octave <= int(detail); octave++) {
+    perlin_signed<T>(p, noise);
+    for (const int64_t i : p.index_range()) {
+      const float increment = (noise[i] + offset) * pwr * value[i];
+      value[i] += increment;
+      p[i] *= lacunarity;
+    }
+    pwr *= roughness;
+  }
+
+  const float rmd = detail - floorf(detail);
+  if (rmd != 0.0f) {
+    perlin_signed<T>(p, noise);
+    for (const int64_t i : p.index_range()) {
+      const float increment = (noise[i] + offset) * pwr * value[i];
+      value[i] += rmd * increment;
+    }
+  }
+}
+
+template<typename T>
+static void perlin_hybrid_multi_fractal_batch(MutableSpan<T> p,
+                                              const float detail,
+                                              const float roughness,
+                                              const float lacunarity,
+                                              const float offset,
+                                              const float gain,
+                                              MutableSpan<float> r_values)
+{
+  std::array<float, perlin_batch_size> noise_buffer;
+  std::array<float, perlin_batch_size> weight_buffer;
+  MutableSpan<float> noise(noise_buffer.data(), p.size());
+  MutableSpan<float> weight(weight_buffer.data(), p.size());
+  MutableSpan<float> value = r_values;
+  value.fill(0.0f);
+  weight.fill(1.0f);
+  float pwr = 1.0f;
+
+  /* Positions with a small weight stop contributing, like the early exit of the scalar loop. */
+  const auto is_active = [](const float weight) { return weight > 0.001f; };
+
+  for (int octave = 0; octave <= int(detail); octave++) {
+    if (!std::any_of(weight.begin(), weight.end(), is_active)) {
+      break;
+    }
+    perlin_signed<T>(p, noise);
+    for (const int64_t i : p.index_range()) {
+      if (!is_active(weight[i])) {
+        continue;
+      }
+      if (weight[i] > 1.0f) {
+        weight[i] = 1.0f;
+      }
+      const float signal = (noise[i] + offset) * pwr;
+      value[i] += weight[i] * signal;
+      weight[i] *= gain * signal;
+      p[i] *= lacunarity;
+    }
+    pwr *= roughness;
+  }
+
+  const float rmd = detail - floorf(detail);
+  if (rmd != 0.0f && std::any_of(weight.begin(), weight.end(), is_active)) {
+    perlin_signed<T>(p, noise);
+    for (const int64_t i : p.index_range()) {
+      if (!is_active(weight[i])) {
+        continue;
+      }
+      if (weight[i] > 1.0f) {
+        weight[i] = 1.0f;
+      }
+      const float signal = (noise[i] + offset) * pwr;
+      value[i] += rmd * weight[i] * signal;
+    }
+  }
+}
+
+template<typename T>
+static void perlin_ridged_multi_fractal_batch(MutableSpan<T> p,
+                                              const float detail,
+                                              const float roughness,
+                                              const float lacunarity,
+                                              const float offset,
+                                              const float gain,
+                                              MutableSpan<float> r_values)
+{
+  std::array<float, perlin_batch_size> noise_buffer;
+  std::array<float, perlin_batch_size> signal_buffer;
+  MutableSpan<float> noise(noise_buffer.data(), p.size());
+  MutableSpan<float> signal(signal_buffer.data(), p.size());
+  MutableSpan<float> value = r_values;
+  float pwr = roughness;
+
+  perlin_signed<T>(p, noise);
+  for (const int64_t i : p.index_range()) {
+    signal[i] = offset - std::abs(noise[i]);
+    signal[i] *= signal[i];
+    value[i] = signal[i];
+  }
+
+  for (int octave = 1; octave <= int(detail); octave++) {
+    for (const int64_t i : p.index_range()) {
+      p[i] *= lacunarity;
+    }
+    perlin_signed<T>(p, noise);
+    for (const int64_t i : p.index_range()) {
+      const float weight = std::clamp(signal[i] * gain, 0.0f, 1.0f);
+      signal[i] = offset - std::abs(noise[i]);
+      signal[i] *= signal[i];
+      signal[i] *= weight;
+      value[i] += signal[i] * pwr;
+    }
+    pwr *= roughness;
+  }
+}
+
+template<typename T>
+static void perlin_select_batch(MutableSpan<T> p,
+                                const float detail,
+                                const float roughness,
+                                const float lacunarity,
+                                const float offset,
+                                const float gain,
+                                const int type,
+                                const bool normalize,
+                                MutableSpan<float> r_values)
+{
+  BLI_assert(p.size() <= perlin_batch_size);
+  switch (type) {
+    case NOISE_SHD_PERLIN_MULTIFRACTAL:
+      perlin_multi_fractal_batch<T>(p, detail, roughness, lacunarity, r_values);
+      break;
+    case NOISE_SHD_PERLIN_FBM:
+      perlin_fbm_batch<T>(p, detail, roughness, lacunarity, normalize, r_values);
+      break;
+    case NOISE_SHD_PERLIN_HYBRID_MULTIFRACTAL:
+      perlin_hybrid_multi_fractal_batch<T>(
+          p, detail, roughness, lacunarity, offset, gain, r_values);
+      break;
+    case NOISE_SHD_PERLIN_RIDGED_MULTIFRACTAL:
+      perlin_ridged_multi_fractal_batch<T>(
+          p, detail, roughness, lacunarity, offset, gain, r_values);
+      break;
+    case NOISE_SHD_PERLIN_HETERO_TERRAIN:
+      perlin_hetero_terrain_batch<T>(p, detail, roughness, lacunarity, offset, r_values);
+      break;
+    default:
+      r_values.fill(0.0f);
+      break;
+  }
+}
+
+template<typename T>
+void perlin_fractal_distorted(const Span<T> positions,
+                              const float detail,
+                              const float roughness,
+                              const float lacunarity,
+                              const float offset,
+                              const float gain,
+                              const float distortion,
+                              const int type,
+                              const bool normalize,
+                              MutableSpan<float> r_values)
+{
+  BLI_assert(positions.size() == r_values.size());
+  std::array<T, perlin_batch_size> batch_buffer;
+  for (int64_t start = 0; start < positions.size(); start += perlin_batch_size) {
+    const IndexRange range(start, std::min(perlin_batch_size, positions.size() - start));
+    MutableSpan<T> batch(batch_buffer.data(), range.size());
+    batch.copy_from(positions.slice(range));
+    perlin_distort_batch<T>(batch, distortion);
+    perlin_select_batch<T>(batch,
+                           detail,
+                           roughness,
+                           lacunarity,
+                           offset,
+                           gain,
+                           type,
+                           normalize,
+                           r_values.slice(range));
+  }
+}
+
+template<typename T>
+void perlin_float3_fractal_distorted(const Span<T> positions,
+                                     const float detail,
+                                     const float roughness,
+                                     const float lacunarity,
+                                     const float offset,
+                                     const float gain,
+                                     const float distortion,
+                                     const int type,
+                                     const bool normalize,
+                                     MutableSpan<float3> r_values)
+{
+  BLI_assert(positions.size() == r_values.size());
+  /* Same seeds as in the non-batched versions. */
+  constexpr float seed = float(perlin_dimensions_num<T>());
+  const std::array<T, 2> channel_offsets = {random_offset<T>(seed), random_offset<T>(seed + 1.0f)};
+
+  std::array<T, perlin_batch_size> distorted_buffer;
+  std::array<T, perlin_batch_size> batch_buffer;
+  std::array<float, perlin_batch_size> channel_buffer;
+  for (int64_t start = 0; start < positions.size(); start += perlin_batch_size) {
+    const IndexRange range(start, std::min(perlin_batch_size, positions.size() - start));
+    MutableSpan<T> distorted(distorted_buffer.data(), range.size());
+    MutableSpan<T> batch(batch_buffer.data(), range.size());
+    MutableSpan<float> channel(channel_buffer.data(), range.size());
+    MutableSpan<float3> values = r_values.slice(range);
+    distorted.copy_from(positions.slice(range));
+    perlin_distort_batch<T>(distorted, distortion);
+
+    for (const int channel_index : IndexRange(3)) {
+      for (const int64_t i : distorted.index_range()) {
+        batch[i] = channel_index == 0 ? distorted[i] :
+                                        distorted[i] + channel_offsets[channel_index - 1];
+      }
+      perlin_select_batch<T>(
+          batch, detail, roughness, lacunarity, offset, gain, type, normalize, channel);
+      for (const int64_t i : distorted.index_range()) {
+        values[i][channel_index] = channel[i];
+      }
+    }
+  }
+}
+
+#define INSTANTIATE_BATCHED_PERLIN(T) \
+  template void perlin_fractal_distorted<T>(Span<T> positions, \
+                                            float detail, \
+                                            float roughness, \
+                                            float lacunarity, \
+                                            float offset, \
+                                            float gain, \
+                                            float distortion, \
+                                            int type, \
+                                            bool normalize, \
+                                            MutableSpan<float> r_values); \
+  template void perlin_float3_fractal_distorted<T>(Span<T> positions, \
+                                                   float detail, \
+                                                   float roughness, \
+                                                   float lacunarity, \
+                                                   float offset, \
+                                                   float gain, \
+                                                   float distortion, \
+                                                   int type, \
+                                                   bool normalize, \
+                                                   MutableSpan<float3> r_values);
+
+INSTANTIATE_BATCHED_PERLIN(float)
+INSTANTIATE_BATCHED_PERLIN(float2)
+INSTANTIATE_BATCHED_PERLIN(float3)
+INSTANTIATE_BATCHED_PERLIN(float4)
+
+#undef INSTANTIATE_BATCHED_PERLIN
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Voronoi Noise
  *
@@ -0,0 +1,79 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include "BLI_array.hh"
+#include "BLI_noise.hh"
+
+namespace blender::noise::tests {
+
+template<typename T> static Array<T> test_positions()
+{
+  /* Include negative, large and non-multiple-of-four sized inputs. */
+  Array<T> positions(203);
+  for (const int i : positions.index_range()) {
+    positions[i] = T(float(i) * 0.173f - 17.0f);
+    if constexpr (!std::is_same_v<T, float>) {
+      positions[i][0] *= 1.7f;
+      positions[i][1] += 3.1f;
+    }
+  }
+  positions[5] = T(150000.5f);
+  positions[6] = T(-2000000.25f);
+  return positions;
+}
+
+template<typename T> static void test_batched_perlin()
+{
+  const Array<T> positions = test_positions<T>();
+
+  Array<float> values(positions.size());
+  perlin_signed<T>(positions, values);
+  for (const int i : positions.index_range()) {
+    EXPECT_EQ(values[i], perlin_signed(positions[i]));
+  }
+
+  for (const int type : IndexRange(5)) {
+    for (const float detail : {0.0f, 2.0f, 4.5f}) {
+      for (const bool normalize : {false, true}) {
+        perlin_fractal_distorted<T>(
+            positions, detail, 0.6f, 2.1f, 0.4f, 1.5f, 0.8f, type, normalize, values);
+        Array<float3> colors(positions.size());
+        perlin_float3_fractal_distorted<T>(
+            positions, detail, 0.6f, 2.1f, 0.4f, 1.5f, 0.8f, type, normalize, colors);
+        for (const int i : positions.index_range()) {
+          EXPECT_EQ(values[i],
+                    perlin_fractal_distorted(
+                        positions[i], detail, 0.6f, 2.1f, 0.4f, 1.5f, 0.8f, type, normalize));
+          EXPECT_EQ(colors[i],
+                    perlin_float3_fractal_distorted(
+                        positions[i], detail, 0.6f, 2.1f, 0.4f, 1.5f, 0.8f, type, normalize));
+        }
+      }
+    }
+  }
+}
+
+TEST(noise, BatchedPerlin1D)
+{
+  test_batched_perlin<float>();
+}
+
+TEST(noise, BatchedPerlin2D)
+{
+  test_batched_perlin<float2>();
+}
+
+TEST(noise, BatchedPerlin3D)
+{
+  test_batched_perlin<float3>();
+}
+
+TEST(noise, BatchedPerlin4D)
+{
+  test_batched_perlin<float4>();
+}
+
+}  // namespace blender::noise::tests
@@ -31,10 +31,13 @@ struct MemFileSharedStorage {
 
 struct MemFileChunk {
   void *next, *prev;
+  /**
+   * Reference counted memory, shared by all chunks with the same content (in any #MemFile).
+   */
   const char *buf;
   /** Size in bytes. */
   size_t size;
-  /** When true, this chunk doesn't own the memory, it's shared with a previous #MemFileChunk */
+  /** When true, this chunk is identical to the matching chunk in the previous step. */
   bool is_identical;
   /** When true, this chunk is also identical to the one in the next step (used by undo code to
    * detect unchanged IDs).
@@ -47,6 +50,10 @@ struct MemFileChunk {
 
 struct MemFile {
   ListBase chunks;
+  /**
+   * Size of the chunk buffers this memfile accounts for: the ones it allocated, and the ones of
+   * previous memfiles that were merged into it and are still used.
+   */
   size_t size;
   /**
    * Some data is not serialized into a new buffer because the undo-step can take ownership of it
@@ -90,6 +97,21 @@ void BLO_memfile_write_init(MemFileWriteData *mem_data,
 void BLO_memfile_write_finalize(MemFileWriteData *mem_data);
 
 void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t size);
+/**
+ * Find the size of the next chunk of a large block of data, roughly \a chunk_size on average.
+ * The chunk boundaries depend on the content, so that inserting or removing data only changes
+ * the chunks around it, and the remaining chunks can still be shared with previous memfiles.
+ */
+size_t BLO_memfile_chunk_size_find(const char *data, size_t size, size_t chunk_size);
+/**
+ * Same as #BLO_memfile_chunk_size_find, but when the data starts with the same content as the
+ * matching chunk of the reference memfile, its size is used directly. That avoids computing the
+ * rolling hash for data that did not change, which is the common case.
+ */
+size_t BLO_memfile_write_chunk_size_find(const MemFileWriteData *mem_data,
+                                         const char *data,
+                                         size_t size,
+                                         size_t chunk_size);
 
 /* exports */
 
@@ -102,6 +124,7 @@ void BLO_memfile_free(MemFile *memfile);
 /**
  * Result is that 'first' is being freed.
  * To keep the #MemFile linked list of consistent, `first` is always first in list.
+ * The size of chunk buffers that are still used is moved to 'second'.
  */
 void BLO_memfile_merge(MemFile *first, MemFile *second);
 /**
@@ -109,8 +132,48 @@ void BLO_memfile_merge(MemFile *first, MemFile *second);
  */
 void BLO_memfile_clear_future(MemFile *memfile);
 
+struct MemFileMemoryStats {
+  /** Number of chunks in all memfiles and their size, as if no memory was shared. */
+  size_t chunks_num = 0;
+  size_t chunks_size = 0;
+  /** Number of chunk buffers and their size, i.e. the memory that is actually used. */
+  size_t buffers_num = 0;
+  size_t buffers_size = 0;
+};
+
+/**
+ * Memory usage of all memfiles, taking into account that chunks with the same content share
+ * their memory.
+ */
+MemFileMemoryStats BLO_memfile_memory_stats();
+
 /* Utilities. */
 
 Main *BLO_memfile_main_get(MemFile *memfile, Main *bmain, Scene **r_scene);
 
 FileReader *BLO_memfile_new_filereader(MemFile *memfile, int undo_direction);
+
+/* **************** incremental writing of memfiles, for auto-save *************** */
+
+/**
+ * A journal file that a sequence of #MemFile is appended to. Only chunks that changed since the
+ * previous write are added to the file, unchanged chunks are referenced from earlier writes. Each
+ * write ends with a snapshot record that lists the parts of the journal that make up the file.
+ */
+struct MemFileJournal;
+
+MemFileJournal *BLO_memfile_journal_new(const char *filepath);
+void BLO_memfile_journal_free(MemFileJournal *journal);
+const char *BLO_memfile_journal_filepath(const MemFileJournal *journal);
+/**
+ * Append the changed chunks of the memfile and a snapshot referencing all its chunks to the
+ * journal. The journal is compacted when it mostly contains data that is not used anymore.
+ *
+ * \return False when writing failed, the journal is reset and rewritten in full on the next call.
+ */
+bool BLO_memfile_journal_write(MemFileJournal *journal, const MemFile *memfile);
+/**
+ * Replay the last complete snapshot of a journal into a regular blend file.
+ * Incomplete records at the end of the journal (e.g. after a crash) are ignored.
+ */
+bool BLO_memfile_journal_recover(const char *journal_filepath, const char *filepath);
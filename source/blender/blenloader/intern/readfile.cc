@@ -6,6 +6,7 @@
  * \ingroup blenloader
  */
 
+#include <atomic>
 #include <cctype> /* for isdigit. */
 #include <cerrno>
 #include <climits>
@@ -43,6 +44,7 @@
 #include "DNA_packedFile_types.h"
 #include "DNA_sdna_types.h"
 #include "DNA_sound_types.h"
+#include "DNA_userdef_types.h"
 #include "DNA_vfont_types.h"
 #include "DNA_volume_types.h"
 #include "DNA_workspace_types.h"
@@ -54,17 +56,24 @@
 #include "BLI_endian_defines.h"
 #include "BLI_endian_switch.h"
 #include "BLI_ghash.h"
+#include "BLI_hash.hh"
 #include "BLI_linklist.h"
 #include "BLI_map.hh"
 #include "BLI_memarena.h"
 #include "BLI_mempool.h"
+#include "BLI_system.h"
+#include "BLI_task.hh"
 #include "BLI_threads.h"
 #include "BLI_time.h"
+#include "BLI_vector.hh"
+
+#include BLI_SYSTEM_PID_H
 
 #include "BLT_translation.hh"
 
 #include "BKE_anim_data.hh"
 #include "BKE_animsys.h"
+#include "BKE_appdir.hh"
 #include "BKE_asset.hh"
 #include "BKE_blender_version.h"
 #include "BKE_collection.hh"
@@ -166,11 +175,23 @@
  * Delay reading blocks we might not use (especially applies to library linking).
  * which keeps large arrays in memory from data-blocks we may not even use.
  *
- * \note This is disabled when using compression,
+ * \note This is disabled when using gzip compression,
  * while ZLIB supports seek it's unusably slow, see: #61880.
+ * Zstd files with a seek table keep the most recently used decompressed frames in a small cache,
+ * so reads on demand only decompress frames that aren't cached. Sequential reads decompress
+ * several following frames ahead in parallel, see `filereader_zstd.c`.
  */
 #define USE_BHEAD_READ_ON_DEMAND
 
+/**
+ * Cache the list of #BHead of large files in a sidecar index in the user cache directory, so that
+ * opening them again (e.g. to link a single asset from a big compressed library) doesn't require
+ * scanning, and possibly decompressing, the whole file. Data blocks are read on demand, so this
+ * requires #USE_BHEAD_READ_ON_DEMAND. Only used when the experimental
+ * `use_blend_file_bhead_index` option is enabled.
+ */
+#define USE_BHEAD_INDEX
+
 /** Use #GHash for #BHead name-based lookups (speeds up linking). */
 #define USE_GHASH_BHEAD
 
@@ -1265,6 +1286,394 @@ static FileData *blo_filedata_from_file_open(const char *filepath, BlendFileRead
   return blo_filedata_from_file_descriptor(filepath, reports, file);
 }
 
+/* -------------------------------------------------------------------- */
+/** \name BHead Index
+ *
+ * The index stores all #BHead of a file with the offsets of their data, and the data itself for
+ * all blocks that are not read on demand (IDs, DNA, thumbnail...). It is only valid for the exact
+ * file it was created from. This is checked with the file size, modification time and header, the
+ * size of the (uncompressed) file data that the offsets refer to, and by comparing the headers of
+ * a few blocks at their expected offsets with the file itself.
+ * \{ */
+
+#if defined(USE_BHEAD_INDEX) && defined(USE_BHEAD_READ_ON_DEMAND)
+
+/** Smaller files are fast enough to scan. */
+#  define BHEAD_INDEX_MIN_FILE_SIZE (16 << 20)
+#  define BHEAD_INDEX_VERSION 3
+/** The least recently used indices are removed when the cache directory contains more. */
+#  define BHEAD_INDEX_MAX_FILES 64
+/** Temporary files of writes that did not finish are removed after this many seconds. */
+#  define BHEAD_INDEX_TMP_FILE_EXPIRE (60 * 60)
+
+/** Blocks whose headers are compared with the file before the index is used. */
+enum {
+  BHEAD_INDEX_CHECK_FIRST = 0,
+  BHEAD_INDEX_CHECK_FIRST_DATA,
+  BHEAD_INDEX_CHECK_DNA,
+  BHEAD_INDEX_CHECK_END,
+  BHEAD_INDEX_CHECK_NUM,
+};
+
+struct BHeadIndexHeader {
+  char magic[8];
+  int version;
+  int bheads_num;
+  /** Size of the file on disk. */
+  int64_t file_size;
+  /** Size of the file data the #BHead offsets refer to, after decompression. */
+  int64_t data_size;
+  int64_t file_mtime;
+  int64_t file_mtime_nsec;
+  char blend_header[SIZEOFBLENDERHEADER];
+  /** Headers of the checked blocks, as stored in the file. */
+  char check_bheads[BHEAD_INDEX_CHECK_NUM][sizeof(BHead8)];
+};
+
+struct BHeadIndexEntry {
+  BHead bhead;
+  off64_t file_offset;
+  /** When set, the data of the block directly follows this entry in the index. */
+  int has_data;
+};
+
+static const char bhead_index_magic[8] = {'B', 'L', 'O', 'B', 'H', 'I', 'D', 'X'};
+
+static bool bhead_index_is_enabled()
+{
+  return USER_EXPERIMENTAL_TEST(&U, use_blend_file_bhead_index);
+}
+
+/** The index is stored in `BKE_appdir_folder_caches/blend-bhead-index/<filepath-hash>`. */
+bool blo_bhead_index_filepath(const char *filepath, char *r_index_path, size_t index_path_size)
+{
+  if (!BKE_appdir_folder_caches(r_index_path, index_path_size)) {
+    return false;
+  }
+
+  char abs_path[FILE_MAX];
+  STRNCPY(abs_path, filepath);
+  BLI_path_abs_from_cwd(abs_path, sizeof(abs_path));
+
+  const uint64_t hash = blender::get_default_hash(blender::StringRef(abs_path));
+  char index_name[64];
+  SNPRINTF(index_name, "%016llx.bhead_index", (unsigned long long)hash);
+  BLI_path_append(r_index_path, index_path_size, "blend-bhead-index");
+  BLI_path_append(r_index_path, index_path_size, index_name);
+  return true;
+}
+
+static int64_t bhead_index_mtime_nsec(const BLI_stat_t &st)
+{
+#  if defined(WIN32)
+  /* Only available with a resolution of seconds. */
+  UNUSED_VARS(st);
+  return 0;
+#  elif defined(__APPLE__)
+  return st.st_mtimespec.tv_nsec;
+#  else
+  return st.st_mtim.tv_nsec;
+#  endif
+}
+
+static bool bhead_index_header_init(FileData *fd, const char *filepath, BHeadIndexHeader *r_header)
+{
+  BLI_stat_t st;
+  if (fd->file->seek == nullptr || BLI_stat(filepath, &st) == -1) {
+    return false;
+  }
+
+  /* Compressed files are seekable in their uncompressed data, see #BLI_filereader_new_zstd. */
+  const off64_t offset = fd->file->offset;
+  const off64_t data_size = fd->file->seek(fd->file, 0, SEEK_END);
+  if (data_size < BHEAD_INDEX_MIN_FILE_SIZE) {
+    fd->file->seek(fd->file, offset, SEEK_SET);
+    return false;
+  }
+
+  memset(r_header, 0, sizeof(*r_header));
+  memcpy(r_header->magic, bhead_index_magic, sizeof(r_header->magic));
+  r_header->version = BHEAD_INDEX_VERSION;
+  r_header->file_size = st.st_size;
+  r_header->data_size = data_size;
+  r_header->file_mtime = st.st_mtime;
+  r_header->file_mtime_nsec = bhead_index_mtime_nsec(st);
+
+  /* Also compare the blend-file header, which contains the pointer size and endianness that the
+   * stored #BHead have been converted from. */
+  const bool success = fd->file->seek(fd->file, 0, SEEK_SET) == 0 &&
+                       fd->file->read(fd->file, r_header->blend_header, SIZEOFBLENDERHEADER) ==
+                           SIZEOFBLENDERHEADER;
+  fd->file->seek(fd->file, offset, SEEK_SET);
+  return success;
+}
+
+/**
+ * Find the offsets of the checked blocks in the file, from the sizes of all blocks before them.
+ * \return False when the #BHead list does not describe a complete file.
+ */
+static bool bhead_index_check_offsets(const ListBase *bhead_list,
+                                      const BHeadIndexHeader *header,
+                                      off64_t r_offsets[BHEAD_INDEX_CHECK_NUM])
+{
+  /* See #decode_blender_header. */
+  const off64_t bhead_size = (header->blend_header[7] == '_') ? sizeof(BHead4) : sizeof(BHead8);
+
+  for (int i = 0; i < BHEAD_INDEX_CHECK_NUM; i++) {
+    r_offsets[i] = -1;
+  }
+
+  off64_t offset = SIZEOFBLENDERHEADER;
+  LISTBASE_FOREACH (const BHeadN *, new_bhead, bhead_list) {
+    if (r_offsets[BHEAD_INDEX_CHECK_FIRST] == -1) {
+      r_offsets[BHEAD_INDEX_CHECK_FIRST] = offset;
+    }
+    if (!new_bhead->has_data) {
+      /* Blocks read on demand know their offset, which has to match the layout. */
+      if (new_bhead->file_offset != offset + bhead_size) {
+        return false;
+      }
+      if (r_offsets[BHEAD_INDEX_CHECK_FIRST_DATA] == -1) {
+        r_offsets[BHEAD_INDEX_CHECK_FIRST_DATA] = offset;
+      }
+    }
+    if (new_bhead->bhead.code == BLO_CODE_DNA1) {
+      r_offsets[BHEAD_INDEX_CHECK_DNA] = offset;
+    }
+    if (new_bhead->bhead.code == BLO_CODE_ENDB) {
+      r_offsets[BHEAD_INDEX_CHECK_END] = offset;
+      return offset < header->data_size;
+    }
+    offset += bhead_size + new_bhead->bhead.len;
+  }
+
+  return false;
+}
+
+/** Read the headers of the checked blocks as they are stored in the file. */
+static bool bhead_index_check_bheads_read(FileData *fd,
+                                          const BHeadIndexHeader *header,
+                                          const off64_t offsets[BHEAD_INDEX_CHECK_NUM],
+                                          char (*r_check_bheads)[sizeof(BHead8)])
+{
+  const size_t bhead_size = (header->blend_header[7] == '_') ? sizeof(BHead4) : sizeof(BHead8);
+  const off64_t file_offset = fd->file->offset;
+
+  memset(r_check_bheads, 0, BHEAD_INDEX_CHECK_NUM * sizeof(BHead8));
+  bool success = true;
+  for (int i = 0; i < BHEAD_INDEX_CHECK_NUM && success; i++) {
+    if (offsets[i] == -1) {
+      continue;
+    }
+    /* The end block may be stored partially. */
+    const size_t size = size_t(std::min<int64_t>(bhead_size, header->data_size - offsets[i]));
+    success = fd->file->seek(fd->file, offsets[i], SEEK_SET) == offsets[i] &&
+              fd->file->read(fd->file, r_check_bheads[i], size) == int64_t(size);
+  }
+
+  fd->file->seek(fd->file, file_offset, SEEK_SET);
+  return success;
+}
+
+/**
+ * Fill the #BHead list of the file from its index, instead of scanning the file.
+ * \return False when there is no valid index for the file, it then has to be scanned as usual.
+ */
+static bool bhead_index_read(FileData *fd, const char *filepath)
+{
+  BHeadIndexHeader expected_header;
+  char index_path[FILE_MAX];
+  if (!bhead_index_header_init(fd, filepath, &expected_header) ||
+      !blo_bhead_index_filepath(filepath, index_path, sizeof(index_path)))
+  {
+    return false;
+  }
+
+  size_t index_size = 0;
+  char *index_data = static_cast<char *>(BLI_file_read_binary_as_mem(index_path, 0, &index_size));
+  if (index_data == nullptr) {
+    return false;
+  }
+  BLI_SCOPED_DEFER([&]() { MEM_freeN(index_data); });
+
+  BHeadIndexHeader header;
+  if (index_size < sizeof(header)) {
+    return false;
+  }
+  memcpy(&header, index_data, sizeof(header));
+  expected_header.bheads_num = header.bheads_num;
+  memcpy(expected_header.check_bheads, header.check_bheads, sizeof(header.check_bheads));
+  if (memcmp(&header, &expected_header, sizeof(header)) != 0) {
+    return false;
+  }
+
+  BLI_assert(BLI_listbase_is_empty(&fd->bhead_list));
+  size_t offset = sizeof(header);
+  for (int i = 0; i < header.bheads_num; i++) {
+    BHeadIndexEntry entry;
+    if (index_size - offset < sizeof(entry)) {
+      break;
+    }
+    memcpy(&entry, index_data + offset, sizeof(entry));
+    offset += sizeof(entry);
+
+    const size_t data_size = entry.has_data ? size_t(entry.bhead.len) : 0;
+    if (entry.bhead.len < 0 || index_size - offset < data_size) {
+      break;
+    }
+    BHeadN *new_bhead = static_cast<BHeadN *>(MEM_mallocN(sizeof(BHeadN) + data_size, __func__));
+    new_bhead->next = new_bhead->prev = nullptr;
+    new_bhead->file_offset = entry.file_offset;
+    new_bhead->has_data = entry.has_data;
+    new_bhead->is_memchunk_identical = false;
+    new_bhead->bhead = entry.bhead;
+    memcpy(new_bhead + 1, index_data + offset, data_size);
+    offset += data_size;
+    BLI_addtail(&fd->bhead_list, new_bhead);
+  }
+
+  /* Compare a few blocks at their offsets with the file, the file may have been replaced by
+   * another one with the same size and modification time. */
+  off64_t check_offsets[BHEAD_INDEX_CHECK_NUM];
+  char check_bheads[BHEAD_INDEX_CHECK_NUM][sizeof(BHead8)];
+  if (offset != index_size ||
+      !bhead_index_check_offsets(&fd->bhead_list, &header, check_offsets) ||
+      !bhead_index_check_bheads_read(fd, &header, check_offsets, check_bheads) ||
+      memcmp(check_bheads, header.check_bheads, sizeof(check_bheads)) != 0)
+  {
+    BLI_freelistN(&fd->bhead_list);
+    return false;
+  }
+
+  /* Mark as recently used, see #bhead_index_prune. */
+  BLI_file_touch(index_path);
+
+  /* All blocks are known, the file itself is only read on demand from now on. */
+  fd->is_eof = true;
+  fd->flags |= FD_FLAGS_HAS_BHEAD_INDEX;
+  return true;
+}
+
+/** Remove the least recently used indices and leftovers of writes that did not finish. */
+static void bhead_index_prune(const char *index_dir)
+{
+  direntry *entries = nullptr;
+  const uint entries_num = BLI_filelist_dir_contents(index_dir, &entries);
+
+  const int64_t now = int64_t(time(nullptr));
+  blender::Vector<const direntry *> indices;
+  for (uint i = 0; i < entries_num; i++) {
+    const direntry &entry = entries[i];
+    if (!S_ISREG(entry.s.st_mode)) {
+      continue;
+    }
+    if (BLI_path_extension_check(entry.path, ".bhead_index")) {
+      indices.append(&entry);
+    }
+    else if (BLI_path_extension_check(entry.path, ".tmp") &&
+             now - int64_t(entry.s.st_mtime) > BHEAD_INDEX_TMP_FILE_EXPIRE)
+    {
+      BLI_delete(entry.path, false, false);
+    }
+  }
+
+  if (indices.size() > BHEAD_INDEX_MAX_FILES) {
+    std::sort(indices.begin(), indices.end(), [](const direntry *a, const direntry *b) {
+      return a->s.st_mtime < b->s.st_mtime;
+    });
+    for (const int64_t i : indices.index_range().drop_back(BHEAD_INDEX_MAX_FILES)) {
+      BLI_delete(indices[i]->path, false, false);
+    }
+  }
+
+  BLI_filelist_free(entries, entries_num);
+}
+
+/**
+ * Write the index of a file that has been opened without one. This is done while opening the file,
+ * so that the index is complete on disk when the file has been read.
+ */
+static void bhead_index_write(FileData *fd, const char *filepath)
+{
+  BHeadIndexHeader header;
+  char index_path[FILE_MAX];
+  if (!bhead_index_header_init(fd, filepath, &header) ||
+      !blo_bhead_index_filepath(filepath, index_path, sizeof(index_path)))
+  {
+    return;
+  }
+
+  /* Usually only a few blocks follow the DNA block, which has been read already. */
+  BHead *bhead = &static_cast<BHeadN *>(fd->bhead_list.last)->bhead;
+  while (bhead->code != BLO_CODE_ENDB) {
+    bhead = blo_bhead_next(fd, bhead);
+    if (bhead == nullptr) {
+      return;
+    }
+  }
+  header.bheads_num = BLI_listbase_count(&fd->bhead_list);
+
+  off64_t check_offsets[BHEAD_INDEX_CHECK_NUM];
+  if (!bhead_index_check_offsets(&fd->bhead_list, &header, check_offsets) ||
+      !bhead_index_check_bheads_read(fd, &header, check_offsets, header.check_bheads))
+  {
+    return;
+  }
+
+  size_t index_size = sizeof(header);
+  LISTBASE_FOREACH (BHeadN *, new_bhead, &fd->bhead_list) {
+    index_size += sizeof(BHeadIndexEntry);
+    if (new_bhead->has_data) {
+      index_size += size_t(new_bhead->bhead.len);
+    }
+  }
+
+  blender::Vector<char> index_data;
+  index_data.reserve(index_size);
+  index_data.extend(blender::Span(reinterpret_cast<const char *>(&header), sizeof(header)));
+  LISTBASE_FOREACH (BHeadN *, new_bhead, &fd->bhead_list) {
+    BHeadIndexEntry entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.bhead = new_bhead->bhead;
+    entry.file_offset = new_bhead->file_offset;
+    entry.has_data = new_bhead->has_data;
+    index_data.extend(blender::Span(reinterpret_cast<const char *>(&entry), sizeof(entry)));
+    if (new_bhead->has_data && new_bhead->bhead.len > 0) {
+      index_data.extend(blender::Span(reinterpret_cast<const char *>(new_bhead + 1),
+                                      int64_t(new_bhead->bhead.len)));
+    }
+  }
+
+  /* Write to a temporary file first, so that other processes never read a partial index. The name
+   * is unique across processes and across indices written concurrently by this process. */
+  static std::atomic<int> tmp_counter = 0;
+  char tmp_path[FILE_MAX];
+  SNPRINTF(tmp_path, "%s.%d.%d.tmp", index_path, int(getpid()), tmp_counter++);
+
+  if (!BLI_file_ensure_parent_dir_exists(tmp_path)) {
+    return;
+  }
+  FILE *file = BLI_fopen(tmp_path, "wb");
+  if (file == nullptr) {
+    return;
+  }
+  bool success = fwrite(index_data.data(), size_t(index_data.size()), 1, file) == 1;
+  success &= fclose(file) == 0;
+
+  if (!success || BLI_rename_overwrite(tmp_path, index_path) != 0) {
+    BLI_delete(tmp_path, false, false);
+    return;
+  }
+
+  char index_dir[FILE_MAX];
+  BLI_path_split_dir_part(index_path, index_dir, sizeof(index_dir));
+  bhead_index_prune(index_dir);
+}
+
+#endif
+
+/** \} */
+
 FileData *blo_filedata_from_file(const char *filepath, BlendFileReadReport *reports)
 {
   FileData *fd = blo_filedata_from_file_open(filepath, reports);
@@ -1272,7 +1681,19 @@ FileData *blo_filedata_from_file(const char *filepath, BlendFileReadReport *repo
     /* needed for library_append and read_libraries */
     STRNCPY(fd->relabase, filepath);
 
+#if defined(USE_BHEAD_INDEX) && defined(USE_BHEAD_READ_ON_DEMAND)
+    if (!bhead_index_is_enabled()) {
+      return blo_decode_and_check(fd, reports->reports);
+    }
+    const bool has_bhead_index = bhead_index_read(fd, filepath);
+    fd = blo_decode_and_check(fd, reports->reports);
+    if (fd != nullptr && !has_bhead_index) {
+      bhead_index_write(fd, filepath);
+    }
+    return fd;
+#else
     return blo_decode_and_check(fd, reports->reports);
+#endif
   }
   return nullptr;
 }
@@ -1791,22 +2212,57 @@ static const char *get_alloc_name(FileData *fd,
 #endif
 }
 
+/**
+ * Whether the data of the block has to be converted to the current DNA (or endianness), rather
+ * than just being copied. This requires the whole block to be in memory.
+ */
+static bool read_struct_needs_conversion(const FileData *fd, const BHead *bh)
+{
+  /* NOTE: raw data (aka #SDNA_RAW_DATA_STRUCT_INDEX #SDNAnr) is not handled here, it's up to
+   * the calling code to manage this. */
+  BLI_STATIC_ASSERT(SDNA_RAW_DATA_STRUCT_INDEX == 0, "'raw data' SDNA struct index should be 0")
+  return (bh->SDNAnr > SDNA_RAW_DATA_STRUCT_INDEX && (fd->flags & FD_FLAGS_SWITCH_ENDIAN)) ||
+         fd->compflags[bh->SDNAnr] == SDNA_CMP_NOT_EQUAL;
+}
+
+/**
+ * Convert the data of a fully read block, see #read_struct_needs_conversion. This only reads from
+ * the #FileData, so it can be called for multiple blocks in parallel.
+ */
+static void *read_struct_convert(const FileData *fd, BHead *bh, const char *alloc_name)
+{
+  /* Endianness switch is based on file DNA. */
+  if (bh->SDNAnr > SDNA_RAW_DATA_STRUCT_INDEX && (fd->flags & FD_FLAGS_SWITCH_ENDIAN)) {
+    switch_endian_structs(fd->filesdna, bh);
+  }
+
+  switch (fd->compflags[bh->SDNAnr]) {
+    case SDNA_CMP_REMOVED:
+      return nullptr;
+    case SDNA_CMP_NOT_EQUAL:
+      return DNA_struct_reconstruct(
+          fd->reconstruct_info, bh->SDNAnr, bh->nr, (bh + 1), alloc_name);
+    default: {
+      const int alignment = DNA_struct_alignment(fd->filesdna, bh->SDNAnr);
+      void *temp = MEM_mallocN_aligned(bh->len, alignment, alloc_name);
+      memcpy(temp, (bh + 1), bh->len);
+      return temp;
+    }
+  }
+}
+
 static void *read_struct(FileData *fd, BHead *bh, const char *blockname, const int id_type_index)
 {
   void *temp = nullptr;
 
   if (bh->len) {
-#ifdef USE_BHEAD_READ_ON_DEMAND
-    BHead *bh_orig = bh;
-#endif
+    const char *alloc_name = (fd->compflags[bh->SDNAnr] != SDNA_CMP_REMOVED) ?
+                                 get_alloc_name(fd, bh, blockname, id_type_index) :
+                                 nullptr;
 
-    /* Endianness switch is based on file DNA.
-     *
-     * NOTE: raw data (aka #SDNA_RAW_DATA_STRUCT_INDEX #SDNAnr) is not handled here, it's up to
-     * the calling code to manage this. */
-    BLI_STATIC_ASSERT(SDNA_RAW_DATA_STRUCT_INDEX == 0, "'raw data' SDNA struct index should be 0")
-    if (bh->SDNAnr > SDNA_RAW_DATA_STRUCT_INDEX && (fd->flags & FD_FLAGS_SWITCH_ENDIAN)) {
+    if (read_struct_needs_conversion(fd, bh)) {
 #ifdef USE_BHEAD_READ_ON_DEMAND
+      BHead *bh_orig = bh;
       if (BHEADN_FROM_BHEAD(bh)->has_data == false) {
         bh = blo_bhead_read_full(fd, bh);
         if (UNLIKELY(bh == nullptr)) {
@@ -1815,52 +2271,34 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname, const i
         }
       }
 #endif
-      switch_endian_structs(fd->filesdna, bh);
-    }
-
-    if (fd->compflags[bh->SDNAnr] != SDNA_CMP_REMOVED) {
-      const char *alloc_name = get_alloc_name(fd, bh, blockname, id_type_index);
-      if (fd->compflags[bh->SDNAnr] == SDNA_CMP_NOT_EQUAL) {
+      temp = read_struct_convert(fd, bh, alloc_name);
 #ifdef USE_BHEAD_READ_ON_DEMAND
-        if (BHEADN_FROM_BHEAD(bh)->has_data == false) {
-          bh = blo_bhead_read_full(fd, bh);
-          if (UNLIKELY(bh == nullptr)) {
-            fd->flags &= ~FD_FLAGS_FILE_OK;
-            return nullptr;
-          }
-        }
+      if (bh_orig != bh) {
+        MEM_freeN(BHEADN_FROM_BHEAD(bh));
+      }
 #endif
-        temp = DNA_struct_reconstruct(
-            fd->reconstruct_info, bh->SDNAnr, bh->nr, (bh + 1), alloc_name);
+    }
+    else if (fd->compflags[bh->SDNAnr] != SDNA_CMP_REMOVED) {
+      /* SDNA_CMP_EQUAL */
+      const int alignment = DNA_struct_alignment(fd->filesdna, bh->SDNAnr);
+      temp = MEM_mallocN_aligned(bh->len, alignment, alloc_name);
+#ifdef USE_BHEAD_READ_ON_DEMAND
+      if (BHEADN_FROM_BHEAD(bh)->has_data) {
+        memcpy(temp, (bh + 1), bh->len);
       }
       else {
-        /* SDNA_CMP_EQUAL */
-        const int alignment = DNA_struct_alignment(fd->filesdna, bh->SDNAnr);
-        temp = MEM_mallocN_aligned(bh->len, alignment, alloc_name);
-#ifdef USE_BHEAD_READ_ON_DEMAND
-        if (BHEADN_FROM_BHEAD(bh)->has_data) {
-          memcpy(temp, (bh + 1), bh->len);
-        }
-        else {
-          /* Instead of allocating the bhead, then copying it,
-           * read the data from the file directly into the memory. */
-          if (UNLIKELY(!blo_bhead_read_data(fd, bh, temp))) {
-            fd->flags &= ~FD_FLAGS_FILE_OK;
-            MEM_freeN(temp);
-            temp = nullptr;
-          }
+        /* Instead of allocating the bhead, then copying it,
+         * read the data from the file directly into the memory. */
+        if (UNLIKELY(!blo_bhead_read_data(fd, bh, temp))) {
+          fd->flags &= ~FD_FLAGS_FILE_OK;
+          MEM_freeN(temp);
+          temp = nullptr;
         }
+      }
 #else
-        memcpy(temp, (bh + 1), bh->len);
+      memcpy(temp, (bh + 1), bh->len);
 #endif
-      }
     }
-
-#ifdef USE_BHEAD_READ_ON_DEMAND
-    if (bh_orig != bh) {
-      MEM_freeN(BHEADN_FROM_BHEAD(bh));
-    }
-#endif
   }
 
   return temp;
@@ -2469,21 +2907,83 @@ static BHead *read_data_into_datamap(FileData *fd,
                                      const char *allocname,
                                      const int id_type_index)
 {
+  struct DataBlock {
+    BHead *bhead;
+    /** Fully read block that still has to be converted, see #read_struct_needs_conversion. */
+    BHead *bhead_full = nullptr;
+    const char *alloc_name = nullptr;
+    void *data = nullptr;
+  };
+
+  /* Reading from the file has to happen in order, but converting blocks to the current DNA can
+   * be expensive, so that is done in parallel afterwards. Only blocks that need DNA
+   * reconstruction or an endian switch are converted, which mostly happens for files saved by
+   * older versions. Blocks that match the current DNA are read directly and gain nothing. */
+  blender::Vector<DataBlock, 16> blocks;
+  int64_t conversion_size = 0;
+
   bhead = blo_bhead_next(fd, bhead);
 
   while (bhead && bhead->code == BLO_CODE_DATA) {
-    void *data = read_struct(fd, bhead, allocname, id_type_index);
-    if (data) {
-      const bool is_new = oldnewmap_insert(fd->datamap, bhead->old, data, 0);
+    blocks.append({bhead});
+    DataBlock &block = blocks.last();
+    if (bhead->len && read_struct_needs_conversion(fd, bhead)) {
+      block.bhead_full = bhead;
+#ifdef USE_BHEAD_READ_ON_DEMAND
+      if (BHEADN_FROM_BHEAD(bhead)->has_data == false) {
+        block.bhead_full = blo_bhead_read_full(fd, bhead);
+        if (UNLIKELY(block.bhead_full == nullptr)) {
+          fd->flags &= ~FD_FLAGS_FILE_OK;
+        }
+      }
+#endif
+      if (fd->compflags[bhead->SDNAnr] != SDNA_CMP_REMOVED) {
+        block.alloc_name = get_alloc_name(fd, bhead, allocname, id_type_index);
+      }
+      conversion_size += bhead->len;
+    }
+    else {
+      block.data = read_struct(fd, bhead, allocname, id_type_index);
+    }
+
+    bhead = blo_bhead_next(fd, bhead);
+  }
+
+  const auto convert_block = [&](DataBlock &block) {
+    if (block.bhead_full) {
+      block.data = read_struct_convert(fd, block.bhead_full, block.alloc_name);
+    }
+  };
+  /* Avoid the threading overhead for the many data-blocks with little data. */
+  if (conversion_size > 64 * 1024) {
+    blender::threading::parallel_for(
+        blocks.index_range(), 1, [&](const blender::IndexRange range) {
+          for (DataBlock &block : blocks.as_mutable_span().slice(range)) {
+            convert_block(block);
+          }
+        });
+  }
+  else {
+    for (DataBlock &block : blocks) {
+      convert_block(block);
+    }
+  }
+
+  for (const DataBlock &block : blocks) {
+#ifdef USE_BHEAD_READ_ON_DEMAND
+    if (block.bhead_full && block.bhead_full != block.bhead) {
+      MEM_freeN(BHEADN_FROM_BHEAD(block.bhead_full));
+    }
+#endif
+    if (block.data) {
+      const bool is_new = oldnewmap_insert(fd->datamap, block.bhead->old, block.data, 0);
       if (!is_new) {
         CLOG_ERROR(&LOG,
                    "Blendfile corruption: Invalid, or multiple `bhead` with same old address "
                    "value (%p) for a given ID.",
-                   bhead->old);
+                   block.bhead->old);
       }
     }
-
-    bhead = blo_bhead_next(fd, bhead);
   }
 
   return bhead;
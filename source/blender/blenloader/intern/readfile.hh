@@ -44,8 +44,10 @@ enum eFileDataFlag {
   FD_FLAGS_POINTSIZE_DIFFERS = 1 << 2,
   FD_FLAGS_FILE_OK = 1 << 3,
   FD_FLAGS_IS_MEMFILE = 1 << 4,
+  /** The #BHead list has been read from the sidecar index of the file, see #USE_BHEAD_INDEX. */
+  FD_FLAGS_HAS_BHEAD_INDEX = 1 << 5,
 };
-ENUM_OPERATORS(eFileDataFlag, FD_FLAGS_IS_MEMFILE)
+ENUM_OPERATORS(eFileDataFlag, FD_FLAGS_HAS_BHEAD_INDEX)
 
 /* Disallow since it's 32bit on ms-windows. */
 #ifdef __GNUC__
@@ -162,6 +164,11 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath) ATTR_N
  * cannot be called with relative paths anymore!
  */
 FileData *blo_filedata_from_file(const char *filepath, BlendFileReadReport *reports);
+/**
+ * Path of the #BHead index of the given blend-file in the user cache directory.
+ * \return False when there is no cache directory.
+ */
+bool blo_bhead_index_filepath(const char *filepath, char *r_index_path, size_t index_path_size);
 FileData *blo_filedata_from_memory(const void *mem, int memsize, BlendFileReadReport *reports);
 FileData *blo_filedata_from_memfile(MemFile *memfile,
                                     const BlendFileReadParams *params,
@@ -11,7 +11,10 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <array>
 #include <fcntl.h>
+#include <mutex>
+#include <string>
 
 /* open/close */
 #ifndef _WIN32
@@ -26,6 +29,9 @@
 
 #include "BLI_blenlib.h"
 #include "BLI_implicit_sharing.hh"
+#include "BLI_memory_utils.hh"
+#include "BLI_task.hh"
+#include "BLI_vector.hh"
 
 #include "BLO_readfile.hh"
 #include "BLO_undofile.hh"
@@ -34,23 +40,112 @@
 #include "BKE_main.hh"
 #include "BKE_undo_system.hh"
 
+#include <xxhash.h>
+
 #include "BLI_strict_flags.h" /* Keep last. */
 
 /* **************** support for memory-write, for undo buffers *************** */
 
+/**
+ * Header in front of the memory of every #MemFileChunk.buf. Buffers are reference counted, so
+ * that all chunks with the same content share a single buffer, in all memfiles.
+ */
+struct alignas(16) MemFileChunkBuffer {
+  int64_t users;
+  uint64_t hash;
+  size_t size;
+  /**
+   * The memfile whose #MemFile.size accounts for this buffer. This is the memfile that created
+   * the buffer, until it is merged into the next one.
+   */
+  MemFile *owner;
+};
+
+/** All chunk buffers by the hash of their content, used to de-duplicate chunks. */
+struct MemFileChunkStore {
+  std::mutex mutex;
+  blender::Map<uint64_t, MemFileChunkBuffer *> buffers;
+  MemFileMemoryStats stats;
+};
+
+static MemFileChunkStore &memfile_chunk_store()
+{
+  static MemFileChunkStore store;
+  return store;
+}
+
+static MemFileChunkBuffer *memfile_chunk_buffer_get(const char *buf)
+{
+  return reinterpret_cast<MemFileChunkBuffer *>(const_cast<char *>(buf)) - 1;
+}
+
+static const char *memfile_chunk_buffer_data(const MemFileChunkBuffer *buffer)
+{
+  return reinterpret_cast<const char *>(buffer + 1);
+}
+
+static void memfile_chunk_buffer_add_user(MemFileChunkBuffer *buffer, MemFile *memfile)
+{
+  buffer->users++;
+  if (buffer->owner == nullptr) {
+    buffer->owner = memfile;
+    memfile->size += buffer->size;
+  }
+}
+
+static void memfile_chunk_buffer_remove_user(MemFileChunkStore &store,
+                                             const char *buf,
+                                             MemFile *memfile)
+{
+  MemFileChunkBuffer *buffer = memfile_chunk_buffer_get(buf);
+  store.stats.chunks_num--;
+  store.stats.chunks_size -= buffer->size;
+  if (--buffer->users > 0) {
+    if (buffer->owner == memfile) {
+      /* Only happens when a memfile is freed before newer memfiles that use its buffers, without
+       * merging it. The next memfile that uses the buffer accounts for it. */
+      buffer->owner = nullptr;
+      memfile->size -= buffer->size;
+    }
+    return;
+  }
+  if (buffer->owner) {
+    buffer->owner->size -= buffer->size;
+  }
+  if (store.buffers.lookup_default(buffer->hash, nullptr) == buffer) {
+    store.buffers.remove(buffer->hash);
+  }
+  store.stats.buffers_num--;
+  store.stats.buffers_size -= buffer->size;
+  MEM_freeN(buffer);
+}
+
 void BLO_memfile_free(MemFile *memfile)
 {
-  while (MemFileChunk *chunk = static_cast<MemFileChunk *>(BLI_pophead(&memfile->chunks))) {
-    if (chunk->is_identical == false) {
-      MEM_freeN((void *)chunk->buf);
+  MemFileChunkStore &store = memfile_chunk_store();
+  {
+    std::lock_guard lock{store.mutex};
+    while (MemFileChunk *chunk = static_cast<MemFileChunk *>(BLI_pophead(&memfile->chunks))) {
+      memfile_chunk_buffer_remove_user(store, chunk->buf, memfile);
+      MEM_freeN(chunk);
+    }
+    if (store.buffers.is_empty()) {
+      /* Avoid keeping memory around when there is no undo data. */
+      store.buffers.clear_and_shrink();
     }
-    MEM_freeN(chunk);
   }
   MEM_delete(memfile->shared_storage);
   memfile->shared_storage = nullptr;
   memfile->size = 0;
 }
 
+MemFileMemoryStats BLO_memfile_memory_stats()
+{
+  MemFileChunkStore &store = memfile_chunk_store();
+  std::lock_guard lock{store.mutex};
+  return store.stats;
+}
+
 MemFileSharedStorage::~MemFileSharedStorage()
 {
   for (const blender::ImplicitSharingInfo *sharing_info : map.values()) {
@@ -61,32 +156,22 @@ MemFileSharedStorage::~MemFileSharedStorage()
 
 void BLO_memfile_merge(MemFile *first, MemFile *second)
 {
-  /* We use this mapping to store the memory buffers from second memfile chunks which are not owned
-   * by it (i.e. shared with some previous memory steps). */
-  blender::Map<const char *, MemFileChunk *> buffer_to_second_memchunk;
-
-  /* First, detect all memchunks in second memfile that are not owned by it. */
-  LISTBASE_FOREACH (MemFileChunk *, sc, &second->chunks) {
-    if (sc->is_identical) {
-      buffer_to_second_memchunk.add(sc->buf, sc);
-    }
-  }
-
-  /* Now, check all chunks from first memfile (the one we are removing), and if a memchunk owned by
-   * it is also used by the second memfile, transfer the ownership. */
-  LISTBASE_FOREACH (MemFileChunk *, fc, &first->chunks) {
-    if (!fc->is_identical) {
-      if (MemFileChunk *sc = buffer_to_second_memchunk.lookup_default(fc->buf, nullptr)) {
-        BLI_assert(sc->is_identical);
-        sc->is_identical = false;
-        fc->is_identical = true;
+  /* Chunk buffers are reference counted, buffers that are still used by the second memfile (or
+   * any other one) are kept alive. Only memfiles newer than the first one can use its buffers, so
+   * the second memfile accounts for them from now on. Buffers that are not used anymore are
+   * removed from its size again when freeing the first memfile. */
+  MemFileChunkStore &store = memfile_chunk_store();
+  {
+    std::lock_guard lock{store.mutex};
+    LISTBASE_FOREACH (MemFileChunk *, chunk, &first->chunks) {
+      MemFileChunkBuffer *buffer = memfile_chunk_buffer_get(chunk->buf);
+      if (buffer->owner == first) {
+        buffer->owner = second;
+        first->size -= buffer->size;
+        second->size += buffer->size;
       }
-      /* Note that if the second memfile does not use that chunk, we assume that the first one
-       * fully owns it without sharing it with any other memfile, and hence it should be freed with
-       * it. */
     }
   }
-
   BLO_memfile_free(first);
 }
 
@@ -145,11 +230,17 @@ void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t s
   curchunk->id_session_uid = mem_data->current_id_session_uid;
   BLI_addtail(&memfile->chunks, curchunk);
 
+  MemFileChunkStore &store = memfile_chunk_store();
+
   /* we compare compchunk with buf */
   if (*compchunk_step != nullptr) {
     MemFileChunk *compchunk = *compchunk_step;
     if (compchunk->size == curchunk->size) {
       if (memcmp(compchunk->buf, buf, size) == 0) {
+        std::lock_guard lock{store.mutex};
+        memfile_chunk_buffer_add_user(memfile_chunk_buffer_get(compchunk->buf), memfile);
+        store.stats.chunks_num++;
+        store.stats.chunks_size += size;
         curchunk->buf = compchunk->buf;
         curchunk->is_identical = true;
         compchunk->is_identical_future = true;
@@ -158,13 +249,99 @@ void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t s
     *compchunk_step = static_cast<MemFileChunk *>(compchunk->next);
   }
 
-  /* not equal... */
+  /* not equal to the matching chunk, but the same data may still exist in any other chunk, e.g.
+   * when data was inserted or reordered, or when changes were undone. */
   if (curchunk->buf == nullptr) {
-    char *buf_new = static_cast<char *>(MEM_mallocN(size, "Chunk buffer"));
-    memcpy(buf_new, buf, size);
-    curchunk->buf = buf_new;
-    memfile->size += size;
+    const uint64_t hash = XXH3_64bits(buf, size);
+    std::lock_guard lock{store.mutex};
+    MemFileChunkBuffer *buffer = store.buffers.lookup_default(hash, nullptr);
+    if (buffer && buffer->size == size &&
+        memcmp(memfile_chunk_buffer_data(buffer), buf, size) == 0)
+    {
+      memfile_chunk_buffer_add_user(buffer, memfile);
+    }
+    else {
+      buffer = static_cast<MemFileChunkBuffer *>(
+          MEM_mallocN(sizeof(MemFileChunkBuffer) + size, "Chunk buffer"));
+      buffer->users = 1;
+      buffer->hash = hash;
+      buffer->size = size;
+      buffer->owner = memfile;
+      memcpy(buffer + 1, buf, size);
+      /* In the unlikely case of a hash collision, the existing buffer is kept. */
+      store.buffers.add(hash, buffer);
+      store.stats.buffers_num++;
+      store.stats.buffers_size += size;
+      memfile->size += size;
+    }
+    store.stats.chunks_num++;
+    store.stats.chunks_size += size;
+    curchunk->buf = memfile_chunk_buffer_data(buffer);
+  }
+}
+
+/** Random values for every byte, used by the rolling hash of #BLO_memfile_chunk_size_find. */
+static const std::array<uint64_t, 256> &memfile_gear_table()
+{
+  static const std::array<uint64_t, 256> table = []() {
+    std::array<uint64_t, 256> table;
+    /* Split-mix 64. */
+    uint64_t state = 0;
+    for (uint64_t &value : table) {
+      state += 0x9E3779B97F4A7C15ull;
+      uint64_t z = state;
+      z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+      z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+      value = z ^ (z >> 31);
+    }
+    return table;
+  }();
+  return table;
+}
+
+size_t BLO_memfile_chunk_size_find(const char *data, const size_t size, const size_t chunk_size)
+{
+  const size_t min_size = chunk_size / 4;
+  const size_t max_size = chunk_size * 4;
+  if (size <= min_size) {
+    return size;
   }
+
+  /* The chunk ends where the high bits of a rolling hash of the last 64 bytes are zero, which
+   * happens every `chunk_size` bytes on average (after the minimum size). */
+  int mask_bits = 0;
+  while ((size_t(2) << mask_bits) <= chunk_size - min_size) {
+    mask_bits++;
+  }
+  const uint64_t mask = ~(~uint64_t(0) >> mask_bits);
+
+  const std::array<uint64_t, 256> &gear = memfile_gear_table();
+  const uchar *bytes = reinterpret_cast<const uchar *>(data);
+  const size_t end = std::min(size, max_size);
+  uint64_t hash = 0;
+  for (size_t i = min_size - std::min<size_t>(min_size, 64); i < min_size; i++) {
+    hash = (hash << 1) + gear[bytes[i]];
+  }
+  for (size_t i = min_size; i < end; i++) {
+    hash = (hash << 1) + gear[bytes[i]];
+    if ((hash & mask) == 0) {
+      return i + 1;
+    }
+  }
+  return end;
+}
+
+size_t BLO_memfile_write_chunk_size_find(const MemFileWriteData *mem_data,
+                                         const char *data,
+                                         const size_t size,
+                                         const size_t chunk_size)
+{
+  if (const MemFileChunk *compchunk = mem_data->reference_current_chunk) {
+    if (compchunk->size <= size && memcmp(compchunk->buf, data, compchunk->size) == 0) {
+      return compchunk->size;
+    }
+  }
+  return BLO_memfile_chunk_size_find(data, size, chunk_size);
 }
 
 Main *BLO_memfile_main_get(MemFile *memfile, Main *bmain, Scene **r_scene)
@@ -279,3 +456,341 @@ FileReader *BLO_memfile_new_filereader(MemFile *memfile, int undo_direction)
 
   return (FileReader *)undo;
 }
+
+/* **************** incremental writing of memfiles, for auto-save *************** */
+
+#define JOURNAL_FILE_MAGIC "BLENJRNL"
+#define JOURNAL_FILE_VERSION 1
+/** Journals smaller than this are never compacted. */
+#define JOURNAL_COMPACT_MIN_SIZE (size_t(64) * 1024 * 1024)
+
+enum class JournalRecordType : uint32_t {
+  /** Data of a single #MemFileChunk. */
+  Chunk = 1,
+  /** A #JournalSnapshotHeader followed by its #JournalSegment array. */
+  Snapshot = 2,
+};
+
+struct JournalFileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t _pad;
+};
+
+struct JournalRecordHeader {
+  uint32_t type;
+  uint32_t _pad;
+  /** Size of the data following the header. */
+  uint64_t size;
+};
+
+struct JournalSnapshotHeader {
+  uint64_t segments_num;
+  /** Size of the file that is made of all segments. */
+  uint64_t file_size;
+  /** Hash of the segments, to detect snapshots that were not fully written. */
+  uint64_t checksum;
+};
+
+/** Continuous range of the journal that is part of a snapshot. */
+struct JournalSegment {
+  uint64_t offset;
+  uint64_t size;
+};
+
+/** Location of a written #MemFileChunk in the journal. */
+struct JournalChunk {
+  size_t size;
+  /** Hash of the content, guards against chunk buffers that were freed and reused in between. */
+  uint64_t hash;
+  uint64_t offset;
+};
+
+struct MemFileJournal {
+  std::string filepath;
+  /** Opened for appending, null when the journal has to be (re)written from scratch. */
+  FILE *file = nullptr;
+  uint64_t file_size = 0;
+  /** The chunks of the last written memfile, by their buffer. */
+  blender::Map<const char *, JournalChunk> chunks;
+};
+
+MemFileJournal *BLO_memfile_journal_new(const char *filepath)
+{
+  MemFileJournal *journal = MEM_new<MemFileJournal>(__func__);
+  journal->filepath = filepath;
+  return journal;
+}
+
+void BLO_memfile_journal_free(MemFileJournal *journal)
+{
+  if (journal->file) {
+    fclose(journal->file);
+  }
+  MEM_delete(journal);
+}
+
+const char *BLO_memfile_journal_filepath(const MemFileJournal *journal)
+{
+  return journal->filepath.c_str();
+}
+
+static bool journal_write(MemFileJournal *journal, const void *data, const size_t size)
+{
+  if (fwrite(data, 1, size, journal->file) != size) {
+    return false;
+  }
+  journal->file_size += size;
+  return true;
+}
+
+static bool journal_write_record_header(MemFileJournal *journal,
+                                        const JournalRecordType type,
+                                        const size_t size)
+{
+  JournalRecordHeader header{};
+  header.type = uint32_t(type);
+  header.size = size;
+  return journal_write(journal, &header, sizeof(header));
+}
+
+static uint64_t journal_snapshot_checksum(const JournalSnapshotHeader &snapshot,
+                                          const blender::Span<JournalSegment> segments)
+{
+  return XXH3_64bits_withSeed(segments.data(),
+                              size_t(segments.size_in_bytes()),
+                              snapshot.segments_num ^ (snapshot.file_size << 1));
+}
+
+static bool journal_write_memfile(MemFileJournal *journal, const MemFile *memfile)
+{
+  using namespace blender;
+  Vector<const MemFileChunk *> chunks;
+  size_t file_size = 0;
+  LISTBASE_FOREACH (const MemFileChunk *, chunk, &memfile->chunks) {
+    chunks.append(chunk);
+    file_size += chunk->size;
+  }
+
+  /* Hashing is only needed to validate unchanged chunks, but doing it for all of them is simpler
+   * and still much cheaper than writing them. */
+  Array<uint64_t> hashes(chunks.size());
+  threading::parallel_for(chunks.index_range(), 256, [&](const IndexRange range) {
+    for (const int64_t i : range) {
+      hashes[i] = XXH3_64bits(chunks[i]->buf, chunks[i]->size);
+    }
+  });
+
+  Map<const char *, JournalChunk> written_chunks;
+  written_chunks.reserve(chunks.size());
+  Vector<JournalSegment> segments;
+  for (const int64_t i : chunks.index_range()) {
+    const MemFileChunk *chunk = chunks[i];
+    JournalChunk journal_chunk;
+    const JournalChunk *prev_chunk = journal->chunks.lookup_ptr(chunk->buf);
+    if (prev_chunk && prev_chunk->size == chunk->size && prev_chunk->hash == hashes[i]) {
+      journal_chunk = *prev_chunk;
+    }
+    else {
+      if (!journal_write_record_header(journal, JournalRecordType::Chunk, chunk->size)) {
+        return false;
+      }
+      journal_chunk.size = chunk->size;
+      journal_chunk.hash = hashes[i];
+      journal_chunk.offset = journal->file_size;
+      if (!journal_write(journal, chunk->buf, chunk->size)) {
+        return false;
+      }
+    }
+    written_chunks.add(chunk->buf, journal_chunk);
+
+    if (!segments.is_empty() &&
+        segments.last().offset + segments.last().size == journal_chunk.offset)
+    {
+      segments.last().size += chunk->size;
+    }
+    else {
+      segments.append({journal_chunk.offset, chunk->size});
+    }
+  }
+
+  JournalSnapshotHeader snapshot{};
+  snapshot.segments_num = uint64_t(segments.size());
+  snapshot.file_size = file_size;
+  snapshot.checksum = journal_snapshot_checksum(snapshot, segments);
+  const size_t segments_size = size_t(segments.as_span().size_in_bytes());
+  if (!journal_write_record_header(
+          journal, JournalRecordType::Snapshot, sizeof(snapshot) + segments_size) ||
+      !journal_write(journal, &snapshot, sizeof(snapshot)) ||
+      !journal_write(journal, segments.data(), segments_size))
+  {
+    return false;
+  }
+  if (fflush(journal->file) != 0) {
+    return false;
+  }
+
+  journal->chunks = std::move(written_chunks);
+  return true;
+}
+
+bool BLO_memfile_journal_write(MemFileJournal *journal, const MemFile *memfile)
+{
+  size_t file_size = 0;
+  LISTBASE_FOREACH (const MemFileChunk *, chunk, &memfile->chunks) {
+    file_size += chunk->size;
+  }
+
+  /* Compact the journal when most of it is not referenced by the latest snapshot anymore.
+   * A new journal is written next to the existing one, so that there always is a file that can
+   * be recovered. */
+  const bool compact = journal->file == nullptr ||
+                       (journal->file_size > JOURNAL_COMPACT_MIN_SIZE &&
+                        journal->file_size > file_size * 2);
+  const std::string filepath_tmp = journal->filepath + "@";
+  if (compact) {
+    if (journal->file) {
+      fclose(journal->file);
+    }
+    journal->chunks.clear();
+    journal->file_size = 0;
+    journal->file = BLI_fopen(filepath_tmp.c_str(), "wb");
+    if (journal->file == nullptr) {
+      return false;
+    }
+    JournalFileHeader header{};
+    memcpy(header.magic, JOURNAL_FILE_MAGIC, sizeof(header.magic));
+    header.version = JOURNAL_FILE_VERSION;
+    if (!journal_write(journal, &header, sizeof(header))) {
+      fclose(journal->file);
+      journal->file = nullptr;
+      return false;
+    }
+  }
+
+  bool success = journal_write_memfile(journal, memfile);
+  if (success && compact) {
+    fclose(journal->file);
+    journal->file = nullptr;
+    if (BLI_rename_overwrite(filepath_tmp.c_str(), journal->filepath.c_str()) == 0) {
+      journal->file = BLI_fopen(journal->filepath.c_str(), "ab");
+    }
+    success = journal->file != nullptr;
+  }
+  if (!success) {
+    if (journal->file) {
+      fclose(journal->file);
+      journal->file = nullptr;
+    }
+    journal->chunks.clear();
+  }
+  return success;
+}
+
+/** Find the segments of the last snapshot that was written completely. */
+static bool journal_read_last_snapshot(FILE *file,
+                                       const uint64_t journal_size,
+                                       blender::Vector<JournalSegment> &r_segments)
+{
+  JournalFileHeader header;
+  if (fread(&header, sizeof(header), 1, file) != 1 ||
+      memcmp(header.magic, JOURNAL_FILE_MAGIC, sizeof(header.magic)) != 0 ||
+      header.version != JOURNAL_FILE_VERSION)
+  {
+    return false;
+  }
+
+  bool found = false;
+  uint64_t offset = sizeof(header);
+  JournalRecordHeader record;
+  while (fread(&record, sizeof(record), 1, file) == 1) {
+    const uint64_t record_offset = offset;
+    offset += sizeof(record);
+    if (record.size > journal_size - offset) {
+      /* Truncated record. */
+      break;
+    }
+    if (record.type == uint32_t(JournalRecordType::Snapshot)) {
+      JournalSnapshotHeader snapshot;
+      if (record.size < sizeof(snapshot) || fread(&snapshot, sizeof(snapshot), 1, file) != 1 ||
+          snapshot.segments_num != (record.size - sizeof(snapshot)) / sizeof(JournalSegment))
+      {
+        break;
+      }
+      blender::Vector<JournalSegment> segments(int64_t(snapshot.segments_num));
+      if (fread(segments.data(), sizeof(JournalSegment), segments.size(), file) !=
+          segments.size())
+      {
+        break;
+      }
+      if (journal_snapshot_checksum(snapshot, segments) != snapshot.checksum) {
+        break;
+      }
+      uint64_t file_size = 0;
+      bool segments_valid = true;
+      for (const JournalSegment &segment : segments) {
+        segments_valid &= segment.offset + segment.size <= record_offset;
+        file_size += segment.size;
+      }
+      if (!segments_valid || file_size != snapshot.file_size) {
+        break;
+      }
+      r_segments = std::move(segments);
+      found = true;
+    }
+    else if (BLI_fseek(file, int64_t(record.size), SEEK_CUR) != 0) {
+      break;
+    }
+    offset += record.size;
+  }
+  return found;
+}
+
+bool BLO_memfile_journal_recover(const char *journal_filepath, const char *filepath)
+{
+  FILE *file = BLI_fopen(journal_filepath, "rb");
+  if (file == nullptr) {
+    return false;
+  }
+  BLI_SCOPED_DEFER([&]() { fclose(file); });
+
+  const size_t journal_size = BLI_file_descriptor_size(fileno(file));
+  if (journal_size == size_t(-1)) {
+    return false;
+  }
+  blender::Vector<JournalSegment> segments;
+  if (!journal_read_last_snapshot(file, journal_size, segments)) {
+    return false;
+  }
+
+  const std::string filepath_tmp = std::string(filepath) + "@";
+  FILE *file_out = BLI_fopen(filepath_tmp.c_str(), "wb");
+  if (file_out == nullptr) {
+    return false;
+  }
+  bool success = true;
+  blender::Array<char> buffer(1024 * 1024);
+  for (const JournalSegment &segment : segments) {
+    if (BLI_fseek(file, int64_t(segment.offset), SEEK_SET) != 0) {
+      success = false;
+      break;
+    }
+    for (uint64_t done = 0; done < segment.size && success;) {
+      const size_t size = size_t(std::min<uint64_t>(segment.size - done, uint64_t(buffer.size())));
+      success = fread(buffer.data(), 1, size, file) == size &&
+                fwrite(buffer.data(), 1, size, file_out) == size;
+      done += size;
+    }
+    if (!success) {
+      break;
+    }
+  }
+  success &= fclose(file_out) == 0;
+  if (success) {
+    success = BLI_rename_overwrite(filepath_tmp.c_str(), filepath) == 0;
+  }
+  if (!success) {
+    BLI_delete(filepath_tmp.c_str(), false, false);
+  }
+  return success;
+}
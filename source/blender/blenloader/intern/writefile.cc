@@ -97,7 +97,9 @@
 #include "BLI_math_base.h"
 #include "BLI_mempool.h"
 #include "BLI_set.hh"
+#include "BLI_task.hh"
 #include "BLI_threads.h"
+#include "BLI_vector.hh"
 
 #include "MEM_guardedalloc.h" /* MEM_freeN */
 
@@ -151,6 +153,11 @@ static CLG_LogRef LOG = {"blo.writefile"};
 /** Use if we want to store how many bytes have been written to the file. */
 // #define USE_WRITE_DATA_LEN
 
+/**
+ * Serialize IDs of some types on multiple threads when writing files, see #write_ids_parallel.
+ */
+#define USE_PARALLEL_ID_WRITE
+
 /* -------------------------------------------------------------------- */
 /** \name Internal Write Wrapper's (Abstracts Compression)
  * \{ */
@@ -399,6 +406,19 @@ bool ZstdWriteWrap::write(const void *buf, size_t buf_len)
 /** \name Write Data Type & Functions
  * \{ */
 
+/**
+ * Writes of an ID that is serialized on a worker thread. The data is recorded together with the
+ * size of every #mywrite call, so that replaying it results in exactly the same output as writing
+ * the ID directly.
+ */
+struct WriteRecording {
+  blender::Vector<uchar> data;
+  /** Size of every #mywrite call, or #WRITE_RECORDING_FLUSH for #mywrite_flush calls. */
+  blender::Vector<size_t> write_sizes;
+};
+
+#define WRITE_RECORDING_FLUSH SIZE_MAX
+
 struct WriteData {
   const SDNA *sdna;
 
@@ -453,6 +473,9 @@ struct WriteData {
    * Will be nullptr for UNDO.
    */
   WriteWrap *ww;
+
+  /** When set, all writes are recorded instead, see #write_ids_parallel. */
+  WriteRecording *recording;
 };
 
 struct BlendWriter {
@@ -528,6 +551,10 @@ static void writedata_free(WriteData *wd)
  */
 static void mywrite_flush(WriteData *wd)
 {
+  if (wd->recording) {
+    wd->recording->write_sizes.append(WRITE_RECORDING_FLUSH);
+    return;
+  }
   if (wd->buffer.used_len != 0) {
     writedata_do_write(wd, wd->buffer.buf, wd->buffer.used_len);
     wd->buffer.used_len = 0;
@@ -550,6 +577,12 @@ static void mywrite(WriteData *wd, const void *adr, size_t len)
     return;
   }
 
+  if (wd->recording) {
+    wd->recording->data.extend(blender::Span(static_cast<const uchar *>(adr), int64_t(len)));
+    wd->recording->write_sizes.append(len);
+    return;
+  }
+
 #ifdef USE_WRITE_DATA_LEN
   wd->write_len += len;
 #endif
@@ -567,7 +600,13 @@ static void mywrite(WriteData *wd, const void *adr, size_t len)
       }
 
       do {
-        size_t writelen = std::min(len, wd->buffer.chunk_size);
+        /* For undo, split the data where its content allows sharing the chunks with previous
+         * undo steps, even when data was inserted or removed. */
+        const size_t writelen =
+            wd->use_memfile ?
+                BLO_memfile_write_chunk_size_find(
+                    &wd->mem, static_cast<const char *>(adr), len, wd->buffer.chunk_size) :
+                std::min(len, wd->buffer.chunk_size);
         writedata_do_write(wd, adr, writelen);
         adr = (const char *)adr + writelen;
         len -= writelen;
@@ -1285,6 +1324,87 @@ static int write_id_direct_linked_data_process_cb(LibraryIDLinkCallbackData *cb_
   return IDWALK_RET_NOP;
 }
 
+/**
+ * Write a single ID and all of its data.
+ * \param id_buffer: Must be initialized for the type of the ID already.
+ */
+static void write_id(WriteData *wd, BLO_Write_IDBuffer *id_buffer, ID *id)
+{
+  const IDTypeInfo *id_type = BKE_idtype_get_info_from_id(id);
+  BlendWriter writer = {wd};
+
+  mywrite_id_begin(wd, id);
+
+  id_buffer_init_from_id(id_buffer, id, wd->use_memfile);
+
+  if (id_type->blend_write != nullptr) {
+    id_type->blend_write(&writer, static_cast<ID *>(id_buffer->temp_id), id);
+  }
+
+  mywrite_id_end(wd, id);
+}
+
+#ifdef USE_PARALLEL_ID_WRITE
+
+/**
+ * ID types whose #IDTypeInfo.blend_write only modifies the temporary copy of the ID, and never
+ * data that is shared with other IDs, so that multiple IDs can be serialized at the same time.
+ * These are also the types that typically hold most of the data in big files.
+ */
+static bool id_type_supports_parallel_write(const IDTypeInfo *id_type)
+{
+  return ELEM(id_type->id_code, ID_ME, ID_CV, ID_PT);
+}
+
+/**
+ * Serialize the IDs on multiple threads into separate recordings, which are then written in
+ * order. The output is identical to writing the IDs one after another with #write_id.
+ * All IDs are expected to have the same type.
+ */
+static void write_ids_parallel(WriteData *wd,
+                               BLO_Write_IDBuffer *id_buffer,
+                               const blender::Span<ID *> ids)
+{
+  using namespace blender;
+  if (ids.size() < 2) {
+    for (ID *id : ids) {
+      write_id(wd, id_buffer, id);
+    }
+    return;
+  }
+
+  const IDTypeInfo *id_type = BKE_idtype_get_info_from_id(ids.first());
+  Array<WriteRecording> recordings(ids.size());
+  threading::parallel_for(ids.index_range(), 1, [&](const IndexRange range) {
+    BLO_Write_IDBuffer *thread_id_buffer = BLO_write_allocate_id_buffer();
+    id_buffer_init_for_id_type(thread_id_buffer, id_type);
+    for (const int64_t i : range) {
+      WriteData *recording_wd = MEM_new<WriteData>(__func__);
+      recording_wd->sdna = wd->sdna;
+      recording_wd->recording = &recordings[i];
+      write_id(recording_wd, thread_id_buffer, ids[i]);
+      writedata_free(recording_wd);
+    }
+    BLO_write_destroy_id_buffer(&thread_id_buffer);
+  });
+
+  for (WriteRecording &recording : recordings) {
+    const uchar *data = recording.data.data();
+    for (const size_t size : recording.write_sizes) {
+      if (size == WRITE_RECORDING_FLUSH) {
+        mywrite_flush(wd);
+      }
+      else if (size > 0) {
+        mywrite(wd, data, size);
+        data += size;
+      }
+    }
+    recording = {};
+  }
+}
+
+#endif
+
 /**
  * When #MemFile arguments are non-null, this is a file-safe to memory.
  *
@@ -1379,6 +1499,11 @@ static bool write_file_handle(Main *mainvar,
    * if needed, without duplicating whole code. */
   Main *bmain = mainvar;
   BLO_Write_IDBuffer *id_buffer = BLO_write_allocate_id_buffer();
+#ifdef USE_PARALLEL_ID_WRITE
+  /* Limits the memory used by recorded IDs that have not been written yet. */
+  const int64_t parallel_batch_size = std::max(2, BLI_system_thread_count());
+  blender::Vector<ID *> parallel_ids;
+#endif
   do {
     ListBase *lbarray[INDEX_ID_MAX];
     int a = set_listbasepointers(bmain, lbarray);
@@ -1451,25 +1576,36 @@ static bool write_file_handle(Main *mainvar,
                                       IDWALK_READONLY | IDWALK_INCLUDE_UI);
         }
 
+#ifdef USE_PARALLEL_ID_WRITE
+        if (!wd->use_memfile && !do_override && id_type_supports_parallel_write(id_type)) {
+          parallel_ids.append(id);
+          if (parallel_ids.size() >= parallel_batch_size) {
+            write_ids_parallel(wd, id_buffer, parallel_ids);
+            parallel_ids.clear();
+          }
+          continue;
+        }
+        /* Keep the order of the IDs in the file. */
+        write_ids_parallel(wd, id_buffer, parallel_ids);
+        parallel_ids.clear();
+#endif
+
         if (do_override) {
           BKE_lib_override_library_operations_store_start(bmain, override_storage, id);
         }
 
-        mywrite_id_begin(wd, id);
-
-        id_buffer_init_from_id(id_buffer, id, wd->use_memfile);
-
-        if (id_type->blend_write != nullptr) {
-          id_type->blend_write(&writer, static_cast<ID *>(id_buffer->temp_id), id);
-        }
+        write_id(wd, id_buffer, id);
 
         if (do_override) {
           BKE_lib_override_library_operations_store_end(override_storage, id);
         }
-
-        mywrite_id_end(wd, id);
       }
 
+#ifdef USE_PARALLEL_ID_WRITE
+      write_ids_parallel(wd, id_buffer, parallel_ids);
+      parallel_ids.clear();
+#endif
+
       mywrite_flush(wd);
     }
   } while ((bmain != override_storage) && (bmain = override_storage));
@@ -0,0 +1,136 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+#include "blendfile_loading_base_test.h"
+
+#include "BKE_appdir.hh"
+#include "BKE_customdata.hh"
+#include "BKE_global.hh"
+#include "BKE_lib_id.hh"
+#include "BKE_main.hh"
+#include "BKE_mesh.hh"
+
+#include "BLI_fileops.h"
+#include "BLI_listbase.h"
+#include "BLI_math_vector_types.hh"
+#include "BLI_path_util.h"
+
+#include "BLO_readfile.hh"
+#include "BLO_writefile.hh"
+
+#include "DNA_mesh_types.h"
+#include "DNA_userdef_types.h"
+
+#include "../intern/readfile.hh"
+
+namespace blender::blo::tests {
+
+/** Large enough for the index to be used, see #BHEAD_INDEX_MIN_FILE_SIZE. */
+static constexpr int test_verts_num = 2 << 20;
+
+class BlendfileBHeadIndexTest : public BlendfileLoadingBaseTest {
+ protected:
+  char filepath_[FILE_MAX] = "";
+  char index_path_[FILE_MAX] = "";
+
+  void SetUp() override
+  {
+    BlendfileLoadingBaseTest::SetUp();
+    U.experimental.use_blend_file_bhead_index = 1;
+  }
+
+  void TearDown() override
+  {
+    U.experimental.use_blend_file_bhead_index = 0;
+    BlendfileLoadingBaseTest::TearDown();
+    if (index_path_[0]) {
+      BLI_delete(index_path_, false, false);
+    }
+    if (filepath_[0]) {
+      BLI_delete(filepath_, false, false);
+    }
+  }
+
+  /** Write a file with a single mesh, whose positions are most of the file data. */
+  bool write_test_file(const int write_flags)
+  {
+    BLI_path_join(filepath_, sizeof(filepath_), BKE_tempdir_session(), "bhead_index_test.blend");
+
+    Main *bmain = BKE_main_new();
+    Mesh *mesh = static_cast<Mesh *>(BKE_id_new(bmain, ID_ME, "Mesh"));
+    id_fake_user_set(&mesh->id);
+    mesh->verts_num = test_verts_num;
+    CustomData_add_layer_named(
+        &mesh->vert_data, CD_PROP_FLOAT3, CD_CONSTRUCT, mesh->verts_num, "position");
+    MutableSpan<float3> positions = mesh->vert_positions_for_write();
+    for (const int i : positions.index_range()) {
+      positions[i] = float3(float(i), 0.0f, 1.0f);
+    }
+
+    BlendFileWriteParams params{};
+    const bool success = BLO_write_file(bmain, filepath_, write_flags, &params, nullptr);
+    BKE_main_free(bmain);
+    if (!success || !blo_bhead_index_filepath(filepath_, index_path_, sizeof(index_path_))) {
+      return false;
+    }
+    /* Remove any index left by an earlier run. */
+    BLI_delete(index_path_, false, false);
+    return true;
+  }
+
+  /** Open the file and return the number of its blocks. */
+  int open_file(bool &r_has_bhead_index)
+  {
+    BlendFileReadReport reports{};
+    FileData *fd = blo_filedata_from_file(filepath_, &reports);
+    if (fd == nullptr) {
+      return 0;
+    }
+    r_has_bhead_index = (fd->flags & FD_FLAGS_HAS_BHEAD_INDEX) != 0;
+    /* Make sure all blocks are known. */
+    BHead *bhead = blo_bhead_first(fd);
+    while (bhead) {
+      bhead = blo_bhead_next(fd, bhead);
+    }
+    const int bheads_num = BLI_listbase_count(&fd->bhead_list);
+    blo_filedata_free(fd);
+    return bheads_num;
+  }
+
+  void test_write_and_read_index()
+  {
+    bool has_bhead_index = false;
+    const int bheads_num = open_file(has_bhead_index);
+    EXPECT_GT(bheads_num, 0);
+    EXPECT_FALSE(has_bhead_index);
+    ASSERT_TRUE(BLI_exists(index_path_));
+
+    EXPECT_EQ(open_file(has_bhead_index), bheads_num);
+    EXPECT_TRUE(has_bhead_index);
+
+    /* Data blocks are read on demand at the offsets from the index. */
+    BlendFileReadReport reports{};
+    bfile = BLO_read_from_file(filepath_, BLO_READ_SKIP_NONE, &reports);
+    ASSERT_NE(bfile, nullptr);
+    const Mesh *mesh = static_cast<const Mesh *>(bfile->main->meshes.first);
+    ASSERT_NE(mesh, nullptr);
+    ASSERT_EQ(mesh->verts_num, test_verts_num);
+    const Span<float3> positions = mesh->vert_positions();
+    EXPECT_EQ(positions.first(), float3(0.0f, 0.0f, 1.0f));
+    EXPECT_EQ(positions.last(), float3(float(test_verts_num - 1), 0.0f, 1.0f));
+  }
+};
+
+TEST_F(BlendfileBHeadIndexTest, uncompressed)
+{
+  ASSERT_TRUE(write_test_file(0));
+  test_write_and_read_index();
+}
+
+TEST_F(BlendfileBHeadIndexTest, compressed)
+{
+  ASSERT_TRUE(write_test_file(G_FILE_COMPRESS));
+  test_write_and_read_index();
+}
+
+}  // namespace blender::blo::tests
@@ -0,0 +1,119 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "testing/testing.h"
+
+#include <string>
+
+#include "BKE_appdir.hh"
+
+#include "BLI_fileops.h"
+#include "BLI_path_util.h"
+#include "BLI_vector.hh"
+
+#include "BLO_undofile.hh"
+
+#include "MEM_guardedalloc.h"
+
+namespace blender::blo::tests {
+
+class MemFileJournalTest : public testing::Test {
+ protected:
+  void SetUp() override
+  {
+    BKE_tempdir_init(nullptr);
+  }
+
+  void TearDown() override
+  {
+    BKE_tempdir_session_purge();
+  }
+
+  static std::string temp_filepath(const char *filename)
+  {
+    return std::string(BKE_tempdir_session()) + SEP_STR + filename;
+  }
+
+  static std::string read_file(const std::string &filepath)
+  {
+    size_t size = 0;
+    void *data = BLI_file_read_binary_as_mem(filepath.c_str(), 0, &size);
+    if (data == nullptr) {
+      return "";
+    }
+    std::string str(static_cast<const char *>(data), size);
+    MEM_freeN(data);
+    return str;
+  }
+};
+
+/** Write the chunks into a memfile, sharing unchanged chunks with the reference memfile. */
+static void memfile_from_chunks(MemFile &memfile,
+                                MemFile *reference,
+                                const Span<std::string> chunks)
+{
+  MemFileWriteData mem_data;
+  BLO_memfile_write_init(&mem_data, &memfile, reference);
+  for (const std::string &chunk : chunks) {
+    BLO_memfile_chunk_add(&mem_data, chunk.data(), chunk.size());
+  }
+  BLO_memfile_write_finalize(&mem_data);
+}
+
+static std::string join(const Span<std::string> chunks)
+{
+  std::string str;
+  for (const std::string &chunk : chunks) {
+    str += chunk;
+  }
+  return str;
+}
+
+TEST_F(MemFileJournalTest, incremental_write_and_recover)
+{
+  const std::string journal_filepath = temp_filepath("test.blend.journal");
+  const std::string recovered_filepath = temp_filepath("recovered.blend");
+
+  const Vector<std::string> chunks_a = {
+      "BLENDER-v500", std::string(10000, 'a'), std::string(20000, 'b'), "ENDB"};
+  Vector<std::string> chunks_b = chunks_a;
+  chunks_b[2] = std::string(20000, 'c');
+  chunks_b.insert(3, std::string(500, 'd'));
+
+  MemFile memfile_a{};
+  MemFile memfile_b{};
+  memfile_from_chunks(memfile_a, nullptr, chunks_a);
+  memfile_from_chunks(memfile_b, &memfile_a, chunks_b);
+
+  MemFileJournal *journal = BLO_memfile_journal_new(journal_filepath.c_str());
+  EXPECT_TRUE(BLO_memfile_journal_write(journal, &memfile_a));
+  const size_t size_a = BLI_file_size(journal_filepath.c_str());
+  EXPECT_TRUE(BLO_memfile_journal_recover(journal_filepath.c_str(), recovered_filepath.c_str()));
+  EXPECT_EQ(read_file(recovered_filepath), join(chunks_a));
+
+  /* Only the changed and new chunks are appended. */
+  EXPECT_TRUE(BLO_memfile_journal_write(journal, &memfile_b));
+  const size_t size_b = BLI_file_size(journal_filepath.c_str());
+  EXPECT_GT(size_b - size_a, size_t(20500));
+  EXPECT_LT(size_b - size_a, size_t(21000));
+  EXPECT_TRUE(BLO_memfile_journal_recover(journal_filepath.c_str(), recovered_filepath.c_str()));
+  EXPECT_EQ(read_file(recovered_filepath), join(chunks_b));
+  BLO_memfile_journal_free(journal);
+
+  /* A snapshot that was not written completely falls back to the previous one. */
+  std::string journal_data = read_file(journal_filepath);
+  journal_data.resize(journal_data.size() - 8);
+  FILE *file = BLI_fopen(journal_filepath.c_str(), "wb");
+  fwrite(journal_data.data(), 1, journal_data.size(), file);
+  fclose(file);
+  EXPECT_TRUE(BLO_memfile_journal_recover(journal_filepath.c_str(), recovered_filepath.c_str()));
+  EXPECT_EQ(read_file(recovered_filepath), join(chunks_a));
+
+  BLO_memfile_free(&memfile_b);
+  BLO_memfile_free(&memfile_a);
+  BLI_delete(journal_filepath.c_str(), false, false);
+  BLI_delete(recovered_filepath.c_str(), false, false);
+}
+
+}  // namespace blender::blo::tests
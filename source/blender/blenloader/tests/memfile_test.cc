@@ -0,0 +1,112 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "testing/testing.h"
+
+#include <string>
+
+#include "BLI_rand.hh"
+#include "BLI_set.hh"
+#include "BLI_vector.hh"
+
+#include "BLO_undofile.hh"
+
+namespace blender::blo::tests {
+
+static void memfile_from_chunks(MemFile &memfile,
+                                MemFile *reference,
+                                const Span<std::string> chunks)
+{
+  MemFileWriteData mem_data;
+  BLO_memfile_write_init(&mem_data, &memfile, reference);
+  for (const std::string &chunk : chunks) {
+    BLO_memfile_chunk_add(&mem_data, chunk.data(), chunk.size());
+  }
+  BLO_memfile_write_finalize(&mem_data);
+}
+
+TEST(memfile, shared_chunks)
+{
+  const MemFileMemoryStats stats_begin = BLO_memfile_memory_stats();
+
+  const std::string a(1000, 'a'), b(2000, 'b'), c(3000, 'c');
+  MemFile memfile_1{};
+  MemFile memfile_2{};
+  MemFile memfile_3{};
+  memfile_from_chunks(memfile_1, nullptr, {a, b, c});
+  /* Reordered chunks are not identical to the previous step, but still share memory. */
+  memfile_from_chunks(memfile_2, &memfile_1, {b, a, c});
+  memfile_from_chunks(memfile_3, &memfile_2, {b, b, std::string(100, 'd')});
+  EXPECT_EQ(memfile_1.size, 6000);
+  EXPECT_EQ(memfile_2.size, 0);
+  EXPECT_EQ(memfile_3.size, 100);
+
+  const MemFileChunk *chunk = static_cast<const MemFileChunk *>(memfile_2.chunks.first);
+  EXPECT_FALSE(chunk->is_identical);
+  EXPECT_TRUE(static_cast<const MemFileChunk *>(memfile_2.chunks.last)->is_identical);
+
+  MemFileMemoryStats stats = BLO_memfile_memory_stats();
+  EXPECT_EQ(stats.chunks_num - stats_begin.chunks_num, 9);
+  EXPECT_EQ(stats.chunks_size - stats_begin.chunks_size, 16100);
+  EXPECT_EQ(stats.buffers_num - stats_begin.buffers_num, 4);
+  EXPECT_EQ(stats.buffers_size - stats_begin.buffers_size, 6100);
+
+  /* Buffers stay alive as long as any memfile uses them, the next memfile accounts for them after
+   * merging. */
+  BLO_memfile_merge(&memfile_1, &memfile_2);
+  EXPECT_EQ(memfile_2.size, 6000);
+  BLO_memfile_merge(&memfile_2, &memfile_3);
+  EXPECT_EQ(memfile_3.size, 2100);
+  stats = BLO_memfile_memory_stats();
+  EXPECT_EQ(stats.buffers_num - stats_begin.buffers_num, 2);
+  EXPECT_EQ(stats.buffers_size - stats_begin.buffers_size, memfile_3.size);
+  const MemFileChunk *chunk_3 = static_cast<const MemFileChunk *>(memfile_3.chunks.first);
+  EXPECT_EQ(std::string(chunk_3->buf, chunk_3->size), b);
+
+  BLO_memfile_free(&memfile_3);
+  stats = BLO_memfile_memory_stats();
+  EXPECT_EQ(stats.chunks_num, stats_begin.chunks_num);
+  EXPECT_EQ(stats.buffers_size, stats_begin.buffers_size);
+}
+
+static Vector<std::string> split_content_defined(const std::string &data, const size_t chunk_size)
+{
+  Vector<std::string> chunks;
+  for (size_t offset = 0; offset < data.size();) {
+    const size_t size = BLO_memfile_chunk_size_find(
+        data.data() + offset, data.size() - offset, chunk_size);
+    chunks.append(data.substr(offset, size));
+    offset += size;
+  }
+  return chunks;
+}
+
+TEST(memfile, content_defined_chunks)
+{
+  const size_t chunk_size = 32 * 1024;
+  RandomNumberGenerator rng(0);
+  std::string data(4 * 1024 * 1024, '\0');
+  for (char &c : data) {
+    c = char(rng.get_int32(256));
+  }
+  const Vector<std::string> chunks = split_content_defined(data, chunk_size);
+  for (const std::string &chunk : chunks.as_span().drop_back(1)) {
+    EXPECT_GE(chunk.size(), chunk_size / 4);
+    EXPECT_LE(chunk.size(), chunk_size * 4);
+  }
+  EXPECT_GT(chunks.size(), data.size() / chunk_size / 2);
+  EXPECT_LT(chunks.size(), data.size() / chunk_size * 2);
+
+  /* Inserting data only changes the chunks around it. */
+  std::string data_inserted = data;
+  data_inserted.insert(data.size() / 3, "inserted");
+  const Set<std::string> chunks_set(chunks.as_span());
+  int shared_num = 0;
+  for (const std::string &chunk : split_content_defined(data_inserted, chunk_size)) {
+    shared_num += chunks_set.contains(chunk);
+  }
+  EXPECT_GE(shared_num, chunks.size() - 3);
+}
+
+}  // namespace blender::blo::tests
@@ -316,6 +316,9 @@ static void bake_geometry_nodes_startjob(void *customdata, wmJobWorkerStatus *wo
                     (frame_file_name + ".json").c_str());
       BLI_file_ensure_parent_dir_exists(meta_path);
       bake::DiskBlobWriter blob_writer{path.blobs_dir, frame_file_name};
+      if (const NodesModifierBake *bake = nmd.find_bake(request.bake_id)) {
+        blob_writer.set_compress_arrays(bake->flag & NODES_MODIFIER_BAKE_COMPRESS);
+      }
       fstream meta_file{meta_path, std::ios::out};
       bake::serialize_bake(frame_cache.state, blob_writer, *request.blob_sharing, meta_file);
     }
@@ -14,6 +14,8 @@
 #include "BLI_ghash.h"
 #include "BLI_listbase.h"
 
+#include "CLG_log.h"
+
 #include "DNA_ID.h"
 #include "DNA_collection_types.h"
 #include "DNA_node_types.h"
@@ -45,6 +47,8 @@
 
 #include <cstdio>
 
+static CLG_LogRef LOG = {"ed.undo.memfile"};
+
 /* -------------------------------------------------------------------- */
 /** \name Implements ED Undo System
  * \{ */
@@ -87,6 +91,20 @@ static bool memfile_undosys_step_encode(bContext * /*C*/, Main *bmain, UndoStep
   us->data = BKE_memfile_undo_encode(bmain, us_prev ? us_prev->data : nullptr);
   us->step.data_size = us->data->undo_size;
 
+  if (CLOG_CHECK(&LOG, 1)) {
+    const MemFileMemoryStats stats = BLO_memfile_memory_stats();
+    CLOG_INFO(&LOG,
+              1,
+              "step size: %zu KB, all steps: %zu chunks (%zu KB), %zu unique (%zu KB, %.1f%%)",
+              us->data->undo_size / 1024,
+              stats.chunks_num,
+              stats.chunks_size / 1024,
+              stats.buffers_num,
+              stats.buffers_size / 1024,
+              stats.chunks_size ? 100.0 * double(stats.buffers_size) / double(stats.chunks_size) :
+                                  100.0);
+  }
+
   /* Store the fact that we should not re-use old data with that undo step, and reset the Main
    * flag. */
   us->step.use_old_bmain_data = !bmain->use_memfile_full_barrier;
@@ -319,6 +337,8 @@ static void memfile_undosys_step_free(UndoStep *us_p)
     if (us_next_p != nullptr) {
       MemFileUndoStep *us_next = (MemFileUndoStep *)us_next_p;
       BLO_memfile_merge(&us->data->memfile, &us_next->data->memfile);
+      us_next->data->undo_size = us_next->data->memfile.size;
+      us_next_p->data_size = us_next->data->undo_size;
     }
   }
 
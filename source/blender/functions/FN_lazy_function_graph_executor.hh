@@ -11,6 +11,7 @@
  * another #Graph again).
  */
 
+#include "BLI_timeit.hh"
 #include "BLI_vector.hh"
 #include "BLI_vector_set.hh"
 
@@ -37,6 +38,14 @@ class GraphExecutorLogger {
                                       const Params &params,
                                       const Context &context) const;
 
+  /**
+   * Called every time a node has been executed, with the time it took. A node may be executed
+   * multiple times in the same evaluation, e.g. when it requests more inputs.
+   */
+  virtual void log_node_execution_time(const FunctionNode &node,
+                                       timeit::Nanoseconds duration,
+                                       const Context &context) const;
+
   virtual void dump_when_outputs_are_missing(const FunctionNode &node,
                                              Span<const OutputSocket *> missing_sockets,
                                              const Context &context) const;
@@ -118,6 +127,25 @@ class GraphExecutor : public LazyFunction {
     int total_size;
   } init_buffer_info_;
 
+  /**
+   * Run time of every node in nanoseconds, indexed by #Node::index_in_graph. It is measured in
+   * previous evaluations of this graph and is zero for nodes that have not been executed yet. The
+   * executor uses it to decide when it's worth letting other threads help, because spawning tasks
+   * for nodes that are fast to compute is only overhead.
+   */
+  mutable Array<std::atomic<int64_t>> node_run_times_ns_;
+  /**
+   * Estimated time of the longest chain of nodes starting at each node, i.e. the node itself and
+   * all the nodes that depend on it. Scheduled nodes on this critical path are executed first, so
+   * that other threads don't run out of work at the end of the evaluation.
+   */
+  mutable Array<std::atomic<int64_t>> critical_path_times_ns_;
+  /**
+   * The critical paths are only recomputed every few evaluations, because the run times of the
+   * nodes don't change much usually.
+   */
+  mutable std::atomic<int> evaluations_until_critical_path_update_ = 1;
+
   friend class Executor;
 
  public:
@@ -134,6 +162,12 @@ class GraphExecutor : public LazyFunction {
   std::string input_name(int index) const override;
   std::string output_name(int index) const override;
 
+  /**
+   * Run time of the node based on previous evaluations. This is zero when the node has not been
+   * executed yet.
+   */
+  timeit::Nanoseconds node_run_time_estimate(const FunctionNode &node) const;
+
  private:
   void execute_impl(Params &params, const Context &context) const override;
 };
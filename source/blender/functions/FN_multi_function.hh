@@ -119,6 +119,13 @@ class MultiFunction : NonCopyable, NonMovable {
      * educated guess about a good grain size.
      */
     bool uniform_execution_time = true;
+    /**
+     * Every output element only depends on the input elements at the same index, and the function
+     * neither uses the context nor has side effects. Such functions can be evaluated on arbitrary
+     * slices of the mask, which allows e.g. fusing multiple of them into a single function or
+     * computing them ahead of time when all inputs are known.
+     */
+    bool is_elementwise = false;
   };
 
   ExecutionHints execution_hints() const;
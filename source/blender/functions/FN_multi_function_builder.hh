@@ -523,6 +523,14 @@ template<typename CallFn, typename... ParamTags> class CustomMF : public MultiFu
   {
     call_fn_(mask, params);
   }
+
+ private:
+  ExecutionHints get_execution_hints() const override
+  {
+    ExecutionHints hints;
+    hints.is_elementwise = true;
+    return hints;
+  }
 };
 
 template<typename Out, typename... In, typename ElementFn, typename ExecPreset>
@@ -671,6 +679,9 @@ class CustomMF_GenericConstant : public MultiFunction {
   void call(const IndexMask &mask, Params params, Context context) const override;
   uint64_t hash() const override;
   bool equals(const MultiFunction &other) const override;
+
+ private:
+  ExecutionHints get_execution_hints() const override;
 };
 
 /**
@@ -730,6 +741,14 @@ template<typename T> class CustomMF_Constant : public MultiFunction {
     }
     return false;
   }
+
+ private:
+  ExecutionHints get_execution_hints() const override
+  {
+    ExecutionHints hints;
+    hints.is_elementwise = true;
+    return hints;
+  }
 };
 
 class CustomMF_DefaultOutput : public MultiFunction {
@@ -262,6 +262,12 @@ class Procedure : NonCopyable, NonMovable {
   DummyInstruction &new_dummy_instruction();
   ReturnInstruction &new_return_instruction();
 
+  /**
+   * Remove a call, destruct or dummy instruction from the procedure. Instructions that pointed to
+   * it point to its next instruction afterwards.
+   */
+  void remove_instruction(Instruction &instruction);
+
   void add_parameter(ParamType::InterfaceType interface_type, Variable &variable);
   Span<ConstParameter> params() const;
 
@@ -46,4 +46,18 @@ namespace blender::fn::multi_function::procedure_optimization {
  */
 void move_destructs_up(Procedure &procedure, Instruction &block_end_instr);
 
+/**
+ * Calls of element-wise functions (see #MultiFunction::ExecutionHints::is_elementwise) whose
+ * inputs are all known while building the procedure, are computed once by this pass. The call is
+ * replaced with constant functions for its outputs. Instructions that only computed inputs for
+ * the removed calls are removed as well.
+ *
+ * Without this pass, such calls are evaluated again for every slice of the mask the procedure is
+ * executed on.
+ *
+ * Like #move_destructs_up, this only works on the linear chain of instructions starting at the
+ * entry of the procedure.
+ */
+void fold_constants(Procedure &procedure);
+
 }  // namespace blender::fn::multi_function::procedure_optimization
@@ -3,6 +3,7 @@
  * SPDX-License-Identifier: GPL-2.0-or-later */
 
 #include "BLI_array_utils.hh"
+#include "BLI_linear_allocator.hh"
 #include "BLI_map.hh"
 #include "BLI_multi_value_map.hh"
 #include "BLI_set.hh"
@@ -18,6 +19,12 @@
 
 namespace blender::fn {
 
+/**
+ * Evaluate trees of element-wise field operations with a single multi-function, instead of
+ * calling every operation for all indices separately.
+ */
+#define USE_FUSED_FIELD_OPERATIONS
+
 /* -------------------------------------------------------------------- */
 /** \name Field Evaluation
  * \{ */
@@ -140,17 +147,330 @@ static Set<GFieldRef> find_varying_fields(const FieldTreeInfo &field_tree_info,
   return found_fields;
 }
 
+#ifdef USE_FUSED_FIELD_OPERATIONS
+
+/**
+ * A multi-function that evaluates a tree of element-wise multi-functions. The mask is processed
+ * in small blocks, and all functions are evaluated for one block before going to the next. That
+ * way intermediate values stay in the CPU cache, and full-size buffers for them are not necessary.
+ */
+class FusedOperationsFunction : public mf::MultiFunction {
+ public:
+  /** Input, intermediate or output value of the fused functions. */
+  struct Slot {
+    const CPPType *type;
+    /** Parameter of the fused function that contains the value, or -1 for intermediate values. */
+    int param_index = -1;
+  };
+
+  struct Step {
+    const mf::MultiFunction *fn;
+    /** The slot used by every parameter of the function. */
+    Vector<int> param_slots;
+  };
+
+ private:
+  /** Small enough so that the intermediate values of a few functions fit in the CPU cache. */
+  static constexpr int64_t block_size = 4096;
+
+  mf::Signature signature_;
+  Vector<Slot> slots_;
+  /** Functions in the order they are evaluated. The last one computes the output. */
+  Vector<Step> steps_;
+  /**
+   * Intermediate values share buffers when they are not used at the same time. This contains the
+   * buffer index for every slot, or -1 for inputs and the output.
+   */
+  Vector<int> buffer_by_slot_;
+  /** The type used to allocate each buffer. */
+  Vector<const CPPType *> buffer_types_;
+  /** Intermediate values that are not used anymore after each step. */
+  Vector<Vector<int>> slots_to_free_by_step_;
+
+ public:
+  FusedOperationsFunction(Vector<Slot> slots, Vector<Step> steps)
+      : slots_(std::move(slots)), steps_(std::move(steps))
+  {
+    this->assign_buffers();
+
+    const int inputs_num = slots_.last().param_index;
+    Array<const CPPType *> input_types(inputs_num);
+    for (const Slot &slot : slots_.as_span().drop_back(1)) {
+      if (slot.param_index != -1) {
+        input_types[slot.param_index] = slot.type;
+      }
+    }
+    mf::SignatureBuilder builder{"Fused Operations", signature_};
+    for (const CPPType *type : input_types) {
+      builder.single_input("Input", *type);
+    }
+    builder.single_output("Output", *slots_.last().type);
+    this->set_signature(&signature_);
+  }
+
+  void call(const IndexMask &mask, mf::Params params, mf::Context context) const override
+  {
+    const int output_param_index = signature_.params.size() - 1;
+    const GMutableSpan dst = params.uninitialized_single_output(output_param_index);
+
+    LinearAllocator<> allocator;
+    Array<void *> buffers(buffer_types_.size());
+    for (const int buffer_index : buffer_types_.index_range()) {
+      const CPPType &type = *buffer_types_[buffer_index];
+      buffers[buffer_index] = allocator.allocate(type.size() * block_size, type.alignment());
+    }
+
+    const IndexRange bounds = mask.bounds();
+    Array<GVArray> block_inputs(output_param_index);
+    for (int64_t start = bounds.start(); start < bounds.one_after_last(); start += block_size) {
+      const IndexRange block = IndexRange::from_begin_end(
+          start, std::min(start + block_size, bounds.one_after_last()));
+      IndexMaskMemory memory;
+      const IndexMask block_mask = mask.slice_content(block).shift(-block.start(), memory);
+      if (block_mask.is_empty()) {
+        continue;
+      }
+      for (const int param_index : block_inputs.index_range()) {
+        block_inputs[param_index] = params.readonly_single_input(param_index).slice(block);
+      }
+
+      for (const int step_index : steps_.index_range()) {
+        const Step &step = steps_[step_index];
+        mf::ParamsBuilder step_params{*step.fn, &block_mask};
+        for (const int param_index : step.fn->param_indices()) {
+          const Slot &slot = slots_[step.param_slots[param_index]];
+          const bool is_input = step.fn->param_type(param_index).interface_type() ==
+                                mf::ParamType::Input;
+          if (this->is_output_slot(slot)) {
+            step_params.add_uninitialized_single_output(dst.slice(block));
+          }
+          else if (slot.param_index != -1) {
+            step_params.add_readonly_single_input(block_inputs[slot.param_index]);
+          }
+          else {
+            const int buffer_index = buffer_by_slot_[step.param_slots[param_index]];
+            const GMutableSpan buffer{*slot.type, buffers[buffer_index], block.size()};
+            if (is_input) {
+              step_params.add_readonly_single_input(GSpan(buffer));
+            }
+            else {
+              step_params.add_uninitialized_single_output(buffer);
+            }
+          }
+        }
+        step.fn->call(block_mask, step_params, context);
+
+        for (const int slot_index : slots_to_free_by_step_[step_index]) {
+          const CPPType &type = *slots_[slot_index].type;
+          if (!type.is_trivially_destructible()) {
+            type.destruct_indices(buffers[buffer_by_slot_[slot_index]], block_mask);
+          }
+        }
+      }
+    }
+  }
+
+ private:
+  void assign_buffers()
+  {
+    Array<int> last_use_by_slot(slots_.size(), -1);
+    for (const int step_index : steps_.index_range()) {
+      const Step &step = steps_[step_index];
+      for (const int param_index : step.fn->param_indices()) {
+        if (step.fn->param_type(param_index).interface_type() == mf::ParamType::Input) {
+          last_use_by_slot[step.param_slots[param_index]] = step_index;
+        }
+      }
+    }
+
+    buffer_by_slot_.resize(slots_.size(), -1);
+    slots_to_free_by_step_.resize(steps_.size());
+    Vector<int> free_buffers;
+    for (const int step_index : steps_.index_range()) {
+      const Step &step = steps_[step_index];
+      /* Outputs can't use the buffers of inputs of the same function. */
+      for (const int param_index : step.fn->param_indices()) {
+        const int slot_index = step.param_slots[param_index];
+        const Slot &slot = slots_[slot_index];
+        if (slot.param_index != -1 ||
+            step.fn->param_type(param_index).interface_type() != mf::ParamType::Output)
+        {
+          continue;
+        }
+        int buffer_index = -1;
+        for (const int i : free_buffers.index_range()) {
+          const CPPType &buffer_type = *buffer_types_[free_buffers[i]];
+          if (buffer_type.size() == slot.type->size() &&
+              buffer_type.alignment() == slot.type->alignment())
+          {
+            buffer_index = free_buffers[i];
+            free_buffers.remove_and_reorder(i);
+            break;
+          }
+        }
+        if (buffer_index == -1) {
+          buffer_index = buffer_types_.append_and_get_index(slot.type);
+        }
+        buffer_by_slot_[slot_index] = buffer_index;
+      }
+      for (const int slot_index : step.param_slots) {
+        if (slots_[slot_index].param_index == -1 && last_use_by_slot[slot_index] == step_index &&
+            !slots_to_free_by_step_[step_index].contains(slot_index))
+        {
+          slots_to_free_by_step_[step_index].append(slot_index);
+          free_buffers.append(buffer_by_slot_[slot_index]);
+        }
+      }
+    }
+  }
+
+  bool is_output_slot(const Slot &slot) const
+  {
+    return &slot == &slots_.last();
+  }
+};
+
+static bool is_elementwise_operation(const FieldOperation &operation)
+{
+  const mf::MultiFunction &fn = operation.multi_function();
+  if (!fn.execution_hints().is_elementwise) {
+    return false;
+  }
+  int outputs_num = 0;
+  for (const int param_index : fn.param_indices()) {
+    const mf::ParamType param_type = fn.param_type(param_index);
+    switch (param_type.category()) {
+      case mf::ParamCategory::SingleInput:
+        break;
+      case mf::ParamCategory::SingleOutput:
+        outputs_num++;
+        break;
+      default:
+        return false;
+    }
+  }
+  return outputs_num == 1;
+}
+
+/** Fields that are evaluated together with the field that uses them. */
+struct FusedOperations {
+  /** Fields that are passed into the fused function. */
+  VectorSet<GFieldRef> inputs;
+  Vector<FusedOperationsFunction::Slot> slots;
+  Vector<FusedOperationsFunction::Step> steps;
+  /** The multi-function that computes the field, or null if nothing was fused. */
+  const mf::MultiFunction *fn = nullptr;
+};
+
+/**
+ * Adds the operation that computes the field and all operations it depends on that are not used
+ * elsewhere to the fused operations.
+ * \return The slot that contains the value of the field.
+ */
+static int add_fused_operations_recursive(const GFieldRef field,
+                                          const bool is_root,
+                                          const FieldTreeInfo &field_tree_info,
+                                          const Set<GFieldRef> &fusable_fields,
+                                          FusedOperations &fused)
+{
+  const bool is_fusable = is_root || (fusable_fields.contains(field) &&
+                                      field_tree_info.field_users.lookup(field).size() == 1);
+  if (!is_fusable || field.node().node_type() != FieldNodeType::Operation ||
+      !is_elementwise_operation(static_cast<const FieldOperation &>(field.node())))
+  {
+    const int input_index = fused.inputs.index_of_try(field);
+    if (input_index != -1) {
+      for (const int slot_index : fused.slots.index_range()) {
+        if (fused.slots[slot_index].param_index == input_index) {
+          return slot_index;
+        }
+      }
+    }
+    fused.inputs.add_new(field);
+    return fused.slots.append_and_get_index({&field.cpp_type(), int(fused.inputs.size() - 1)});
+  }
+
+  const FieldOperation &operation = static_cast<const FieldOperation &>(field.node());
+  const mf::MultiFunction &fn = operation.multi_function();
+  FusedOperationsFunction::Step step;
+  step.fn = &fn;
+  int output_slot = -1;
+  int input_index = 0;
+  for (const int param_index : fn.param_indices()) {
+    if (fn.param_type(param_index).interface_type() == mf::ParamType::Input) {
+      step.param_slots.append(add_fused_operations_recursive(
+          operation.inputs()[input_index], false, field_tree_info, fusable_fields, fused));
+      input_index++;
+    }
+    else {
+      output_slot = fused.slots.append_and_get_index({&field.cpp_type()});
+      step.param_slots.append(output_slot);
+    }
+  }
+  fused.steps.append(std::move(step));
+  return output_slot;
+}
+
+/**
+ * Finds the element-wise operations that can be evaluated together with the given field.
+ * \param fusable_fields: Fields that may be computed as part of a fused function, i.e. varying
+ * fields that are not outputs.
+ */
+static FusedOperations find_fused_operations(const GFieldRef field,
+                                             const FieldTreeInfo &field_tree_info,
+                                             const Set<GFieldRef> &fusable_fields,
+                                             mf::Procedure &procedure)
+{
+  FusedOperations fused;
+  if (!is_elementwise_operation(static_cast<const FieldOperation &>(field.node()))) {
+    return fused;
+  }
+  const int output_slot = add_fused_operations_recursive(
+      field, true, field_tree_info, fusable_fields, fused);
+  if (fused.steps.size() < 2) {
+    return fused;
+  }
+  /* Move the output slot to the end, and give it the parameter index after the inputs. */
+  const int last_slot = fused.slots.size() - 1;
+  for (FusedOperationsFunction::Step &step : fused.steps) {
+    for (int &slot : step.param_slots) {
+      if (slot == output_slot) {
+        slot = last_slot;
+      }
+      else if (slot == last_slot) {
+        slot = output_slot;
+      }
+    }
+  }
+  std::swap(fused.slots[output_slot], fused.slots[last_slot]);
+  fused.slots.last().param_index = fused.inputs.size();
+
+  fused.fn = &procedure.construct_function<FusedOperationsFunction>(std::move(fused.slots),
+                                                                     std::move(fused.steps));
+  return fused;
+}
+
+#endif
+
 /**
  * Builds the #procedure so that it computes the fields.
+ * \param fusable_fields: When provided, element-wise operations in the given set are computed
+ * together with the field that uses them.
  */
 static void build_multi_function_procedure_for_fields(mf::Procedure &procedure,
                                                       ResourceScope &scope,
                                                       const FieldTreeInfo &field_tree_info,
-                                                      Span<GFieldRef> output_fields)
+                                                      Span<GFieldRef> output_fields,
+                                                      const Set<GFieldRef> *fusable_fields)
 {
   mf::ProcedureBuilder builder{procedure};
   /* Every input, intermediate and output field corresponds to a variable in the procedure. */
   Map<GFieldRef, mf::Variable *> variable_by_field;
+#ifdef USE_FUSED_FIELD_OPERATIONS
+  Map<GFieldRef, FusedOperations> fused_by_field;
+#else
+  UNUSED_VARS(fusable_fields);
+#endif
 
   /* Start by adding the field inputs as parameters to the procedure. */
   for (const FieldInput &field_input : field_tree_info.deduplicated_field_inputs) {
@@ -188,6 +508,29 @@ static void build_multi_function_procedure_for_fields(mf::Procedure &procedure,
           const FieldOperation &operation_node = static_cast<const FieldOperation &>(field.node());
           const Span<GField> operation_inputs = operation_node.inputs();
 
+#ifdef USE_FUSED_FIELD_OPERATIONS
+          if (fusable_fields != nullptr) {
+            const FusedOperations &fused = fused_by_field.lookup_or_add_cb(field, [&]() {
+              return find_fused_operations(field, field_tree_info, *fusable_fields, procedure);
+            });
+            if (fused.fn != nullptr) {
+              if (field_with_index.current_input_index < fused.inputs.size()) {
+                fields_to_check.push({fused.inputs[field_with_index.current_input_index]});
+                field_with_index.current_input_index++;
+              }
+              else {
+                Vector<mf::Variable *> variables;
+                for (const GFieldRef &input_field : fused.inputs) {
+                  variables.append(variable_by_field.lookup(input_field));
+                }
+                mf::Variable &new_variable = *builder.add_call<1>(*fused.fn, variables)[0];
+                variable_by_field.add_new(field, &new_variable);
+              }
+              break;
+            }
+          }
+#endif
+
           if (field_with_index.current_input_index < operation_inputs.size()) {
             /* Not all inputs are handled yet. Push the next input field to the stack and increment
              * the input index. */
@@ -272,6 +615,7 @@ static void build_multi_function_procedure_for_fields(mf::Procedure &procedure,
 
   mf::ReturnInstruction &return_instr = builder.add_return();
 
+  mf::procedure_optimization::fold_constants(procedure);
   mf::procedure_optimization::move_destructs_up(procedure, return_instr);
 
   // std::cout << procedure.to_dot() << "\n";
@@ -369,8 +713,12 @@ Vector<GVArray> evaluate_fields(ResourceScope &scope,
   if (!varying_fields_to_evaluate.is_empty()) {
     /* Build the procedure for those fields. */
     mf::Procedure procedure;
+    Set<GFieldRef> fusable_fields = varying_fields;
+    for (const GFieldRef &field : varying_fields_to_evaluate) {
+      fusable_fields.remove(field);
+    }
     build_multi_function_procedure_for_fields(
-        procedure, scope, field_tree_info, varying_fields_to_evaluate);
+        procedure, scope, field_tree_info, varying_fields_to_evaluate, &fusable_fields);
     mf::ProcedureExecutor procedure_executor{procedure};
 
     mf::ParamsBuilder mf_params{procedure_executor, &mask};
@@ -422,7 +770,7 @@ Vector<GVArray> evaluate_fields(ResourceScope &scope,
     /* Build the procedure for those fields. */
     mf::Procedure procedure;
     build_multi_function_procedure_for_fields(
-        procedure, scope, field_tree_info, constant_fields_to_evaluate);
+        procedure, scope, field_tree_info, constant_fields_to_evaluate, nullptr);
     mf::ProcedureExecutor procedure_executor{procedure};
     const IndexMask mask(1);
     mf::ParamsBuilder mf_params{procedure_executor, &mask};
@@ -184,6 +184,11 @@ struct NodeState {
    * Custom storage of the node.
    */
   void *storage = nullptr;
+  /**
+   * Total time spent executing this node in the current evaluation. Does not need the lock,
+   * because the node is only executed by one thread at a time.
+   */
+  int64_t run_time_ns = 0;
 };
 
 /**
@@ -220,28 +225,63 @@ class GraphExecutorLFParams;
  */
 struct ScheduledNodes {
  private:
+  struct ScheduledNode {
+    const FunctionNode *node;
+    /** Estimated run time of the node itself. */
+    int64_t run_time_ns;
+    /** Estimated run time of the node and the longest chain of nodes depending on it. */
+    int64_t critical_path_ns;
+  };
+
   /** Use two stacks of scheduled nodes for different priorities. */
-  Vector<const FunctionNode *> priority_;
-  Vector<const FunctionNode *> normal_;
+  Vector<ScheduledNode> priority_;
+  Vector<ScheduledNode> normal_;
+  /** Sum of the estimated run times of all scheduled nodes. */
+  int64_t run_time_ns_ = 0;
+
+  /**
+   * Number of most recently scheduled normal nodes that are considered when choosing the node on
+   * the longest critical path. Keeping this small retains the depth-first order mostly, which
+   * helps keeping the data that is worked on in the cache.
+   */
+  static constexpr int64_t critical_path_window = 8;
 
  public:
-  void schedule(const FunctionNode &node, const bool is_priority)
+  void schedule(const FunctionNode &node,
+                const bool is_priority,
+                const int64_t run_time_ns,
+                const int64_t critical_path_ns)
   {
     if (is_priority) {
-      this->priority_.append(&node);
+      this->priority_.append({&node, run_time_ns, critical_path_ns});
     }
     else {
-      this->normal_.append(&node);
+      this->normal_.append({&node, run_time_ns, critical_path_ns});
     }
+    run_time_ns_ += run_time_ns;
   }
 
   const FunctionNode *pop_next_node()
   {
     if (!this->priority_.is_empty()) {
-      return this->priority_.pop_last();
+      const ScheduledNode scheduled = this->priority_.pop_last();
+      run_time_ns_ -= scheduled.run_time_ns;
+      return scheduled.node;
     }
     if (!this->normal_.is_empty()) {
-      return this->normal_.pop_last();
+      /* Prefer the node that starts the longest chain of work. Without any timings from previous
+       * evaluations, this is the most recently scheduled node. */
+      int64_t best_index = normal_.size() - 1;
+      const int64_t window_start = std::max<int64_t>(0, normal_.size() - critical_path_window);
+      for (int64_t i = best_index - 1; i >= window_start; i--) {
+        if (normal_[i].critical_path_ns > normal_[best_index].critical_path_ns) {
+          best_index = i;
+        }
+      }
+      const ScheduledNode scheduled = normal_[best_index];
+      normal_.remove(best_index);
+      run_time_ns_ -= scheduled.run_time_ns;
+      return scheduled.node;
     }
     return nullptr;
   }
@@ -256,6 +296,14 @@ struct ScheduledNodes {
     return priority_.size() + normal_.size();
   }
 
+  /**
+   * Estimated time it takes to execute all scheduled nodes once.
+   */
+  int64_t run_time_ns() const
+  {
+    return run_time_ns_;
+  }
+
   /**
    * Split up the scheduled nodes into two groups that can be worked on in parallel.
    */
@@ -268,6 +316,20 @@ struct ScheduledNodes {
     other.normal_.extend(normal_.as_span().drop_front(normal_split));
     priority_.resize(priority_split);
     normal_.resize(normal_split);
+    this->update_run_time();
+    other.update_run_time();
+  }
+
+ private:
+  void update_run_time()
+  {
+    run_time_ns_ = 0;
+    for (const ScheduledNode &scheduled : priority_) {
+      run_time_ns_ += scheduled.run_time_ns;
+    }
+    for (const ScheduledNode &scheduled : normal_) {
+      run_time_ns_ += scheduled.run_time_ns;
+    }
   }
 };
 
@@ -328,6 +390,21 @@ class Executor {
    */
   bool is_first_execution_ = true;
 
+  /**
+   * Nodes that took longer than this in previous evaluations let other threads take over the
+   * remaining scheduled nodes before they start, instead of waiting for a hint from the node.
+   */
+  static constexpr int64_t expensive_node_run_time_ns = 100'000;
+  /**
+   * Scheduled nodes that are expected to take longer than this in total are split up between
+   * multiple threads.
+   */
+  static constexpr int64_t split_scheduled_nodes_run_time_ns = 200'000;
+  /**
+   * Number of evaluations after which the critical path estimates are updated again.
+   */
+  static constexpr int critical_path_update_interval = 16;
+
   friend GraphExecutorLFParams;
 
   /**
@@ -353,13 +430,25 @@ class Executor {
     if (TaskPool *task_pool = task_pool_.load()) {
       BLI_task_pool_free(task_pool);
     }
+    std::atomic<bool> any_node_executed = false;
     threading::parallel_for(node_states_.index_range(), 1024, [&](const IndexRange range) {
       for (const int node_index : range) {
         const Node &node = *self_.graph_.nodes()[node_index];
         NodeState &node_state = *node_states_[node_index];
+        if (node_state.run_time_ns > 0) {
+          this->update_node_run_time(node_index, node_state.run_time_ns);
+          any_node_executed.store(true, std::memory_order_relaxed);
+        }
         this->destruct_node_state(node, node_state);
       }
     });
+    if (any_node_executed &&
+        self_.evaluations_until_critical_path_update_.fetch_sub(1, std::memory_order_relaxed) == 1)
+    {
+      this->update_critical_path_times();
+      self_.evaluations_until_critical_path_update_.store(critical_path_update_interval,
+                                                          std::memory_order_relaxed);
+    }
   }
 
   /**
@@ -461,6 +550,77 @@ class Executor {
     });
   }
 
+  /**
+   * Blend the run time of the current evaluation into the estimate from previous evaluations, so
+   * that a single outlier does not change the scheduling too much.
+   */
+  void update_node_run_time(const int node_index, const int64_t run_time_ns)
+  {
+    std::atomic<int64_t> &estimate = self_.node_run_times_ns_[node_index];
+    /* Concurrent evaluations of the same graph may overwrite each others updates. That is fine,
+     * because this is just an estimate. */
+    const int64_t old_estimate = estimate.load(std::memory_order_relaxed);
+    const int64_t new_estimate = old_estimate == 0 ? run_time_ns :
+                                                     (old_estimate * 3 + run_time_ns) / 4;
+    estimate.store(std::max<int64_t>(new_estimate, 1), std::memory_order_relaxed);
+  }
+
+  /**
+   * Compute the estimated time of the longest chain of nodes starting at every node, based on the
+   * run times of the nodes. Nodes are processed in depth-first post-order, so that all nodes that
+   * depend on a node are processed before it. Links that would form a cycle are ignored.
+   */
+  void update_critical_path_times()
+  {
+    enum class VisitState : uint8_t { NotVisited, InProgress, Done };
+    const Span<const Node *> nodes = self_.graph_.nodes();
+    Array<VisitState> visit_states(nodes.size(), VisitState::NotVisited);
+    Array<int64_t> critical_paths(nodes.size(), 0);
+    Vector<const Node *, 64> stack;
+    for (const Node *start_node : nodes) {
+      if (visit_states[start_node->index_in_graph()] != VisitState::NotVisited) {
+        continue;
+      }
+      stack.append(start_node);
+      while (!stack.is_empty()) {
+        const Node &node = *stack.last();
+        const int node_index = node.index_in_graph();
+        if (visit_states[node_index] == VisitState::NotVisited) {
+          visit_states[node_index] = VisitState::InProgress;
+          for (const OutputSocket *output_socket : node.outputs()) {
+            for (const InputSocket *target_socket : output_socket->targets()) {
+              const Node &target_node = target_socket->node();
+              if (visit_states[target_node.index_in_graph()] == VisitState::NotVisited) {
+                stack.append(&target_node);
+              }
+            }
+          }
+          continue;
+        }
+        stack.pop_last();
+        if (visit_states[node_index] == VisitState::Done) {
+          continue;
+        }
+        visit_states[node_index] = VisitState::Done;
+        int64_t max_target_path = 0;
+        for (const OutputSocket *output_socket : node.outputs()) {
+          for (const InputSocket *target_socket : output_socket->targets()) {
+            const int target_index = target_socket->node().index_in_graph();
+            if (visit_states[target_index] == VisitState::Done) {
+              max_target_path = std::max(max_target_path, critical_paths[target_index]);
+            }
+          }
+        }
+        critical_paths[node_index] = max_target_path + self_.node_run_times_ns_[node_index].load(
+                                                           std::memory_order_relaxed);
+      }
+    }
+    for (const int node_index : nodes.index_range()) {
+      self_.critical_path_times_ns_[node_index].store(critical_paths[node_index],
+                                                      std::memory_order_relaxed);
+    }
+  }
+
   void destruct_node_state(const Node &node, NodeState &node_state)
   {
     if (node.is_function()) {
@@ -742,12 +902,17 @@ class Executor {
       case NodeScheduleState::NotScheduled: {
         locked_node.node_state.schedule_state = NodeScheduleState::Scheduled;
         const FunctionNode &node = static_cast<const FunctionNode &>(locked_node.node);
+        const int node_index = node.index_in_graph();
+        const int64_t run_time_ns = self_.node_run_times_ns_[node_index].load(
+            std::memory_order_relaxed);
+        const int64_t critical_path_ns = self_.critical_path_times_ns_[node_index].load(
+            std::memory_order_relaxed);
         if (this->use_multi_threading()) {
           std::lock_guard lock{current_task.mutex};
-          current_task.scheduled_nodes.schedule(node, is_priority);
+          current_task.scheduled_nodes.schedule(node, is_priority, run_time_ns, critical_path_ns);
         }
         else {
-          current_task.scheduled_nodes.schedule(node, is_priority);
+          current_task.scheduled_nodes.schedule(node, is_priority, run_time_ns, critical_path_ns);
         }
         current_task.has_scheduled_nodes.store(true, std::memory_order_relaxed);
         break;
@@ -814,9 +979,13 @@ class Executor {
       }
       this->run_node_task(*node, current_task, local_data);
 
-      /* If there are many nodes scheduled at the same time, it's beneficial to let multiple
-       * threads work on those. */
-      if (current_task.scheduled_nodes.nodes_num() > 128) {
+      /* If there are many nodes scheduled at the same time or they are known to take a while from
+       * previous evaluations, it's beneficial to let multiple threads work on those. */
+      const int64_t scheduled_nodes_num = current_task.scheduled_nodes.nodes_num();
+      if (scheduled_nodes_num > 128 ||
+          (scheduled_nodes_num >= 2 &&
+           current_task.scheduled_nodes.run_time_ns() > split_scheduled_nodes_run_time_ns))
+      {
         if (this->try_enable_multi_threading()) {
           std::unique_ptr<ScheduledNodes> split_nodes = std::make_unique<ScheduledNodes>();
           current_task.scheduled_nodes.split_into(*split_nodes);
@@ -1447,16 +1616,28 @@ inline void Executor::execute_node(const FunctionNode &node,
     this->push_all_scheduled_nodes_to_task_pool(current_task);
   };
 
+  /* The node is known to take a while from previous evaluations, so don't wait for the node to
+   * send a hint before other threads can start working on the remaining scheduled nodes. */
+  if (self_.node_run_times_ns_[node.index_in_graph()].load(std::memory_order_relaxed) >
+      expensive_node_run_time_ns)
+  {
+    blocking_hint_fn();
+  }
+
   lazy_threading::HintReceiver blocking_hint_receiver{blocking_hint_fn};
+  const timeit::TimePoint start_time = timeit::Clock::now();
   if (self_.node_execute_wrapper_) {
     self_.node_execute_wrapper_->execute_node(node, node_params, fn_context);
   }
   else {
     fn.execute(node_params, fn_context);
   }
+  const timeit::Nanoseconds duration = timeit::Clock::now() - start_time;
+  node_state.run_time_ns += std::max<int64_t>(duration.count(), 1);
 
   if (self_.logger_ != nullptr) {
     self_.logger_->log_after_node_execute(node, node_params, fn_context);
+    self_.logger_->log_node_execution_time(node, duration, fn_context);
   }
 }
 
@@ -1515,6 +1696,13 @@ GraphExecutor::GraphExecutor(const Graph &graph,
   }
 
   init_buffer_info_.total_size = offset;
+
+  node_run_times_ns_.reinitialize(nodes.size());
+  critical_path_times_ns_.reinitialize(nodes.size());
+  for (const int i : nodes.index_range()) {
+    node_run_times_ns_[i].store(0, std::memory_order_relaxed);
+    critical_path_times_ns_[i].store(0, std::memory_order_relaxed);
+  }
 }
 
 void GraphExecutor::execute_impl(Params &params, const Context &context) const
@@ -1546,6 +1734,12 @@ std::string GraphExecutor::output_name(const int index) const
   return socket.name();
 }
 
+timeit::Nanoseconds GraphExecutor::node_run_time_estimate(const FunctionNode &node) const
+{
+  return timeit::Nanoseconds(
+      node_run_times_ns_[node.index_in_graph()].load(std::memory_order_relaxed));
+}
+
 void GraphExecutorLogger::log_socket_value(const Socket &socket,
                                            const GPointer value,
                                            const Context &context) const
@@ -1567,6 +1761,13 @@ void GraphExecutorLogger::log_after_node_execute(const FunctionNode &node,
   UNUSED_VARS(node, params, context);
 }
 
+void GraphExecutorLogger::log_node_execution_time(const FunctionNode &node,
+                                                  const timeit::Nanoseconds duration,
+                                                  const Context &context) const
+{
+  UNUSED_VARS(node, duration, context);
+}
+
 Vector<const FunctionNode *> GraphExecutorSideEffectProvider::get_nodes_with_side_effects(
     const Context &context) const
 {
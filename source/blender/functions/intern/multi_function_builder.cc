@@ -58,6 +58,13 @@ bool CustomMF_GenericConstant::equals(const MultiFunction &other) const
   return type_.is_equal(value_, _other->value_);
 }
 
+MultiFunction::ExecutionHints CustomMF_GenericConstant::get_execution_hints() const
+{
+  ExecutionHints hints;
+  hints.is_elementwise = true;
+  return hints;
+}
+
 CustomMF_GenericConstantArray::CustomMF_GenericConstantArray(GSpan array) : array_(array)
 {
   const CPPType &type = array.type();
@@ -228,6 +228,64 @@ ReturnInstruction &Procedure::new_return_instruction()
   return instruction;
 }
 
+void Procedure::remove_instruction(Instruction &instruction)
+{
+  Instruction *next = nullptr;
+  switch (instruction.type_) {
+    case InstructionType::Call:
+      next = static_cast<CallInstruction &>(instruction).next_;
+      break;
+    case InstructionType::Destruct:
+      next = static_cast<DestructInstruction &>(instruction).next_;
+      break;
+    case InstructionType::Dummy:
+      next = static_cast<DummyInstruction &>(instruction).next_;
+      break;
+    case InstructionType::Branch:
+    case InstructionType::Return:
+      BLI_assert_unreachable();
+      return;
+  }
+
+  /* Copy the cursors, because they are removed from the instruction when relinking. */
+  const Vector<InstructionCursor> prev_cursors = instruction.prev_;
+  for (const InstructionCursor &cursor : prev_cursors) {
+    cursor.set_next(*this, next);
+  }
+  BLI_assert(instruction.prev_.is_empty());
+
+  switch (instruction.type_) {
+    case InstructionType::Call: {
+      CallInstruction &call_instruction = static_cast<CallInstruction &>(instruction);
+      call_instruction.set_next(nullptr);
+      for (const int param_index : call_instruction.params_.index_range()) {
+        call_instruction.set_param_variable(param_index, nullptr);
+      }
+      call_instructions_.remove_first_occurrence_and_reorder(&call_instruction);
+      call_instruction.~CallInstruction();
+      break;
+    }
+    case InstructionType::Destruct: {
+      DestructInstruction &destruct_instruction = static_cast<DestructInstruction &>(instruction);
+      destruct_instruction.set_next(nullptr);
+      destruct_instruction.set_variable(nullptr);
+      destruct_instructions_.remove_first_occurrence_and_reorder(&destruct_instruction);
+      destruct_instruction.~DestructInstruction();
+      break;
+    }
+    case InstructionType::Dummy: {
+      DummyInstruction &dummy_instruction = static_cast<DummyInstruction &>(instruction);
+      dummy_instruction.set_next(nullptr);
+      dummy_instructions_.remove_first_occurrence_and_reorder(&dummy_instruction);
+      dummy_instruction.~DummyInstruction();
+      break;
+    }
+    case InstructionType::Branch:
+    case InstructionType::Return:
+      break;
+  }
+}
+
 void Procedure::add_parameter(ParamType::InterfaceType interface_type, Variable &variable)
 {
   params_.append({interface_type, &variable});
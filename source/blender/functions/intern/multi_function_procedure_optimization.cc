@@ -2,6 +2,9 @@
  *
  * SPDX-License-Identifier: GPL-2.0-or-later */
 
+#include "BLI_resource_scope.hh"
+
+#include "FN_multi_function_builder.hh"
 #include "FN_multi_function_procedure_optimization.hh"
 
 namespace blender::fn::multi_function::procedure_optimization {
@@ -74,4 +77,194 @@ void move_destructs_up(Procedure &procedure, Instruction &block_end_instr)
   }
 }
 
+static bool is_procedure_parameter(const Procedure &procedure, const Variable &variable)
+{
+  for (const ConstParameter &param : procedure.params()) {
+    if (param.variable == &variable) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static bool can_fold_call(const CallInstruction &call_instr,
+                          const Map<const Variable *, GPointer> &constant_values)
+{
+  const MultiFunction &fn = call_instr.fn();
+  if (!fn.execution_hints().is_elementwise) {
+    return false;
+  }
+  for (const int param_index : fn.param_indices()) {
+    switch (fn.param_type(param_index).category()) {
+      case ParamCategory::SingleInput: {
+        if (!constant_values.contains(call_instr.params()[param_index])) {
+          return false;
+        }
+        break;
+      }
+      case ParamCategory::SingleOutput: {
+        break;
+      }
+      default: {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+/**
+ * Remove the instructions that compute and destruct the variable if nothing else uses it. This
+ * is done recursively for the inputs of the removed instructions.
+ */
+static void remove_unused_variable(Procedure &procedure, Variable &variable)
+{
+  if (is_procedure_parameter(procedure, variable)) {
+    return;
+  }
+  CallInstruction *producer = nullptr;
+  Vector<Instruction *> destruct_instrs;
+  for (Instruction *user : variable.users()) {
+    if (user->type() == InstructionType::Destruct) {
+      destruct_instrs.append(user);
+      continue;
+    }
+    if (user->type() != InstructionType::Call || producer != nullptr) {
+      return;
+    }
+    CallInstruction &call_instr = static_cast<CallInstruction &>(*user);
+    const MultiFunction &fn = call_instr.fn();
+    if (!fn.execution_hints().is_elementwise) {
+      return;
+    }
+    for (const int param_index : fn.param_indices()) {
+      const Variable *param_variable = call_instr.params()[param_index];
+      const bool is_output = fn.param_type(param_index).interface_type() == ParamType::Output;
+      if (param_variable == &variable && !is_output) {
+        return;
+      }
+      if (param_variable != &variable && param_variable != nullptr && is_output) {
+        /* Another output of the function is still used. */
+        return;
+      }
+    }
+    producer = &call_instr;
+  }
+  if (producer == nullptr) {
+    return;
+  }
+
+  Vector<Variable *> producer_inputs;
+  for (Variable *param_variable : producer->params()) {
+    if (param_variable != nullptr && param_variable != &variable) {
+      producer_inputs.append_non_duplicates(param_variable);
+    }
+  }
+  for (Instruction *destruct_instr : destruct_instrs) {
+    procedure.remove_instruction(*destruct_instr);
+  }
+  procedure.remove_instruction(*producer);
+  for (Variable *input_variable : producer_inputs) {
+    remove_unused_variable(procedure, *input_variable);
+  }
+}
+
+void fold_constants(Procedure &procedure)
+{
+  /* Owns the computed values until they are copied into the new constant functions. */
+  ResourceScope scope;
+  Map<const Variable *, GPointer> constant_values;
+
+  Instruction *current_instr = procedure.entry();
+  while (current_instr != nullptr) {
+    Instruction *next_instr = nullptr;
+    switch (current_instr->type()) {
+      case InstructionType::Destruct: {
+        DestructInstruction &destruct_instr = static_cast<DestructInstruction &>(*current_instr);
+        constant_values.remove(destruct_instr.variable());
+        next_instr = destruct_instr.next();
+        break;
+      }
+      case InstructionType::Dummy: {
+        next_instr = static_cast<DummyInstruction &>(*current_instr).next();
+        break;
+      }
+      case InstructionType::Call: {
+        CallInstruction &call_instr = static_cast<CallInstruction &>(*current_instr);
+        next_instr = call_instr.next();
+        const MultiFunction &fn = call_instr.fn();
+        if (!can_fold_call(call_instr, constant_values)) {
+          for (const Variable *variable : call_instr.params()) {
+            constant_values.remove(variable);
+          }
+          break;
+        }
+
+        /* Compute the outputs for a single index. */
+        const IndexMask mask(1);
+        ParamsBuilder params{fn, &mask};
+        ContextBuilder context;
+        Vector<Variable *> input_variables;
+        Vector<std::pair<Variable *, GPointer>> outputs;
+        for (const int param_index : fn.param_indices()) {
+          Variable *variable = call_instr.params()[param_index];
+          const ParamType param_type = fn.param_type(param_index);
+          if (param_type.interface_type() == ParamType::Input) {
+            params.add_readonly_single_input(constant_values.lookup(variable));
+            input_variables.append_non_duplicates(variable);
+          }
+          else if (variable == nullptr) {
+            params.add_ignored_single_output();
+          }
+          else {
+            const CPPType &type = param_type.data_type().single_type();
+            void *buffer = scope.linear_allocator().allocate(type.size(), type.alignment());
+            params.add_uninitialized_single_output({type, buffer, 1});
+            outputs.append({variable, {type, buffer}});
+          }
+        }
+        fn.call(mask, params, context);
+        for (const auto &[variable, value] : outputs) {
+          if (!value.type()->is_trivially_destructible()) {
+            scope.add_destruct_call(
+                [value = value]() { value.type()->destruct(const_cast<void *>(value.get())); });
+          }
+          constant_values.add_overwrite(variable, value);
+        }
+        if (input_variables.is_empty() || outputs.is_empty()) {
+          /* The function is a constant already or nothing uses it. */
+          break;
+        }
+
+        /* Replace the call with constant functions, one for every output. */
+        Instruction *insert_before = next_instr;
+        for (const auto &[variable, value] : outputs) {
+          const MultiFunction &constant_fn =
+              procedure.construct_function<CustomMF_GenericConstant>(
+                  *value.type(), value.get(), true);
+          CallInstruction &constant_instr = procedure.new_call_instruction(constant_fn);
+          call_instr.set_param_variable(call_instr.params().first_index(variable), nullptr);
+          constant_instr.set_param_variable(0, variable);
+          constant_instr.set_next(insert_before);
+          insert_before = &constant_instr;
+        }
+        call_instr.set_next(insert_before);
+        procedure.remove_instruction(call_instr);
+        for (Variable *variable : input_variables) {
+          remove_unused_variable(procedure, *variable);
+        }
+        /* The previous next instruction might have been removed, so continue with the new
+         * constants. Evaluating them again is cheap. */
+        next_instr = insert_before;
+        break;
+      }
+      case InstructionType::Branch:
+      case InstructionType::Return: {
+        break;
+      }
+    }
+    current_instr = next_instr;
+  }
+}
+
 }  // namespace blender::fn::multi_function::procedure_optimization
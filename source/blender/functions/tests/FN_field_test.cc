@@ -246,6 +246,45 @@ TEST(field, TwoFunctionsTwoOutputs)
   EXPECT_EQ(result_2.get(8), 36);
 }
 
+TEST(field, FusedOperations)
+{
+  GField index_field{std::make_shared<IndexFieldInput>()};
+  auto add_fn = mf::build::SI2_SO<int, int, int>("add", [](int a, int b) { return a + b; });
+  auto to_string_fn = mf::build::SI1_SO<int, std::string>(
+      "to_string", [](int a) { return std::to_string(a); });
+  auto length_fn = mf::build::SI1_SO<std::string, int>(
+      "length", [](const std::string &a) { return int(a.size()); });
+
+  /* The shared field is used twice, so it is computed separately. */
+  GField shared_field{FieldOperation::Create(add_fn, {index_field, index_field}), 0};
+  GField string_field{FieldOperation::Create(to_string_fn, {shared_field}), 0};
+  GField length_field{FieldOperation::Create(length_fn, {string_field}), 0};
+  GField constant_field{FieldOperation::Create(std::make_unique<mf::CustomMF_Constant<int>>(3)),
+                        0};
+  GField sum_field{FieldOperation::Create(add_fn, {length_field, constant_field}), 0};
+  Field<int> result_field{FieldOperation::Create(add_fn, {sum_field, shared_field}), 0};
+
+  IndexMaskMemory memory;
+  const IndexMask mask = IndexMask::from_predicate(
+      IndexRange(5000), GrainSize(512), memory, [](const int64_t i) {
+        return i < 3000 || i % 7 == 0;
+      });
+  Array<int> result(5000, -1);
+
+  FieldContext context;
+  FieldEvaluator evaluator{context, &mask};
+  evaluator.add_with_destination(result_field, result.as_mutable_span());
+  evaluator.evaluate();
+  for (const int i : result.index_range()) {
+    if (mask.contains(i)) {
+      EXPECT_EQ(result[i], int(std::to_string(i * 2).size()) + 3 + i * 2);
+    }
+    else {
+      EXPECT_EQ(result[i], -1);
+    }
+  }
+}
+
 TEST(field, SameFieldTwice)
 {
   GField constant_field{FieldOperation::Create(std::make_unique<mf::CustomMF_Constant<int>>(10)),
@@ -179,4 +179,55 @@ TEST(lazy_function, GraphWithCycle)
   EXPECT_EQ(result, 10 * 2 * 5);
 }
 
+class ExecutionTimeLogger : public GraphExecutor::Logger {
+ public:
+  mutable std::atomic<int> logged_num = 0;
+
+  void log_node_execution_time(const FunctionNode & /*node*/,
+                               const timeit::Nanoseconds duration,
+                               const Context & /*context*/) const override
+  {
+    EXPECT_GE(duration.count(), 0);
+    logged_num++;
+  }
+};
+
+TEST(lazy_function, ExecutionTimes)
+{
+  const AddLazyFunction add_fn;
+
+  Graph graph;
+  GraphInputSocket &input_socket = graph.add_input(CPPType::get<int>());
+  GraphOutputSocket &output_socket = graph.add_output(CPPType::get<int>());
+  Vector<FunctionNode *> add_nodes;
+  OutputSocket *prev_socket = &input_socket;
+  for ([[maybe_unused]] const int i : IndexRange(10)) {
+    FunctionNode &add_node = graph.add_function(add_fn);
+    graph.add_link(*prev_socket, add_node.input(0));
+    graph.add_link(input_socket, add_node.input(1));
+    add_nodes.append(&add_node);
+    prev_socket = &add_node.output(0);
+  }
+  graph.add_link(*prev_socket, output_socket);
+  graph.update_node_indices();
+
+  ExecutionTimeLogger logger;
+  GraphExecutor executor_fn{graph, {&input_socket}, {&output_socket}, &logger, nullptr, nullptr};
+  for (const FunctionNode *add_node : add_nodes) {
+    EXPECT_EQ(executor_fn.node_run_time_estimate(*add_node).count(), 0);
+  }
+
+  /* Evaluate multiple times, so that the critical path estimates are used as well. */
+  for (const int i : IndexRange(3)) {
+    int result = 0;
+    execute_lazy_function_eagerly(
+        executor_fn, nullptr, nullptr, std::make_tuple(i), std::make_tuple(&result));
+    EXPECT_EQ(result, i * 11);
+  }
+  EXPECT_EQ(logger.logged_num, 30);
+  for (const FunctionNode *add_node : add_nodes) {
+    EXPECT_GT(executor_fn.node_run_time_estimate(*add_node).count(), 0);
+  }
+}
+
 }  // namespace blender::fn::lazy_function::tests
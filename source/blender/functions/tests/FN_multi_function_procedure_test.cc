@@ -7,6 +7,7 @@
 #include "FN_multi_function_builder.hh"
 #include "FN_multi_function_procedure_builder.hh"
 #include "FN_multi_function_procedure_executor.hh"
+#include "FN_multi_function_procedure_optimization.hh"
 #include "FN_multi_function_test_common.hh"
 
 namespace blender::fn::multi_function::tests {
@@ -423,4 +424,56 @@ TEST(multi_function_procedure, OutputBufferReplaced)
   EXPECT_EQ(output[2], output_value);
 }
 
+TEST(multi_function_procedure, FoldConstants)
+{
+  /**
+   * procedure(int a, int *out) {
+   *   int b = 5;
+   *   int c = b + b;
+   *   int d = c + 10;
+   *   out = a + d;
+   * }
+   */
+
+  CustomMF_Constant<int> constant_fn{5};
+  auto add_fn = build::SI2_SO<int, int, int>("add", [](int a, int b) { return a + b; });
+  auto add_10_fn = build::SI1_SO<int, int>("add 10", [](int a) { return a + 10; });
+
+  Procedure procedure;
+  ProcedureBuilder builder{procedure};
+
+  Variable *var_a = &builder.add_single_input_parameter<int>();
+  auto [var_b] = builder.add_call<1>(constant_fn);
+  auto [var_c] = builder.add_call<1>(add_fn, {var_b, var_b});
+  auto [var_d] = builder.add_call<1>(add_10_fn, {var_c});
+  auto [var_out] = builder.add_call<1>(add_fn, {var_a, var_d});
+  builder.add_destruct({var_a, var_b, var_c, var_d});
+  builder.add_return();
+  builder.add_output_parameter(*var_out);
+  EXPECT_TRUE(procedure.validate());
+
+  procedure_optimization::fold_constants(procedure);
+  EXPECT_TRUE(procedure.validate());
+  /* Only the final constant and the destruct instruction remain. */
+  EXPECT_TRUE(var_b->users().is_empty());
+  EXPECT_TRUE(var_c->users().is_empty());
+  EXPECT_EQ(var_d->users().size(), 3);
+
+  ProcedureExecutor procedure_fn{procedure};
+
+  Array<int> inputs = {4, 1, 6};
+  Array<int> results(3, -1);
+  const IndexMask mask(3);
+  ParamsBuilder params{procedure_fn, &mask};
+  params.add_readonly_single_input(inputs.as_span());
+  params.add_uninitialized_single_output(results.as_mutable_span());
+
+  ContextBuilder context;
+  procedure_fn.call(mask, params, context);
+
+  EXPECT_EQ(results[0], 24);
+  EXPECT_EQ(results[1], 21);
+  EXPECT_EQ(results[2], 26);
+}
+
 }  // namespace blender::fn::multi_function::tests
@@ -0,0 +1,41 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#pragma once
+
+#include "BLI_index_mask.hh"
+#include "BLI_math_vector_types.hh"
+
+/** \file
+ * \ingroup geo
+ */
+
+namespace blender::geometry {
+
+/**
+ * Find the selected points that should be merged because they are within \a merge_distance of
+ * another selected point. Every point that is not merged yet becomes the merge target of all
+ * unmerged points around it. Merging is always a single step, i.e. merged points are never used
+ * as targets.
+ *
+ * The points are sorted into a uniform grid with cells at least as large as the merge distance.
+ * Cells that don't share any neighbor cells are processed in parallel, in a fixed order that only
+ * depends on the cell positions. Therefore the result is deterministic and does not depend on the
+ * number of threads.
+ *
+ * \param use_index_order: Visit the points in index order instead of cell order, so that the
+ *   unmerged point with the lowest index becomes the target. Only the neighbor lookup uses the
+ *   grid then, the merging itself is single threaded.
+ * \param r_merge_targets: Array with an entry for every point. For selected points, it is filled
+ *   with -1 if the point is not merged, or the index of the point it is merged into. Targets are
+ *   mapped to themselves. Other entries are not changed.
+ * \return The number of points that are merged into another point.
+ */
+int find_merge_by_distance_targets(Span<float3> positions,
+                                   const IndexMask &selection,
+                                   float merge_distance,
+                                   bool use_index_order,
+                                   MutableSpan<int> r_merge_targets);
+
+}  // namespace blender::geometry
@@ -19,7 +19,8 @@ namespace blender::geometry {
 
 /**
  * Merge selected vertices into other selected vertices within the \a merge_distance. The merged
- * indices favor speed over accuracy, since the results will depend on the order of the vertices.
+ * indices favor speed over accuracy, since the results depend on which vertices are processed
+ * first. See #find_merge_by_distance_targets.
  *
  * \returns #std::nullopt if the mesh should not be changed (no vertices are merged), in order to
  * avoid copying the input. Otherwise returns the new mesh with merged geometry.
@@ -18,7 +18,8 @@ namespace blender::geometry {
 
 /**
  * Merge selected points into other selected points within the \a merge_distance. The merged
- * indices favor speed over accuracy, since the results will depend on the order of the points.
+ * indices favor speed over accuracy, since the results depend on which points are processed
+ * first. See #find_merge_by_distance_targets.
  */
 PointCloud *point_merge_by_distance(const PointCloud &src_points,
                                     const float merge_distance,
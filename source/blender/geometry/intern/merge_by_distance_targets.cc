@@ -0,0 +1,294 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+
+#include "BLI_array.hh"
+#include "BLI_bounds.hh"
+#include "BLI_math_vector.hh"
+#include "BLI_offset_indices.hh"
+#include "BLI_sort.hh"
+#include "BLI_task.hh"
+#include "BLI_vector.hh"
+
+#include "GEO_merge_by_distance_targets.hh"
+
+namespace blender::geometry {
+
+/**
+ * Grid cells are identified by their three coordinates packed into a single integer, so that
+ * sorting by the key groups cells into rows along the z axis. Coordinates are relative to the
+ * bounds of the points and clamped to the available bits. The cell size is chosen so that clamping
+ * does not happen in practice, it only guards against rounding at the far end of the bounds.
+ */
+using CellKey = uint64_t;
+static constexpr int cell_coord_bits = 21;
+static constexpr uint32_t cell_coord_max = (1u << cell_coord_bits) - 1;
+
+/** The number of passes over the cells. Cells in the same pass don't share any neighbors. */
+static constexpr int passes_num = 3 * 3 * 3;
+
+/**
+ * Cells are made larger than the merge distance when the points are sparse, to avoid looking up
+ * many neighbor cells that contain only a single point.
+ */
+static constexpr float points_per_cell = 4.0f;
+
+static uint32_t cell_coord(const float value, const float min, const float cell_size)
+{
+  const double cell = std::floor((double(value) - double(min)) / double(cell_size));
+  if (!(cell > 0.0)) {
+    /* Also handles NaN. */
+    return 0;
+  }
+  return uint32_t(std::min(cell, double(cell_coord_max)));
+}
+
+static CellKey cell_key(const uint32_t x, const uint32_t y, const uint32_t z)
+{
+  return (CellKey(x) << (2 * cell_coord_bits)) | (CellKey(y) << cell_coord_bits) | CellKey(z);
+}
+
+static std::array<uint32_t, 3> cell_coords(const CellKey key)
+{
+  return {uint32_t(key >> (2 * cell_coord_bits)),
+          uint32_t(key >> cell_coord_bits) & cell_coord_max,
+          uint32_t(key) & cell_coord_max};
+}
+
+static int cell_pass(const CellKey key)
+{
+  const std::array<uint32_t, 3> coords = cell_coords(key);
+  return int(coords[0] % 3 + (coords[1] % 3) * 3 + (coords[2] % 3) * 9);
+}
+
+static float calc_cell_size(const Bounds<float3> &bounds,
+                            const int64_t points_num,
+                            const float merge_distance)
+{
+  const float3 size = bounds.max - bounds.min;
+  std::array<float, 3> extents = {size.x, size.y, size.z};
+  std::sort(extents.begin(), extents.end(), std::greater<>());
+
+  /* Estimate the density only from the extents in which the points spread over multiple cells.
+   * Planar or linear inputs would otherwise have no volume. */
+  float cell_size = 0.0f;
+  float measure = 1.0f;
+  for (const int dims : IndexRange(1, 3)) {
+    const float extent = extents[dims - 1];
+    if (!(extent > cell_size)) {
+      break;
+    }
+    measure *= extent;
+    cell_size = std::pow(measure * points_per_cell / float(points_num), 1.0f / float(dims));
+  }
+  cell_size = std::max(cell_size, merge_distance);
+
+  /* Make sure cell coordinates never saturate, which would put many points in the outer cells. */
+  cell_size = std::max(cell_size, extents[0] / float(cell_coord_max));
+
+  if (!(cell_size > 0.0f) || !std::isfinite(cell_size)) {
+    /* All points are at the same position or the bounds are invalid. */
+    return 1.0f;
+  }
+  return cell_size;
+}
+
+/** Points are stored in cell order, so the points of neighboring cells are close in memory. */
+struct GridPoint {
+  CellKey cell;
+  float3 position;
+  int index;
+};
+
+int find_merge_by_distance_targets(const Span<float3> positions,
+                                   const IndexMask &selection,
+                                   const float merge_distance,
+                                   const bool use_index_order,
+                                   MutableSpan<int> r_merge_targets)
+{
+  BLI_assert(positions.size() == r_merge_targets.size());
+  index_mask::masked_fill(r_merge_targets, -1, selection);
+  if (selection.is_empty() || merge_distance < 0.0f) {
+    return 0;
+  }
+  const Bounds<float3> bounds = *bounds::min_max(selection, positions);
+  const float cell_size = calc_cell_size(bounds, selection.size(), merge_distance);
+  const float merge_distance_sq = merge_distance * merge_distance;
+
+  /* Sort the points by cell. Within a cell, points are processed in index order. */
+  Array<GridPoint> points(selection.size());
+  selection.foreach_index_optimized<int>(GrainSize(4096), [&](const int i, const int pos) {
+    const float3 &position = positions[i];
+    points[pos] = {cell_key(cell_coord(position.x, bounds.min.x, cell_size),
+                            cell_coord(position.y, bounds.min.y, cell_size),
+                            cell_coord(position.z, bounds.min.z, cell_size)),
+                   position,
+                   i};
+  });
+  parallel_sort(points.begin(), points.end(), [](const GridPoint &a, const GridPoint &b) {
+    return a.cell < b.cell || (a.cell == b.cell && a.index < b.index);
+  });
+
+  IndexMaskMemory memory;
+  const IndexMask cell_starts = IndexMask::from_predicate(
+      points.index_range(), GrainSize(4096), memory, [&](const int64_t i) {
+        return i == 0 || points[i].cell != points[i - 1].cell;
+      });
+  Array<int> cell_offsets_data(cell_starts.size() + 1);
+  cell_starts.to_indices<int>(cell_offsets_data.as_mutable_span().drop_back(1));
+  cell_offsets_data.last() = points.size();
+  const OffsetIndices<int> cells(cell_offsets_data);
+
+  Array<CellKey> cell_keys(cells.size());
+  threading::parallel_for(cells.index_range(), 4096, [&](const IndexRange range) {
+    for (const int cell : range) {
+      cell_keys[cell] = points[cells[cell].first()].cell;
+    }
+  });
+
+  /**
+   * The cells of a row with the same x and y coordinates are consecutive, so the points of up to
+   * three neighboring cells in that row are a single range.
+   */
+  const auto find_row_points = [&](const Span<CellKey> keys_to_search,
+                                   const uint32_t x,
+                                   const uint32_t y,
+                                   const uint32_t z) -> IndexRange {
+    const CellKey first_key = cell_key(x, y, z == 0 ? 0 : z - 1);
+    const CellKey last_key = cell_key(x, y, std::min(z + 1, cell_coord_max));
+    const CellKey *first = std::lower_bound(
+        keys_to_search.begin(), keys_to_search.end(), first_key);
+    const CellKey *last = first;
+    while (last != keys_to_search.end() && *last <= last_key) {
+      last++;
+    }
+    if (first == last) {
+      return {};
+    }
+    const int first_cell = int(first - cell_keys.begin());
+    const int last_cell = int(last - cell_keys.begin()) - 1;
+    return IndexRange::from_begin_end(cells[first_cell].first(),
+                                      cells[last_cell].one_after_last());
+  };
+
+  /** The points of the cell and its neighbors, as ranges in the sorted points. */
+  using NeighborRows = Vector<IndexRange, 9>;
+  const auto find_neighbor_rows = [&](const int cell) {
+    const std::array<uint32_t, 3> coords = cell_coords(cell_keys[cell]);
+    /* Rows before the current cell come first in the sorted keys, rows after it come later. */
+    const Span<CellKey> keys_before = cell_keys.as_span().take_front(cell);
+    const Span<CellKey> keys_after = cell_keys.as_span().drop_front(cell);
+    NeighborRows neighbor_rows;
+    for (const int dx : {-1, 0, 1}) {
+      for (const int dy : {-1, 0, 1}) {
+        const int64_t x = int64_t(coords[0]) + dx;
+        const int64_t y = int64_t(coords[1]) + dy;
+        if (std::min(x, y) < 0 || std::max(x, y) > cell_coord_max) {
+          continue;
+        }
+        const bool is_before = dx < 0 || (dx == 0 && dy < 0);
+        const bool is_current = dx == 0 && dy == 0;
+        const Span<CellKey> keys_to_search = is_current ?
+                                                 cell_keys.as_span() :
+                                                 (is_before ? keys_before : keys_after);
+        const IndexRange row = find_row_points(
+            keys_to_search, uint32_t(x), uint32_t(y), coords[2]);
+        if (!row.is_empty()) {
+          neighbor_rows.append_unchecked(row);
+        }
+      }
+    }
+    return neighbor_rows;
+  };
+
+  /* The target of every point in sorted order, or -1 if the point has not been merged yet. */
+  Array<int> sorted_targets(points.size(), -1);
+
+  /** Merge all unmerged points around the point into it, returns the number of merged points. */
+  const auto merge_point = [&](const int pos, const Span<IndexRange> neighbor_rows) {
+    if (sorted_targets[pos] != -1) {
+      return 0;
+    }
+    const int i = points[pos].index;
+    const float3 &position = points[pos].position;
+    int point_merged_num = 0;
+    for (const IndexRange row : neighbor_rows) {
+      for (const int other_pos : row) {
+        if (other_pos == pos || sorted_targets[other_pos] != -1) {
+          continue;
+        }
+        if (math::distance_squared(position, points[other_pos].position) <= merge_distance_sq) {
+          sorted_targets[other_pos] = i;
+          point_merged_num++;
+        }
+      }
+    }
+    if (point_merged_num > 0) {
+      /* Prevent chains of merges. */
+      sorted_targets[pos] = i;
+    }
+    return point_merged_num;
+  };
+
+  std::atomic<int> merged_num = 0;
+  if (use_index_order) {
+    /* Visit the points in index order. Consecutive indices are often in the same cell, so the
+     * neighbor rows are only looked up again when the cell changes. */
+    Array<int> pos_by_index(positions.size());
+    Array<int> point_cells(points.size());
+    threading::parallel_for(cells.index_range(), 1024, [&](const IndexRange range) {
+      for (const int cell : range) {
+        for (const int pos : cells[cell]) {
+          pos_by_index[points[pos].index] = pos;
+          point_cells[pos] = cell;
+        }
+      }
+    });
+    int current_cell = -1;
+    NeighborRows neighbor_rows;
+    int index_order_merged_num = 0;
+    selection.foreach_index([&](const int i) {
+      const int pos = pos_by_index[i];
+      if (point_cells[pos] != current_cell) {
+        current_cell = point_cells[pos];
+        neighbor_rows = find_neighbor_rows(current_cell);
+      }
+      index_order_merged_num += merge_point(pos, neighbor_rows);
+    });
+    merged_num = index_order_merged_num;
+  }
+  else {
+    /* Cells in the same pass are at least three cells apart in one direction. So they don't
+     * change the same points and can be processed in parallel without affecting the result. */
+    std::array<IndexMask, passes_num> pass_cells;
+    IndexMask::from_groups<int>(
+        cells.index_range(),
+        memory,
+        [&](const int64_t cell) { return cell_pass(cell_keys[cell]); },
+        pass_cells);
+    for (const IndexMask &cells_in_pass : pass_cells) {
+      cells_in_pass.foreach_index(GrainSize(64), [&](const int cell) {
+        const NeighborRows neighbor_rows = find_neighbor_rows(cell);
+        int cell_merged_num = 0;
+        for (const int pos : cells[cell]) {
+          cell_merged_num += merge_point(pos, neighbor_rows);
+        }
+        merged_num += cell_merged_num;
+      });
+    }
+  }
+
+  threading::parallel_for(points.index_range(), 4096, [&](const IndexRange range) {
+    for (const int pos : range) {
+      r_merge_targets[points[pos].index] = sorted_targets[pos];
+    }
+  });
+
+  return merged_num;
+}
+
+}  // namespace blender::geometry
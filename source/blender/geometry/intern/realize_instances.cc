@@ -360,6 +360,13 @@ static int64_t get_final_points_num(const GatherTasks &tasks)
   return points_num;
 }
 
+/**
+ * Approximate number of elements that are realized on a thread at once. Consecutive instances are
+ * grouped into batches of about this size, so that many tiny instances don't cause scheduling
+ * overhead, while a single large instance is still split up further internally.
+ */
+static constexpr int64_t realize_batch_elements_num = 8192;
+
 static void copy_transformed_positions(const Span<float3> src,
                                        const float4x4 &transform,
                                        MutableSpan<float3> dst)
@@ -433,6 +440,46 @@ static void copy_generic_attributes_to_result(
       });
 }
 
+/**
+ * Same as #copy_generic_attributes_to_result, but for a batch of consecutive tasks. The batch is
+ * processed column-wise, i.e. one attribute after the other, so that every destination array is
+ * written sequentially. The copies are only multi-threaded within large instances, small instances
+ * don't have any per-instance scheduling overhead.
+ *
+ * \param src_attributes_fn: Returns the source attributes of a task, ordered like
+ *   #ordered_attributes.
+ * \param range_fn: Returns the range of elements in the result that a task writes to.
+ */
+template<typename TaskT, typename SrcAttributesFn, typename RangeFn>
+static void copy_generic_attributes_to_result_batch(
+    const Span<TaskT> tasks,
+    const OrderedAttributes &ordered_attributes,
+    const SrcAttributesFn &src_attributes_fn,
+    const RangeFn &range_fn,
+    MutableSpan<GSpanAttributeWriter> dst_attribute_writers)
+{
+  for (const int attribute_index : dst_attribute_writers.index_range()) {
+    const bke::AttrDomain domain = ordered_attributes.kinds[attribute_index].domain;
+    const GMutableSpan dst_span = dst_attribute_writers[attribute_index].span;
+    const CPPType &cpp_type = dst_span.type();
+    for (const TaskT &task : tasks) {
+      const IndexRange element_slice = range_fn(task, domain);
+      if (element_slice.is_empty()) {
+        continue;
+      }
+      const Span<std::optional<GVArraySpan>> src_attributes = src_attributes_fn(task);
+      if (src_attributes[attribute_index].has_value()) {
+        threaded_copy(*src_attributes[attribute_index], dst_span.slice(element_slice));
+      }
+      else {
+        const void *fallback = task.attribute_fallbacks.array[attribute_index];
+        threaded_fill({cpp_type, fallback ? fallback : cpp_type.default_value()},
+                      dst_span.slice(element_slice));
+      }
+    }
+  }
+}
+
 static void create_result_ids(const RealizeInstancesOptions &options,
                               const Span<int> stored_ids,
                               const int task_id,
@@ -1119,8 +1166,6 @@ static AllPointCloudsInfo preprocess_pointclouds(const bke::GeometrySet &geometr
 static void execute_realize_pointcloud_task(
     const RealizeInstancesOptions &options,
     const RealizePointCloudTask &task,
-    const OrderedAttributes &ordered_attributes,
-    MutableSpan<GSpanAttributeWriter> dst_attribute_writers,
     MutableSpan<float> all_dst_radii,
     MutableSpan<int> all_dst_ids,
     MutableSpan<float3> all_dst_positions)
@@ -1140,17 +1185,13 @@ static void execute_realize_pointcloud_task(
   if (!all_dst_radii.is_empty()) {
     pointcloud_info.radii.materialize(all_dst_radii.slice(point_slice));
   }
+}
 
-  copy_generic_attributes_to_result(
-      pointcloud_info.attributes,
-      task.attribute_fallbacks,
-      ordered_attributes,
-      [&](const bke::AttrDomain domain) {
-        BLI_assert(domain == bke::AttrDomain::Point);
-        UNUSED_VARS_NDEBUG(domain);
-        return point_slice;
-      },
-      dst_attribute_writers);
+static int64_t pointcloud_tasks_elements_num(const Span<RealizePointCloudTask> tasks)
+{
+  const RealizePointCloudTask &last_task = tasks.last();
+  return last_task.start_index + last_task.pointcloud_info->pointcloud->totpoint -
+         tasks.first().start_index;
 }
 
 static void execute_realize_pointcloud_tasks(const RealizeInstancesOptions &options,
@@ -1201,19 +1242,32 @@ static void execute_realize_pointcloud_tasks(const RealizeInstancesOptions &opti
         attribute_id, bke::AttrDomain::Point, data_type));
   }
 
-  /* Actually execute all tasks. */
-  threading::parallel_for(tasks.index_range(), 100, [&](const IndexRange task_range) {
-    for (const int task_index : task_range) {
-      const RealizePointCloudTask &task = tasks[task_index];
-      execute_realize_pointcloud_task(options,
-                                      task,
-                                      ordered_attributes,
-                                      dst_attribute_writers,
-                                      point_radii.span,
-                                      point_ids.span,
-                                      positions.span);
-    }
-  });
+  /* Actually execute all tasks, in batches of consecutive tasks with a similar size. */
+  threading::parallel_for(
+      tasks.index_range(),
+      realize_batch_elements_num,
+      [&](const IndexRange task_range) {
+        const Span<RealizePointCloudTask> batch = tasks.slice(task_range);
+        for (const RealizePointCloudTask &task : batch) {
+          execute_realize_pointcloud_task(
+              options, task, point_radii.span, point_ids.span, positions.span);
+        }
+        copy_generic_attributes_to_result_batch(
+            batch,
+            ordered_attributes,
+            [](const RealizePointCloudTask &task) {
+              return task.pointcloud_info->attributes.as_span();
+            },
+            [](const RealizePointCloudTask &task, const bke::AttrDomain domain) {
+              BLI_assert(domain == bke::AttrDomain::Point);
+              UNUSED_VARS_NDEBUG(domain);
+              return IndexRange(task.start_index, task.pointcloud_info->pointcloud->totpoint);
+            },
+            dst_attribute_writers);
+      },
+      threading::accumulated_task_sizes([&](const IndexRange task_range) {
+        return pointcloud_tasks_elements_num(tasks.slice(task_range));
+      }));
 
   /* Tag modified attributes. */
   for (GSpanAttributeWriter &dst_attribute : dst_attribute_writers) {
@@ -1370,8 +1424,6 @@ static AllMeshesInfo preprocess_meshes(const bke::GeometrySet &geometry_set,
 
 static void execute_realize_mesh_task(const RealizeInstancesOptions &options,
                                       const RealizeMeshTask &task,
-                                      const OrderedAttributes &ordered_attributes,
-                                      MutableSpan<GSpanAttributeWriter> dst_attribute_writers,
                                       MutableSpan<float3> all_dst_positions,
                                       MutableSpan<int2> all_dst_edges,
                                       MutableSpan<int> all_dst_face_offsets,
@@ -1457,27 +1509,35 @@ static void execute_realize_mesh_task(const RealizeInstancesOptions &options,
                       task.id,
                       all_dst_vertex_ids.slice(task.start_indices.vertex, mesh.verts_num));
   }
+}
 
-  copy_generic_attributes_to_result(
-      mesh_info.attributes,
-      task.attribute_fallbacks,
-      ordered_attributes,
-      [&](const bke::AttrDomain domain) {
-        switch (domain) {
-          case bke::AttrDomain::Point:
-            return dst_vert_range;
-          case bke::AttrDomain::Edge:
-            return dst_edge_range;
-          case bke::AttrDomain::Face:
-            return dst_face_range;
-          case bke::AttrDomain::Corner:
-            return dst_loop_range;
-          default:
-            BLI_assert_unreachable();
-            return IndexRange();
-        }
-      },
-      dst_attribute_writers);
+static IndexRange mesh_task_dst_range(const RealizeMeshTask &task, const bke::AttrDomain domain)
+{
+  const Mesh &mesh = *task.mesh_info->mesh;
+  switch (domain) {
+    case bke::AttrDomain::Point:
+      return IndexRange(task.start_indices.vertex, mesh.verts_num);
+    case bke::AttrDomain::Edge:
+      return IndexRange(task.start_indices.edge, mesh.edges_num);
+    case bke::AttrDomain::Face:
+      return IndexRange(task.start_indices.face, mesh.faces_num);
+    case bke::AttrDomain::Corner:
+      return IndexRange(task.start_indices.loop, mesh.corners_num);
+    default:
+      BLI_assert_unreachable();
+      return IndexRange();
+  }
+}
+
+static int64_t mesh_tasks_elements_num(const Span<RealizeMeshTask> tasks)
+{
+  const MeshElementStartIndices &first = tasks.first().start_indices;
+  const MeshElementStartIndices &last = tasks.last().start_indices;
+  const Mesh &last_mesh = *tasks.last().mesh_info->mesh;
+  return int64_t(last.vertex + last_mesh.verts_num - first.vertex) +
+         int64_t(last.edge + last_mesh.edges_num - first.edge) +
+         int64_t(last.face + last_mesh.faces_num - first.face) +
+         int64_t(last.loop + last_mesh.corners_num - first.loop);
 }
 
 static void execute_realize_mesh_tasks(const RealizeInstancesOptions &options,
@@ -1559,23 +1619,33 @@ static void execute_realize_mesh_tasks(const RealizeInstancesOptions &options,
       CustomData_set_layer_render(&dst_mesh->corner_data, CD_PROP_FLOAT2, id);
     }
   }
-  /* Actually execute all tasks. */
-  threading::parallel_for(tasks.index_range(), 100, [&](const IndexRange task_range) {
-    for (const int task_index : task_range) {
-      const RealizeMeshTask &task = tasks[task_index];
-      execute_realize_mesh_task(options,
-                                task,
-                                ordered_attributes,
-                                dst_attribute_writers,
-                                dst_positions,
-                                dst_edges,
-                                dst_face_offsets,
-                                dst_corner_verts,
-                                dst_corner_edges,
-                                vertex_ids.span,
-                                material_indices.span);
-    }
-  });
+  /* Actually execute all tasks, in batches of consecutive tasks with a similar size. */
+  threading::parallel_for(
+      tasks.index_range(),
+      realize_batch_elements_num,
+      [&](const IndexRange task_range) {
+        const Span<RealizeMeshTask> batch = tasks.slice(task_range);
+        for (const RealizeMeshTask &task : batch) {
+          execute_realize_mesh_task(options,
+                                    task,
+                                    dst_positions,
+                                    dst_edges,
+                                    dst_face_offsets,
+                                    dst_corner_verts,
+                                    dst_corner_edges,
+                                    vertex_ids.span,
+                                    material_indices.span);
+        }
+        copy_generic_attributes_to_result_batch(
+            batch,
+            ordered_attributes,
+            [](const RealizeMeshTask &task) { return task.mesh_info->attributes.as_span(); },
+            mesh_task_dst_range,
+            dst_attribute_writers);
+      },
+      threading::accumulated_task_sizes([&](const IndexRange task_range) {
+        return mesh_tasks_elements_num(tasks.slice(task_range));
+      }));
 
   /* Tag modified attributes. */
   for (GSpanAttributeWriter &dst_attribute : dst_attribute_writers) {
@@ -1720,9 +1790,7 @@ static AllCurvesInfo preprocess_curves(const bke::GeometrySet &geometry_set,
 static void execute_realize_curve_task(const RealizeInstancesOptions &options,
                                        const AllCurvesInfo &all_curves_info,
                                        const RealizeCurveTask &task,
-                                       const OrderedAttributes &ordered_attributes,
                                        bke::CurvesGeometry &dst_curves,
-                                       MutableSpan<GSpanAttributeWriter> dst_attribute_writers,
                                        MutableSpan<int> all_dst_ids,
                                        MutableSpan<float3> all_handle_left,
                                        MutableSpan<float3> all_handle_right,
@@ -1802,23 +1870,29 @@ static void execute_realize_curve_task(const RealizeInstancesOptions &options,
     create_result_ids(
         options, curves_info.stored_ids, task.id, all_dst_ids.slice(dst_point_range));
   }
+}
 
-  copy_generic_attributes_to_result(
-      curves_info.attributes,
-      task.attribute_fallbacks,
-      ordered_attributes,
-      [&](const bke::AttrDomain domain) {
-        switch (domain) {
-          case bke::AttrDomain::Point:
-            return IndexRange(task.start_indices.point, curves.points_num());
-          case bke::AttrDomain::Curve:
-            return IndexRange(task.start_indices.curve, curves.curves_num());
-          default:
-            BLI_assert_unreachable();
-            return IndexRange();
-        }
-      },
-      dst_attribute_writers);
+static IndexRange curve_task_dst_range(const RealizeCurveTask &task, const bke::AttrDomain domain)
+{
+  const bke::CurvesGeometry &curves = task.curve_info->curves->geometry.wrap();
+  switch (domain) {
+    case bke::AttrDomain::Point:
+      return IndexRange(task.start_indices.point, curves.points_num());
+    case bke::AttrDomain::Curve:
+      return IndexRange(task.start_indices.curve, curves.curves_num());
+    default:
+      BLI_assert_unreachable();
+      return IndexRange();
+  }
+}
+
+static int64_t curve_tasks_elements_num(const Span<RealizeCurveTask> tasks)
+{
+  const CurvesElementStartIndices &first = tasks.first().start_indices;
+  const CurvesElementStartIndices &last = tasks.last().start_indices;
+  const bke::CurvesGeometry &last_curves = tasks.last().curve_info->curves->geometry.wrap();
+  return int64_t(last.point + last_curves.points_num() - first.point) +
+         int64_t(last.curve + last_curves.curves_num() - first.curve);
 }
 
 static void execute_realize_curve_tasks(const RealizeInstancesOptions &options,
@@ -1896,25 +1970,35 @@ static void execute_realize_curve_tasks(const RealizeInstancesOptions &options,
         "custom_normal", bke::AttrDomain::Point);
   }
 
-  /* Actually execute all tasks. */
-  threading::parallel_for(tasks.index_range(), 100, [&](const IndexRange task_range) {
-    for (const int task_index : task_range) {
-      const RealizeCurveTask &task = tasks[task_index];
-      execute_realize_curve_task(options,
-                                 all_curves_info,
-                                 task,
-                                 ordered_attributes,
-                                 dst_curves,
-                                 dst_attribute_writers,
-                                 point_ids.span,
-                                 handle_left.span,
-                                 handle_right.span,
-                                 radius.span,
-                                 nurbs_weight.span,
-                                 resolution.span,
-                                 custom_normal.span);
-    }
-  });
+  /* Actually execute all tasks, in batches of consecutive tasks with a similar size. */
+  threading::parallel_for(
+      tasks.index_range(),
+      realize_batch_elements_num,
+      [&](const IndexRange task_range) {
+        const Span<RealizeCurveTask> batch = tasks.slice(task_range);
+        for (const RealizeCurveTask &task : batch) {
+          execute_realize_curve_task(options,
+                                     all_curves_info,
+                                     task,
+                                     dst_curves,
+                                     point_ids.span,
+                                     handle_left.span,
+                                     handle_right.span,
+                                     radius.span,
+                                     nurbs_weight.span,
+                                     resolution.span,
+                                     custom_normal.span);
+        }
+        copy_generic_attributes_to_result_batch(
+            batch,
+            ordered_attributes,
+            [](const RealizeCurveTask &task) { return task.curve_info->attributes.as_span(); },
+            curve_task_dst_range,
+            dst_attribute_writers);
+      },
+      threading::accumulated_task_sizes([&](const IndexRange task_range) {
+        return curve_tasks_elements_num(tasks.slice(task_range));
+      }));
 
   /* Type counts have to be updated eagerly. */
   dst_curves.runtime->type_counts.fill(0);
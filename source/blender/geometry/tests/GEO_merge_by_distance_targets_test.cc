@@ -0,0 +1,163 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include "BLI_array.hh"
+#include "BLI_math_vector.hh"
+#include "BLI_rand.hh"
+#include "BLI_vector.hh"
+
+#include "GEO_merge_by_distance_targets.hh"
+
+#include "testing/testing.h"
+
+namespace blender::geometry::tests {
+
+static Array<float3> random_positions(const int size, const float extent)
+{
+  RandomNumberGenerator rng(42);
+  Array<float3> positions(size);
+  for (float3 &position : positions) {
+    position = float3(rng.get_float(), rng.get_float(), rng.get_float()) * extent - extent / 2;
+  }
+  return positions;
+}
+
+TEST(merge_by_distance_targets, exact_duplicates)
+{
+  const Array<float3> positions = {
+      {0, 0, 0}, {1, 0, 0}, {0, 0, 0}, {1, 0, 0}, {2, 0, 0}, {0, 0, 0}};
+  for (const bool use_index_order : {false, true}) {
+    Array<int> targets(positions.size());
+    EXPECT_EQ(find_merge_by_distance_targets(
+                  positions, positions.index_range(), 0.0f, use_index_order, targets),
+              3);
+    EXPECT_EQ(targets.as_span(), Span<int>({0, 1, 0, 1, -1, 0}));
+  }
+}
+
+TEST(merge_by_distance_targets, selection)
+{
+  const Array<float3> positions = {{0, 0, 0}, {0.1f, 0, 0}, {0.2f, 0, 0}, {5, 0, 0}};
+  IndexMaskMemory memory;
+  const IndexMask selection = IndexMask::from_indices<int>({1, 2, 3}, memory);
+  for (const bool use_index_order : {false, true}) {
+    Array<int> targets(positions.size(), 7);
+    EXPECT_EQ(find_merge_by_distance_targets(positions, selection, 0.5f, use_index_order, targets),
+              1);
+    EXPECT_EQ(targets.as_span(), Span<int>({7, 1, 1, -1}));
+  }
+}
+
+/** Like merging with a KD-tree in index order, the lowest unmerged index becomes the target. */
+TEST(merge_by_distance_targets, index_order)
+{
+  const Array<float3> positions = {
+      {1.1f, 0, 0}, {0.9f, 0, 0}, {-1.1f, 0, 0}, {-0.9f, 0, 0}, {0, 0, 0}, {0.7f, 0, 0}};
+  Array<int> targets(positions.size());
+  EXPECT_EQ(
+      find_merge_by_distance_targets(positions, positions.index_range(), 0.5f, true, targets), 3);
+  EXPECT_EQ(targets.as_span(), Span<int>({0, 0, 2, 2, -1, 0}));
+}
+
+/**
+ * Large planar grids have no volume, the cell size then must still follow the density of the
+ * points, otherwise most points end up in the same cells.
+ */
+TEST(merge_by_distance_targets, planar_grid)
+{
+  const int grid_size = 500;
+  const int duplicate_step = 7;
+  for (const float spacing : {1e-4f, 1.0f, 1e5f}) {
+    Vector<float3> positions;
+    for (const int y : IndexRange(grid_size)) {
+      for (const int x : IndexRange(grid_size)) {
+        positions.append(float3(x, y, 0.0f) * spacing);
+      }
+    }
+    const int grid_points_num = positions.size();
+    for (int i = 0; i < grid_points_num; i += duplicate_step) {
+      const float3 position = positions[i];
+      positions.append(position);
+    }
+
+    Array<int> targets(positions.size());
+    const int merged_num = find_merge_by_distance_targets(
+        positions, positions.index_range(), 0.0f, false, targets);
+    EXPECT_EQ(merged_num, positions.size() - grid_points_num);
+    for (const int i : positions.index_range().drop_front(grid_points_num)) {
+      EXPECT_EQ(targets[i], (i - grid_points_num) * duplicate_step);
+    }
+    for (int i = 0; i < grid_points_num; i++) {
+      EXPECT_EQ(targets[i], i % duplicate_step == 0 ? i : -1);
+    }
+  }
+}
+
+/** Reference implementation, the same as merging with a KD-tree in index order. */
+static Array<int> merge_targets_brute_force(const Span<float3> positions,
+                                            const float merge_distance)
+{
+  Array<int> targets(positions.size(), -1);
+  for (const int i : positions.index_range()) {
+    if (targets[i] != -1) {
+      continue;
+    }
+    for (const int j : positions.index_range()) {
+      if (j != i && targets[j] == -1 &&
+          math::distance_squared(positions[i], positions[j]) <= merge_distance * merge_distance)
+      {
+        targets[j] = i;
+        targets[i] = i;
+      }
+    }
+  }
+  return targets;
+}
+
+TEST(merge_by_distance_targets, random)
+{
+  const float merge_distance = 0.05f;
+  const Array<float3> positions = random_positions(5000, 1.0f);
+  for (const bool use_index_order : {false, true}) {
+    Array<int> targets(positions.size());
+    const int merged_num = find_merge_by_distance_targets(
+        positions, positions.index_range(), merge_distance, use_index_order, targets);
+    EXPECT_GT(merged_num, 0);
+
+    int expected_merged_num = 0;
+    for (const int i : positions.index_range()) {
+      const int target = targets[i];
+      if (target == -1 || target == i) {
+        continue;
+      }
+      expected_merged_num++;
+      /* Merged points are close to their target, and targets are not merged themselves. */
+      EXPECT_LE(math::distance(positions[i], positions[target]), merge_distance);
+      EXPECT_EQ(targets[target], target);
+    }
+    EXPECT_EQ(merged_num, expected_merged_num);
+
+    /* None of the remaining points are close to each other. */
+    for (const int i : positions.index_range()) {
+      for (const int j : positions.index_range().drop_front(i + 1)) {
+        if (ELEM(targets[i], -1, i) && ELEM(targets[j], -1, j)) {
+          EXPECT_GT(math::distance_squared(positions[i], positions[j]),
+                    merge_distance * merge_distance);
+        }
+      }
+    }
+
+    /* The result is deterministic. */
+    Array<int> targets_again(positions.size());
+    find_merge_by_distance_targets(
+        positions, positions.index_range(), merge_distance, use_index_order, targets_again);
+    EXPECT_EQ(targets.as_span(), targets_again.as_span());
+
+    if (use_index_order) {
+      EXPECT_EQ(targets.as_span(), merge_targets_brute_force(positions, merge_distance).as_span());
+    }
+  }
+}
+
+}  // namespace blender::geometry::tests
@@ -5,10 +5,17 @@
 #include "ply_import_buffer.hh"
 
 #include "BLI_fileops.h"
+#include "BLI_mmap.h"
 
 #include <cstdio>
 #include <cstring>
+#include <fcntl.h>
 #include <stdexcept>
+#ifndef WIN32
+#  include <unistd.h>
+#else
+#  include <io.h>
+#endif
 
 static inline bool is_newline(char ch)
 {
@@ -17,14 +24,20 @@ static inline bool is_newline(char ch)
 
 namespace blender::io::ply {
 
-PlyReadBuffer::PlyReadBuffer(const char *file_path, size_t read_buffer_size)
-    : buffer_(read_buffer_size), read_buffer_size_(read_buffer_size)
+PlyReadBuffer::PlyReadBuffer(const char *file_path, size_t read_buffer_size, bool use_mmap)
+    : buffer_(read_buffer_size),
+      read_buffer_size_(read_buffer_size),
+      file_path_(file_path),
+      use_mmap_(use_mmap)
 {
   file_ = BLI_fopen(file_path, "rb");
 }
 
 PlyReadBuffer::~PlyReadBuffer()
 {
+  if (mmap_file_ != nullptr) {
+    BLI_mmap_free(mmap_file_);
+  }
   if (file_ != nullptr) {
     fclose(file_);
   }
@@ -33,6 +46,37 @@ PlyReadBuffer::~PlyReadBuffer()
 void PlyReadBuffer::after_header(bool is_binary)
 {
   is_binary_ = is_binary;
+  if (!is_binary_ || !use_mmap_ || file_ == nullptr) {
+    return;
+  }
+
+  const int file = BLI_open(file_path_.c_str(), O_BINARY | O_RDONLY, 0);
+  if (file == -1) {
+    return;
+  }
+  mmap_file_ = BLI_mmap_open(file);
+  close(file);
+  if (mmap_file_ == nullptr) {
+    return;
+  }
+  mapped_data_ = static_cast<const uint8_t *>(BLI_mmap_get_pointer(mmap_file_));
+  mapped_size_ = BLI_mmap_get_length(mmap_file_);
+  /* Continue right after the header, which has been read through the buffer. */
+  mapped_pos_ = std::min(buffer_file_offset_ + pos_, mapped_size_);
+}
+
+Span<uint8_t> PlyReadBuffer::mapped_remaining() const
+{
+  if (mapped_data_ == nullptr) {
+    return {};
+  }
+  return Span<uint8_t>(mapped_data_ + mapped_pos_, int64_t(mapped_size_ - mapped_pos_));
+}
+
+void PlyReadBuffer::skip_mapped(size_t size)
+{
+  BLI_assert(mapped_pos_ + size <= mapped_size_);
+  mapped_pos_ += size;
 }
 
 Span<char> PlyReadBuffer::read_line()
@@ -62,6 +106,14 @@ Span<char> PlyReadBuffer::read_line()
 
 bool PlyReadBuffer::read_bytes(void *dst, size_t size)
 {
+  if (mapped_data_ != nullptr) {
+    if (mapped_pos_ + size > mapped_size_) {
+      return false;
+    }
+    memcpy(dst, mapped_data_ + mapped_pos_, size);
+    mapped_pos_ += size;
+    return true;
+  }
   while (size > 0) {
     if (pos_ + size > buf_used_) {
       if (!refill_buffer()) {
@@ -92,6 +144,7 @@ bool PlyReadBuffer::refill_buffer()
 
   /* Move any leftover to start of buffer. */
   int keep = buf_used_ - pos_;
+  buffer_file_offset_ += pos_;
   if (keep > 0) {
     memmove(buffer_.data(), buffer_.data() + pos_, keep);
   }
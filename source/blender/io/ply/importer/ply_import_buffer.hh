@@ -9,24 +9,47 @@
 #pragma once
 
 #include <cstdio>
+#include <string>
 
 #include "BLI_array.hh"
 #include "BLI_span.hh"
 
+struct BLI_mmap_file;
+
 namespace blender::io::ply {
 
 /**
  * Reads underlying PLY file in large chunks, and provides interface for ascii/header
  * parsing to read individual lines, and for binary parsing to read chunks of bytes.
+ *
+ * With `use_mmap`, the binary body of the file is memory-mapped once the header is parsed, so
+ * that element blocks can be decoded straight from the mapped pages without going through the
+ * read buffer. If mapping fails, reading falls back to the regular buffered reads.
  */
 class PlyReadBuffer {
  public:
-  PlyReadBuffer(const char *file_path, size_t read_buffer_size = 64 * 1024);
+  PlyReadBuffer(const char *file_path, size_t read_buffer_size = 64 * 1024, bool use_mmap = false);
   ~PlyReadBuffer();
 
   /** After header is parsed, indicate whether the rest of reading will be ascii or binary. */
   void after_header(bool is_binary);
 
+  /** Whether the binary body of the file is accessed through a memory mapping. */
+  bool is_mapped() const
+  {
+    return mapped_data_ != nullptr;
+  }
+
+  /**
+   * The not yet consumed part of a memory-mapped file. The data is read-only and stays valid for
+   * the lifetime of the buffer. Empty when the file is not mapped.
+   */
+  Span<uint8_t> mapped_remaining() const;
+
+  /** Move the read position of a memory-mapped file forward, past data used from
+   * #mapped_remaining. */
+  void skip_mapped(size_t size);
+
   /**
    * Gets the next line from the file as a Span. The line does not include any newline characters.
    */
@@ -50,6 +73,15 @@ class PlyReadBuffer {
   size_t read_buffer_size_ = 0;
   bool at_eof_ = false;
   bool is_binary_ = false;
+
+  /** Offset in the file of the first byte in the read buffer. */
+  size_t buffer_file_offset_ = 0;
+  std::string file_path_;
+  bool use_mmap_ = false;
+  BLI_mmap_file *mmap_file_ = nullptr;
+  const uint8_t *mapped_data_ = nullptr;
+  size_t mapped_size_ = 0;
+  size_t mapped_pos_ = 0;
 };
 
 }  // namespace blender::io::ply
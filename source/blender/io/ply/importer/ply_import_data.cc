@@ -12,6 +12,7 @@
 
 #include "BLI_endian_switch.h"
 #include "BLI_string_ref.hh"
+#include "BLI_task.hh"
 
 #include "fast_float.h"
 
@@ -190,6 +191,26 @@ template<typename T> static T get_binary_value(PlyDataTypes type, const uint8_t
   return val;
 }
 
+/**
+ * Same as #get_binary_value, but switches the byte order into a temporary first when needed,
+ * so that it can be used on read-only (memory-mapped) data.
+ */
+template<typename T>
+static T get_binary_value_from_const(PlyDataTypes type, const uint8_t *&r_ptr, bool big_endian)
+{
+  if (!big_endian) {
+    return get_binary_value<T>(type, r_ptr);
+  }
+  const int size = data_type_size[type];
+  uint8_t swapped[8];
+  for (int i = 0; i < size; i++) {
+    swapped[i] = r_ptr[size - 1 - i];
+  }
+  const uint8_t *swapped_ptr = swapped;
+  r_ptr += size;
+  return get_binary_value<T>(type, swapped_ptr);
+}
+
 static const char *parse_row_binary(PlyReadBuffer &file,
                                     const PlyHeader &header,
                                     const PlyElement &element,
@@ -229,6 +250,65 @@ static const char *parse_row_binary(PlyReadBuffer &file,
   return nullptr;
 }
 
+/**
+ * Read all rows of an element that has no list properties, and call `fn(row_index, values)`
+ * with the property values of each row converted to floats. For memory-mapped binary files the
+ * rows are decoded directly from the mapped data on multiple threads, so `fn` must be safe to
+ * call concurrently for different rows.
+ */
+template<typename Fn>
+static const char *load_element_rows(PlyReadBuffer &file,
+                                     const PlyHeader &header,
+                                     const PlyElement &element,
+                                     const Fn &fn)
+{
+  if (header.type != PlyFormatType::ASCII && file.is_mapped()) {
+    if (element.stride == 0) {
+      return "Vertex/Edge element contains list properties, this is not supported";
+    }
+    const Span<uint8_t> block = file.mapped_remaining();
+    const int64_t block_size = int64_t(element.count) * element.stride;
+    if (block.size() < block_size) {
+      return "Could not read row of binary property";
+    }
+    const bool big_endian = header.type == PlyFormatType::BINARY_BE;
+    threading::parallel_for(IndexRange(element.count), 4096, [&](const IndexRange range) {
+      Vector<float, 16> values(element.properties.size());
+      for (const int64_t i : range) {
+        const uint8_t *ptr = block.data() + i * element.stride;
+        for (const int64_t prop_i : element.properties.index_range()) {
+          values[prop_i] = get_binary_value_from_const<float>(
+              element.properties[prop_i].type, ptr, big_endian);
+        }
+        fn(int(i), values.as_span());
+      }
+    });
+    file.skip_mapped(block_size);
+    return nullptr;
+  }
+
+  Vector<float> value_vec(element.properties.size());
+  Vector<uint8_t> scratch;
+  if (header.type != PlyFormatType::ASCII) {
+    scratch.resize(element.stride);
+  }
+
+  for (int i = 0; i < element.count; i++) {
+    const char *error = nullptr;
+    if (header.type == PlyFormatType::ASCII) {
+      error = parse_row_ascii(file, value_vec);
+    }
+    else {
+      error = parse_row_binary(file, header, element, scratch, value_vec);
+    }
+    if (error != nullptr) {
+      return error;
+    }
+    fn(i, value_vec.as_span());
+  }
+  return nullptr;
+}
+
 static const char *load_vertex_element(PlyReadBuffer &file,
                                        const PlyHeader &header,
                                        const PlyElement &element,
@@ -266,15 +346,15 @@ static const char *load_vertex_element(PlyReadBuffer &file,
     data->vertex_custom_attr.append(attr);
   }
 
-  data->vertices.reserve(element.count);
+  data->vertices.resize(element.count);
   if (has_color) {
-    data->vertex_colors.reserve(element.count);
+    data->vertex_colors.resize(element.count);
   }
   if (has_normal) {
-    data->vertex_normals.reserve(element.count);
+    data->vertex_normals.resize(element.count);
   }
   if (has_uv) {
-    data->uv_coordinates.reserve(element.count);
+    data->uv_coordinates.resize(element.count);
   }
 
   float4 color_norm = {1, 1, 1, 1};
@@ -287,31 +367,13 @@ static const char *load_vertex_element(PlyReadBuffer &file,
     color_norm.w = data_type_normalizer[element.properties[alpha_index].type];
   }
 
-  Vector<float> value_vec(element.properties.size());
-  Vector<uint8_t> scratch;
-  if (header.type != PlyFormatType::ASCII) {
-    scratch.resize(element.stride);
-  }
-
-  for (int i = 0; i < element.count; i++) {
-
-    const char *error = nullptr;
-    if (header.type == PlyFormatType::ASCII) {
-      error = parse_row_ascii(file, value_vec);
-    }
-    else {
-      error = parse_row_binary(file, header, element, scratch, value_vec);
-    }
-    if (error != nullptr) {
-      return error;
-    }
-
+  return load_element_rows(file, header, element, [&](const int i, const Span<float> value_vec) {
     /* Vertex coord */
     float3 vertex3;
     vertex3.x = value_vec[vertex_index.x];
     vertex3.y = value_vec[vertex_index.y];
     vertex3.z = value_vec[vertex_index.z];
-    data->vertices.append(vertex3);
+    data->vertices[i] = vertex3;
 
     /* Vertex color */
     if (has_color) {
@@ -325,7 +387,7 @@ static const char *load_vertex_element(PlyReadBuffer &file,
       else {
         colors4.w = 1.0f;
       }
-      data->vertex_colors.append(colors4);
+      data->vertex_colors[i] = colors4;
     }
 
     /* If normals */
@@ -334,7 +396,7 @@ static const char *load_vertex_element(PlyReadBuffer &file,
       normals3.x = value_vec[normal_index.x];
       normals3.y = value_vec[normal_index.y];
       normals3.z = value_vec[normal_index.z];
-      data->vertex_normals.append(normals3);
+      data->vertex_normals[i] = normals3;
     }
 
     /* If uv */
@@ -342,7 +404,7 @@ static const char *load_vertex_element(PlyReadBuffer &file,
       float2 uvmap;
       uvmap.x = value_vec[uv_index.x];
       uvmap.y = value_vec[uv_index.y];
-      data->uv_coordinates.append(uvmap);
+      data->uv_coordinates[i] = uvmap;
     }
 
     /* Custom attributes */
@@ -350,8 +412,7 @@ static const char *load_vertex_element(PlyReadBuffer &file,
       float value = value_vec[custom_attr_indices[ci]];
       data->vertex_custom_attr[ci].data[i] = value;
     }
-  }
-  return nullptr;
+  });
 }
 
 static uint32_t read_list_count(PlyReadBuffer &file,
@@ -385,6 +446,80 @@ static void skip_property(PlyReadBuffer &file,
   }
 }
 
+/**
+ * Binary face loading for memory-mapped files. Rows have a variable size, so a first pass only
+ * walks the list counts to find where the index list of every face starts. The indices are then
+ * decoded from the mapped data in parallel.
+ */
+static const char *load_face_element_mapped(PlyReadBuffer &file,
+                                            const PlyHeader &header,
+                                            const PlyElement &element,
+                                            const int prop_index,
+                                            PlyData *data)
+{
+  const bool big_endian = header.type == PlyFormatType::BINARY_BE;
+  const Span<uint8_t> block = file.mapped_remaining();
+  const PlyProperty &indices_prop = element.properties[prop_index];
+
+  Vector<int64_t> list_offsets;
+  list_offsets.reserve(element.count);
+  data->face_sizes.reserve(element.count);
+
+  int64_t pos = 0;
+  for (int i = 0; i < element.count; i++) {
+    for (const int64_t j : element.properties.index_range()) {
+      const PlyProperty &prop = element.properties[j];
+      if (prop.count_type == PlyDataTypes::NONE) {
+        pos += data_type_size[prop.type];
+        continue;
+      }
+      if (pos + data_type_size[prop.count_type] > block.size()) {
+        return "Could not read row of binary property";
+      }
+      const uint8_t *ptr = block.data() + pos;
+      const uint32_t count = get_binary_value_from_const<uint32_t>(prop.count_type, ptr, big_endian);
+      pos += data_type_size[prop.count_type];
+      if (j == prop_index) {
+        if (count < 1 || count > 255) {
+          return "Invalid face size, must be between 1 and 255";
+        }
+        /* Previous python based importer was accepting faces with fewer
+         * than 3 vertices, and silently dropping them. */
+        if (count < 3) {
+          fprintf(stderr, "PLY Importer: ignoring face %i (%i vertices)\n", i, int(count));
+        }
+        else {
+          list_offsets.append(pos);
+          data->face_sizes.append(count);
+        }
+      }
+      pos += int64_t(count) * data_type_size[prop.type];
+    }
+  }
+  if (pos > block.size()) {
+    return "Could not read row of binary property";
+  }
+  file.skip_mapped(pos);
+
+  Array<int64_t> face_starts(data->face_sizes.size() + 1);
+  face_starts[0] = 0;
+  for (const int64_t i : data->face_sizes.index_range()) {
+    face_starts[i + 1] = face_starts[i] + data->face_sizes[i];
+  }
+  data->face_vertices.resize(face_starts.last());
+
+  threading::parallel_for(data->face_sizes.index_range(), 4096, [&](const IndexRange range) {
+    for (const int64_t i : range) {
+      const uint8_t *ptr = block.data() + list_offsets[i];
+      for (const int64_t j : IndexRange::from_begin_end(face_starts[i], face_starts[i + 1])) {
+        data->face_vertices[j] = get_binary_value_from_const<uint32_t>(
+            indices_prop.type, ptr, big_endian);
+      }
+    }
+  });
+  return nullptr;
+}
+
 static const char *load_face_element(PlyReadBuffer &file,
                                      const PlyHeader &header,
                                      const PlyElement &element,
@@ -405,6 +540,10 @@ static const char *load_face_element(PlyReadBuffer &file,
     return "Face element vertex indices property must be a list";
   }
 
+  if (header.type != PlyFormatType::ASCII && file.is_mapped()) {
+    return load_face_element_mapped(file, header, element, prop_index, data);
+  }
+
   data->face_vertices.reserve(element.count * 3);
   data->face_sizes.reserve(element.count);
 
@@ -590,30 +729,12 @@ static const char *load_edge_element(PlyReadBuffer &file,
     return "Edge element does not contain vertex1 and vertex2 properties";
   }
 
-  data->edges.reserve(element.count);
-
-  Vector<float> value_vec(element.properties.size());
-  Vector<uint8_t> scratch;
-  if (header.type != PlyFormatType::ASCII) {
-    scratch.resize(element.stride);
-  }
-
-  for (int i = 0; i < element.count; i++) {
-    const char *error = nullptr;
-    if (header.type == PlyFormatType::ASCII) {
-      error = parse_row_ascii(file, value_vec);
-    }
-    else {
-      error = parse_row_binary(file, header, element, scratch, value_vec);
-    }
-    if (error != nullptr) {
-      return error;
-    }
+  data->edges.resize(element.count);
+  return load_element_rows(file, header, element, [&](const int i, const Span<float> value_vec) {
     int index1 = value_vec[prop_vertex1];
     int index2 = value_vec[prop_vertex2];
-    data->edges.append(std::make_pair(index1, index2));
-  }
-  return nullptr;
+    data->edges[i] = std::make_pair(index1, index2);
+  });
 }
 
 static const char *skip_element(PlyReadBuffer &file,
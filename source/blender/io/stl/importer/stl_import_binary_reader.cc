@@ -6,12 +6,15 @@
  * \ingroup stl
  */
 
+#include <algorithm>
 #include <cstdint>
 #include <cstdio>
 
 #include "BKE_mesh.hh"
 
 #include "BLI_array.hh"
+#include "BLI_memory_utils.hh"
+#include "BLI_mmap.h"
 
 #include "DNA_mesh_types.h"
 
@@ -24,7 +27,6 @@ namespace blender::io::stl {
 
 Mesh *read_stl_binary(FILE *file, const bool use_custom_normals)
 {
-  const int chunk_size = 1024;
   uint32_t num_tris = 0;
   fseek(file, BINARY_HEADER_SIZE, SEEK_SET);
   if (fread(&num_tris, sizeof(uint32_t), 1, file) != 1) {
@@ -36,16 +38,23 @@ Mesh *read_stl_binary(FILE *file, const bool use_custom_normals)
     return BKE_mesh_new_nomain(0, 0, 0, 0);
   }
 
-  Array<PackedTriangle> tris_buf(chunk_size);
-  STLMeshHelper stl_mesh(num_tris, use_custom_normals);
-  size_t num_read_tris;
-  while ((num_read_tris = fread(tris_buf.data(), sizeof(PackedTriangle), chunk_size, file))) {
-    for (size_t i = 0; i < num_read_tris; i++) {
-      stl_mesh.add_triangle(tris_buf[i]);
-    }
+  /* Map the file, so that the triangle block can be decoded by multiple threads without copying
+   * it first. */
+  BLI_mmap_file *mmap_file = BLI_mmap_open(fileno(file));
+  if (mmap_file != nullptr) {
+    BLI_SCOPED_DEFER([&]() { BLI_mmap_free(mmap_file); });
+    const size_t tris_offset = BINARY_HEADER_SIZE + sizeof(uint32_t);
+    const size_t length = BLI_mmap_get_length(mmap_file);
+    const size_t tris_read = std::min<size_t>(
+        num_tris, length > tris_offset ? (length - tris_offset) / BINARY_STRIDE : 0);
+    const PackedTriangle *tris = reinterpret_cast<const PackedTriangle *>(
+        static_cast<const uint8_t *>(BLI_mmap_get_pointer(mmap_file)) + tris_offset);
+    return stl_mesh_from_triangles({tris, int64_t(tris_read)}, use_custom_normals);
   }
 
-  return stl_mesh.to_mesh();
+  Array<PackedTriangle> tris(num_tris);
+  const size_t tris_read = fread(tris.data(), sizeof(PackedTriangle), num_tris, file);
+  return stl_mesh_from_triangles(tris.as_span().take_front(tris_read), use_custom_normals);
 }
 
 }  // namespace blender::io::stl
@@ -10,8 +10,14 @@
 
 #include "BKE_mesh.hh"
 
+#include "BLI_array.hh"
 #include "BLI_array_utils.hh"
+#include "BLI_index_mask.hh"
+#include "BLI_map.hh"
+#include "BLI_math_base.h"
+#include "BLI_offset_indices.hh"
 #include "BLI_span.hh"
+#include "BLI_task.hh"
 
 #include "DNA_mesh_types.h"
 
@@ -53,28 +59,183 @@ bool STLMeshHelper::add_triangle(const PackedTriangle &data)
   return true;
 }
 
-Mesh *STLMeshHelper::to_mesh()
+static void report_removed_triangles(const int degenerate_tris_num, const int duplicate_tris_num)
 {
-  if (degenerate_tris_num_ > 0) {
-    std::cout << "STL Importer: " << degenerate_tris_num_ << " degenerate triangles were removed"
+  if (degenerate_tris_num > 0) {
+    std::cout << "STL Importer: " << degenerate_tris_num << " degenerate triangles were removed"
               << std::endl;
   }
-  if (duplicate_tris_num_ > 0) {
-    std::cout << "STL Importer: " << duplicate_tris_num_ << " duplicate triangles were removed"
+  if (duplicate_tris_num > 0) {
+    std::cout << "STL Importer: " << duplicate_tris_num << " duplicate triangles were removed"
               << std::endl;
   }
+}
+
+/** Creates the face offsets, edges and custom normals once positions and corners are filled. */
+static void finish_mesh(Mesh &mesh, MutableSpan<float3> loop_normals, const bool use_custom_normals)
+{
+  offset_indices::fill_constant_group_size(3, 0, mesh.face_offsets_for_write());
+
+  /* NOTE: edges must be calculated first before setting custom normals. */
+  bke::mesh_calc_edges(mesh, false, false);
+
+  if (use_custom_normals && loop_normals.size() == mesh.corners_num) {
+    BKE_mesh_set_custom_normals(&mesh, reinterpret_cast<float(*)[3]>(loop_normals.data()));
+  }
+}
+
+Mesh *STLMeshHelper::to_mesh()
+{
+  report_removed_triangles(degenerate_tris_num_, duplicate_tris_num_);
 
   Mesh *mesh = BKE_mesh_new_nomain(verts_.size(), 0, tris_.size(), tris_.size() * 3);
   mesh->vert_positions_for_write().copy_from(verts_);
-  offset_indices::fill_constant_group_size(3, 0, mesh->face_offsets_for_write());
   array_utils::copy(tris_.as_span().cast<int>(), mesh->corner_verts_for_write());
+  finish_mesh(*mesh, loop_normals_, use_custom_normals_);
 
-  /* NOTE: edges must be calculated first before setting custom normals. */
-  bke::mesh_calc_edges(*mesh, false, false);
+  return mesh;
+}
+
+/* The shard is taken from the top bits of the hash, the shard maps use the low bits. */
+static constexpr int shard_bits = 8;
+static constexpr int shards_num = 1 << shard_bits;
+static constexpr int64_t shard_chunk_size = 16 * 1024;
 
-  if (use_custom_normals_ && loop_normals_.size() == mesh->corners_num) {
-    BKE_mesh_set_custom_normals(mesh, reinterpret_cast<float(*)[3]>(loop_normals_.data()));
+/**
+ * For every index, find the smallest index with an equal key. Keys are distributed over shards
+ * which are processed in parallel. Within a shard the keys are visited in index order, so the
+ * result is the same as when adding all keys to a single set one after another.
+ */
+template<typename Key, typename GetKeyFn>
+static Array<int> find_first_occurrences(const int size, const GetKeyFn &get_key)
+{
+  const int chunks_num = int(divide_ceil_ul(uint64_t(size), shard_chunk_size));
+  const auto chunk_range = [&](const int chunk) {
+    return IndexRange::from_begin_end(chunk * shard_chunk_size,
+                                      std::min<int64_t>(size, (chunk + 1) * shard_chunk_size));
+  };
+
+  /* Count the keys of every shard in every chunk. */
+  Array<uint8_t> shards(size);
+  Array<int> chunk_offsets(chunks_num * shards_num, 0);
+  threading::parallel_for(IndexRange(chunks_num), 1, [&](const IndexRange chunks) {
+    for (const int chunk : chunks) {
+      MutableSpan<int> counts = chunk_offsets.as_mutable_span().slice(chunk * shards_num,
+                                                                      shards_num);
+      for (const int i : chunk_range(chunk)) {
+        const uint64_t hash = DefaultHash<Key>{}(get_key(i)) * 0x9E3779B97F4A7C15ull;
+        const int shard = int(hash >> (64 - shard_bits));
+        shards[i] = uint8_t(shard);
+        counts[shard]++;
+      }
+    }
+  });
+
+  /* Turn the counts into offsets, ordered by shard first and by chunk second. */
+  Array<int> shard_offset_data(shards_num + 1);
+  int offset = 0;
+  for (const int shard : IndexRange(shards_num)) {
+    shard_offset_data[shard] = offset;
+    for (const int chunk : IndexRange(chunks_num)) {
+      int &chunk_offset = chunk_offsets[chunk * shards_num + shard];
+      const int count = chunk_offset;
+      chunk_offset = offset;
+      offset += count;
+    }
   }
+  shard_offset_data.last() = offset;
+  const OffsetIndices<int> shard_offsets(shard_offset_data);
+
+  /* Gather the indices of every shard, in increasing order. */
+  Array<int> shard_indices(size);
+  threading::parallel_for(IndexRange(chunks_num), 1, [&](const IndexRange chunks) {
+    for (const int chunk : chunks) {
+      MutableSpan<int> offsets = chunk_offsets.as_mutable_span().slice(chunk * shards_num,
+                                                                       shards_num);
+      for (const int i : chunk_range(chunk)) {
+        shard_indices[offsets[shards[i]]++] = i;
+      }
+    }
+  });
+
+  Array<int> first_indices(size);
+  threading::parallel_for(IndexRange(shards_num), 1, [&](const IndexRange range) {
+    for (const int shard : range) {
+      const Span<int> indices = shard_indices.as_span().slice(shard_offsets[shard]);
+      Map<Key, int> first_by_key;
+      first_by_key.reserve(indices.size());
+      for (const int i : indices) {
+        first_indices[i] = first_by_key.lookup_or_add(get_key(i), i);
+      }
+    }
+  });
+  return first_indices;
+}
+
+Mesh *stl_mesh_from_triangles(const Span<PackedTriangle> tris, const bool use_custom_normals)
+{
+  const int corners_num = int(tris.size()) * 3;
+  const auto corner_position = [&](const int corner) -> float3 {
+    return tris[corner / 3].vertices[corner % 3];
+  };
+
+  /* Vertices are numbered in the order of their first occurrence. */
+  const Array<int> first_corners = find_first_occurrences<float3>(corners_num, corner_position);
+  IndexMaskMemory memory;
+  const IndexMask unique_corners = IndexMask::from_predicate(
+      IndexRange(corners_num), GrainSize(4096), memory, [&](const int corner) {
+        return first_corners[corner] == corner;
+      });
+  Array<int> corner_verts(corners_num);
+  unique_corners.foreach_index(GrainSize(4096), [&](const int corner, const int vert) {
+    corner_verts[corner] = vert;
+  });
+  threading::parallel_for(IndexRange(corners_num), 4096, [&](const IndexRange range) {
+    for (const int corner : range) {
+      corner_verts[corner] = corner_verts[first_corners[corner]];
+    }
+  });
+
+  const auto triangle = [&](const int tri) -> Triangle {
+    return {corner_verts[tri * 3], corner_verts[tri * 3 + 1], corner_verts[tri * 3 + 2]};
+  };
+  const auto is_degenerate = [&](const int tri) {
+    const Triangle t = triangle(tri);
+    return (t.v1 == t.v2) || (t.v1 == t.v3) || (t.v2 == t.v3);
+  };
+
+  /* A degenerate triangle never compares equal to a valid one, so there is no need to exclude
+   * them before searching for duplicates. */
+  const Array<int> first_tris = find_first_occurrences<Triangle>(int(tris.size()), triangle);
+  const IndexMask degenerate_tris = IndexMask::from_predicate(
+      tris.index_range(), GrainSize(4096), memory, is_degenerate);
+  const IndexMask unique_tris = IndexMask::from_predicate(
+      tris.index_range(), GrainSize(4096), memory, [&](const int tri) {
+        return first_tris[tri] == tri && !is_degenerate(tri);
+      });
+  const int degenerate_tris_num = degenerate_tris.size();
+  report_removed_triangles(degenerate_tris_num,
+                           tris.size() - degenerate_tris_num - unique_tris.size());
+
+  Mesh *mesh = BKE_mesh_new_nomain(
+      unique_corners.size(), 0, unique_tris.size(), unique_tris.size() * 3);
+  MutableSpan<float3> positions = mesh->vert_positions_for_write();
+  unique_corners.foreach_index(GrainSize(4096), [&](const int corner, const int vert) {
+    positions[vert] = corner_position(corner);
+  });
+
+  MutableSpan<int> mesh_corner_verts = mesh->corner_verts_for_write();
+  Array<float3> loop_normals(use_custom_normals ? mesh->corners_num : 0);
+  unique_tris.foreach_index(GrainSize(4096), [&](const int tri, const int face) {
+    const IndexRange src = IndexRange(tri * 3, 3);
+    const IndexRange dst = IndexRange(face * 3, 3);
+    mesh_corner_verts.slice(dst).copy_from(corner_verts.as_span().slice(src));
+    if (use_custom_normals) {
+      loop_normals.as_mutable_span().slice(dst).fill(tris[tri].normal);
+    }
+  });
+
+  finish_mesh(*mesh, loop_normals, use_custom_normals);
 
   return mesh;
 }
@@ -11,6 +11,7 @@
 #include <cstdint>
 
 #include "BLI_math_vector_types.hh"
+#include "BLI_span.hh"
 #include "BLI_vector.hh"
 #include "BLI_vector_set.hh"
 #include "stl_data.hh"
@@ -67,4 +68,12 @@ class STLMeshHelper {
   Mesh *to_mesh();
 };
 
+/**
+ * Creates a mesh from a block of triangles, merging duplicate vertices and triangles in the same
+ * way as adding them one by one to #STLMeshHelper would. The work is split over multiple threads:
+ * vertices and triangles are distributed over shards by their hash, and the first occurrence of
+ * every key is found within its shard.
+ */
+Mesh *stl_mesh_from_triangles(Span<PackedTriangle> tris, bool use_custom_normals);
+
 }  // namespace blender::io::stl
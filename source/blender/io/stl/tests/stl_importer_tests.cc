@@ -4,11 +4,13 @@
 
 #include "tests/blendfile_loading_base_test.h"
 
+#include "BKE_lib_id.hh"
 #include "BKE_mesh.hh"
 #include "BKE_object.hh"
 
 #include "BLI_math_base.h"
 #include "BLI_math_vector_types.hh"
+#include "BLI_rand.hh"
 #include "BLI_string.h"
 
 #include "BLO_readfile.hh"
@@ -16,6 +18,7 @@
 #include "DEG_depsgraph_query.hh"
 
 #include "stl_import.hh"
+#include "stl_import_mesh.hh"
 
 namespace blender::io::stl {
 
@@ -125,4 +128,34 @@ TEST_F(stl_importer_test, non_uniform_scale)
   import_and_check("non_uniform_scale.stl", expect);
 }
 
+TEST(stl_importer_mesh, parallel_merge_matches_helper)
+{
+  /* Use a small set of positions, so that there are many duplicate and degenerate triangles. */
+  RandomNumberGenerator rng(0);
+  Array<PackedTriangle> tris(20000);
+  for (const int i : tris.index_range()) {
+    for (const int j : IndexRange(3)) {
+      const int position = rng.get_int32(200);
+      tris[i].vertices[j] = float3(position % 7, position / 7, 0.5f);
+    }
+    tris[i].normal = float3(0, 0, 1);
+  }
+
+  STLMeshHelper helper(tris.size(), false);
+  for (const PackedTriangle &tri : tris) {
+    helper.add_triangle(tri);
+  }
+  Mesh *expected = helper.to_mesh();
+  Mesh *result = stl_mesh_from_triangles(tris, false);
+
+  EXPECT_EQ(result->verts_num, expected->verts_num);
+  EXPECT_EQ(result->edges_num, expected->edges_num);
+  EXPECT_EQ(result->faces_num, expected->faces_num);
+  EXPECT_EQ(result->vert_positions(), expected->vert_positions());
+  EXPECT_EQ(result->corner_verts(), expected->corner_verts());
+
+  BKE_id_free(nullptr, result);
+  BKE_id_free(nullptr, expected);
+}
+
 }  // namespace blender::io::stl
@@ -82,6 +82,11 @@ struct OBJImportParams {
   bool validate_meshes = true;
   bool relative_paths = true;
   bool clear_selection = true;
+  /**
+   * Parse vertex and face lines on multiple threads.
+   * The result is the same as with serial parsing.
+   */
+  bool use_parallel_parse = true;
 
   ReportList *reports = nullptr;
 };
@@ -19,6 +19,7 @@
 #include "BLI_path_util.h"
 #include "BLI_string.h"
 #include "BLI_task.hh"
+#include "BLI_threads.h"
 
 #include "IO_path_util.hh"
 
@@ -168,7 +169,7 @@ void OBJWriter::write_header() const
   FormatHandler fh;
   fh.write_string("# Blender "s + BKE_blender_version_string());
   fh.write_string("# www.blender.org");
-  fh.write_to_file(outfile_);
+  fh.write_to(*file_writer_);
 }
 
 void OBJWriter::write_mtllib_name(const StringRefNull mtl_filepath) const
@@ -183,7 +184,7 @@ void OBJWriter::write_mtllib_name(const StringRefNull mtl_filepath) const
                           sizeof(mtl_file_name));
   FormatHandler fh;
   fh.write_obj_mtllib(mtl_file_name);
-  fh.write_to_file(outfile_);
+  fh.write_to(*file_writer_);
 }
 
 static void spaces_to_underscores(std::string &r_name)
@@ -216,7 +217,9 @@ static int calc_chunk_count(int count)
  * by a /function/ that should be independent from other items.
  * If the amount of items is large enough (> chunk_size), then writing
  * will be done in parallel, into temporary FormatHandler buffers that
- * will be written into the final /fh/ buffer at the end.
+ * will be written into the final /fh/ buffer in order.
+ * The chunks are processed in batches, so that only a limited amount of
+ * text is kept in memory when /fh/ streams its output to the file.
  */
 template<typename Function>
 void obj_parallel_chunked_output(FormatHandler &fh, int tot_count, const Function &function)
@@ -234,21 +237,25 @@ void obj_parallel_chunked_output(FormatHandler &fh, int tot_count, const Functio
     }
     return;
   }
-  /* Give each chunk its own temporary output buffer, and process them in parallel. */
-  Array<FormatHandler> buffers(chunk_count);
-  threading::parallel_for(IndexRange(chunk_count), 1, [&](IndexRange range) {
-    for (const int r : range) {
-      int i_start = r * chunk_size;
-      int i_end = std::min(i_start + chunk_size, tot_count);
-      auto &buf = buffers[r];
-      for (int i = i_start; i < i_end; i++) {
-        function(buf, i);
+  /* Give each chunk of a batch its own temporary output buffer, and process them in parallel. */
+  const int batch_size = std::min(chunk_count, BLI_system_thread_count() * 4);
+  Array<FormatHandler> buffers(batch_size);
+  for (int batch_start = 0; batch_start < chunk_count; batch_start += batch_size) {
+    const IndexRange batch(batch_start, std::min(batch_size, chunk_count - batch_start));
+    threading::parallel_for(batch.index_range(), 1, [&](IndexRange range) {
+      for (const int r : range) {
+        int i_start = batch[r] * chunk_size;
+        int i_end = std::min(i_start + chunk_size, tot_count);
+        auto &buf = buffers[r];
+        for (int i = i_start; i < i_end; i++) {
+          function(buf, i);
+        }
       }
+    });
+    /* Emit the temporary output buffers into the destination buffer. */
+    for (const int r : batch.index_range()) {
+      fh.append_from(buffers[r]);
     }
-  });
-  /* Emit all temporary output buffers into the destination buffer. */
-  for (auto &buf : buffers) {
-    fh.append_from(buf);
   }
 }
 
@@ -544,15 +551,20 @@ MTLWriter::MTLWriter(const char *obj_filepath) noexcept(false)
 }
 MTLWriter::~MTLWriter()
 {
-  if (outfile_) {
-    fmt_handler_.write_to_file(outfile_);
-    if (std::fclose(outfile_)) {
-      std::cerr << "Error: could not close the file '" << mtl_filepath_
-                << "' properly, it may be corrupted." << std::endl;
-    }
+  if (outfile_ && !this->finish()) {
+    std::cerr << "Error: could not write the file '" << mtl_filepath_
+              << "' properly, it may be corrupted." << std::endl;
   }
 }
 
+bool MTLWriter::finish()
+{
+  const bool write_ok = fmt_handler_.write_to_file(outfile_);
+  const bool close_ok = std::fclose(outfile_) == 0;
+  outfile_ = nullptr;
+  return write_ok && close_ok;
+}
+
 void MTLWriter::write_header(const char *blen_filepath)
 {
   using namespace std::string_literals;
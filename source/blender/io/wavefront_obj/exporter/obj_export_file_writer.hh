@@ -17,6 +17,7 @@
 #include "obj_export_mtl.hh"
 
 #include <iostream>
+#include <memory>
 
 namespace blender::io::obj {
 
@@ -40,6 +41,8 @@ class OBJWriter : NonMovable, NonCopyable {
   const OBJExportParams &export_params_;
   std::string outfile_path_;
   FILE *outfile_;
+  /** All text is written to the file on a separate thread. */
+  std::unique_ptr<AsyncFileWriter> file_writer_;
 
  public:
   OBJWriter(const char *filepath, const OBJExportParams &export_params) noexcept(false)
@@ -49,18 +52,31 @@ class OBJWriter : NonMovable, NonCopyable {
     if (!outfile_) {
       throw std::system_error(errno, std::system_category(), "Cannot open file " + outfile_path_);
     }
+    file_writer_ = std::make_unique<AsyncFileWriter>(outfile_);
   }
   ~OBJWriter()
   {
-    if (outfile_ && std::fclose(outfile_)) {
-      std::cerr << "Error: could not close the file '" << outfile_path_
+    if (outfile_ && !this->finish()) {
+      std::cerr << "Error: could not write the file '" << outfile_path_
                 << "' properly, it may be corrupted." << std::endl;
     }
   }
 
-  FILE *get_outfile() const
+  /**
+   * Finish writing the queued text and close the file.
+   * \return False if writing or closing the file failed.
+   */
+  bool finish()
+  {
+    const bool write_ok = file_writer_->finish();
+    const bool close_ok = std::fclose(outfile_) == 0;
+    outfile_ = nullptr;
+    return write_ok && close_ok;
+  }
+
+  AsyncFileWriter &get_file_writer() const
   {
-    return outfile_;
+    return *file_writer_;
   }
 
   void write_header() const;
@@ -180,6 +196,12 @@ class MTLWriter : NonMovable, NonCopyable {
   MTLWriter(const char *obj_filepath) noexcept(false);
   ~MTLWriter();
 
+  /**
+   * Write the buffered text to the file and close it.
+   * \return False if writing or closing the file failed.
+   */
+  bool finish();
+
   void write_header(const char *blen_filepath);
   /**
    * Write all of the material specifications to the MTL file.
@@ -8,7 +8,11 @@
 
 #pragma once
 
+#include <condition_variable>
 #include <cstdio>
+#include <deque>
+#include <mutex>
+#include <thread>
 #include <type_traits>
 
 #include "BLI_compiler_attrs.h"
@@ -23,27 +27,136 @@
 
 namespace blender::io::obj {
 
+/**
+ * Writes blocks of text into a file on a separate thread, so that formatting the text and writing
+ * it to disk overlap. Queuing a block waits while too much data is waiting to be written already,
+ * which limits the memory used for the text of the file.
+ */
+class AsyncFileWriter : NonCopyable, NonMovable {
+ private:
+  FILE *file_;
+  size_t max_queued_size_;
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  std::deque<Vector<char>> queue_;
+  size_t queued_size_ = 0;
+  bool finished_ = false;
+  /** Set when writing to the file failed, all following blocks are discarded. */
+  bool write_failed_ = false;
+  std::thread thread_;
+
+ public:
+  AsyncFileWriter(FILE *file, size_t max_queued_size = 64 * 1024 * 1024)
+      : file_(file), max_queued_size_(max_queued_size)
+  {
+    thread_ = std::thread([this]() { this->run(); });
+  }
+
+  ~AsyncFileWriter()
+  {
+    this->finish();
+  }
+
+  /**
+   * Wait until all queued blocks are written. No blocks may be written afterwards.
+   * \return False if writing to the file failed.
+   */
+  bool finish()
+  {
+    if (thread_.joinable()) {
+      {
+        std::lock_guard lock{mutex_};
+        finished_ = true;
+      }
+      cond_.notify_all();
+      thread_.join();
+    }
+    return !write_failed_;
+  }
+
+  void write(Vector<char> &&block)
+  {
+    if (block.is_empty()) {
+      return;
+    }
+    std::unique_lock lock{mutex_};
+    cond_.wait(lock, [&]() { return queued_size_ < max_queued_size_; });
+    if (write_failed_) {
+      return;
+    }
+    queued_size_ += block.size();
+    queue_.push_back(std::move(block));
+    lock.unlock();
+    cond_.notify_all();
+  }
+
+ private:
+  void run()
+  {
+    std::unique_lock lock{mutex_};
+    while (true) {
+      cond_.wait(lock, [&]() { return !queue_.empty() || finished_; });
+      if (queue_.empty()) {
+        return;
+      }
+      Vector<char> block = std::move(queue_.front());
+      queue_.pop_front();
+      const bool skip = write_failed_;
+      lock.unlock();
+      const bool ok = skip || fwrite(block.data(), 1, block.size(), file_) == block.size();
+      lock.lock();
+      write_failed_ |= !ok;
+      queued_size_ -= block.size();
+      cond_.notify_all();
+    }
+  }
+};
+
 /**
  * File buffer writer.
  * All writes are done into an internal chunked memory buffer
  * (list of default 64 kilobyte blocks).
  * Call write_fo_file once in a while to write the memory buffer(s)
  * into the given file.
+ *
+ * When a #AsyncFileWriter stream is given, every block is passed on to it as soon as it is full,
+ * so that only the last block is kept in memory.
  */
 class FormatHandler : NonCopyable, NonMovable {
  private:
   using VectorChar = Vector<char>;
   Vector<VectorChar> blocks_;
   size_t buffer_chunk_size_;
+  AsyncFileWriter *stream_;
 
  public:
-  FormatHandler(size_t buffer_chunk_size = 64 * 1024) : buffer_chunk_size_(buffer_chunk_size) {}
+  FormatHandler(size_t buffer_chunk_size = 64 * 1024, AsyncFileWriter *stream = nullptr)
+      : buffer_chunk_size_(buffer_chunk_size), stream_(stream)
+  {
+  }
 
-  /* Write contents to the buffer(s) into a file, and clear the buffers. */
-  void write_to_file(FILE *f)
+  /**
+   * Write contents to the buffer(s) into a file, and clear the buffers.
+   * \return False if writing to the file failed.
+   */
+  bool write_to_file(FILE *f)
   {
+    bool ok = true;
     for (const auto &b : blocks_) {
-      fwrite(b.data(), 1, b.size(), f);
+      if (fwrite(b.data(), 1, b.size(), f) != b.size()) {
+        ok = false;
+        break;
+      }
+    }
+    blocks_.clear();
+    return ok;
+  }
+
+  /* Pass the contents of the buffer(s) on to the writer, and clear the buffers. */
+  void write_to(AsyncFileWriter &writer)
+  {
+    for (VectorChar &b : blocks_) {
+      writer.write(std::move(b));
     }
     blocks_.clear();
   }
@@ -63,6 +176,11 @@ class FormatHandler : NonCopyable, NonMovable {
 
   void append_from(FormatHandler &v)
   {
+    if (stream_) {
+      this->write_to(*stream_);
+      v.write_to(*stream_);
+      return;
+    }
     blocks_.insert(blocks_.end(),
                    std::make_move_iterator(v.blocks_.begin()),
                    std::make_move_iterator(v.blocks_.end()));
@@ -203,6 +321,9 @@ class FormatHandler : NonCopyable, NonMovable {
   void ensure_space(size_t at_least)
   {
     if (blocks_.is_empty() || (blocks_.last().capacity() - blocks_.last().size() < at_least)) {
+      if (stream_) {
+        this->write_to(*stream_);
+      }
       blocks_.append(VectorChar());
       blocks_.last().reserve(std::max(at_least, buffer_chunk_size_));
     }
@@ -18,6 +18,7 @@
 #include "BLI_path_util.h"
 #include "BLI_string.h"
 #include "BLI_task.hh"
+#include "BLI_threads.h"
 #include "BLI_vector.hh"
 
 #include "DEG_depsgraph_query.hh"
@@ -152,16 +153,57 @@ filter_supported_objects(Depsgraph *depsgraph, const OBJExportParams &export_par
   return {std::move(r_exportable_meshes), std::move(r_exportable_nurbs)};
 }
 
+static void write_mesh_object(FormatHandler &fh,
+                              OBJWriter &obj_writer,
+                              MTLWriter *mtl_writer,
+                              OBJMesh &obj,
+                              const Vector<int> *obj_mtlindices,
+                              const IndexOffsets &offsets,
+                              const OBJExportParams &export_params)
+{
+  obj_writer.write_object_name(fh, obj);
+  obj_writer.write_vertex_coords(fh, obj, export_params.export_colors);
+
+  if (obj.tot_faces() > 0) {
+    if (export_params.export_normals) {
+      obj_writer.write_normals(fh, obj);
+    }
+    if (export_params.export_uv) {
+      obj_writer.write_uv_coords(fh, obj);
+    }
+    /* This function takes a 0-indexed slot index for the obj_mesh object and
+     * returns the material name that we are using in the `.obj` file for it. */
+    auto matname_fn = [&](int s) -> const char * {
+      if (!obj_mtlindices || s < 0 || s >= obj_mtlindices->size()) {
+        return nullptr;
+      }
+      return mtl_writer->mtlmaterial_name((*obj_mtlindices)[s]);
+    };
+    obj_writer.write_face_elements(fh, offsets, obj, matname_fn);
+  }
+  obj_writer.write_edges_indices(fh, offsets, obj);
+
+  /* Nothing will need this object's data after this point, release
+   * various arrays here. */
+  obj.clear();
+}
+
+/* Objects with less elements are written in parallel with other small objects,
+ * larger objects are split into chunks that are written in parallel. */
+static const int64_t small_object_size = 32768;
+
+static int64_t object_elements_num(const OBJMesh &obj)
+{
+  return int64_t(obj.tot_vertices()) + obj.tot_faces() + obj.tot_uv_vertices() +
+         obj.get_normal_coords().size();
+}
+
 static void write_mesh_objects(const Span<std::unique_ptr<OBJMesh>> exportable_as_mesh,
                                OBJWriter &obj_writer,
                                MTLWriter *mtl_writer,
                                const OBJExportParams &export_params)
 {
-  /* Parallelization is over meshes/objects, which means
-   * we have to have the output text buffer for each object,
-   * and write them all into the file at the end. */
-  size_t count = exportable_as_mesh.size();
-  Array<FormatHandler> buffers(count);
+  const int64_t count = exportable_as_mesh.size();
 
   /* Serial: gather material indices, ensure normals & edges. */
   Vector<Vector<int>> mtlindices;
@@ -176,7 +218,9 @@ static void write_mesh_objects(const Span<std::unique_ptr<OBJMesh>> exportable_a
     }
   }
 
-  /* Parallel over meshes: store normal coords & indices, uv coords and indices. */
+  /* Parallel over meshes: store normal coords & indices, uv coords and indices, calculate smooth
+   * groups and face order. Large meshes are written one after another later on, so this is where
+   * their mostly single threaded preparation runs in parallel. */
   threading::parallel_for(IndexRange(count), 1, [&](IndexRange range) {
     for (const int i : range) {
       OBJMesh &obj = *exportable_as_mesh[i];
@@ -186,6 +230,14 @@ static void write_mesh_objects(const Span<std::unique_ptr<OBJMesh>> exportable_a
       if (export_params.export_uv) {
         obj.store_uv_coords_and_indices();
       }
+      if (obj.tot_faces() > 0) {
+        if (export_params.export_smooth_groups) {
+          obj.calc_smooth_groups(export_params.smooth_groups_bitflags);
+        }
+        if (export_params.export_materials) {
+          obj.calc_face_order();
+        }
+      }
     }
   });
 
@@ -202,52 +254,51 @@ static void write_mesh_objects(const Span<std::unique_ptr<OBJMesh>> exportable_a
     offsets.normal_offset += obj.get_normal_coords().size();
   }
 
-  /* Parallel over meshes: main result writing. */
-  threading::parallel_for(IndexRange(count), 1, [&](IndexRange range) {
-    for (const int i : range) {
-      OBJMesh &obj = *exportable_as_mesh[i];
-      auto &fh = buffers[i];
-
-      obj_writer.write_object_name(fh, obj);
-      obj_writer.write_vertex_coords(fh, obj, export_params.export_colors);
-
-      if (obj.tot_faces() > 0) {
-        if (export_params.export_smooth_groups) {
-          obj.calc_smooth_groups(export_params.smooth_groups_bitflags);
-        }
-        if (export_params.export_materials) {
-          obj.calc_face_order();
-        }
-        if (export_params.export_normals) {
-          obj_writer.write_normals(fh, obj);
-        }
-        if (export_params.export_uv) {
-          obj_writer.write_uv_coords(fh, obj);
-        }
-        /* This function takes a 0-indexed slot index for the obj_mesh object and
-         * returns the material name that we are using in the `.obj` file for it. */
-        const auto *obj_mtlindices = mtlindices.is_empty() ? nullptr : &mtlindices[i];
-        auto matname_fn = [&](int s) -> const char * {
-          if (!obj_mtlindices || s < 0 || s >= obj_mtlindices->size()) {
-            return nullptr;
-          }
-          return mtl_writer->mtlmaterial_name((*obj_mtlindices)[s]);
-        };
-        obj_writer.write_face_elements(fh, index_offsets[i], obj, matname_fn);
+  auto write_object = [&](FormatHandler &fh, const int i) {
+    write_mesh_object(fh,
+                      obj_writer,
+                      mtl_writer,
+                      *exportable_as_mesh[i],
+                      mtlindices.is_empty() ? nullptr : &mtlindices[i],
+                      index_offsets[i],
+                      export_params);
+  };
+
+  /* Main result writing, in order of the objects. The text is passed on to the file writer
+   * while it is generated, so that only a limited amount of it is in memory at once. */
+  FormatHandler fh(64 * 1024, &obj_writer.get_file_writer());
+  const int64_t max_batch_size = small_object_size * BLI_system_thread_count() * 4;
+  for (int64_t i = 0; i < count;) {
+    if (object_elements_num(*exportable_as_mesh[i]) >= small_object_size) {
+      /* Parallel over chunks of the object's elements. */
+      write_object(fh, i);
+      i++;
+      continue;
+    }
+    /* Parallel over a batch of consecutive small meshes. */
+    int64_t batch_end = i;
+    int64_t batch_size = 0;
+    while (batch_end < count && batch_size < max_batch_size) {
+      const int64_t size = object_elements_num(*exportable_as_mesh[batch_end]);
+      if (size >= small_object_size) {
+        break;
       }
-      obj_writer.write_edges_indices(fh, index_offsets[i], obj);
-
-      /* Nothing will need this object's data after this point, release
-       * various arrays here. */
-      obj.clear();
+      batch_size += size;
+      batch_end++;
     }
-  });
-
-  /* Write all the object text buffers into the output file. */
-  FILE *f = obj_writer.get_outfile();
-  for (auto &b : buffers) {
-    b.write_to_file(f);
+    const IndexRange batch = IndexRange::from_begin_end(i, batch_end);
+    Array<FormatHandler> buffers(batch.size());
+    threading::parallel_for(batch.index_range(), 1, [&](IndexRange range) {
+      for (const int r : range) {
+        write_object(buffers[r], batch[r]);
+      }
+    });
+    for (FormatHandler &buffer : buffers) {
+      fh.append_from(buffer);
+    }
+    i = batch_end;
   }
+  fh.write_to(obj_writer.get_file_writer());
 }
 
 /**
@@ -262,7 +313,7 @@ static void write_nurbs_curve_objects(const Span<std::unique_ptr<OBJCurve>> expo
   for (const std::unique_ptr<OBJCurve> &obj_curve : exportable_as_nurbs) {
     obj_writer.write_nurbs_curve(fh, *obj_curve);
   }
-  fh.write_to_file(obj_writer.get_outfile());
+  fh.write_to(obj_writer.get_file_writer());
 }
 
 void export_frame(Depsgraph *depsgraph, const OBJExportParams &export_params, const char *filepath)
@@ -317,6 +368,17 @@ void export_frame(Depsgraph *depsgraph, const OBJExportParams &export_params, co
                                 export_params.export_pbr_extensions);
   }
   write_nurbs_curve_objects(exportable_as_nurbs, *frame_writer);
+
+  if (mtl_writer && !mtl_writer->finish()) {
+    BKE_reportf(export_params.reports,
+                RPT_ERROR,
+                "OBJ Export: Failed to write file '%s'",
+                mtl_writer->mtl_file_path().c_str());
+  }
+  if (!frame_writer->finish()) {
+    BKE_reportf(
+        export_params.reports, RPT_ERROR, "OBJ Export: Failed to write file '%s'", filepath);
+  }
 }
 
 bool append_frame_to_filename(const char *filepath,
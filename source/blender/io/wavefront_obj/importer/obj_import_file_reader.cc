@@ -14,6 +14,7 @@
 #include "BLI_math_vector_types.hh"
 #include "BLI_string.h"
 #include "BLI_string_ref.hh"
+#include "BLI_task.hh"
 #include "BLI_vector.hh"
 
 #include "obj_export_mtl.hh"
@@ -71,12 +72,19 @@ static Geometry *create_geometry(Geometry *const prev_geometry,
   return new_geometry();
 }
 
-static void geom_add_vertex(const char *p, const char *end, GlobalVertices &r_global_vertices)
+/**
+ * Vertex position and optional color as read from a `v` line.
+ */
+struct ParsedVertex {
+  float3 position;
+  float3 color;
+  bool has_color = false;
+};
+
+static void parse_vertex(const char *p, const char *end, ParsedVertex &r_vert)
 {
-  r_global_vertices.flush_mrgb_block();
-  float3 vert;
-  p = parse_floats(p, end, 0.0f, vert, 3);
-  r_global_vertices.vertices.append(vert);
+  p = parse_floats(p, end, 0.0f, r_vert.position, 3);
+  r_vert.has_color = false;
   /* OBJ extension: `xyzrgb` vertex colors, when the vertex position
    * is followed by 3 more RGB color components. See
    * http://paulbourke.net/dataformats/obj/colour.html */
@@ -84,14 +92,22 @@ static void geom_add_vertex(const char *p, const char *end, GlobalVertices &r_gl
     float3 srgb;
     p = parse_floats(p, end, -1.0f, srgb, 3);
     if (srgb.x >= 0 && srgb.y >= 0 && srgb.z >= 0) {
-      float3 linear;
-      srgb_to_linearrgb_v3_v3(linear, srgb);
-      r_global_vertices.set_vertex_color(r_global_vertices.vertices.size() - 1, linear);
+      srgb_to_linearrgb_v3_v3(r_vert.color, srgb);
+      r_vert.has_color = true;
     }
   }
   UNUSED_VARS(p);
 }
 
+static void geom_add_vertex(const ParsedVertex &vert, GlobalVertices &r_global_vertices)
+{
+  r_global_vertices.flush_mrgb_block();
+  r_global_vertices.vertices.append(vert.position);
+  if (vert.has_color) {
+    r_global_vertices.set_vertex_color(r_global_vertices.vertices.size() - 1, vert.color);
+  }
+}
+
 static void geom_add_mrgb_colors(const char *p, const char *end, GlobalVertices &r_global_vertices)
 {
   /* MRGB color extension, in the form of
@@ -119,9 +135,7 @@ static void geom_add_mrgb_colors(const char *p, const char *end, GlobalVertices
   }
 }
 
-static void geom_add_vertex_normal(const char *p,
-                                   const char *end,
-                                   GlobalVertices &r_global_vertices)
+static float3 parse_vertex_normal(const char *p, const char *end)
 {
   float3 normal;
   parse_floats(p, end, 0.0f, normal, 3);
@@ -129,14 +143,14 @@ static void geom_add_vertex_normal(const char *p,
    * making them ever-so-slightly non unit length. Make sure they are
    * normalized. */
   normalize_v3(normal);
-  r_global_vertices.vert_normals.append(normal);
+  return normal;
 }
 
-static void geom_add_uv_vertex(const char *p, const char *end, GlobalVertices &r_global_vertices)
+static float2 parse_uv_vertex(const char *p, const char *end)
 {
   float2 uv;
   parse_floats(p, end, 0.0f, uv, 2);
-  r_global_vertices.uv_vertices.append(uv);
+  return uv;
 }
 
 /**
@@ -202,30 +216,21 @@ static void geom_add_polyline(Geometry *geom,
   }
 }
 
-static void geom_add_polygon(Geometry *geom,
-                             const char *p,
-                             const char *end,
-                             const GlobalVertices &global_vertices,
-                             const int material_index,
-                             const int group_index,
-                             const bool shaded_smooth)
-{
-  FaceElem curr_face;
-  curr_face.shaded_smooth = shaded_smooth;
-  curr_face.material_index = material_index;
-  if (group_index >= 0) {
-    curr_face.vertex_group_index = group_index;
-    geom->has_vertex_groups_ = true;
-  }
-
-  const int orig_corners_size = geom->face_corners_.size();
-  curr_face.start_index_ = orig_corners_size;
+/**
+ * Face corner indices as written in the file, before they are made zero-based and validated.
+ */
+struct ParsedFaceCorner {
+  FaceCorner corner;
+  bool got_uv = false;
+  bool got_normal = false;
+};
 
-  bool face_valid = true;
+static void parse_face_corners(const char *p, const char *end, Vector<ParsedFaceCorner> &r_corners)
+{
   p = drop_whitespace(p, end);
-  while (p < end && face_valid) {
-    FaceCorner corner;
-    bool got_uv = false, got_normal = false;
+  while (p < end) {
+    ParsedFaceCorner parsed;
+    FaceCorner &corner = parsed.corner;
     /* Parse vertex index. */
     p = parse_int(p, end, INT32_MAX, corner.vert_index, false);
 
@@ -234,21 +239,54 @@ static void geom_add_polygon(Geometry *geom,
       break;
     }
 
-    face_valid &= corner.vert_index != INT32_MAX;
     if (p < end && *p == '/') {
       /* Parse UV index. */
       ++p;
       if (p < end && *p != '/') {
         p = parse_int(p, end, INT32_MAX, corner.uv_vert_index, false);
-        got_uv = corner.uv_vert_index != INT32_MAX;
+        parsed.got_uv = corner.uv_vert_index != INT32_MAX;
       }
       /* Parse normal index. */
       if (p < end && *p == '/') {
         ++p;
         p = parse_int(p, end, INT32_MAX, corner.vertex_normal_index, false);
-        got_normal = corner.vertex_normal_index != INT32_MAX;
+        parsed.got_normal = corner.vertex_normal_index != INT32_MAX;
       }
     }
+    r_corners.append(parsed);
+
+    /* Some files contain extra stuff per face (e.g. 4 indices); skip any remainder (#103441). */
+    p = drop_non_whitespace(p, end);
+    /* Skip whitespace to get to the next face corner. */
+    p = drop_whitespace(p, end);
+  }
+}
+
+static void geom_add_polygon(Geometry *geom,
+                             const Span<ParsedFaceCorner> corners,
+                             const GlobalVertices &global_vertices,
+                             const int material_index,
+                             const int group_index,
+                             const bool shaded_smooth)
+{
+  FaceElem curr_face;
+  curr_face.shaded_smooth = shaded_smooth;
+  curr_face.material_index = material_index;
+  if (group_index >= 0) {
+    curr_face.vertex_group_index = group_index;
+    geom->has_vertex_groups_ = true;
+  }
+
+  const int orig_corners_size = geom->face_corners_.size();
+  curr_face.start_index_ = orig_corners_size;
+
+  bool face_valid = true;
+  for (const ParsedFaceCorner &parsed : corners) {
+    if (!face_valid) {
+      break;
+    }
+    FaceCorner corner = parsed.corner;
+    face_valid &= corner.vert_index != INT32_MAX;
     /* Always keep stored indices non-negative and zero-based. */
     corner.vert_index += corner.vert_index < 0 ? global_vertices.vertices.size() : -1;
     if (corner.vert_index < 0 || corner.vert_index >= global_vertices.vertices.size()) {
@@ -262,7 +300,7 @@ static void geom_add_polygon(Geometry *geom,
       geom->track_vertex_index(corner.vert_index);
     }
     /* Ignore UV index, if the geometry does not have any UVs (#103212). */
-    if (got_uv && !global_vertices.uv_vertices.is_empty()) {
+    if (parsed.got_uv && !global_vertices.uv_vertices.is_empty()) {
       corner.uv_vert_index += corner.uv_vert_index < 0 ? global_vertices.uv_vertices.size() : -1;
       if (corner.uv_vert_index < 0 || corner.uv_vert_index >= global_vertices.uv_vertices.size()) {
         fprintf(stderr,
@@ -275,7 +313,7 @@ static void geom_add_polygon(Geometry *geom,
     /* Ignore corner normal index, if the geometry does not have any normals.
      * Some obj files out there do have face definitions that refer to normal indices,
      * without any normals being present (#98782). */
-    if (got_normal && !global_vertices.vert_normals.is_empty()) {
+    if (parsed.got_normal && !global_vertices.vert_normals.is_empty()) {
       corner.vertex_normal_index += corner.vertex_normal_index < 0 ?
                                         global_vertices.vert_normals.size() :
                                         -1;
@@ -291,11 +329,6 @@ static void geom_add_polygon(Geometry *geom,
     }
     geom->face_corners_.append(corner);
     curr_face.corner_count_++;
-
-    /* Some files contain extra stuff per face (e.g. 4 indices); skip any remainder (#103441). */
-    p = drop_non_whitespace(p, end);
-    /* Skip whitespace to get to the next face corner. */
-    p = drop_whitespace(p, end);
   }
 
   if (face_valid) {
@@ -421,8 +454,12 @@ static void geom_new_object(const char *p,
       r_curr_geom, GEOM_MESH, StringRef(p, end).trim(), r_all_geometries);
 }
 
-OBJParser::OBJParser(const OBJImportParams &import_params, size_t read_buffer_size)
-    : import_params_(import_params), read_buffer_size_(read_buffer_size)
+OBJParser::OBJParser(const OBJImportParams &import_params,
+                     size_t read_buffer_size,
+                     size_t parallel_chunk_size)
+    : import_params_(import_params),
+      read_buffer_size_(read_buffer_size),
+      parallel_chunk_size_(parallel_chunk_size)
 {
   obj_file_ = BLI_fopen(import_params_.filepath, "rb");
   if (!obj_file_) {
@@ -477,6 +514,232 @@ static void use_all_vertices_if_no_faces(Geometry *geom,
   }
 }
 
+/**
+ * State variables: once set, they remain the same for the remaining elements in the object.
+ */
+struct OBJParser::ParserState {
+  Geometry *curr_geom = nullptr;
+  bool shaded_smooth = false;
+  string group_name;
+  int group_index = -1;
+  string material_name;
+  int material_index = -1;
+};
+
+static void geom_add_face(const Span<ParsedFaceCorner> corners,
+                          const GlobalVertices &global_vertices,
+                          OBJParser::ParserState &state)
+{
+  /* If we don't have a material index assigned yet, get one.
+   * It means "usemtl" state came from the previous object. */
+  Geometry *geom = state.curr_geom;
+  if (state.material_index == -1 && !state.material_name.empty() &&
+      geom->material_indices_.is_empty())
+  {
+    geom->material_indices_.add_new(state.material_name, 0);
+    geom->material_order_.append(state.material_name);
+    state.material_index = 0;
+  }
+
+  geom_add_polygon(geom,
+                   corners,
+                   global_vertices,
+                   state.material_index,
+                   state.group_index,
+                   state.shaded_smooth);
+}
+
+void OBJParser::parse_state_line(const char *p,
+                                 const char *end,
+                                 ParserState &state,
+                                 Vector<std::unique_ptr<Geometry>> &r_all_geometries,
+                                 GlobalVertices &r_global_vertices)
+{
+  /* Faces. */
+  if (parse_keyword(p, end, "l")) {
+    geom_add_polyline(state.curr_geom, p, end, r_global_vertices);
+  }
+  /* Objects. */
+  else if (parse_keyword(p, end, "o")) {
+    if (import_params_.use_split_objects) {
+      geom_new_object(p,
+                      end,
+                      state.shaded_smooth,
+                      state.group_name,
+                      state.material_index,
+                      state.curr_geom,
+                      r_all_geometries);
+    }
+  }
+  /* Groups. */
+  else if (parse_keyword(p, end, "g")) {
+    if (import_params_.use_split_groups) {
+      geom_new_object(p,
+                      end,
+                      state.shaded_smooth,
+                      state.group_name,
+                      state.material_index,
+                      state.curr_geom,
+                      r_all_geometries);
+    }
+    else {
+      geom_update_group(StringRef(p, end).trim(), state.group_name);
+      int new_index = state.curr_geom->group_indices_.size();
+      state.group_index = state.curr_geom->group_indices_.lookup_or_add(state.group_name,
+                                                                        new_index);
+      if (new_index == state.group_index) {
+        state.curr_geom->group_order_.append(state.group_name);
+      }
+    }
+  }
+  /* Smoothing groups. */
+  else if (parse_keyword(p, end, "s")) {
+    geom_update_smooth_group(p, end, state.shaded_smooth);
+  }
+  /* Materials and their libraries. */
+  else if (parse_keyword(p, end, "usemtl")) {
+    state.material_name = StringRef(p, end).trim();
+    int new_mat_index = state.curr_geom->material_indices_.size();
+    state.material_index = state.curr_geom->material_indices_.lookup_or_add(state.material_name,
+                                                                            new_mat_index);
+    if (new_mat_index == state.material_index) {
+      state.curr_geom->material_order_.append(state.material_name);
+    }
+  }
+  else if (parse_keyword(p, end, "mtllib")) {
+    add_mtl_library(StringRef(p, end).trim());
+  }
+  else if (parse_keyword(p, end, "#MRGB")) {
+    geom_add_mrgb_colors(p, end, r_global_vertices);
+  }
+  /* Comments. */
+  else if (*p == '#') {
+    /* Nothing to do. */
+  }
+  /* Curve related things. */
+  else if (parse_keyword(p, end, "cstype")) {
+    state.curr_geom = geom_set_curve_type(
+        state.curr_geom, p, end, state.group_name, r_all_geometries);
+  }
+  else if (parse_keyword(p, end, "deg")) {
+    geom_set_curve_degree(state.curr_geom, p, end);
+  }
+  else if (parse_keyword(p, end, "curv")) {
+    geom_add_curve_vertex_indices(state.curr_geom, p, end, r_global_vertices);
+  }
+  else if (parse_keyword(p, end, "parm")) {
+    geom_add_curve_parameters(state.curr_geom, p, end);
+  }
+  else if (StringRef(p, end).startswith("end")) {
+    /* End of curve definition, nothing else to do. */
+  }
+  else {
+    std::cout << "OBJ element not recognized: '" << std::string(p, end) << "'" << std::endl;
+  }
+}
+
+/**
+ * A piece of the read buffer whose vertex, normal, UV and face lines have been parsed on a worker
+ * thread. Everything that depends on the elements that come before it in the file (index
+ * resolution, current object, material and group state) is applied afterwards in file order, so
+ * that the result does not depend on how the buffer was split.
+ */
+struct ParsedChunk {
+  enum class LineType : uint8_t {
+    Vertex,
+    VertexNormal,
+    UVVertex,
+    Face,
+    Other,
+  };
+
+  /** Type of each line that has to be handled in the ordered pass. */
+  Vector<LineType> line_types;
+  Vector<ParsedVertex> vertices;
+  Vector<float3> vert_normals;
+  Vector<float2> uv_vertices;
+  Vector<ParsedFaceCorner> face_corners;
+  Vector<int> face_corner_counts;
+  /** Lines of type #LineType::Other, with leading whitespace removed. */
+  Vector<StringRef> other_lines;
+  size_t line_count = 0;
+
+  void clear()
+  {
+    line_types.clear();
+    vertices.clear();
+    vert_normals.clear();
+    uv_vertices.clear();
+    face_corners.clear();
+    face_corner_counts.clear();
+    other_lines.clear();
+    line_count = 0;
+  }
+};
+
+static void parse_chunk(StringRef buffer_str, ParsedChunk &r_chunk)
+{
+  using LineType = ParsedChunk::LineType;
+  r_chunk.clear();
+  while (!buffer_str.is_empty()) {
+    StringRef line = read_next_line(buffer_str);
+    const char *p = line.begin(), *end = line.end();
+    p = drop_whitespace(p, end);
+    r_chunk.line_count++;
+    if (p == end) {
+      continue;
+    }
+    const char *line_start = p;
+    if (*p == 'v') {
+      if (parse_keyword(p, end, "v")) {
+        r_chunk.vertices.append_as();
+        parse_vertex(p, end, r_chunk.vertices.last());
+        r_chunk.line_types.append(LineType::Vertex);
+      }
+      else if (parse_keyword(p, end, "vn")) {
+        r_chunk.vert_normals.append(parse_vertex_normal(p, end));
+        r_chunk.line_types.append(LineType::VertexNormal);
+      }
+      else if (parse_keyword(p, end, "vt")) {
+        r_chunk.uv_vertices.append(parse_uv_vertex(p, end));
+        r_chunk.line_types.append(LineType::UVVertex);
+      }
+    }
+    else if (parse_keyword(p, end, "f")) {
+      const int64_t corners_start = r_chunk.face_corners.size();
+      parse_face_corners(p, end, r_chunk.face_corners);
+      r_chunk.face_corner_counts.append(int(r_chunk.face_corners.size() - corners_start));
+      r_chunk.line_types.append(LineType::Face);
+    }
+    else if (*p == '#' && !parse_keyword(p, end, "#MRGB")) {
+      /* Comments. */
+    }
+    else {
+      r_chunk.other_lines.append(StringRef(line_start, end));
+      r_chunk.line_types.append(LineType::Other);
+    }
+  }
+}
+
+/**
+ * Split the buffer into pieces of roughly the given size, at line boundaries.
+ */
+static Vector<StringRef> split_buffer_at_lines(const StringRef buffer_str, const size_t chunk_size)
+{
+  Vector<StringRef> pieces;
+  int64_t start = 0;
+  while (start < buffer_str.size()) {
+    int64_t piece_end = std::min<int64_t>(start + chunk_size, buffer_str.size());
+    if (piece_end < buffer_str.size()) {
+      const int64_t nl = buffer_str.find('\n', piece_end - 1);
+      piece_end = nl == StringRef::not_found ? buffer_str.size() : nl + 1;
+    }
+    pieces.append(buffer_str.substr(start, piece_end - start));
+    start = piece_end;
+  }
+  return pieces;
+}
+
 void OBJParser::parse(Vector<std::unique_ptr<Geometry>> &r_all_geometries,
                       GlobalVertices &r_global_vertices)
 {
@@ -489,20 +752,17 @@ void OBJParser::parse(Vector<std::unique_ptr<Geometry>> &r_all_geometries,
   STRNCPY(ob_name, BLI_path_basename(import_params_.filepath));
   BLI_path_extension_strip(ob_name);
 
-  Geometry *curr_geom = create_geometry(nullptr, GEOM_MESH, ob_name, r_all_geometries);
-
-  /* State variables: once set, they remain the same for the remaining
-   * elements in the object. */
-  bool state_shaded_smooth = false;
-  string state_group_name;
-  int state_group_index = -1;
-  string state_material_name;
-  int state_material_index = -1;
+  ParserState state;
+  state.curr_geom = create_geometry(nullptr, GEOM_MESH, ob_name, r_all_geometries);
 
   /* Read the input file in chunks. We need up to twice the possible chunk size,
    * to possibly store remainder of the previous input line that got broken mid-chunk. */
   Array<char> buffer(read_buffer_size_ * 2);
 
+  /* Reused between buffers to avoid reallocations. */
+  Vector<ParsedFaceCorner> face_corners;
+  Vector<ParsedChunk> chunks;
+
   size_t buffer_offset = 0;
   size_t line_number = 0;
   while (true) {
@@ -548,127 +808,86 @@ void OBJParser::parse(Vector<std::unique_ptr<Geometry>> &r_all_geometries,
     }
     ++last_nl;
 
-    /* Parse the buffer (until last newline) that we have so far,
-     * line by line. */
     StringRef buffer_str{buffer.data(), int64_t(last_nl)};
-    while (!buffer_str.is_empty()) {
-      StringRef line = read_next_line(buffer_str);
-      const char *p = line.begin(), *end = line.end();
-      p = drop_whitespace(p, end);
-      ++line_number;
-      if (p == end) {
-        continue;
-      }
-      /* Most common things that start with 'v': vertices, normals, UVs. */
-      if (*p == 'v') {
-        if (parse_keyword(p, end, "v")) {
-          geom_add_vertex(p, end, r_global_vertices);
-        }
-        else if (parse_keyword(p, end, "vn")) {
-          geom_add_vertex_normal(p, end, r_global_vertices);
-        }
-        else if (parse_keyword(p, end, "vt")) {
-          geom_add_uv_vertex(p, end, r_global_vertices);
-        }
+    if (import_params_.use_parallel_parse) {
+      /* Parse the numbers of all pieces in parallel, then add the elements in file order. */
+      const Vector<StringRef> pieces = split_buffer_at_lines(buffer_str, parallel_chunk_size_);
+      if (chunks.size() < pieces.size()) {
+        chunks.resize(pieces.size());
       }
-      /* Faces. */
-      else if (parse_keyword(p, end, "f")) {
-        /* If we don't have a material index assigned yet, get one.
-         * It means "usemtl" state came from the previous object. */
-        if (state_material_index == -1 && !state_material_name.empty() &&
-            curr_geom->material_indices_.is_empty())
-        {
-          curr_geom->material_indices_.add_new(state_material_name, 0);
-          curr_geom->material_order_.append(state_material_name);
-          state_material_index = 0;
+      threading::parallel_for(pieces.index_range(), 1, [&](const IndexRange range) {
+        for (const int64_t i : range) {
+          parse_chunk(pieces[i], chunks[i]);
         }
-
-        geom_add_polygon(curr_geom,
-                         p,
-                         end,
-                         r_global_vertices,
-                         state_material_index,
-                         state_group_index,
-                         state_shaded_smooth);
-      }
-      /* Faces. */
-      else if (parse_keyword(p, end, "l")) {
-        geom_add_polyline(curr_geom, p, end, r_global_vertices);
-      }
-      /* Objects. */
-      else if (parse_keyword(p, end, "o")) {
-        if (import_params_.use_split_objects) {
-          geom_new_object(p,
-                          end,
-                          state_shaded_smooth,
-                          state_group_name,
-                          state_material_index,
-                          curr_geom,
-                          r_all_geometries);
+      });
+
+      using LineType = ParsedChunk::LineType;
+      for (const ParsedChunk &chunk : chunks.as_span().take_front(pieces.size())) {
+        int64_t vertex_i = 0, normal_i = 0, uv_i = 0, face_i = 0, corner_i = 0, other_i = 0;
+        for (const LineType type : chunk.line_types) {
+          switch (type) {
+            case LineType::Vertex:
+              geom_add_vertex(chunk.vertices[vertex_i++], r_global_vertices);
+              break;
+            case LineType::VertexNormal:
+              r_global_vertices.vert_normals.append(chunk.vert_normals[normal_i++]);
+              break;
+            case LineType::UVVertex:
+              r_global_vertices.uv_vertices.append(chunk.uv_vertices[uv_i++]);
+              break;
+            case LineType::Face: {
+              const int corners_num = chunk.face_corner_counts[face_i++];
+              geom_add_face(chunk.face_corners.as_span().slice(corner_i, corners_num),
+                            r_global_vertices,
+                            state);
+              corner_i += corners_num;
+              break;
+            }
+            case LineType::Other: {
+              const StringRef line = chunk.other_lines[other_i++];
+              parse_state_line(
+                  line.begin(), line.end(), state, r_all_geometries, r_global_vertices);
+              break;
+            }
+          }
         }
+        line_number += chunk.line_count;
       }
-      /* Groups. */
-      else if (parse_keyword(p, end, "g")) {
-        if (import_params_.use_split_groups) {
-          geom_new_object(p,
-                          end,
-                          state_shaded_smooth,
-                          state_group_name,
-                          state_material_index,
-                          curr_geom,
-                          r_all_geometries);
+    }
+    else {
+      /* Parse the buffer (until last newline) that we have so far,
+       * line by line. */
+      while (!buffer_str.is_empty()) {
+        StringRef line = read_next_line(buffer_str);
+        const char *p = line.begin(), *end = line.end();
+        p = drop_whitespace(p, end);
+        ++line_number;
+        if (p == end) {
+          continue;
         }
-        else {
-          geom_update_group(StringRef(p, end).trim(), state_group_name);
-          int new_index = curr_geom->group_indices_.size();
-          state_group_index = curr_geom->group_indices_.lookup_or_add(state_group_name, new_index);
-          if (new_index == state_group_index) {
-            curr_geom->group_order_.append(state_group_name);
+        /* Most common things that start with 'v': vertices, normals, UVs. */
+        if (*p == 'v') {
+          if (parse_keyword(p, end, "v")) {
+            ParsedVertex vert;
+            parse_vertex(p, end, vert);
+            geom_add_vertex(vert, r_global_vertices);
+          }
+          else if (parse_keyword(p, end, "vn")) {
+            r_global_vertices.vert_normals.append(parse_vertex_normal(p, end));
+          }
+          else if (parse_keyword(p, end, "vt")) {
+            r_global_vertices.uv_vertices.append(parse_uv_vertex(p, end));
           }
         }
-      }
-      /* Smoothing groups. */
-      else if (parse_keyword(p, end, "s")) {
-        geom_update_smooth_group(p, end, state_shaded_smooth);
-      }
-      /* Materials and their libraries. */
-      else if (parse_keyword(p, end, "usemtl")) {
-        state_material_name = StringRef(p, end).trim();
-        int new_mat_index = curr_geom->material_indices_.size();
-        state_material_index = curr_geom->material_indices_.lookup_or_add(state_material_name,
-                                                                          new_mat_index);
-        if (new_mat_index == state_material_index) {
-          curr_geom->material_order_.append(state_material_name);
+        /* Faces. */
+        else if (parse_keyword(p, end, "f")) {
+          face_corners.clear();
+          parse_face_corners(p, end, face_corners);
+          geom_add_face(face_corners, r_global_vertices, state);
+        }
+        else {
+          parse_state_line(p, end, state, r_all_geometries, r_global_vertices);
         }
-      }
-      else if (parse_keyword(p, end, "mtllib")) {
-        add_mtl_library(StringRef(p, end).trim());
-      }
-      else if (parse_keyword(p, end, "#MRGB")) {
-        geom_add_mrgb_colors(p, end, r_global_vertices);
-      }
-      /* Comments. */
-      else if (*p == '#') {
-        /* Nothing to do. */
-      }
-      /* Curve related things. */
-      else if (parse_keyword(p, end, "cstype")) {
-        curr_geom = geom_set_curve_type(curr_geom, p, end, state_group_name, r_all_geometries);
-      }
-      else if (parse_keyword(p, end, "deg")) {
-        geom_set_curve_degree(curr_geom, p, end);
-      }
-      else if (parse_keyword(p, end, "curv")) {
-        geom_add_curve_vertex_indices(curr_geom, p, end, r_global_vertices);
-      }
-      else if (parse_keyword(p, end, "parm")) {
-        geom_add_curve_parameters(curr_geom, p, end);
-      }
-      else if (StringRef(p, end).startswith("end")) {
-        /* End of curve definition, nothing else to do. */
-      }
-      else {
-        std::cout << "OBJ element not recognized: '" << std::string(p, end) << "'" << std::endl;
       }
     }
 
@@ -680,7 +899,7 @@ void OBJParser::parse(Vector<std::unique_ptr<Geometry>> &r_all_geometries,
   }
 
   r_global_vertices.flush_mrgb_block();
-  use_all_vertices_if_no_faces(curr_geom, r_all_geometries, r_global_vertices);
+  use_all_vertices_if_no_faces(state.curr_geom, r_all_geometries, r_global_vertices);
   add_default_mtl_library();
 }
 
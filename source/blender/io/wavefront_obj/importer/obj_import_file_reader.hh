@@ -27,17 +27,28 @@ class OBJParser {
   FILE *obj_file_;
   Vector<std::string> mtl_libraries_;
   size_t read_buffer_size_;
+  size_t parallel_chunk_size_;
 
  public:
+  struct ParserState;
+
   /**
    * Open OBJ file at the path given in import parameters.
+   *
+   * \param parallel_chunk_size: Approximate size of the pieces each read buffer is split into
+   * when #OBJImportParams::use_parallel_parse is enabled.
    */
-  OBJParser(const OBJImportParams &import_params, size_t read_buffer_size);
+  OBJParser(const OBJImportParams &import_params,
+            size_t read_buffer_size,
+            size_t parallel_chunk_size = 64 * 1024);
   ~OBJParser();
 
   /**
    * Read the OBJ file line by line and create OBJ Geometry instances. Also store all the vertex
    * and UV vertex coordinates in a struct accessible by all objects.
+   *
+   * With #OBJImportParams::use_parallel_parse, the number parsing of vertex and face lines runs
+   * on multiple threads. The result is identical to parsing serially.
    */
   void parse(Vector<std::unique_ptr<Geometry>> &r_all_geometries,
              GlobalVertices &r_global_vertices);
@@ -49,6 +60,15 @@ class OBJParser {
  private:
   void add_mtl_library(StringRef path);
   void add_default_mtl_library();
+  /**
+   * Handle a line that is not a vertex, normal, UV or face, i.e. one that may change the state
+   * that applies to the following elements.
+   */
+  void parse_state_line(const char *p,
+                        const char *end,
+                        ParserState &state,
+                        Vector<std::unique_ptr<Geometry>> &r_all_geometries,
+                        GlobalVertices &r_global_vertices);
 };
 
 class MTLParser {
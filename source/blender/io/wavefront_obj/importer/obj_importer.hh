@@ -14,7 +14,7 @@ namespace blender::io::obj {
 
 void importer_geometry(const OBJImportParams &import_params,
                        Vector<bke::GeometrySet> &geometries,
-                       size_t read_buffer_size = 256 * 1024);
+                       size_t read_buffer_size = 4 * 1024 * 1024);
 
 /* Main import function used from within Blender. */
 void importer_main(bContext *C, const OBJImportParams &import_params);
@@ -24,6 +24,6 @@ void importer_main(Main *bmain,
                    Scene *scene,
                    ViewLayer *view_layer,
                    const OBJImportParams &import_params,
-                   size_t read_buffer_size = 256 * 1024);
+                   size_t read_buffer_size = 4 * 1024 * 1024);
 
 }  // namespace blender::io::obj
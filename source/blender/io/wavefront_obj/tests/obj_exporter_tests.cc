@@ -243,6 +243,59 @@ parm u 0.0
   ASSERT_EQ(got_string, expected);
 }
 
+TEST_F(ObjExporterWriterTest, format_handler_stream)
+{
+  std::string out_file_path = get_temp_obj_filename();
+  FormatHandler expected(16);
+  {
+    FILE *file = BLI_fopen(out_file_path.c_str(), "wb");
+    ASSERT_NE(file, nullptr);
+    {
+      /* Use a tiny queue, so that writing has to wait for the writer thread. */
+      AsyncFileWriter writer(file, 64);
+      FormatHandler h(16, &writer);
+      for (const int i : IndexRange(1000)) {
+        FormatHandler other(16);
+        other.write_obj_vertex(i, 0.5f, -i);
+        expected.write_obj_vertex(i, 0.5f, -i);
+        h.append_from(other);
+        h.write_obj_face_v(i);
+        expected.write_obj_face_v(i);
+        /* Full blocks are passed on to the writer. */
+        EXPECT_LE(h.get_block_count(), 1);
+      }
+      h.write_to(writer);
+      EXPECT_TRUE(writer.finish());
+    }
+    fclose(file);
+  }
+  ASSERT_EQ(read_temp_file_in_string(out_file_path), expected.get_as_string());
+}
+
+TEST_F(ObjExporterWriterTest, format_handler_stream_error)
+{
+  std::string out_file_path = get_temp_obj_filename();
+  FILE *file = BLI_fopen(out_file_path.c_str(), "wb");
+  ASSERT_NE(file, nullptr);
+  fclose(file);
+  /* Writing to a file that is opened for reading fails. */
+  file = BLI_fopen(out_file_path.c_str(), "rb");
+  ASSERT_NE(file, nullptr);
+  {
+    AsyncFileWriter writer(file, 64);
+    FormatHandler h(16, &writer);
+    for (const int i : IndexRange(100)) {
+      h.write_obj_vertex(i, 0.5f, -i);
+    }
+    h.write_to(writer);
+    EXPECT_FALSE(writer.finish());
+  }
+  FormatHandler h(16);
+  h.write_obj_vertex(0.0f, 0.5f, 0.0f);
+  EXPECT_FALSE(h.write_to_file(file));
+  fclose(file);
+}
+
 /* Return true if string #a and string #b are equal after their first newline. */
 static bool strings_equal_after_first_lines(const std::string &a, const std::string &b)
 {
@@ -0,0 +1,210 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include <gtest/gtest.h>
+
+#include "BKE_appdir.hh"
+
+#include "BLI_fileops.h"
+#include "BLI_rand.hh"
+#include "BLI_string.h"
+#include "BLI_timeit.hh"
+
+#include "obj_import_file_reader.hh"
+
+namespace blender::io::obj {
+
+class OBJParserTest : public testing::Test {
+ protected:
+  void SetUp() override
+  {
+    BKE_tempdir_init(nullptr);
+  }
+
+  void TearDown() override
+  {
+    BKE_tempdir_session_purge();
+  }
+
+  std::string write_temp_obj_file(const std::string &contents)
+  {
+    const std::string path = std::string(BKE_tempdir_session()) + SEP_STR + "parser_test.obj";
+    FILE *file = BLI_fopen(path.c_str(), "wb");
+    fwrite(contents.data(), 1, contents.size(), file);
+    fclose(file);
+    return path;
+  }
+};
+
+/**
+ * Generate a file that mixes all kinds of elements, including invalid and relative indices,
+ * object, group and material changes and line continuations.
+ */
+static std::string generate_mixed_obj(const int lines_num, const uint32_t seed)
+{
+  RandomNumberGenerator rng(seed);
+  std::string str = "mtllib a.mtl\nv 1 2 3\nv 1 2 3 0.5 0.5 0.5\n#MRGB ff00ff00ff00ff00\n";
+  char line[256];
+  int verts_num = 2;
+  for (const int i : IndexRange(lines_num)) {
+    switch (rng.get_int32(12)) {
+      case 0:
+      case 1:
+      case 2:
+        SNPRINTF(line, "v %f %f %f\n", rng.get_float(), rng.get_float() * 10, -rng.get_float());
+        verts_num++;
+        break;
+      case 3:
+        SNPRINTF(line, "vn %f %f %f\n", rng.get_float(), 1.0f, 0.5f);
+        break;
+      case 4:
+        SNPRINTF(line, "vt %f %f\n", rng.get_float(), rng.get_float());
+        break;
+      case 5:
+      case 6:
+      case 7:
+        SNPRINTF(line,
+                 "f %d/%d/%d %d//%d -1 %d # comment\n",
+                 1 + rng.get_int32(verts_num + 2),
+                 1 + rng.get_int32(50),
+                 1 + rng.get_int32(50),
+                 1 + rng.get_int32(verts_num),
+                 1 + rng.get_int32(40),
+                 1 + rng.get_int32(verts_num + 1));
+        break;
+      case 8:
+        SNPRINTF(line, "g group%d\ns %d\nusemtl mat%d\n", i % 5, i % 2, i % 3);
+        break;
+      case 9:
+        SNPRINTF(line, "o object%d\n  \n#MRGB ff112233\n", i);
+        break;
+      case 10:
+        STRNCPY(line, "l 1 2 3\nf 1 x 2\n");
+        break;
+      default:
+        STRNCPY(line, "f 1 2 \\\n 3\n");
+        break;
+    }
+    str += line;
+  }
+  return str;
+}
+
+static void expect_equal_geometries(const Span<std::unique_ptr<Geometry>> a,
+                                    const Span<std::unique_ptr<Geometry>> b)
+{
+  ASSERT_EQ(a.size(), b.size());
+  for (const int i : a.index_range()) {
+    const Geometry &ga = *a[i];
+    const Geometry &gb = *b[i];
+    EXPECT_EQ(ga.geom_type_, gb.geom_type_);
+    EXPECT_EQ(ga.geometry_name_, gb.geometry_name_);
+    EXPECT_EQ(ga.group_order_, gb.group_order_);
+    EXPECT_EQ(ga.material_order_, gb.material_order_);
+    EXPECT_EQ(ga.vertex_index_min_, gb.vertex_index_min_);
+    EXPECT_EQ(ga.vertex_index_max_, gb.vertex_index_max_);
+    EXPECT_EQ(ga.get_vertex_count(), gb.get_vertex_count());
+    EXPECT_EQ(ga.edges_, gb.edges_);
+    EXPECT_EQ(ga.total_corner_, gb.total_corner_);
+    EXPECT_EQ(ga.has_invalid_faces_, gb.has_invalid_faces_);
+    EXPECT_EQ(ga.has_vertex_groups_, gb.has_vertex_groups_);
+    ASSERT_EQ(ga.face_corners_.size(), gb.face_corners_.size());
+    for (const int j : ga.face_corners_.index_range()) {
+      EXPECT_EQ(ga.face_corners_[j].vert_index, gb.face_corners_[j].vert_index);
+      EXPECT_EQ(ga.face_corners_[j].uv_vert_index, gb.face_corners_[j].uv_vert_index);
+      EXPECT_EQ(ga.face_corners_[j].vertex_normal_index, gb.face_corners_[j].vertex_normal_index);
+    }
+    ASSERT_EQ(ga.face_elements_.size(), gb.face_elements_.size());
+    for (const int j : ga.face_elements_.index_range()) {
+      EXPECT_EQ(ga.face_elements_[j].vertex_group_index, gb.face_elements_[j].vertex_group_index);
+      EXPECT_EQ(ga.face_elements_[j].material_index, gb.face_elements_[j].material_index);
+      EXPECT_EQ(ga.face_elements_[j].shaded_smooth, gb.face_elements_[j].shaded_smooth);
+      EXPECT_EQ(ga.face_elements_[j].start_index_, gb.face_elements_[j].start_index_);
+      EXPECT_EQ(ga.face_elements_[j].corner_count_, gb.face_elements_[j].corner_count_);
+    }
+  }
+}
+
+TEST_F(OBJParserTest, parallel_parse_matches_serial)
+{
+  const std::string path = write_temp_obj_file(generate_mixed_obj(5000, 0));
+  OBJImportParams params;
+  STRNCPY(params.filepath, path.c_str());
+
+  for (const bool use_split_groups : {false, true}) {
+    params.use_split_groups = use_split_groups;
+
+    params.use_parallel_parse = false;
+    Vector<std::unique_ptr<Geometry>> serial_geometries;
+    GlobalVertices serial_vertices;
+    OBJParser serial_parser{params, 650};
+    serial_parser.parse(serial_geometries, serial_vertices);
+
+    /* Use small read buffers and pieces, so that lines are split in many different places. */
+    params.use_parallel_parse = true;
+    for (const size_t read_buffer_size : {650, 4096, 1024 * 1024}) {
+      for (const size_t chunk_size : {1, 97, 1000}) {
+        Vector<std::unique_ptr<Geometry>> geometries;
+        GlobalVertices vertices;
+        OBJParser parser{params, read_buffer_size, chunk_size};
+        parser.parse(geometries, vertices);
+
+        EXPECT_EQ(vertices.vertices, serial_vertices.vertices);
+        EXPECT_EQ(vertices.uv_vertices, serial_vertices.uv_vertices);
+        EXPECT_EQ(vertices.vert_normals, serial_vertices.vert_normals);
+        EXPECT_EQ(vertices.vertex_colors, serial_vertices.vertex_colors);
+        EXPECT_EQ(parser.mtl_libraries(), serial_parser.mtl_libraries());
+        expect_equal_geometries(geometries, serial_geometries);
+      }
+    }
+  }
+}
+
+static std::string generate_grid_obj(const int size)
+{
+  std::string str;
+  char line[256];
+  for (const int y : IndexRange(size)) {
+    for (const int x : IndexRange(size)) {
+      SNPRINTF(line, "v %f %f %f\n", x * 0.01f, y * 0.01f, (x * y) % 7 * 0.001f);
+      str += line;
+      SNPRINTF(line, "vt %f %f\n", float(x) / size, float(y) / size);
+      str += line;
+      SNPRINTF(line, "vn %f %f %f\n", 0.0f, 0.0f, 1.0f);
+      str += line;
+    }
+  }
+  for (const int y : IndexRange(size - 1)) {
+    for (const int x : IndexRange(size - 1)) {
+      const int a = y * size + x + 1, b = a + 1, c = a + size + 1, d = a + size;
+      SNPRINTF(line, "f %d/%d/%d %d/%d/%d %d/%d/%d %d/%d/%d\n", a, a, a, b, b, b, c, c, c, d, d, d);
+      str += line;
+    }
+  }
+  return str;
+}
+
+/**
+ * The benchmark is too slow to run during normal test runs, run it with
+ * `--gtest_also_run_disabled_tests --gtest_filter=*parse_benchmark`.
+ */
+TEST_F(OBJParserTest, DISABLED_parse_benchmark)
+{
+  const std::string path = write_temp_obj_file(generate_grid_obj(2000));
+  OBJImportParams params;
+  STRNCPY(params.filepath, path.c_str());
+
+  for (const bool use_parallel_parse : {false, true}) {
+    params.use_parallel_parse = use_parallel_parse;
+    for ([[maybe_unused]] const int i : IndexRange(3)) {
+      Vector<std::unique_ptr<Geometry>> geometries;
+      GlobalVertices vertices;
+      OBJParser parser{params, 4 * 1024 * 1024};
+      SCOPED_TIMER(use_parallel_parse ? "parallel" : "serial");
+      parser.parse(geometries, vertices);
+    }
+  }
+}
+
+}  // namespace blender::io::obj
@@ -761,7 +761,10 @@ typedef struct UserDef_Experimental {
   char use_animation_baklava;
   char use_docking;
   char enable_new_cpu_compositor;
-  char _pad[1];
+  char use_incremental_autosave;
+  char use_geometry_nodes_memoization;
+  char use_blend_file_bhead_index;
+  char _pad[6];
   /** `makesdna` does not allow empty structs. */
 } UserDef_Experimental;
 
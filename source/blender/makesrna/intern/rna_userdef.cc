@@ -7451,6 +7451,28 @@ static void rna_def_userdef_experimental(BlenderRNA *brna)
   RNA_def_property_boolean_sdna(prop, nullptr, "enable_new_cpu_compositor", 1);
   RNA_def_property_ui_text(prop, "CPU Compositor", "Enable the new CPU compositor");
 
+  prop = RNA_def_property(srna, "use_incremental_autosave", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_sdna(prop, nullptr, "use_incremental_autosave", 1);
+  RNA_def_property_ui_text(prop,
+                           "Incremental Auto Save",
+                           "Only write the data that changed since the last auto-save, using the "
+                           "global undo memory. Recovering a file replays the auto-save journal");
+
+  prop = RNA_def_property(srna, "use_geometry_nodes_memoization", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_sdna(prop, nullptr, "use_geometry_nodes_memoization", 1);
+  RNA_def_property_ui_text(prop,
+                           "Node Group Memoization",
+                           "Reuse the outputs of geometry node groups from previous evaluations "
+                           "when their inputs did not change");
+
+  prop = RNA_def_property(srna, "use_blend_file_bhead_index", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_sdna(prop, nullptr, "use_blend_file_bhead_index", 1);
+  RNA_def_property_ui_text(prop,
+                           "Blend File Block Index",
+                           "Cache the list of data-blocks of large blend-files in the user cache "
+                           "directory, to open or link from them again without reading the whole "
+                           "file");
+
   prop = RNA_def_property(srna, "use_all_linked_data_direct", PROP_BOOLEAN, PROP_NONE);
   RNA_def_property_ui_text(
       prop,
@@ -963,8 +963,9 @@ static BakeFrameIndices get_bake_frame_indices(
   return frame_indices;
 }
 
-static void ensure_bake_loaded(bake::NodeBakeCache &bake_cache, bake::FrameCache &frame_cache)
+static void ensure_bake_loaded(bake::NodeBakeCache &bake_cache, const int frame_index)
 {
+  bake::FrameCache &frame_cache = *bake_cache.frames[frame_index];
   if (!frame_cache.state.items_by_id.is_empty()) {
     return;
   }
@@ -974,16 +975,33 @@ static void ensure_bake_loaded(bake::NodeBakeCache &bake_cache, bake::FrameCache
   if (!frame_cache.meta_path) {
     return;
   }
-  bke::bake::DiskBlobReader blob_reader{*bake_cache.blobs_dir};
-  fstream meta_file{*frame_cache.meta_path};
-  std::optional<bke::bake::BakeState> bake_state = bke::bake::deserialize_bake(
-      meta_file, blob_reader, *bake_cache.blob_sharing);
+  std::optional<bke::bake::BakeState> bake_state =
+      bake_cache.prefetcher ?
+          bake_cache.prefetcher->load(frame_cache, frame_index) :
+          bke::bake::load_baked_frame(
+              *bake_cache.blobs_dir, *frame_cache.meta_path, *bake_cache.blob_sharing);
   if (!bake_state.has_value()) {
     return;
   }
   frame_cache.state = std::move(*bake_state);
 }
 
+/**
+ * Start loading the baked frames that are likely needed next in the background, so that they
+ * don't have to be loaded during playback.
+ */
+static void prefetch_bake_frames(bake::NodeBakeCache &bake_cache, const SubFrame current_frame)
+{
+  if (!bake_cache.blobs_dir) {
+    return;
+  }
+  if (!bake_cache.prefetcher) {
+    bake_cache.prefetcher = std::make_unique<bake::FramePrefetcher>(*bake_cache.blobs_dir,
+                                                                    *bake_cache.blob_sharing);
+  }
+  bake_cache.prefetcher->prefetch(bake_cache.frames, current_frame);
+}
+
 static bool try_find_baked_data(bake::NodeBakeCache &bake,
                                 const Main &bmain,
                                 const Object &object,
@@ -1291,6 +1309,7 @@ class NodesModifierSimulationParams : public nodes::GeoNodesSimulationParams {
                        bake::SimulationNodeCache &node_cache,
                        nodes::SimulationZoneBehavior &zone_behavior) const
   {
+    prefetch_bake_frames(node_cache.bake, current_frame_);
     if (frame_indices.prev) {
       auto &output_copy_info = zone_behavior.input.emplace<sim_input::OutputCopy>();
       bake::FrameCache &frame_cache = *node_cache.bake.frames[*frame_indices.prev];
@@ -1327,7 +1346,7 @@ class NodesModifierSimulationParams : public nodes::GeoNodesSimulationParams {
                    nodes::SimulationZoneBehavior &zone_behavior) const
   {
     bake::FrameCache &frame_cache = *node_cache.bake.frames[frame_index];
-    ensure_bake_loaded(node_cache.bake, frame_cache);
+    ensure_bake_loaded(node_cache.bake, frame_index);
     auto &read_single_info = zone_behavior.output.emplace<sim_output::ReadSingle>();
     read_single_info.state = frame_cache.state;
   }
@@ -1339,8 +1358,8 @@ class NodesModifierSimulationParams : public nodes::GeoNodesSimulationParams {
   {
     bake::FrameCache &prev_frame_cache = *node_cache.bake.frames[prev_frame_index];
     bake::FrameCache &next_frame_cache = *node_cache.bake.frames[next_frame_index];
-    ensure_bake_loaded(node_cache.bake, prev_frame_cache);
-    ensure_bake_loaded(node_cache.bake, next_frame_cache);
+    ensure_bake_loaded(node_cache.bake, prev_frame_index);
+    ensure_bake_loaded(node_cache.bake, next_frame_index);
     auto &read_interpolated_info = zone_behavior.output.emplace<sim_output::ReadInterpolated>();
     read_interpolated_info.mix_factor = (float(current_frame_) - float(prev_frame_cache.frame)) /
                                         (float(next_frame_cache.frame) -
@@ -1446,6 +1465,7 @@ class NodesModifierBakeParams : public nodes::GeoNodesBakeParams {
     }
     const BakeFrameIndices frame_indices = get_bake_frame_indices(node_cache.bake.frames,
                                                                   current_frame_);
+    prefetch_bake_frames(node_cache.bake, current_frame_);
     if (frame_indices.current) {
       this->read_single(*frame_indices.current, node_cache, behavior);
       return;
@@ -1470,7 +1490,7 @@ class NodesModifierBakeParams : public nodes::GeoNodesBakeParams {
                    nodes::BakeNodeBehavior &behavior) const
   {
     bake::FrameCache &frame_cache = *node_cache.bake.frames[frame_index];
-    ensure_bake_loaded(node_cache.bake, frame_cache);
+    ensure_bake_loaded(node_cache.bake, frame_index);
     if (this->check_read_error(frame_cache, behavior)) {
       return;
     }
@@ -1485,8 +1505,8 @@ class NodesModifierBakeParams : public nodes::GeoNodesBakeParams {
   {
     bake::FrameCache &prev_frame_cache = *node_cache.bake.frames[prev_frame_index];
     bake::FrameCache &next_frame_cache = *node_cache.bake.frames[next_frame_index];
-    ensure_bake_loaded(node_cache.bake, prev_frame_cache);
-    ensure_bake_loaded(node_cache.bake, next_frame_cache);
+    ensure_bake_loaded(node_cache.bake, prev_frame_index);
+    ensure_bake_loaded(node_cache.bake, next_frame_index);
     if (this->check_read_error(prev_frame_cache, behavior) ||
         this->check_read_error(next_frame_cache, behavior))
     {
@@ -30,6 +30,7 @@
 
 #include "BLI_compute_context.hh"
 #include "BLI_math_quaternion_types.hh"
+#include "BLI_session_uid.h"
 
 #include "BKE_bake_items.hh"
 #include "BKE_node_tree_zones.hh"
@@ -423,6 +424,11 @@ struct GeometryNodesLazyFunctionGraphInfo {
    * This can be used as a simple heuristic for the complexity of the node group.
    */
   int num_inline_nodes_approximate = 0;
+  /**
+   * Identifies this graph in the current session. Unlike the address, it is never reused after the
+   * graph has been freed, so it can be used to identify cached results of the node group.
+   */
+  SessionUID session_uid = BLI_session_uid_generate();
 };
 
 std::unique_ptr<LazyFunction> get_simulation_output_lazy_function(
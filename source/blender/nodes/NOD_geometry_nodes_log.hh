@@ -29,6 +29,7 @@
 #pragma once
 
 #include <chrono>
+#include <mutex>
 
 #include "BLI_compute_context.hh"
 #include "BLI_enumerable_thread_specific.hh"
@@ -362,11 +363,20 @@ class GeoModifierLog {
 
   /** Container for all thread-local data. */
   threading::EnumerableThreadSpecific<LocalData> data_per_thread_;
+  /**
+   * Logs of earlier evaluations whose results have been reused in this evaluation, see
+   * #add_reused_log.
+   */
+  Vector<std::shared_ptr<GeoModifierLog>> reused_logs_;
+  std::mutex reused_logs_mutex_;
   /**
    * A #GeoTreeLog for every compute context. Those are created lazily when requested by UI code.
    */
   Map<ComputeContextHash, std::unique_ptr<GeoTreeLog>> tree_logs_;
 
+  void collect_tree_loggers(const ComputeContextHash &compute_context_hash,
+                            Vector<GeoTreeLogger *> &r_tree_loggers);
+
  public:
   GeoModifierLog();
   ~GeoModifierLog();
@@ -376,6 +386,19 @@ class GeoModifierLog {
    */
   GeoTreeLogger &get_local_tree_logger(const ComputeContext &compute_context);
 
+  /**
+   * Include everything that has been logged in another evaluation, as if it was logged in this
+   * one. This is used when the outputs of a node group evaluation are reused, because the nodes
+   * inside are not executed again. The compute contexts of both evaluations have to match.
+   */
+  void add_reused_log(std::shared_ptr<GeoModifierLog> log);
+
+  /**
+   * Get the compute contexts nested in the given one (recursively) that something was logged in.
+   */
+  Vector<ComputeContextHash> get_nested_context_hashes(
+      const ComputeContextHash &compute_context_hash);
+
   /**
    * Get a log a specific node tree instance.
    */
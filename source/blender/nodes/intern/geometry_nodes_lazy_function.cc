@@ -36,6 +36,7 @@
 #include "BLI_map.hh"
 
 #include "DNA_ID.h"
+#include "DNA_userdef_types.h"
 
 #include "BKE_anonymous_attribute_make.hh"
 #include "BKE_compute_contexts.hh"
@@ -54,6 +55,8 @@
 #include <fmt/format.h>
 #include <sstream>
 
+#include "geometry_nodes_memoization.hh"
+
 namespace blender::nodes {
 
 namespace aai = bke::anonymous_attribute_inferencing;
@@ -1079,8 +1082,11 @@ static bool should_log_socket_values_for_context(const GeoNodesLFUserData &user_
 class LazyFunctionForGroupNode : public LazyFunction {
  private:
   const bNode &group_node_;
+  const GeometryNodesLazyFunctionGraphInfo &group_lf_graph_info_;
   const LazyFunction &group_lazy_function_;
   bool has_many_nodes_ = false;
+  /** The outputs of the group only depend on its inputs, so they can be cached. */
+  bool is_memoizable_ = false;
 
   struct Storage {
     void *group_storage = nullptr;
@@ -1092,7 +1098,9 @@ class LazyFunctionForGroupNode : public LazyFunction {
   LazyFunctionForGroupNode(const bNode &group_node,
                            const GeometryNodesLazyFunctionGraphInfo &group_lf_graph_info,
                            GeometryNodesLazyFunctionGraphInfo &own_lf_graph_info)
-      : group_node_(group_node), group_lazy_function_(*group_lf_graph_info.function.function)
+      : group_node_(group_node),
+        group_lf_graph_info_(group_lf_graph_info),
+        group_lazy_function_(*group_lf_graph_info.function.function)
   {
     debug_name_ = group_node.name;
     allow_missing_requested_inputs_ = true;
@@ -1102,6 +1110,7 @@ class LazyFunctionForGroupNode : public LazyFunction {
     outputs_ = group_lf_graph_info.function.function->outputs();
 
     has_many_nodes_ = group_lf_graph_info.num_inline_nodes_approximate > 1000;
+    is_memoizable_ = node_group_is_memoizable(*reinterpret_cast<const bNodeTree *>(group_node.id));
 
     /* Add a boolean input for every output bsocket that indicates whether that socket is used. */
     for (const int i : group_node.output_sockets().index_range()) {
@@ -1149,9 +1158,190 @@ class LazyFunctionForGroupNode : public LazyFunction {
 
     GeoNodesLFLocalUserData group_local_user_data{group_user_data};
     lf::Context group_context{storage->group_storage, &group_user_data, &group_local_user_data};
+
+    /* Socket values in the group are only logged when it is evaluated, not when cached outputs
+     * are reused. */
+    if (is_memoizable_ && !group_user_data.log_socket_values &&
+        USER_EXPERIMENTAL_TEST(&U, use_geometry_nodes_memoization))
+    {
+      this->execute_memoized(params, group_context, compute_context.hash());
+      return;
+    }
     group_lazy_function_.execute(params, group_context);
   }
 
+  /**
+   * Reuse the outputs of a previous evaluation with the same inputs if possible. Since the inputs
+   * are part of the cache key, all of them are requested. The node group is then evaluated eagerly
+   * with all outputs being used, so that the cached outputs work for every caller. Everything that
+   * is logged inside the node group is stored with the outputs and added to the log again when the
+   * outputs are reused.
+   */
+  void execute_memoized(lf::Params &params,
+                        const lf::Context &group_context,
+                        const ComputeContextHash &context_hash) const
+  {
+    const GeometryNodesGroupFunction &group_fn = group_lf_graph_info_.function;
+    /* Report all inputs as used right away. The actual usages are only known after evaluating the
+     * node group, which needs all inputs already. Using more inputs than necessary is ok. */
+    for (const int i : group_fn.outputs.input_usages) {
+      if (!params.output_was_set(i)) {
+        params.set_output(i, true);
+      }
+    }
+    Vector<GPointer, 16> inputs;
+    bool any_input_missing = false;
+    for (const int i : group_fn.inputs.main) {
+      if (const void *value = params.try_get_input_data_ptr_or_request(i)) {
+        inputs.append({*inputs_[i].type, value});
+      }
+      else {
+        any_input_missing = true;
+      }
+    }
+    if (any_input_missing) {
+      /* The node runs again once the requested inputs are available. */
+      return;
+    }
+
+    const GeoNodesLFUserData &group_user_data = *static_cast<GeoNodesLFUserData *>(
+        group_context.user_data);
+    geo_eval_log::GeoModifierLog *eval_log = group_user_data.call_data->eval_log;
+    const std::unique_ptr<GenericKey> key = make_node_group_eval_key(
+        group_lf_graph_info_.session_uid, context_hash, eval_log != nullptr, inputs);
+
+    const auto compute_fn = [&]() {
+      auto outputs = std::make_unique<NodeGroupCachedOutputs>();
+      if (key) {
+        outputs->key_size_in_bytes = node_group_eval_key_size_in_bytes(*key);
+      }
+      if (eval_log == nullptr) {
+        this->execute_eagerly(inputs, group_context, *outputs);
+        return outputs;
+      }
+      /* Log into a separate log that can be reused together with the outputs. */
+      outputs->log = std::make_shared<geo_eval_log::GeoModifierLog>();
+      GeoNodesCallData call_data = *group_user_data.call_data;
+      call_data.eval_log = outputs->log.get();
+      GeoNodesLFUserData user_data = group_user_data;
+      user_data.call_data = &call_data;
+      GeoNodesLFLocalUserData local_user_data{user_data};
+      const lf::Context context{group_context.storage, &user_data, &local_user_data};
+      this->execute_eagerly(inputs, context, *outputs);
+      for (const ComputeContextHash &hash : outputs->log->get_nested_context_hashes(context_hash))
+      {
+        if (!should_log_socket_values_for_context(user_data, hash)) {
+          outputs->contexts_without_socket_values.append(hash);
+        }
+      }
+      return outputs;
+    };
+    std::shared_ptr<const NodeGroupCachedOutputs> outputs;
+    if (key) {
+      outputs = memory_cache::get<NodeGroupCachedOutputs>(*key, compute_fn);
+      /* Socket values inside of the group may be requested now, e.g. because it has been opened in
+       * a node editor. Those are only available when the node group is evaluated again. */
+      for (const ComputeContextHash &hash : outputs->contexts_without_socket_values) {
+        if (should_log_socket_values_for_context(group_user_data, hash)) {
+          outputs = compute_fn();
+          break;
+        }
+      }
+    }
+    else {
+      outputs = compute_fn();
+    }
+    if (eval_log != nullptr) {
+      eval_log->add_reused_log(outputs->log);
+    }
+
+    for (const int i : group_fn.outputs.main.index_range()) {
+      const int lf_index = group_fn.outputs.main[i];
+      if (params.output_was_set(lf_index)) {
+        continue;
+      }
+      const GMutablePointer value = outputs->values[i];
+      value.type()->copy_construct(value.get(), params.get_output_data_ptr(lf_index));
+      params.output_set(lf_index);
+    }
+  }
+
+  void execute_eagerly(const Span<GPointer> main_inputs,
+                       const lf::Context &group_context,
+                       NodeGroupCachedOutputs &r_outputs) const
+  {
+    const GeometryNodesGroupFunction &group_fn = group_lf_graph_info_.function;
+    const Span<lf::Input> fn_inputs = group_lazy_function_.inputs();
+    const Span<lf::Output> fn_outputs = group_lazy_function_.outputs();
+    LinearAllocator<> &allocator = r_outputs.allocator;
+
+    Array<GMutablePointer> inputs(fn_inputs.size());
+    for (const int i : group_fn.inputs.main.index_range()) {
+      const GPointer value = main_inputs[i];
+      inputs[group_fn.inputs.main[i]] = {value.type(), const_cast<void *>(value.get())};
+    }
+    /* All outputs are computed, so that the cached values can be used by every caller. */
+    static const bool output_is_used = true;
+    for (const int i : group_fn.inputs.output_usages) {
+      inputs[i] = {CPPType::get<bool>(), const_cast<bool *>(&output_is_used)};
+    }
+    /* Anonymous attributes are propagated when the caller might need them. Since the cached
+     * outputs are used by all callers, propagate all of them. */
+    bke::AnonymousAttributeSet all_attributes;
+    all_attributes.names = std::make_shared<Set<std::string>>();
+    for (const GPointer value : main_inputs) {
+      if (value.type()->is<bke::GeometrySet>()) {
+        value.get<bke::GeometrySet>()->attribute_foreach(
+            {bke::GeometryComponent::Type::Mesh,
+             bke::GeometryComponent::Type::PointCloud,
+             bke::GeometryComponent::Type::Curve,
+             bke::GeometryComponent::Type::Instance,
+             bke::GeometryComponent::Type::GreasePencil},
+            true,
+            [&](const StringRef attribute_id,
+                const bke::AttributeMetaData & /*meta_data*/,
+                const bke::GeometryComponent & /*component*/) {
+              if (bke::attribute_name_is_anonymous(attribute_id)) {
+                all_attributes.names->add_as(attribute_id);
+              }
+            });
+      }
+    }
+    for (const int i : group_fn.inputs.attributes_to_propagate.range) {
+      inputs[i] = {CPPType::get<bke::AnonymousAttributeSet>(), &all_attributes};
+    }
+
+    Array<GMutablePointer> outputs(fn_outputs.size());
+    for (const int i : fn_outputs.index_range()) {
+      const CPPType &type = *fn_outputs[i].type;
+      outputs[i] = {type, allocator.allocate(type.size(), type.alignment())};
+    }
+    Array<std::optional<lf::ValueUsage>> input_usages(fn_inputs.size());
+    Array<lf::ValueUsage> output_usages(fn_outputs.size(), lf::ValueUsage::Used);
+    Array<bool> set_outputs(fn_outputs.size(), false);
+    lf::BasicParams eager_params{
+        group_lazy_function_, inputs, outputs, input_usages, output_usages, set_outputs};
+
+    /* Use separate storage, because the regular storage of the node might be used already. */
+    LinearAllocator<> storage_allocator;
+    void *storage = group_lazy_function_.init_storage(storage_allocator);
+    lf::Context eager_context{storage, group_context.user_data, group_context.local_user_data};
+    group_lazy_function_.execute(eager_params, eager_context);
+    group_lazy_function_.destruct_storage(storage);
+
+    for (const int i : group_fn.outputs.main) {
+      if (!set_outputs[i]) {
+        outputs[i].type()->value_initialize(outputs[i].get());
+      }
+      r_outputs.values.append(outputs[i]);
+    }
+    for (const int i : group_fn.outputs.input_usages) {
+      if (set_outputs[i]) {
+        outputs[i].destruct();
+      }
+    }
+  }
+
   void *init_storage(LinearAllocator<> &allocator) const override
   {
     Storage *s = allocator.construct<Storage>().release();
@@ -615,17 +615,49 @@ GeoTreeLogger &GeoModifierLog::get_local_tree_logger(const ComputeContext &compu
   return tree_logger;
 }
 
+void GeoModifierLog::add_reused_log(std::shared_ptr<GeoModifierLog> log)
+{
+  std::lock_guard lock{reused_logs_mutex_};
+  reused_logs_.append(std::move(log));
+}
+
+void GeoModifierLog::collect_tree_loggers(const ComputeContextHash &compute_context_hash,
+                                          Vector<GeoTreeLogger *> &r_tree_loggers)
+{
+  for (LocalData &local_data : data_per_thread_) {
+    destruct_ptr<GeoTreeLogger> *tree_log = local_data.tree_logger_by_context.lookup_ptr(
+        compute_context_hash);
+    if (tree_log != nullptr) {
+      r_tree_loggers.append(tree_log->get());
+    }
+  }
+  for (const std::shared_ptr<GeoModifierLog> &reused_log : reused_logs_) {
+    reused_log->collect_tree_loggers(compute_context_hash, r_tree_loggers);
+  }
+}
+
+Vector<ComputeContextHash> GeoModifierLog::get_nested_context_hashes(
+    const ComputeContextHash &compute_context_hash)
+{
+  VectorSet<ComputeContextHash> hashes;
+  Vector<GeoTreeLogger *> tree_loggers;
+  this->collect_tree_loggers(compute_context_hash, tree_loggers);
+  /* The tree loggers of newly found contexts are appended while iterating. */
+  for (int64_t i = 0; i < tree_loggers.size(); i++) {
+    for (const ComputeContextHash &child_hash : tree_loggers[i]->children_hashes) {
+      if (hashes.add(child_hash)) {
+        this->collect_tree_loggers(child_hash, tree_loggers);
+      }
+    }
+  }
+  return hashes.as_span();
+}
+
 GeoTreeLog &GeoModifierLog::get_tree_log(const ComputeContextHash &compute_context_hash)
 {
   GeoTreeLog &reduced_tree_log = *tree_logs_.lookup_or_add_cb(compute_context_hash, [&]() {
     Vector<GeoTreeLogger *> tree_logs;
-    for (LocalData &local_data : data_per_thread_) {
-      destruct_ptr<GeoTreeLogger> *tree_log = local_data.tree_logger_by_context.lookup_ptr(
-          compute_context_hash);
-      if (tree_log != nullptr) {
-        tree_logs.append(tree_log->get());
-      }
-    }
+    this->collect_tree_loggers(compute_context_hash, tree_logs);
     return std::make_unique<GeoTreeLog>(this, std::move(tree_logs));
   });
   return reduced_tree_log;
@@ -0,0 +1,447 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "BLI_hash.hh"
+#include "BLI_implicit_sharing_ptr.hh"
+#include "BLI_listbase.h"
+#include "BLI_memory_counter.hh"
+#include "BLI_set.hh"
+
+#include "DNA_curves_types.h"
+#include "DNA_mesh_types.h"
+#include "DNA_object_types.h"
+#include "DNA_pointcloud_types.h"
+
+#include "BKE_curves.hh"
+#include "BKE_geometry_set.hh"
+#include "BKE_instances.hh"
+#include "BKE_mesh_types.hh"
+#include "BKE_node.hh"
+#include "BKE_node_runtime.hh"
+#include "BKE_node_socket_value.hh"
+
+#include "FN_field.hh"
+
+#include "geometry_nodes_memoization.hh"
+
+namespace blender::nodes {
+
+using bke::GeometryComponent;
+using bke::GeometrySet;
+using bke::SocketValueVariant;
+
+static bool node_depends_on_context(const bNode &node)
+{
+  switch (node.type) {
+    case GEO_NODE_INPUT_SCENE_TIME:
+    case GEO_NODE_SIMULATION_INPUT:
+    case GEO_NODE_SIMULATION_OUTPUT:
+    case GEO_NODE_BAKE:
+    case GEO_NODE_VIEWER:
+    case GEO_NODE_WARNING:
+    case GEO_NODE_IS_VIEWPORT:
+    case GEO_NODE_SELF_OBJECT:
+    case GEO_NODE_INPUT_ACTIVE_CAMERA:
+    case GEO_NODE_OBJECT_INFO:
+    case GEO_NODE_COLLECTION_INFO:
+    case GEO_NODE_IMAGE_INFO:
+    case GEO_NODE_IMAGE_TEXTURE:
+    case GEO_NODE_IMPORT_OBJ:
+    case GEO_NODE_IMPORT_PLY:
+    case GEO_NODE_IMPORT_STL:
+    case GEO_NODE_GIZMO_LINEAR:
+    case GEO_NODE_GIZMO_DIAL:
+    case GEO_NODE_GIZMO_TRANSFORM:
+    case GEO_NODE_TOOL_SELECTION:
+    case GEO_NODE_TOOL_SET_SELECTION:
+    case GEO_NODE_TOOL_3D_CURSOR:
+    case GEO_NODE_TOOL_FACE_SET:
+    case GEO_NODE_TOOL_SET_FACE_SET:
+    case GEO_NODE_TOOL_ACTIVE_ELEMENT:
+    case GEO_NODE_TOOL_VIEWPORT_TRANSFORM:
+    case GEO_NODE_TOOL_MOUSE_POSITION:
+      return true;
+  }
+  /* The data of referenced data-blocks can change without the pointer changing. */
+  for (const bNodeSocket *socket : node.input_sockets()) {
+    if (ELEM(socket->type, SOCK_OBJECT, SOCK_COLLECTION, SOCK_IMAGE, SOCK_TEXTURE)) {
+      return true;
+    }
+  }
+  for (const bNodeSocket *socket : node.output_sockets()) {
+    if (ELEM(socket->type, SOCK_OBJECT, SOCK_COLLECTION, SOCK_IMAGE, SOCK_TEXTURE)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static bool node_group_is_memoizable_recursive(const bNodeTree &tree,
+                                               Set<const bNodeTree *> &checked_groups)
+{
+  if (!checked_groups.add(&tree)) {
+    return true;
+  }
+  tree.ensure_topology_cache();
+  for (const bNode *node : tree.all_nodes()) {
+    if (node_depends_on_context(*node)) {
+      return false;
+    }
+  }
+  for (const bNode *node : tree.group_nodes()) {
+    if (const bNodeTree *sub_tree = reinterpret_cast<const bNodeTree *>(node->id)) {
+      if (!node_group_is_memoizable_recursive(*sub_tree, checked_groups)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool node_group_is_memoizable(const bNodeTree &tree)
+{
+  Set<const bNodeTree *> checked_groups;
+  return node_group_is_memoizable_recursive(tree, checked_groups);
+}
+
+namespace {
+
+class NodeGroupEvalKey : public GenericKey {
+ public:
+  /** Most of the key is encoded in these words, which are compared bit by bit. */
+  Vector<uint64_t> words;
+  /** Fields can't be encoded in words, they are compared with their own equality operator. */
+  Vector<fn::GField> fields;
+  /**
+   * Keeps the sharing infos whose addresses are encoded in #words alive, so that the addresses
+   * can't be reused for other data while the key exists. The data itself may be freed though.
+   * Only weak users are added, so that the key does not force copies when the data is modified.
+   */
+  Vector<WeakImplicitSharingPtr> sharing_infos;
+  uint64_t hash_value = 0;
+
+  uint64_t hash() const override
+  {
+    return hash_value;
+  }
+
+  bool equal_to(const GenericKey &other) const override
+  {
+    if (const auto *other_typed = dynamic_cast<const NodeGroupEvalKey *>(&other)) {
+      return this->hash_value == other_typed->hash_value && this->words == other_typed->words &&
+             this->fields == other_typed->fields;
+    }
+    return false;
+  }
+
+  std::unique_ptr<GenericKey> to_storable() const override
+  {
+    return std::make_unique<NodeGroupEvalKey>(*this);
+  }
+
+  void add_bytes(const void *data, const int64_t size)
+  {
+    const int64_t old_size = words.size();
+    words.append_n_times(0, (size + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+    memcpy(words.data() + old_size, data, size);
+  }
+
+  void add_string(const StringRef str)
+  {
+    words.append(str.size());
+    this->add_bytes(str.data(), str.size());
+  }
+
+  void add_pointer(const void *ptr)
+  {
+    words.append(uint64_t(uintptr_t(ptr)));
+  }
+
+  void add_sharing_info(const ImplicitSharingInfo &sharing_info)
+  {
+    this->add_pointer(&sharing_info);
+    words.append(sharing_info.version());
+    sharing_info.add_weak_user();
+    sharing_infos.append(WeakImplicitSharingPtr(&sharing_info));
+  }
+
+  /**
+   * Identify a component by its address and version, which changes when it is modified in place.
+   */
+  void add_component(const GeometryComponent &component)
+  {
+    this->add_sharing_info(component);
+  }
+};
+
+}  // namespace
+
+static bool add_custom_data_to_key(NodeGroupEvalKey &key, const CustomData &data)
+{
+  key.words.append(data.totlayer);
+  for (const CustomDataLayer &layer : Span(data.layers, data.totlayer)) {
+    if (layer.sharing_info == nullptr) {
+      return false;
+    }
+    key.words.append(uint64_t(layer.type) << 32 | uint32_t(layer.flag));
+    key.words.append(uint64_t(layer.active) << 32 | uint32_t(layer.active_rnd));
+    key.add_string(layer.name);
+    key.add_sharing_info(*layer.sharing_info);
+  }
+  return true;
+}
+
+static void add_materials_to_key(NodeGroupEvalKey &key, const Span<const Material *> materials)
+{
+  key.words.append(materials.size());
+  for (const Material *material : materials) {
+    key.add_pointer(material);
+  }
+}
+
+static void add_vertex_group_names_to_key(NodeGroupEvalKey &key, const ListBase &names)
+{
+  LISTBASE_FOREACH (const bDeformGroup *, group, &names) {
+    key.add_string(group->name);
+  }
+}
+
+static bool instances_reference_data_blocks(const bke::Instances &instances)
+{
+  for (const bke::InstanceReference &reference : instances.references()) {
+    switch (reference.type()) {
+      case bke::InstanceReference::Type::None:
+        break;
+      case bke::InstanceReference::Type::Object:
+      case bke::InstanceReference::Type::Collection:
+        return true;
+      case bke::InstanceReference::Type::GeometrySet:
+        if (const bke::Instances *nested = reference.geometry_set().get_instances()) {
+          if (instances_reference_data_blocks(*nested)) {
+            return true;
+          }
+        }
+        break;
+    }
+  }
+  return false;
+}
+
+static bool add_geometry_to_key(NodeGroupEvalKey &key, const GeometrySet &geometry)
+{
+  key.add_string(geometry.name);
+  for (const GeometryComponent *component : geometry.get_components()) {
+    key.words.append(uint64_t(component->type()));
+    switch (component->type()) {
+      case GeometryComponent::Type::Mesh: {
+        if (!geometry.has_mesh()) {
+          break;
+        }
+        const Mesh &mesh = *geometry.get_mesh();
+        key.words.extend({uint64_t(mesh.verts_num),
+                          uint64_t(mesh.edges_num),
+                          uint64_t(mesh.faces_num),
+                          uint64_t(mesh.corners_num)});
+        if (mesh.faces_num > 0) {
+          if (mesh.runtime->face_offsets_sharing_info == nullptr) {
+            return false;
+          }
+          key.add_sharing_info(*mesh.runtime->face_offsets_sharing_info);
+        }
+        if (!add_custom_data_to_key(key, mesh.vert_data) ||
+            !add_custom_data_to_key(key, mesh.edge_data) ||
+            !add_custom_data_to_key(key, mesh.face_data) ||
+            !add_custom_data_to_key(key, mesh.corner_data))
+        {
+          return false;
+        }
+        add_materials_to_key(key, Span(mesh.mat, mesh.totcol));
+        add_vertex_group_names_to_key(key, mesh.vertex_group_names);
+        key.add_string(StringRef(mesh.active_color_attribute));
+        key.add_string(StringRef(mesh.default_color_attribute));
+        break;
+      }
+      case GeometryComponent::Type::PointCloud: {
+        if (!geometry.has_pointcloud()) {
+          break;
+        }
+        const PointCloud &pointcloud = *geometry.get_pointcloud();
+        key.words.append(pointcloud.totpoint);
+        if (!add_custom_data_to_key(key, pointcloud.pdata)) {
+          return false;
+        }
+        add_materials_to_key(key, Span(pointcloud.mat, pointcloud.totcol));
+        break;
+      }
+      case GeometryComponent::Type::Curve: {
+        if (!geometry.has_curves()) {
+          break;
+        }
+        const Curves &curves_id = *geometry.get_curves();
+        if (curves_id.surface != nullptr) {
+          /* The surface mesh can change independently of the curves. */
+          return false;
+        }
+        const bke::CurvesGeometry &curves = curves_id.geometry.wrap();
+        key.words.extend({uint64_t(curves.points_num()), uint64_t(curves.curves_num())});
+        if (curves.curves_num() > 0) {
+          if (curves.runtime->curve_offsets_sharing_info == nullptr) {
+            return false;
+          }
+          key.add_sharing_info(*curves.runtime->curve_offsets_sharing_info);
+        }
+        if (!add_custom_data_to_key(key, curves.point_data) ||
+            !add_custom_data_to_key(key, curves.curve_data))
+        {
+          return false;
+        }
+        add_materials_to_key(key, Span(curves_id.mat, curves_id.totcol));
+        add_vertex_group_names_to_key(key, curves.vertex_group_names);
+        break;
+      }
+      case GeometryComponent::Type::Instance: {
+        if (geometry.has_instances() &&
+            instances_reference_data_blocks(*geometry.get_instances()))
+        {
+          return false;
+        }
+        key.add_component(*component);
+        break;
+      }
+      case GeometryComponent::Type::Volume:
+      case GeometryComponent::Type::Edit:
+      case GeometryComponent::Type::GreasePencil: {
+        key.add_component(*component);
+        break;
+      }
+    }
+  }
+  return true;
+}
+
+static bool add_single_value_to_key(NodeGroupEvalKey &key, const GPointer value)
+{
+  const CPPType &type = *value.type();
+  key.add_pointer(&type);
+  if (type.is<std::string>()) {
+    key.add_string(*value.get<std::string>());
+    return true;
+  }
+  if (type.is_any<Object *, Collection *, Image *, Tex *>()) {
+    return false;
+  }
+  if (type.is_trivial()) {
+    key.add_bytes(value.get(), type.size());
+    return true;
+  }
+  return false;
+}
+
+std::unique_ptr<GenericKey> make_node_group_eval_key(const SessionUID &group_uid,
+                                                     const ComputeContextHash &context_hash,
+                                                     const bool is_logged,
+                                                     const Span<GPointer> inputs)
+{
+  auto key = std::make_unique<NodeGroupEvalKey>();
+  key->add_bytes(&group_uid, sizeof(group_uid));
+  key->words.extend({context_hash.v1, context_hash.v2, uint64_t(is_logged)});
+  for (const GPointer input : inputs) {
+    const CPPType &type = *input.type();
+    if (type.is<SocketValueVariant>()) {
+      const SocketValueVariant &value_variant = *input.get<SocketValueVariant>();
+      if (value_variant.is_single()) {
+        if (!add_single_value_to_key(*key, value_variant.get_single_ptr())) {
+          return nullptr;
+        }
+      }
+      else if (value_variant.is_context_dependent_field()) {
+        key->fields.append(value_variant.get<fn::GField>());
+      }
+      else {
+        return nullptr;
+      }
+    }
+    else if (type.is<GeometrySet>()) {
+      if (!add_geometry_to_key(*key, *input.get<GeometrySet>())) {
+        return nullptr;
+      }
+    }
+    else if (!add_single_value_to_key(*key, input)) {
+      return nullptr;
+    }
+  }
+
+  uint64_t hash = get_default_hash(key->words.size(), key->fields.size());
+  for (const uint64_t word : key->words) {
+    hash = get_default_hash(hash, word);
+  }
+  for (const fn::GField &field : key->fields) {
+    hash = get_default_hash(hash, field.hash());
+  }
+  key->hash_value = hash;
+  return key;
+}
+
+static void count_field_node_memory(const fn::FieldNode &node,
+                                    Set<const fn::FieldNode *> &counted_nodes,
+                                    int64_t &r_bytes)
+{
+  if (!counted_nodes.add(&node)) {
+    return;
+  }
+  switch (node.node_type()) {
+    case fn::FieldNodeType::Input: {
+      r_bytes += sizeof(fn::FieldInput);
+      break;
+    }
+    case fn::FieldNodeType::Constant: {
+      const fn::FieldConstant &constant = static_cast<const fn::FieldConstant &>(node);
+      r_bytes += sizeof(fn::FieldConstant) + constant.type().size();
+      break;
+    }
+    case fn::FieldNodeType::Operation: {
+      const fn::FieldOperation &operation = static_cast<const fn::FieldOperation &>(node);
+      r_bytes += sizeof(fn::FieldOperation) + operation.inputs().size_in_bytes();
+      for (const fn::GField &input : operation.inputs()) {
+        count_field_node_memory(input.node(), counted_nodes, r_bytes);
+      }
+      break;
+    }
+  }
+}
+
+int64_t node_group_eval_key_size_in_bytes(const GenericKey &key)
+{
+  const NodeGroupEvalKey &eval_key = dynamic_cast<const NodeGroupEvalKey &>(key);
+  int64_t bytes = sizeof(NodeGroupEvalKey) + eval_key.words.as_span().size_in_bytes() +
+                  eval_key.fields.as_span().size_in_bytes() +
+                  eval_key.sharing_infos.as_span().size_in_bytes();
+  Set<const fn::FieldNode *> counted_nodes;
+  for (const fn::GField &field : eval_key.fields) {
+    count_field_node_memory(field.node(), counted_nodes, bytes);
+  }
+  return bytes;
+}
+
+NodeGroupCachedOutputs::~NodeGroupCachedOutputs()
+{
+  for (GMutablePointer value : this->values) {
+    value.destruct();
+  }
+}
+
+void NodeGroupCachedOutputs::count_memory(MemoryCounter &memory) const
+{
+  memory.add(this->key_size_in_bytes);
+  for (const GMutablePointer value : this->values) {
+    if (value.type()->is<GeometrySet>()) {
+      value.get<GeometrySet>()->count_memory(memory);
+    }
+    else {
+      memory.add(value.type()->size());
+    }
+  }
+}
+
+}  // namespace blender::nodes
@@ -0,0 +1,80 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup nodes
+ *
+ * Node groups whose outputs only depend on their inputs can be memoized. The outputs of an
+ * evaluation are stored in the global #memory_cache and are reused when the node group is evaluated
+ * with the same inputs again, e.g. in the next depsgraph evaluation after a change further
+ * downstream in the node tree.
+ */
+
+#pragma once
+
+#include "BLI_compute_context.hh"
+#include "BLI_generic_key.hh"
+#include "BLI_generic_pointer.hh"
+#include "BLI_linear_allocator.hh"
+#include "BLI_memory_cache.hh"
+#include "BLI_session_uid.h"
+#include "BLI_vector.hh"
+
+struct bNodeTree;
+
+namespace blender::nodes {
+
+namespace geo_eval_log {
+class GeoModifierLog;
+}
+
+/**
+ * Checks if the outputs of the node group (including nested groups) only depend on its inputs.
+ * That is not the case when it uses e.g. the scene time, other data-blocks or the tool context.
+ */
+bool node_group_is_memoizable(const bNodeTree &tree);
+
+/**
+ * Create a key that identifies the evaluation of a node group with the given inputs. Geometries
+ * are identified by the implicit-sharing info and version of their data, so that unchanged data
+ * is recognized even when it is in a different geometry. Other values are compared by value.
+ *
+ * Evaluations that are logged are cached separately, because their outputs include the log.
+ *
+ * \return Null if some input can't be part of a key.
+ */
+std::unique_ptr<GenericKey> make_node_group_eval_key(const SessionUID &group_uid,
+                                                     const ComputeContextHash &context_hash,
+                                                     bool is_logged,
+                                                     Span<GPointer> inputs);
+
+/**
+ * Approximate memory used by a key created with #make_node_group_eval_key, including the fields
+ * it references. Geometries are only referenced weakly, so their data is not included.
+ */
+int64_t node_group_eval_key_size_in_bytes(const GenericKey &key);
+
+/**
+ * Outputs of a node group evaluation that are stored in the #memory_cache.
+ */
+class NodeGroupCachedOutputs : public memory_cache::CachedValue {
+ public:
+  LinearAllocator<> allocator;
+  Vector<GMutablePointer> values;
+  /**
+   * Everything that was logged inside the node group during the evaluation. It is added to the
+   * log of every evaluation that reuses the outputs, since the nodes are not executed again then.
+   */
+  std::shared_ptr<geo_eval_log::GeoModifierLog> log;
+  /** Nested compute contexts whose socket values are not in #log. */
+  Vector<ComputeContextHash> contexts_without_socket_values;
+  /** The key is stored in the cache along with these outputs. */
+  int64_t key_size_in_bytes = 0;
+
+  ~NodeGroupCachedOutputs() override;
+
+  void count_memory(MemoryCounter &memory) const override;
+};
+
+}  // namespace blender::nodes
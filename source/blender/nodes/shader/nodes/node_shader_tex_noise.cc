@@ -239,6 +239,75 @@ class NoiseFunction : public mf::MultiFunction {
     return signature;
   }
 
+  struct NoiseParams {
+    float detail;
+    float roughness;
+    float lacunarity;
+    float offset;
+    float gain;
+    float distortion;
+  };
+
+  /**
+   * Evaluate the noise for many positions at once. This is used when only the positions differ
+   * between elements, which is the common case.
+   */
+  template<typename T, typename PositionFn>
+  void call_batched(const IndexMask &mask,
+                    const PositionFn &get_position,
+                    const NoiseParams &noise_params,
+                    MutableSpan<float> r_factor,
+                    MutableSpan<ColorGeometry4f> r_color) const
+  {
+    static constexpr int64_t chunk_size = 256;
+    std::array<T, chunk_size> positions_buffer;
+    std::array<float, chunk_size> factors_buffer;
+    std::array<float3, chunk_size> colors_buffer;
+    mask.foreach_segment([&](const IndexMaskSegment segment) {
+      for (int64_t start = 0; start < segment.size(); start += chunk_size) {
+        const IndexMaskSegment chunk = segment.slice(
+            start, std::min(chunk_size, segment.size() - start));
+        MutableSpan<T> positions(positions_buffer.data(), chunk.size());
+        for (const int64_t i : chunk.index_range()) {
+          positions[i] = get_position(chunk[i]);
+        }
+        if (!r_factor.is_empty()) {
+          MutableSpan<float> factors(factors_buffer.data(), chunk.size());
+          noise::perlin_fractal_distorted<T>(positions,
+                                             noise_params.detail,
+                                             noise_params.roughness,
+                                             noise_params.lacunarity,
+                                             noise_params.offset,
+                                             noise_params.gain,
+                                             noise_params.distortion,
+                                             type_,
+                                             normalize_,
+                                             factors);
+          for (const int64_t i : chunk.index_range()) {
+            r_factor[chunk[i]] = factors[i];
+          }
+        }
+        if (!r_color.is_empty()) {
+          MutableSpan<float3> colors(colors_buffer.data(), chunk.size());
+          noise::perlin_float3_fractal_distorted<T>(positions,
+                                                    noise_params.detail,
+                                                    noise_params.roughness,
+                                                    noise_params.lacunarity,
+                                                    noise_params.offset,
+                                                    noise_params.gain,
+                                                    noise_params.distortion,
+                                                    type_,
+                                                    normalize_,
+                                                    colors);
+          for (const int64_t i : chunk.index_range()) {
+            const float3 &c = colors[i];
+            r_color[chunk[i]] = ColorGeometry4f(c[0], c[1], c[2], 1.0f);
+          }
+        }
+      }
+    });
+  }
+
   void call(const IndexMask &mask, mf::Params params, mf::Context /*context*/) const override
   {
     int param = ELEM(dimensions_, 2, 3, 4) + ELEM(dimensions_, 1, 4);
@@ -269,6 +338,64 @@ class NoiseFunction : public mf::MultiFunction {
     const bool compute_factor = !r_factor.is_empty();
     const bool compute_color = !r_color.is_empty();
 
+    if (detail.is_single() && roughness.is_single() && lacunarity.is_single() &&
+        offset.is_single() && gain.is_single() && distortion.is_single())
+    {
+      const NoiseParams noise_params{math::clamp(detail.get_internal_single(), 0.0f, 15.0f),
+                                     math::max(roughness.get_internal_single(), 0.0f),
+                                     lacunarity.get_internal_single(),
+                                     offset.get_internal_single(),
+                                     gain.get_internal_single(),
+                                     distortion.get_internal_single()};
+      switch (dimensions_) {
+        case 1: {
+          const VArray<float> &w = params.readonly_single_input<float>(0, "W");
+          this->call_batched<float>(
+              mask,
+              [&](const int64_t i) { return w[i] * scale[i]; },
+              noise_params,
+              r_factor,
+              r_color);
+          break;
+        }
+        case 2: {
+          const VArray<float3> &vector = params.readonly_single_input<float3>(0, "Vector");
+          this->call_batched<float2>(
+              mask,
+              [&](const int64_t i) { return float2(vector[i] * scale[i]); },
+              noise_params,
+              r_factor,
+              r_color);
+          break;
+        }
+        case 3: {
+          const VArray<float3> &vector = params.readonly_single_input<float3>(0, "Vector");
+          this->call_batched<float3>(
+              mask,
+              [&](const int64_t i) { return vector[i] * scale[i]; },
+              noise_params,
+              r_factor,
+              r_color);
+          break;
+        }
+        case 4: {
+          const VArray<float3> &vector = params.readonly_single_input<float3>(0, "Vector");
+          const VArray<float> &w = params.readonly_single_input<float>(1, "W");
+          this->call_batched<float4>(
+              mask,
+              [&](const int64_t i) {
+                const float3 position_vector = vector[i] * scale[i];
+                return float4(position_vector, w[i] * scale[i]);
+              },
+              noise_params,
+              r_factor,
+              r_color);
+          break;
+        }
+      }
+      return;
+    }
+
     switch (dimensions_) {
       case 1: {
         const VArray<float> &w = params.readonly_single_input<float>(0, "W");
@@ -47,6 +47,7 @@
 #include BLI_SYSTEM_PID_H
 
 #include "BLO_readfile.hh"
+#include "BLO_undofile.hh"
 #include "BLT_translation.hh"
 
 #include "BLF_api.hh"
@@ -2159,6 +2160,100 @@ static void wm_autosave_location(char filepath[FILE_MAX])
   BLI_path_join(filepath, FILE_MAX, tempdir_base, filename);
 }
 
+#define AUTOSAVE_JOURNAL_EXT ".journal"
+
+/** Journal of the incremental auto-save, null when the full file was written last. */
+static MemFileJournal *wm_autosave_journal = nullptr;
+
+static void wm_autosave_journal_location(char filepath[FILE_MAX])
+{
+  wm_autosave_location(filepath);
+  BLI_strncat(filepath, AUTOSAVE_JOURNAL_EXT, FILE_MAX);
+}
+
+static void wm_autosave_journal_delete()
+{
+  if (wm_autosave_journal) {
+    BLO_memfile_journal_free(wm_autosave_journal);
+    wm_autosave_journal = nullptr;
+  }
+
+  char filepath[FILE_MAX];
+  wm_autosave_journal_location(filepath);
+  if (BLI_exists(filepath)) {
+    BLI_delete(filepath, false, false);
+  }
+}
+
+/**
+ * Append the changes of the active global undo step to the auto-save journal, instead of writing
+ * the whole file. The undo step includes the recovery information, see #BKE_memfile_undo_encode.
+ *
+ * \return False when the full file has to be written instead.
+ */
+static bool wm_autosave_write_incremental(wmWindowManager *wm)
+{
+  if (!USER_EXPERIMENTAL_TEST(&U, use_incremental_autosave)) {
+    return false;
+  }
+  MemFile *memfile = ED_undosys_stack_memfile_get_if_active(wm->undo_stack);
+  if (memfile == nullptr) {
+    return false;
+  }
+
+  char filepath[FILE_MAX];
+  wm_autosave_journal_location(filepath);
+  if (wm_autosave_journal &&
+      !STREQ(BLO_memfile_journal_filepath(wm_autosave_journal), filepath))
+  {
+    /* The file was saved under a different name. */
+    BLO_memfile_journal_free(wm_autosave_journal);
+    wm_autosave_journal = nullptr;
+  }
+  if (wm_autosave_journal == nullptr) {
+    wm_autosave_journal = BLO_memfile_journal_new(filepath);
+  }
+  return BLO_memfile_journal_write(wm_autosave_journal, memfile);
+}
+
+/**
+ * Write the auto-save file from its journal, when the journal is more recent.
+ */
+static void wm_autosave_journal_recover(const char *filepath)
+{
+  char journal_filepath[FILE_MAX];
+  SNPRINTF(journal_filepath, "%s" AUTOSAVE_JOURNAL_EXT, filepath);
+  if (!BLI_exists(journal_filepath)) {
+    return;
+  }
+  if (BLI_exists(filepath) && !BLI_file_older(filepath, journal_filepath)) {
+    return;
+  }
+  if (!BLO_memfile_journal_recover(journal_filepath, filepath)) {
+    CLOG_WARN(&LOG, "Failed to recover auto-save journal \"%s\"", journal_filepath);
+  }
+}
+
+/**
+ * Write the auto-save files of all journals in the temporary directory, so that they can be
+ * selected for recovery.
+ */
+static void wm_autosave_journal_recover_all()
+{
+  direntry *files;
+  const uint files_num = BLI_filelist_dir_contents(BKE_tempdir_base(), &files);
+  for (const uint i : blender::IndexRange(files_num)) {
+    if (!BLI_str_endswith(files[i].relname, ".blend" AUTOSAVE_JOURNAL_EXT)) {
+      continue;
+    }
+    char filepath[FILE_MAX];
+    STRNCPY(filepath, files[i].path);
+    filepath[strlen(filepath) - strlen(AUTOSAVE_JOURNAL_EXT)] = '\0';
+    wm_autosave_journal_recover(filepath);
+  }
+  BLI_filelist_free(files, files_num);
+}
+
 static bool wm_autosave_write_try(Main *bmain, wmWindowManager *wm)
 {
   char filepath[FILE_MAX];
@@ -2190,14 +2285,19 @@ void WM_autosave_write(wmWindowManager *wm, Main *bmain)
 {
   ED_editors_flush_edits(bmain);
 
-  char filepath[FILE_MAX];
-  wm_autosave_location(filepath);
-  /* Save as regular blend file with recovery information. */
-  const int fileflags = (G.fileflags & ~G_FILE_COMPRESS) | G_FILE_RECOVER_WRITE;
+  if (!wm_autosave_write_incremental(wm)) {
+    char filepath[FILE_MAX];
+    wm_autosave_location(filepath);
+    /* Save as regular blend file with recovery information. */
+    const int fileflags = (G.fileflags & ~G_FILE_COMPRESS) | G_FILE_RECOVER_WRITE;
 
-  /* Error reporting into console. */
-  BlendFileWriteParams params{};
-  BLO_write_file(bmain, filepath, fileflags, &params, nullptr);
+    /* Error reporting into console. */
+    BlendFileWriteParams params{};
+    BLO_write_file(bmain, filepath, fileflags, &params, nullptr);
+
+    /* The journal is older than the file now. */
+    wm_autosave_journal_delete();
+  }
 
   /* Restart auto-save timer. */
   wm_autosave_timer_end(wm);
@@ -2265,6 +2365,9 @@ void wm_autosave_delete()
 
   wm_autosave_location(filepath);
 
+  /* The journal is only written with global undo, in which case the auto-save is removed too. */
+  wm_autosave_journal_delete();
+
   if (BLI_exists(filepath)) {
     char filepath_quit[FILE_MAX];
     BLI_path_join(filepath_quit, sizeof(filepath_quit), BKE_tempdir_base(), BLENDER_QUIT_FILE);
@@ -3365,6 +3468,8 @@ static int wm_recover_auto_save_exec(bContext *C, wmOperator *op)
   RNA_string_get(op->ptr, "filepath", filepath);
   BLI_path_canonicalize_native(filepath, sizeof(filepath));
 
+  wm_autosave_journal_recover(filepath);
+
   wm_open_init_use_scripts(op, true);
   SET_FLAG_FROM_TEST(G.f, RNA_boolean_get(op->ptr, "use_scripts"), G_FLAG_SCRIPT_AUTOEXEC);
 
@@ -3391,6 +3496,8 @@ static int wm_recover_auto_save_invoke(bContext *C, wmOperator *op, const wmEven
 {
   char filepath[FILE_MAX];
 
+  wm_autosave_journal_recover_all();
+
   wm_autosave_location(filepath);
   RNA_string_set(op->ptr, "filepath", filepath);
   wm_open_init_use_scripts(op, true);
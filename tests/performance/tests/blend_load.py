@@ -5,12 +5,18 @@
 import api
 
 
-def _run(filepath):
+def _run(args):
     import bpy
     import time
 
+    filepath = args['filepath']
+
     # Load once to ensure it's cached by OS
     bpy.ops.wm.open_mainfile(filepath=filepath)
+    if args['only_old_version'] and tuple(bpy.data.version) >= tuple(bpy.app.version_file):
+        # Only files saved by older versions have data blocks that need to be converted to the
+        # current DNA, which is done in parallel.
+        return {}
     bpy.ops.wm.read_homefile(use_empty=True, use_factory_startup=True)
 
     # Measure loading the second time
@@ -23,20 +29,23 @@ def _run(filepath):
 
 
 class BlendLoadTest(api.Test):
-    def __init__(self, filepath):
+    def __init__(self, filepath, only_old_version=False):
         self.filepath = filepath
+        self.only_old_version = only_old_version
 
     def name(self):
         return self.filepath.stem
 
     def category(self):
-        return "blend_load"
+        return "blend_load_old_version" if self.only_old_version else "blend_load"
 
     def run(self, env, device_id):
-        result, _ = env.run_in_blender(_run, str(self.filepath))
+        args = {'filepath': str(self.filepath), 'only_old_version': self.only_old_version}
+        result, _ = env.run_in_blender(_run, args)
         return result
 
 
 def generate(env):
     filepaths = env.find_blend_files('*/*')
-    return [BlendLoadTest(filepath) for filepath in filepaths]
+    return ([BlendLoadTest(filepath) for filepath in filepaths] +
+            [BlendLoadTest(filepath, only_old_version=True) for filepath in filepaths])